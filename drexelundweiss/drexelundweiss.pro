@@ -1,4 +1,5 @@
 include(../plugins.pri)
+include(../modbus.pri)
 
 QT += \
     serialport \
@@ -35,6 +35,11 @@
 #include <hardware/modbus/modbusrtumaster.h>
 #include <hardware/modbus/modbusrtuhardwareresource.h>
 
+#include <modbusrtuscheduler.h>
+#include <modbusrtuslavescanner.h>
+
+#include <algorithm>
+
 IntegrationPluginDrexelUndWeiss::IntegrationPluginDrexelUndWeiss()
 {
     m_connectedStateTypeIds.insert(x2luThingClassId, x2luConnectedStateTypeId);
@@ -82,11 +87,25 @@ void IntegrationPluginDrexelUndWeiss::discoverThings(ThingDiscoveryInfo *info)
         info->finish(Thing::ThingErrorInvalidParameter, QT_TR_NOOP("The Modbus slave address must be between 1 and 254"));
         return;
     }
+
+    // Probe the slave address on all connected masters at the same time and offer only those where the device responds
+    ModbusRtuSlaveScanner *scanner = new ModbusRtuSlaveScanner(info);
+    scanner->setSlaveIds({static_cast<quint16>(slaveAddress)});
+    scanner->setProbeRegisters(QModbusDataUnit::HoldingRegisters, ModbusRegisterX2::Geraetetyp, 2);
     Q_FOREACH(ModbusRtuMaster *modbusMaster, hardwareManager()->modbusRtuResource()->modbusRtuMasters()) {
         qCDebug(dcDrexelUndWeiss()) << "Found RTU master resource" << modbusMaster << "connected" << modbusMaster->connected();
         if (!modbusMaster->connected()) {
             continue;
         }
+        scanner->addMaster(modbusMaster);
+    }
+
+    connect(scanner, &ModbusRtuSlaveScanner::slaveFound, info, [this, info, slaveAddress](const ModbusRtuSlaveScanner::Result &result){
+        ModbusRtuMaster *modbusMaster = hardwareManager()->modbusRtuResource()->getModbusRtuMaster(result.modbusUuid);
+        if (!modbusMaster)
+            return;
+
+        qCDebug(dcDrexelUndWeiss()) << "Device responded on" << modbusMaster->serialPort() << "slave address" << slaveAddress;
         QString name;
         if (info->thingClassId() == x2wpThingClassId) {
             name = QT_TR_NOOP("X2 Heat pump");
@@ -99,9 +118,13 @@ void IntegrationPluginDrexelUndWeiss::discoverThings(ThingDiscoveryInfo *info)
         params << Param(m_modbusUuidParamTypeIds.value(info->thingClassId()), modbusMaster->modbusUuid());
         descriptor.setParams(params);
         info->addThingDescriptor(descriptor);
-    }
-    info->finish(Thing::ThingErrorNoError);
-    return;
+    });
+
+    connect(scanner, &ModbusRtuSlaveScanner::finished, info, [info](){
+        info->finish(Thing::ThingErrorNoError);
+    });
+
+    scanner->startScan();
 }
 
 void IntegrationPluginDrexelUndWeiss::setupThing(ThingSetupInfo *info)
@@ -124,7 +147,7 @@ void IntegrationPluginDrexelUndWeiss::setupThing(ThingSetupInfo *info)
         return info->finish(Thing::ThingErrorHardwareNotAvailable, QT_TR_NOOP("The Modbus RTU interface is not connected."));
     }
 
-    ModbusRtuReply *reply = modbus->readHoldingRegister(slaveAddress, ModbusRegisterX2::Geraetetyp, 2);
+    ModbusRtuReply *reply = ModbusRtuScheduler::scheduler(modbus)->readHoldingRegister(slaveAddress, ModbusRegisterX2::Geraetetyp, 2);
     connect(reply, &ModbusRtuReply::finished, reply, &ModbusRtuReply::deleteLater);
     connect(reply, &ModbusRtuReply::finished, info, [reply, modbus, info, thing, this] {
         if (info->isFinished())
@@ -246,7 +269,7 @@ void IntegrationPluginDrexelUndWeiss::sendWriteRequest(ThingActionInfo *info, ui
     QVector<uint16_t> values;
     values.append(static_cast<uint16_t>(value>>16));
     values.append(static_cast<uint16_t>(value&0xffff));
-    ModbusRtuReply *reply = modbus->writeHoldingRegisters(slaveAddress, modbusRegister, values);
+    ModbusRtuReply *reply = ModbusRtuScheduler::scheduler(modbus)->writeHoldingRegisters(slaveAddress, modbusRegister, values);
     connect(reply, &ModbusRtuReply::finished, reply, &ModbusRtuReply::deleteLater);
     connect(reply, &ModbusRtuReply::finished, info, [info, reply, this] {
 
@@ -267,8 +290,11 @@ void IntegrationPluginDrexelUndWeiss::thingRemoved(Thing *thing)
 {
     qCDebug(dcDrexelUndWeiss()) << "Thing removed" << thing->name();
 
-    if (thing->thingClassId() == x2luThingClassId || thing->thingClassId() == x2luThingClassId) {
-        m_modbusRtuMasters.remove(thing);
+    if (thing->thingClassId() == x2luThingClassId || thing->thingClassId() == x2wpThingClassId) {
+        ModbusRtuMaster *modbus = m_modbusRtuMasters.take(thing);
+        SlaveKey key(modbus, thing->paramValue(m_slaveIdParamTypeIds.value(thing->thingClassId())).toUInt());
+        m_unbatchableRegisters.remove(key);
+        m_blockTimeouts.remove(key);
     }
 
     if (myThings().isEmpty()) {
@@ -296,9 +322,11 @@ void IntegrationPluginDrexelUndWeiss::updateStates(Thing *thing)
         }
         uint slaveAddress = thing->paramValue(x2luThingSlaveAddressParamTypeId).toUInt();
 
-        readHoldingRegister(thing, modbus, slaveAddress, ModbusRegisterX2::AktiveLuefterstufe);
-        readHoldingRegister(thing, modbus, slaveAddress, ModbusRegisterX2::Betriebsart); // Ventilation mode
-        readHoldingRegister(thing, modbus, slaveAddress, ModbusRegisterX2::CO2);
+        QList<uint> modbusRegisters;
+        modbusRegisters << ModbusRegisterX2::AktiveLuefterstufe;
+        modbusRegisters << ModbusRegisterX2::Betriebsart; // Ventilation mode
+        modbusRegisters << ModbusRegisterX2::CO2;
+        readHoldingRegisters(thing, modbus, slaveAddress, modbusRegisters);
     }
 
     if (thing->thingClassId() == x2wpThingClassId) {
@@ -308,28 +336,123 @@ void IntegrationPluginDrexelUndWeiss::updateStates(Thing *thing)
         }
         int slaveAddress = thing->paramValue(x2wpThingSlaveAddressParamTypeId).toUInt();
 
-        readHoldingRegister(thing, modbus, slaveAddress, ModbusRegisterX2::Waermepumpe);
-        readHoldingRegister(thing, modbus, slaveAddress, ModbusRegisterX2::RaumSoll);
-        readHoldingRegister(thing, modbus, slaveAddress, ModbusRegisterX2::Raum);
-        readHoldingRegister(thing, modbus, slaveAddress, ModbusRegisterX2::TemperaturWarmwasserspeicherUnten);
-        readHoldingRegister(thing, modbus, slaveAddress, ModbusRegisterX2::BrauchwasserSolltermperatur);
-        readHoldingRegister(thing, modbus, slaveAddress, ModbusRegisterX2::Auszenluft);
-        readHoldingRegister(thing, modbus, slaveAddress, ModbusRegisterX2::Summenstoerung);
-        readHoldingRegister(thing, modbus, slaveAddress, ModbusRegisterX2::LeistungKompressor);
-        readHoldingRegister(thing, modbus, slaveAddress, ModbusRegisterX2::LeistungWarmwasser);
-        readHoldingRegister(thing, modbus, slaveAddress, ModbusRegisterX2::LeistungRaumheizung);
-        readHoldingRegister(thing, modbus, slaveAddress, ModbusRegisterX2::LeistungLuftvorwaermung);
-        readHoldingRegister(thing, modbus, slaveAddress, ModbusRegisterX2::EnergieKompressor);
-        readHoldingRegister(thing, modbus, slaveAddress, ModbusRegisterX2::EnergieWarmwasser);
-        readHoldingRegister(thing, modbus, slaveAddress, ModbusRegisterX2::EnergieRaumheizung);
-        readHoldingRegister(thing, modbus, slaveAddress, ModbusRegisterX2::EnergieLuftvorerwarrmung);
+        QList<uint> modbusRegisters;
+        modbusRegisters << ModbusRegisterX2::Waermepumpe;
+        modbusRegisters << ModbusRegisterX2::RaumSoll;
+        modbusRegisters << ModbusRegisterX2::Raum;
+        modbusRegisters << ModbusRegisterX2::TemperaturWarmwasserspeicherUnten;
+        modbusRegisters << ModbusRegisterX2::BrauchwasserSolltermperatur;
+        modbusRegisters << ModbusRegisterX2::Auszenluft;
+        modbusRegisters << ModbusRegisterX2::Summenstoerung;
+        modbusRegisters << ModbusRegisterX2::LeistungKompressor;
+        modbusRegisters << ModbusRegisterX2::LeistungWarmwasser;
+        modbusRegisters << ModbusRegisterX2::LeistungRaumheizung;
+        modbusRegisters << ModbusRegisterX2::LeistungLuftvorwaermung;
+        modbusRegisters << ModbusRegisterX2::EnergieKompressor;
+        modbusRegisters << ModbusRegisterX2::EnergieWarmwasser;
+        modbusRegisters << ModbusRegisterX2::EnergieRaumheizung;
+        modbusRegisters << ModbusRegisterX2::EnergieLuftvorerwarrmung;
+        readHoldingRegisters(thing, modbus, slaveAddress, modbusRegisters);
     }
 }
 
+QList<QPair<uint, uint> > IntegrationPluginDrexelUndWeiss::planRegisterReads(ModbusRtuMaster *modbus, uint slaveAddress, const QList<uint> &modbusRegisters) const
+{
+    // Each X2 value is 32 bit wide and starts on an even address. Group the values into as few
+    // reads as possible, only values close to each other and never a register the controller
+    // rejected within a block read.
+    QList<uint> sortedRegisters = modbusRegisters;
+    std::sort(sortedRegisters.begin(), sortedRegisters.end());
+
+    QSet<uint> unbatchableRegisters = m_unbatchableRegisters.value(SlaveKey(modbus, slaveAddress));
+
+    QList<QPair<uint, uint> > blocks;
+    foreach (uint modbusRegister, sortedRegisters) {
+        bool batchable = !unbatchableRegisters.contains(modbusRegister);
+        if (batchable && !blocks.isEmpty() && !unbatchableRegisters.contains(blocks.last().first)) {
+            QPair<uint, uint> &block = blocks.last();
+            uint blockEnd = block.first + block.second;
+            if (modbusRegister <= blockEnd + s_maxBlockGap && modbusRegister + 2 - block.first <= s_maxBlockSize) {
+                block.second = qMax(blockEnd, modbusRegister + 2) - block.first;
+                continue;
+            }
+        }
+
+        blocks.append(QPair<uint, uint>(modbusRegister, 2));
+    }
+
+    return blocks;
+}
+
+void IntegrationPluginDrexelUndWeiss::readHoldingRegisters(Thing *thing, ModbusRtuMaster *modbus, uint slaveAddress, const QList<uint> &modbusRegisters)
+{
+    typedef QPair<uint, uint> Block;
+    foreach (const Block &block, planRegisterReads(modbus, slaveAddress, modbusRegisters)) {
+        if (block.second <= 2) {
+            readHoldingRegister(thing, modbus, slaveAddress, block.first);
+            continue;
+        }
+
+        QList<uint> blockRegisters;
+        foreach (uint modbusRegister, modbusRegisters) {
+            if (modbusRegister >= block.first && modbusRegister + 2 <= block.first + block.second) {
+                blockRegisters.append(modbusRegister);
+            }
+        }
+        std::sort(blockRegisters.begin(), blockRegisters.end());
+
+        qCDebug(dcDrexelUndWeiss()) << "Reading" << blockRegisters.count() << "values from register" << block.first << "size" << block.second;
+        ModbusRtuReply *reply = ModbusRtuScheduler::scheduler(modbus)->readHoldingRegister(slaveAddress, block.first, block.second);
+        connect(reply, &ModbusRtuReply::finished, reply, &ModbusRtuReply::deleteLater);
+        connect(reply, &ModbusRtuReply::finished, this, [=] {
+            SlaveKey key(modbus, slaveAddress);
+            bool rejected = reply->error() == ModbusRtuReply::Error::ProtocolError;
+
+            // Some controllers silently drop block reads they don't support. Only count the timeout
+            // if the controller was answering, otherwise it is just offline.
+            if (reply->error() == ModbusRtuReply::Error::TimeoutError && thing->stateValue(m_connectedStateTypeIds.value(thing->thingClassId())).toBool()) {
+                int timeouts = ++m_blockTimeouts[key][block.first];
+                qCDebug(dcDrexelUndWeiss()) << "Block read from register" << block.first << "size" << block.second << "timed out" << timeouts << "times";
+                rejected = timeouts >= s_maxBlockTimeouts;
+            }
+
+            if (rejected) {
+                // The controller does not accept this block, read these values one by one from now on
+                qCWarning(dcDrexelUndWeiss()) << "Block read from register" << block.first << "size" << block.second << "rejected" << reply->errorString() << "Reading the values separately.";
+                m_blockTimeouts[key].remove(block.first);
+                foreach (uint modbusRegister, blockRegisters) {
+                    m_unbatchableRegisters[key].insert(modbusRegister);
+                    readHoldingRegister(thing, modbus, slaveAddress, modbusRegister);
+                }
+                return;
+            }
+
+            if (reply->error() != ModbusRtuReply::Error::NoError) {
+                qCWarning(dcDrexelUndWeiss()) << "Modbus error" << reply->errorString();
+                thing->setStateValue(m_connectedStateTypeIds.value(thing->thingClassId()), false);
+                return;
+            }
+            thing->setStateValue(m_connectedStateTypeIds.value(thing->thingClassId()), true);
+            if (m_blockTimeouts.contains(key))
+                m_blockTimeouts[key].remove(block.first);
+
+            QVector<quint16> result = reply->result();
+            if (static_cast<uint>(result.length()) != block.second) {
+                return;
+            }
+
+            foreach (uint modbusRegister, blockRegisters) {
+                int offset = modbusRegister - block.first;
+                uint32_t value = (static_cast<uint32_t>(result[offset])<<16 | result[offset + 1]);
+                processRegisterValue(thing, modbusRegister, value);
+            }
+        });
+    }
+}
 
 void IntegrationPluginDrexelUndWeiss::readHoldingRegister(Thing *thing, ModbusRtuMaster *modbus, uint slaveAddress, uint modbusRegister)
 {
-    ModbusRtuReply *reply = modbus->readHoldingRegister(slaveAddress, modbusRegister, 2); // min 2 registers must be read
+    ModbusRtuReply *reply = ModbusRtuScheduler::scheduler(modbus)->readHoldingRegister(slaveAddress, modbusRegister, 2); // min 2 registers must be read
     connect(reply, &ModbusRtuReply::finished, reply, &ModbusRtuReply::deleteLater);
     connect(reply, &ModbusRtuReply::finished, this, [reply, thing, this] {
         if (reply->error() != ModbusRtuReply::Error::NoError) {
@@ -342,217 +465,221 @@ void IntegrationPluginDrexelUndWeiss::readHoldingRegister(Thing *thing, ModbusRt
             return;
         }
         uint32_t value = (static_cast<uint32_t>(reply->result()[0])<<16 | reply->result()[1]);
+        processRegisterValue(thing, reply->registerAddress(), value);
+    });
+}
 
-        if (thing->thingClassId() == x2wpThingClassId) {
-            switch (reply->registerAddress()) {
-            case ModbusRegisterX2::Waermepumpe:
-                thing->setStateValue(x2wpPowerStateTypeId, value);
-                break;
-
-            case ModbusRegisterX2::RaumSoll:
-                thing->setStateValue(x2wpTargetTemperatureStateTypeId, value/1000.00);
-                break;
-
-            case ModbusRegisterX2::Raum:
-                thing->setStateValue(x2wpTemperatureStateTypeId, value/1000.00);
-                break;
-
-            case ModbusRegisterX2::TemperaturWarmwasserspeicherUnten:
-                thing->setStateValue(x2wpWaterTemperatureStateTypeId, value/1000.00);
-                break;
-            case ModbusRegisterX2::BrauchwasserSolltermperatur:
-                thing->setStateValue(x2wpTargetWaterTemperatureStateTypeId, value/1000.00);
-                break;
-            case ModbusRegisterX2::Auszenluft:
-                thing->setStateValue(x2wpOutsideAirTemperatureStateTypeId, value/1000.00);
-                break;
-
-            case ModbusRegisterX2::Summenstoerung:
-                if (value != 0) {
-                    //get actual error
-                } else {
-                    thing->setStateValue(x2wpErrorStateTypeId, "No error");
-                }
-                break;
-
-            case ModbusRegisterX2::StoerungAbluftventilator:
-                if (value != 0)
-                    thing->setStateValue(x2wpErrorStateTypeId, "Exhaust fan");
-                break;
-
-            case ModbusRegisterX2::StoerungBoilerfuehlerElektroheizstab:
-                if (value != 0)
-                    thing->setStateValue(x2wpErrorStateTypeId, "Boiler sensor electric heating element");
-                break;
-
-            case ModbusRegisterX2::StoerungBoilerfuehlerSolar:
-                if (value != 0)
-                    thing->setStateValue(x2wpErrorStateTypeId, "Boiler sensor solar");
-                break;
-
-            case  ModbusRegisterX2::StoerungBoilerfuehlerWaermepumpe:
-                if (value != 0)
-                    thing->setStateValue(x2wpErrorStateTypeId, "Boiler sensor heat pump");
-                break;
-
-            case  ModbusRegisterX2::StoerungBoileruebertemperatur:
-                if (value != 0)
-                    thing->setStateValue(x2wpErrorStateTypeId, "Boiler overtemperature");
-                break;
-
-            case  ModbusRegisterX2::StoerungCO2Sensor:
-                if (value != 0)
-                    thing->setStateValue(x2wpErrorStateTypeId, "CO2-Sensor");
-                break;
-
-            case  ModbusRegisterX2::StoerungDruckverlustAbluftZuGrosz:
-                if (value != 0)
-                    thing->setStateValue(x2wpErrorStateTypeId, "Pressure loss exhaust air too big");
-                break;
-
-            case ModbusRegisterX2::StoerungDruckverlustZuluftZuGrosz:
-                if (value != 0)
-                    thing->setStateValue(x2wpErrorStateTypeId, "Pressure loss supply air too large");
-                break;
-
-            case ModbusRegisterX2::StoerungDurchflussmengeHeizgkreis:
-                if (value != 0)
-                    thing->setStateValue(x2wpErrorStateTypeId, "Flow rate of heating circuit");
-                break;
-
-            case ModbusRegisterX2::StoerungDurchflussmengeSolekreis:
-                if (value != 0)
-                    thing->setStateValue(x2wpErrorStateTypeId, "Flow rate brine circuit");
-                break;
-
-            case ModbusRegisterX2::StoerungTeilnehmerNichtErreichbar:
-                if (value != 0)
-                    thing->setStateValue(x2wpErrorStateTypeId, "Participant not available");
-                break;
-
-            case ModbusRegisterX2::StoerungTemperaturfuehlerAuszenluft:
-                if (value != 0)
-                    thing->setStateValue(x2wpErrorStateTypeId, "Temperature sensor outside air");
-                break;
-
-            case ModbusRegisterX2::StoerungTemperaturfuehlerHeizkreisVorlauf:
-                if (value != 0)
-                    thing->setStateValue(x2wpErrorStateTypeId, "Temperature sensor heating circuit flow");
-                break;
-
-            case ModbusRegisterX2::StoerungTemperaturfuehlerRaum:
-                if (value != 0)
-                    thing->setStateValue(x2wpErrorStateTypeId, "Temperature sensor room");
-                break;
-
-            case ModbusRegisterX2::StoerungTemperaturfuehlerSolarkollektor:
-                if (value != 0)
-                    thing->setStateValue(x2wpErrorStateTypeId, "Temperature sensor solar collector");
-                break;
-
-            case ModbusRegisterX2::StoerungTemperaturfuehlerSole:
-                if (value != 0)
-                    thing->setStateValue(x2wpErrorStateTypeId, "Temperature sensor brine");
-                break;
-
-            case ModbusRegisterX2::StoerungTemperaturfuehlerSoleAuszenluft:
-                if (value != 0)
-                    thing->setStateValue(x2wpErrorStateTypeId, "Temperature sensor brine outside air");
-                break;
-
-            case ModbusRegisterX2::StoerungWaermepumpeHochdruck:
-                if (value != 0)
-                    thing->setStateValue(x2wpErrorStateTypeId, "Heat pump high pressure");
-                break;
-
-            case ModbusRegisterX2::StoerungWaermepumpeNiederdruck:
-                if (value != 0)
-                    thing->setStateValue(x2wpErrorStateTypeId, "Heat pump low pressure");
-                break;
-
-            case ModbusRegisterX2::StoerungWertNichtZulaessig:
-                if (value != 0)
-                    thing->setStateValue(x2wpErrorStateTypeId, "Value not allowed");
-                break;
-
-            case ModbusRegisterX2::StoerungZuluftventilator:
-                if (value != 0)
-                    thing->setStateValue(x2wpErrorStateTypeId, "Supply air fan");
-                break;
-
-            case ModbusRegisterX2::LeistungKompressor:
-                thing->setStateValue(x2wpPowerCompressorStateTypeId, value/1000.00);
-                break;
-
-            case ModbusRegisterX2::LeistungWarmwasser:
-                thing->setStateValue(x2wpPowerWaterHeatingStateTypeId, value/1000.00);
-                break;
-
-            case ModbusRegisterX2::LeistungRaumheizung:
-                thing->setStateValue(x2wpPowerRoomHeatingStateTypeId, value/1000.00);
-                break;
-
-            case ModbusRegisterX2::LeistungLuftvorwaermung: {
-                float power = value/1000.00;
-                thing->setStateValue(x2wpPowerAirPreheatingStateTypeId, power);
-                power += thing->stateValue(x2wpPowerCompressorStateTypeId).toFloat();
-                thing->setStateValue(x2wpCurrentPowerStateTypeId, power);
-                break;
-            }
-            case ModbusRegisterX2::EnergieKompressor:
-                thing->setStateValue(x2wpEnergyCompressorStateTypeId, value/1000.00);
-                break;
-
-            case ModbusRegisterX2::EnergieWarmwasser:
-                thing->setStateValue(x2wpEnergyWaterHeatingStateTypeId, value/1000.00);
-                break;
-
-            case ModbusRegisterX2::EnergieRaumheizung:
-                thing->setStateValue(x2wpEnergyRoomHeatingStateTypeId, value/1000.00);
-                break;
-
-            case ModbusRegisterX2::EnergieLuftvorerwarrmung: {
-                float energy = value/1000.00;
-                thing->setStateValue(x2wpEnergyAirPreheatingStateTypeId, energy);
-                energy += thing->stateValue(x2wpEnergyCompressorStateTypeId).toFloat();
-                thing->setStateValue(x2wpTotalEnergyConsumedStateTypeId, energy);
-                break;
+void IntegrationPluginDrexelUndWeiss::processRegisterValue(Thing *thing, uint modbusRegister, uint32_t value)
+{
+    if (thing->thingClassId() == x2wpThingClassId) {
+        switch (modbusRegister) {
+        case ModbusRegisterX2::Waermepumpe:
+            thing->setStateValue(x2wpPowerStateTypeId, value);
+            break;
+
+        case ModbusRegisterX2::RaumSoll:
+            thing->setStateValue(x2wpTargetTemperatureStateTypeId, value/1000.00);
+            break;
+
+        case ModbusRegisterX2::Raum:
+            thing->setStateValue(x2wpTemperatureStateTypeId, value/1000.00);
+            break;
+
+        case ModbusRegisterX2::TemperaturWarmwasserspeicherUnten:
+            thing->setStateValue(x2wpWaterTemperatureStateTypeId, value/1000.00);
+            break;
+        case ModbusRegisterX2::BrauchwasserSolltermperatur:
+            thing->setStateValue(x2wpTargetWaterTemperatureStateTypeId, value/1000.00);
+            break;
+        case ModbusRegisterX2::Auszenluft:
+            thing->setStateValue(x2wpOutsideAirTemperatureStateTypeId, value/1000.00);
+            break;
+
+        case ModbusRegisterX2::Summenstoerung:
+            if (value != 0) {
+                //get actual error
+            } else {
+                thing->setStateValue(x2wpErrorStateTypeId, "No error");
             }
-            default:
-                break;
+            break;
+
+        case ModbusRegisterX2::StoerungAbluftventilator:
+            if (value != 0)
+                thing->setStateValue(x2wpErrorStateTypeId, "Exhaust fan");
+            break;
+
+        case ModbusRegisterX2::StoerungBoilerfuehlerElektroheizstab:
+            if (value != 0)
+                thing->setStateValue(x2wpErrorStateTypeId, "Boiler sensor electric heating element");
+            break;
+
+        case ModbusRegisterX2::StoerungBoilerfuehlerSolar:
+            if (value != 0)
+                thing->setStateValue(x2wpErrorStateTypeId, "Boiler sensor solar");
+            break;
+
+        case  ModbusRegisterX2::StoerungBoilerfuehlerWaermepumpe:
+            if (value != 0)
+                thing->setStateValue(x2wpErrorStateTypeId, "Boiler sensor heat pump");
+            break;
+
+        case  ModbusRegisterX2::StoerungBoileruebertemperatur:
+            if (value != 0)
+                thing->setStateValue(x2wpErrorStateTypeId, "Boiler overtemperature");
+            break;
+
+        case  ModbusRegisterX2::StoerungCO2Sensor:
+            if (value != 0)
+                thing->setStateValue(x2wpErrorStateTypeId, "CO2-Sensor");
+            break;
+
+        case  ModbusRegisterX2::StoerungDruckverlustAbluftZuGrosz:
+            if (value != 0)
+                thing->setStateValue(x2wpErrorStateTypeId, "Pressure loss exhaust air too big");
+            break;
+
+        case ModbusRegisterX2::StoerungDruckverlustZuluftZuGrosz:
+            if (value != 0)
+                thing->setStateValue(x2wpErrorStateTypeId, "Pressure loss supply air too large");
+            break;
+
+        case ModbusRegisterX2::StoerungDurchflussmengeHeizgkreis:
+            if (value != 0)
+                thing->setStateValue(x2wpErrorStateTypeId, "Flow rate of heating circuit");
+            break;
+
+        case ModbusRegisterX2::StoerungDurchflussmengeSolekreis:
+            if (value != 0)
+                thing->setStateValue(x2wpErrorStateTypeId, "Flow rate brine circuit");
+            break;
+
+        case ModbusRegisterX2::StoerungTeilnehmerNichtErreichbar:
+            if (value != 0)
+                thing->setStateValue(x2wpErrorStateTypeId, "Participant not available");
+            break;
+
+        case ModbusRegisterX2::StoerungTemperaturfuehlerAuszenluft:
+            if (value != 0)
+                thing->setStateValue(x2wpErrorStateTypeId, "Temperature sensor outside air");
+            break;
+
+        case ModbusRegisterX2::StoerungTemperaturfuehlerHeizkreisVorlauf:
+            if (value != 0)
+                thing->setStateValue(x2wpErrorStateTypeId, "Temperature sensor heating circuit flow");
+            break;
+
+        case ModbusRegisterX2::StoerungTemperaturfuehlerRaum:
+            if (value != 0)
+                thing->setStateValue(x2wpErrorStateTypeId, "Temperature sensor room");
+            break;
+
+        case ModbusRegisterX2::StoerungTemperaturfuehlerSolarkollektor:
+            if (value != 0)
+                thing->setStateValue(x2wpErrorStateTypeId, "Temperature sensor solar collector");
+            break;
+
+        case ModbusRegisterX2::StoerungTemperaturfuehlerSole:
+            if (value != 0)
+                thing->setStateValue(x2wpErrorStateTypeId, "Temperature sensor brine");
+            break;
+
+        case ModbusRegisterX2::StoerungTemperaturfuehlerSoleAuszenluft:
+            if (value != 0)
+                thing->setStateValue(x2wpErrorStateTypeId, "Temperature sensor brine outside air");
+            break;
+
+        case ModbusRegisterX2::StoerungWaermepumpeHochdruck:
+            if (value != 0)
+                thing->setStateValue(x2wpErrorStateTypeId, "Heat pump high pressure");
+            break;
+
+        case ModbusRegisterX2::StoerungWaermepumpeNiederdruck:
+            if (value != 0)
+                thing->setStateValue(x2wpErrorStateTypeId, "Heat pump low pressure");
+            break;
+
+        case ModbusRegisterX2::StoerungWertNichtZulaessig:
+            if (value != 0)
+                thing->setStateValue(x2wpErrorStateTypeId, "Value not allowed");
+            break;
+
+        case ModbusRegisterX2::StoerungZuluftventilator:
+            if (value != 0)
+                thing->setStateValue(x2wpErrorStateTypeId, "Supply air fan");
+            break;
+
+        case ModbusRegisterX2::LeistungKompressor:
+            thing->setStateValue(x2wpPowerCompressorStateTypeId, value/1000.00);
+            break;
+
+        case ModbusRegisterX2::LeistungWarmwasser:
+            thing->setStateValue(x2wpPowerWaterHeatingStateTypeId, value/1000.00);
+            break;
+
+        case ModbusRegisterX2::LeistungRaumheizung:
+            thing->setStateValue(x2wpPowerRoomHeatingStateTypeId, value/1000.00);
+            break;
+
+        case ModbusRegisterX2::LeistungLuftvorwaermung: {
+            float power = value/1000.00;
+            thing->setStateValue(x2wpPowerAirPreheatingStateTypeId, power);
+            power += thing->stateValue(x2wpPowerCompressorStateTypeId).toFloat();
+            thing->setStateValue(x2wpCurrentPowerStateTypeId, power);
+            break;
+        }
+        case ModbusRegisterX2::EnergieKompressor:
+            thing->setStateValue(x2wpEnergyCompressorStateTypeId, value/1000.00);
+            break;
+
+        case ModbusRegisterX2::EnergieWarmwasser:
+            thing->setStateValue(x2wpEnergyWaterHeatingStateTypeId, value/1000.00);
+            break;
+
+        case ModbusRegisterX2::EnergieRaumheizung:
+            thing->setStateValue(x2wpEnergyRoomHeatingStateTypeId, value/1000.00);
+            break;
+
+        case ModbusRegisterX2::EnergieLuftvorerwarrmung: {
+            float energy = value/1000.00;
+            thing->setStateValue(x2wpEnergyAirPreheatingStateTypeId, energy);
+            energy += thing->stateValue(x2wpEnergyCompressorStateTypeId).toFloat();
+            thing->setStateValue(x2wpTotalEnergyConsumedStateTypeId, energy);
+            break;
+        }
+        default:
+            break;
+        }
+    } else if (thing->thingClassId() == x2luThingClassId) {
+
+        switch (modbusRegister) {
+        case ModbusRegisterX2::Betriebsart:
+            if (value == VentilationMode::ManuellStufe0) {
+                thing->setStateValue(x2luVentilationModeStateTypeId, "Manual level 0");
+            } else if (value == VentilationMode::ManuellStufe1) {
+                thing->setStateValue(x2luVentilationModeStateTypeId, "Manual level 1");
+            } else if (value == VentilationMode::ManuellStufe2) {
+                thing->setStateValue(x2luVentilationModeStateTypeId, "Manual level 2");
+            } else if (value == VentilationMode::ManuellStufe3) {
+                thing->setStateValue(x2luVentilationModeStateTypeId, "Manual level 3");
+            } else if (value == VentilationMode::Automatikbetrieb) {
+                thing->setStateValue(x2luVentilationModeStateTypeId, "Automatic");
+            } else if (value == VentilationMode::Party) {
+                thing->setStateValue(x2luVentilationModeStateTypeId, "Party");
             }
-        } else if (thing->thingClassId() == x2luThingClassId) {
-
-            switch (reply->registerAddress()) {
-            case ModbusRegisterX2::Betriebsart:
-                if (value == VentilationMode::ManuellStufe0) {
-                    thing->setStateValue(x2luVentilationModeStateTypeId, "Manual level 0");
-                } else if (value == VentilationMode::ManuellStufe1) {
-                    thing->setStateValue(x2luVentilationModeStateTypeId, "Manual level 1");
-                } else if (value == VentilationMode::ManuellStufe2) {
-                    thing->setStateValue(x2luVentilationModeStateTypeId, "Manual level 2");
-                } else if (value == VentilationMode::ManuellStufe3) {
-                    thing->setStateValue(x2luVentilationModeStateTypeId, "Manual level 3");
-                } else if (value == VentilationMode::Automatikbetrieb) {
-                    thing->setStateValue(x2luVentilationModeStateTypeId, "Automatic");
-                } else if (value == VentilationMode::Party) {
-                    thing->setStateValue(x2luVentilationModeStateTypeId, "Party");
-                }
-                if (value == VentilationMode::ManuellStufe0) {
-                    thing->setStateValue(x2luPowerStateTypeId, false);
-                } else {
-                    thing->setStateValue(x2luPowerStateTypeId, true);
-                }
-                break;
-            case ModbusRegisterX2::AktiveLuefterstufe:
-                thing->setStateValue(x2luActiveVentilationLevelStateTypeId, value);
-                break;
-            case ModbusRegisterX2::CO2:
-                thing->setStateValue(x2luCo2StateTypeId, value);
-                break;
+            if (value == VentilationMode::ManuellStufe0) {
+                thing->setStateValue(x2luPowerStateTypeId, false);
+            } else {
+                thing->setStateValue(x2luPowerStateTypeId, true);
             }
+            break;
+        case ModbusRegisterX2::AktiveLuefterstufe:
+            thing->setStateValue(x2luActiveVentilationLevelStateTypeId, value);
+            break;
+        case ModbusRegisterX2::CO2:
+            thing->setStateValue(x2luCo2StateTypeId, value);
+            break;
         }
-    });
+    }
 }
 
 VentilationMode IntegrationPluginDrexelUndWeiss::getVentilationModeFromString(const QString &modeString)
@@ -37,6 +37,7 @@
 
 #include "modbusregisterdefinition.h"
 
+#include <QSet>
 #include <QDateTime>
 
 class IntegrationPluginDrexelUndWeiss : public IntegrationPlugin
@@ -68,6 +69,18 @@ private:
     void updateStates(Thing *thing);
     void discoverModbusSlaves(ModbusRtuMaster *modbus, uint slaveAddress);
     void readHoldingRegister(Thing *thing, ModbusRtuMaster *modbus, uint slaveAddress, uint modbusRegister);
+    void readHoldingRegisters(Thing *thing, ModbusRtuMaster *modbus, uint slaveAddress, const QList<uint> &modbusRegisters);
+    void processRegisterValue(Thing *thing, uint modbusRegister, uint32_t value);
+
+    // Block reads of the X2 values. Registers a controller rejected in a block, or which repeatedly
+    // timed out in a block while the controller was answering, are read one by one on that controller.
+    typedef QPair<ModbusRtuMaster *, uint> SlaveKey;
+    static const uint s_maxBlockSize = 32;
+    static const uint s_maxBlockGap = 8;
+    static const int s_maxBlockTimeouts = 3;
+    QHash<SlaveKey, QSet<uint> > m_unbatchableRegisters;
+    QHash<SlaveKey, QHash<uint, int> > m_blockTimeouts;
+    QList<QPair<uint, uint> > planRegisterReads(ModbusRtuMaster *modbus, uint slaveAddress, const QList<uint> &modbusRegisters) const;
 
     VentilationMode getVentilationModeFromString(const QString &modeString);
 
@@ -34,6 +34,10 @@
 
 NYMEA_LOGGING_CATEGORY(dcHuaweiFusionSolar, "HuaweiFusionSolar")
 
+const int HuaweiFusionSolar::s_initialRequestGap;
+const int HuaweiFusionSolar::s_minimumRequestGap;
+const int HuaweiFusionSolar::s_maximumRequestGap;
+
 HuaweiFusionSolar::HuaweiFusionSolar(const QHostAddress &hostAddress, uint port, quint16 slaveId, QObject *parent) :
     HuaweiFusionModbusTcpConnection(hostAddress, port, slaveId, parent),
     m_slaveId(slaveId)
@@ -45,9 +49,18 @@ HuaweiFusionSolar::HuaweiFusionSolar(const QHostAddress &hostAddress, uint port,
     connect(modbusTcpMaster(), &ModbusTcpMaster::connectionStateChanged, this, [=](bool connected){
         if (!connected) {
             m_registersQueue.clear();
+            resetRequestPacing();
         }
     });
 
+    connect(this, &HuaweiFusionModbusTcpConnection::lunaBattery1StatusChanged, this, [this](BatteryDeviceStatus lunaBattery1Status){
+        m_battery1Available = lunaBattery1Status != BatteryDeviceStatusOffline;
+    });
+
+    connect(this, &HuaweiFusionModbusTcpConnection::lunaBattery2StatusChanged, this, [this](BatteryDeviceStatus lunaBattery2Status){
+        m_battery2Available = lunaBattery2Status != BatteryDeviceStatusOffline;
+    });
+
     connect(this, &HuaweiFusionModbusTcpConnection::initializationFinished, this, [=](bool success) {
         if (success) {
             qCDebug(dcHuawei()) << "Huawei init finished successfully:" << model() << serialNumber() << productNumber();
@@ -107,6 +120,7 @@ void HuaweiFusionSolar::readNextRegister()
         return;
 
     m_currentRegisterRequest = m_registersQueue.dequeue();
+    m_requestTimer.start();
 
     switch (m_currentRegisterRequest) {
     case HuaweiFusionModbusTcpConnection::RegisterInverterActivePower: {
@@ -115,13 +129,13 @@ void HuaweiFusionSolar::readNextRegister()
         QModbusReply *reply = readInverterActivePower();
         if (!reply) {
             qCWarning(dcHuaweiFusionSolar()) << "Error occurred while reading \"Inverter active power\" registers from" << modbusTcpMaster()->hostAddress().toString() << modbusTcpMaster()->errorString();
-            finishRequest();
+            finishRequest(reply);
             return;
         }
 
         if (reply->isFinished()) {
             reply->deleteLater(); // Broadcast reply returns immediatly
-            finishRequest();
+            finishRequest(reply);
             return;
         }
 
@@ -138,7 +152,7 @@ void HuaweiFusionSolar::readNextRegister()
                 }
             }
 
-            finishRequest();
+            finishRequest(reply);
         });
 
         connect(reply, &QModbusReply::errorOccurred, this, [this, reply] (QModbusDevice::Error error){
@@ -160,13 +174,13 @@ void HuaweiFusionSolar::readNextRegister()
         QModbusReply *reply = readInverterInputPower();
         if (!reply) {
             qCWarning(dcHuaweiFusionSolar()) << "Error occurred while reading \"Inverter input power\" registers from" << modbusTcpMaster()->hostAddress().toString() << modbusTcpMaster()->errorString();
-            finishRequest();
+            finishRequest(reply);
             return;
         }
 
         if (reply->isFinished()) {
             reply->deleteLater(); // Broadcast reply returns immediatly
-            finishRequest();
+            finishRequest(reply);
             return;
         }
 
@@ -183,7 +197,7 @@ void HuaweiFusionSolar::readNextRegister()
                 }
             }
 
-            finishRequest();
+            finishRequest(reply);
         });
 
         connect(reply, &QModbusReply::errorOccurred, this, [this, reply] (QModbusDevice::Error error){
@@ -205,13 +219,13 @@ void HuaweiFusionSolar::readNextRegister()
         QModbusReply *reply = readInverterDeviceStatus();
         if (!reply) {
             qCWarning(dcHuaweiFusionSolar()) << "Error occurred while reading \"Inverter device status\" registers from" << modbusTcpMaster()->hostAddress().toString() << modbusTcpMaster()->errorString();
-            finishRequest();
+            finishRequest(reply);
             return;
         }
 
         if (reply->isFinished()) {
             reply->deleteLater(); // Broadcast reply returns immediatly
-            finishRequest();
+            finishRequest(reply);
             return;
         }
 
@@ -227,7 +241,7 @@ void HuaweiFusionSolar::readNextRegister()
                     processInverterDeviceStatusRegisterValues(unit.values());
                 }
             }
-            finishRequest();
+            finishRequest(reply);
         });
 
         connect(reply, &QModbusReply::errorOccurred, this, [this, reply] (QModbusDevice::Error error){
@@ -249,13 +263,13 @@ void HuaweiFusionSolar::readNextRegister()
         QModbusReply *reply = readInverterEnergyProduced();
         if (!reply) {
             qCWarning(dcHuaweiFusionSolar()) << "Error occurred while reading \"Inverter energy produced\" registers from" << modbusTcpMaster()->hostAddress().toString() << modbusTcpMaster()->errorString();
-            finishRequest();
+            finishRequest(reply);
             return;
         }
 
         if (reply->isFinished()) {
             reply->deleteLater(); // Broadcast reply returns immediatly
-            finishRequest();
+            finishRequest(reply);
             return;
         }
 
@@ -271,7 +285,7 @@ void HuaweiFusionSolar::readNextRegister()
                     processInverterEnergyProducedRegisterValues(unit.values());
                 }
             }
-            finishRequest();
+            finishRequest(reply);
         });
 
         connect(reply, &QModbusReply::errorOccurred, this, [this, reply] (QModbusDevice::Error error){
@@ -292,13 +306,13 @@ void HuaweiFusionSolar::readNextRegister()
         QModbusReply *reply = readPowerMeterActivePower();
         if (!reply) {
             qCWarning(dcHuaweiFusionSolar()) << "Error occurred while reading \"Power meter active power\" registers from" << modbusTcpMaster()->hostAddress().toString() << modbusTcpMaster()->errorString();
-            finishRequest();
+            finishRequest(reply);
             return;
         }
 
         if (reply->isFinished()) {
             reply->deleteLater(); // Broadcast reply returns immediatly
-            finishRequest();
+            finishRequest(reply);
             return;
         }
 
@@ -314,7 +328,7 @@ void HuaweiFusionSolar::readNextRegister()
                     processPowerMeterActivePowerRegisterValues(unit.values());
                 }
             }
-            finishRequest();
+            finishRequest(reply);
         });
 
         connect(reply, &QModbusReply::errorOccurred, this, [this, reply] (QModbusDevice::Error error){
@@ -336,13 +350,13 @@ void HuaweiFusionSolar::readNextRegister()
         QModbusReply *reply = readLunaBattery1Status();
         if (!reply) {
             qCWarning(dcHuaweiFusionSolar()) << "Error occurred while reading \"Luna 2000 Battery 1 status\" registers from" << modbusTcpMaster()->hostAddress().toString() << modbusTcpMaster()->errorString();
-            finishRequest();
+            finishRequest(reply);
             return;
         }
 
         if (reply->isFinished()) {
             reply->deleteLater(); // Broadcast reply returns immediatly
-            finishRequest();
+            finishRequest(reply);
             return;
         }
 
@@ -358,7 +372,7 @@ void HuaweiFusionSolar::readNextRegister()
                     processLunaBattery1StatusRegisterValues(unit.values());
                 }
             }
-            finishRequest();
+            finishRequest(reply);
         });
 
         connect(reply, &QModbusReply::errorOccurred, this, [this, reply] (QModbusDevice::Error error){
@@ -379,13 +393,13 @@ void HuaweiFusionSolar::readNextRegister()
         QModbusReply *reply = readLunaBattery1Power();
         if (!reply) {
             qCWarning(dcHuaweiFusionSolar()) << "Error occurred while reading \"Luna 2000 Battery 1 power\" registers from" << modbusTcpMaster()->hostAddress().toString() << modbusTcpMaster()->errorString();
-            finishRequest();
+            finishRequest(reply);
             return;
         }
 
         if (reply->isFinished()) {
             reply->deleteLater(); // Broadcast reply returns immediatly
-            finishRequest();
+            finishRequest(reply);
             return;
         }
 
@@ -401,7 +415,7 @@ void HuaweiFusionSolar::readNextRegister()
                     processLunaBattery1PowerRegisterValues(unit.values());
                 }
             }
-            finishRequest();
+            finishRequest(reply);
         });
 
         connect(reply, &QModbusReply::errorOccurred, this, [this, reply] (QModbusDevice::Error error){
@@ -422,13 +436,13 @@ void HuaweiFusionSolar::readNextRegister()
         QModbusReply *reply = readLunaBattery1Soc();
         if (!reply) {
             qCWarning(dcHuaweiFusionSolar()) << "Error occurred while reading \"Luna 2000 Battery 1 state of charge\" registers from" << modbusTcpMaster()->hostAddress().toString() << modbusTcpMaster()->errorString();
-            finishRequest();
+            finishRequest(reply);
             return;
         }
 
         if (reply->isFinished()) {
             reply->deleteLater(); // Broadcast reply returns immediatly
-            finishRequest();
+            finishRequest(reply);
             return;
         }
 
@@ -444,7 +458,7 @@ void HuaweiFusionSolar::readNextRegister()
                     processLunaBattery1SocRegisterValues(unit.values());
                 }
             }
-            finishRequest();
+            finishRequest(reply);
         });
 
         connect(reply, &QModbusReply::errorOccurred, this, [this, reply] (QModbusDevice::Error error){
@@ -466,13 +480,13 @@ void HuaweiFusionSolar::readNextRegister()
         QModbusReply *reply = readLunaBattery2Status();
         if (!reply) {
             qCWarning(dcHuaweiFusionSolar()) << "Error occurred while reading \"Luna 2000 Battery 2 status\" registers from" << modbusTcpMaster()->hostAddress().toString() << modbusTcpMaster()->errorString();
-            finishRequest();
+            finishRequest(reply);
             return;
         }
 
         if (reply->isFinished()) {
             reply->deleteLater(); // Broadcast reply returns immediatly
-            finishRequest();
+            finishRequest(reply);
             return;
         }
 
@@ -488,7 +502,7 @@ void HuaweiFusionSolar::readNextRegister()
                     processLunaBattery2StatusRegisterValues(unit.values());
                 }
             }
-            finishRequest();
+            finishRequest(reply);
         });
 
         connect(reply, &QModbusReply::errorOccurred, this, [this, reply] (QModbusDevice::Error error){
@@ -509,13 +523,13 @@ void HuaweiFusionSolar::readNextRegister()
         QModbusReply *reply = readLunaBattery2Power();
         if (!reply) {
             qCWarning(dcHuaweiFusionSolar()) << "Error occurred while reading \"Luna 2000 Battery 2 power\" registers from" << modbusTcpMaster()->hostAddress().toString() << modbusTcpMaster()->errorString();
-            finishRequest();
+            finishRequest(reply);
             return;
         }
 
         if (reply->isFinished()) {
             reply->deleteLater(); // Broadcast reply returns immediatly
-            finishRequest();
+            finishRequest(reply);
             return;
         }
 
@@ -531,7 +545,7 @@ void HuaweiFusionSolar::readNextRegister()
                     processLunaBattery2PowerRegisterValues(unit.values());
                 }
             }
-            finishRequest();
+            finishRequest(reply);
         });
 
         connect(reply, &QModbusReply::errorOccurred, this, [this, reply] (QModbusDevice::Error error){
@@ -552,13 +566,13 @@ void HuaweiFusionSolar::readNextRegister()
         QModbusReply *reply = readLunaBattery2Soc();
         if (!reply) {
             qCWarning(dcHuaweiFusionSolar()) << "Error occurred while reading \"Luna 2000 Battery 2 state of charge\" registers from" << modbusTcpMaster()->hostAddress().toString() << modbusTcpMaster()->errorString();
-            finishRequest();
+            finishRequest(reply);
             return;
         }
 
         if (reply->isFinished()) {
             reply->deleteLater(); // Broadcast reply returns immediatly
-            finishRequest();
+            finishRequest(reply);
             return;
         }
 
@@ -574,7 +588,7 @@ void HuaweiFusionSolar::readNextRegister()
                     processLunaBattery2SocRegisterValues(unit.values());
                 }
             }
-            finishRequest();
+            finishRequest(reply);
         });
 
         connect(reply, &QModbusReply::errorOccurred, this, [this, reply] (QModbusDevice::Error error){
@@ -622,10 +636,93 @@ bool HuaweiFusionSolar::valuesAreVaild(const QVector<quint16> &values, int readS
     return true;
 }
 
-void HuaweiFusionSolar::finishRequest()
+void HuaweiFusionSolar::finishRequest(QModbusReply *reply)
 {
+    updateBatteryAvailability(reply);
     m_currentRegisterRequest = -1;
-    QTimer::singleShot(1000, this, &HuaweiFusionSolar::readNextRegister);
+
+    // Adapt the gap between requests to what the dongle can handle: shrink it slowly
+    // towards the measured response time while requests succeed, back off quickly on
+    // timeouts and busy or gateway exceptions. Other errors, like reading registers the
+    // device does not have, say nothing about its load and leave the gap as it is.
+    bool success = reply && reply->error() == QModbusDevice::NoError;
+    if (success) {
+        qint64 responseTime = m_requestTimer.elapsed();
+        m_averageResponseTime = m_averageResponseTime < 0 ? responseTime : (m_averageResponseTime * 7 + responseTime) / 8;
+        m_errorRate = m_errorRate * 7 / 8;
+
+        // Only speed up while the device copes without errors
+        if (m_errorRate < 0.1) {
+            int targetGap = qBound(s_minimumRequestGap, static_cast<int>(m_averageResponseTime), s_maximumRequestGap);
+            m_requestGap = qMax(targetGap, m_requestGap * 3 / 4);
+        }
+    } else if (isCongestionError(reply)) {
+        m_errorRate = (m_errorRate * 7 + 1) / 8;
+        m_requestGap = qMin(s_maximumRequestGap, m_requestGap * 2);
+
+        if (reply && reply->error() == QModbusDevice::TimeoutError) {
+            m_requestGap = s_maximumRequestGap;
+        }
+
+        qCDebug(dcHuaweiFusionSolar()) << "Request failed, increasing the request gap to" << m_requestGap << "ms. Error rate:" << m_errorRate;
+    }
+
+    QTimer::singleShot(m_requestGap, this, &HuaweiFusionSolar::readNextRegister);
+}
+
+bool HuaweiFusionSolar::isCongestionError(QModbusReply *reply) const
+{
+    if (!reply)
+        return false;
+
+    if (reply->error() == QModbusDevice::TimeoutError)
+        return true;
+
+    if (reply->error() != QModbusDevice::ProtocolError || !reply->rawResult().isException())
+        return false;
+
+    switch (reply->rawResult().exceptionCode()) {
+    case QModbusPdu::ServerDeviceBusy:
+    case QModbusPdu::GatewayPathUnavailable:
+    case QModbusPdu::GatewayTargetDeviceFailedToRespond:
+        return true;
+    default:
+        return false;
+    }
+}
+
+void HuaweiFusionSolar::updateBatteryAvailability(QModbusReply *reply)
+{
+    // A device without this battery rejects its registers, stop polling them
+    if (!reply || reply->error() != QModbusDevice::ProtocolError || !reply->rawResult().isException()
+            || reply->rawResult().exceptionCode() != QModbusPdu::IllegalDataAddress)
+        return;
+
+    switch (m_currentRegisterRequest) {
+    case HuaweiFusionModbusTcpConnection::RegisterLunaBattery1Power:
+    case HuaweiFusionModbusTcpConnection::RegisterLunaBattery1Soc:
+        if (m_battery1Available)
+            qCDebug(dcHuaweiFusionSolar()) << "Luna 2000 battery 1 registers not available, stop polling them";
+
+        m_battery1Available = false;
+        break;
+    case HuaweiFusionModbusTcpConnection::RegisterLunaBattery2Power:
+    case HuaweiFusionModbusTcpConnection::RegisterLunaBattery2Soc:
+        if (m_battery2Available)
+            qCDebug(dcHuaweiFusionSolar()) << "Luna 2000 battery 2 registers not available, stop polling them";
+
+        m_battery2Available = false;
+        break;
+    default:
+        break;
+    }
+}
+
+void HuaweiFusionSolar::resetRequestPacing()
+{
+    m_requestGap = s_initialRequestGap;
+    m_averageResponseTime = -1;
+    m_errorRate = 0;
 }
 
 QString HuaweiFusionSolar::exceptionToString(QModbusPdu::ExceptionCode exception)
@@ -33,6 +33,7 @@
 
 #include <QObject>
 #include <QQueue>
+#include <QElapsedTimer>
 
 #include "huaweifusionmodbustcpconnection.h"
 
@@ -53,10 +54,24 @@ private:
     QModbusReply *m_initReply = nullptr;
 
     int m_currentRegisterRequest = -1;
-    void finishRequest();
+    void finishRequest(QModbusReply *reply);
 
+    // Adaptive pacing between requests, in ms
+    static const int s_initialRequestGap = 1000;
+    static const int s_minimumRequestGap = 100;
+    static const int s_maximumRequestGap = 5000;
+    int m_requestGap = s_initialRequestGap;
+    qint64 m_averageResponseTime = -1;
+    double m_errorRate = 0;
+    QElapsedTimer m_requestTimer;
+    void resetRequestPacing();
+    bool isCongestionError(QModbusReply *reply) const;
+
+    // Power and SoC of a battery are only read while the battery seems available. The status is
+    // read in any case and makes a battery available again once it comes online.
     bool m_battery1Available = true;
     bool m_battery2Available = true;
+    void updateBatteryAvailability(QModbusReply *reply);
 
     double m_actualInverterPower = 0;
 
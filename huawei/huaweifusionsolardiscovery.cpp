@@ -37,22 +37,69 @@ HuaweiFusionSolarDiscovery::HuaweiFusionSolarDiscovery(NetworkDeviceDiscovery *n
       m_port{port},
       m_slaveIds{slaveIds}
 {
+    // Only slave IDs answering on the inverter power register get a full connection.
+    // The dongle can be slow to answer, give it more time than the default.
+    m_probe = new ModbusNetworkProbe(this);
+    m_probe->addPort(m_port);
+    m_probe->setTimeout(3000);
+    m_probe->setStopOnFirstMatch(false);
 
+    foreach (quint16 slaveId, m_slaveIds) {
+        ModbusNetworkProbe::Fingerprint fingerprint;
+        fingerprint.name = "huawei-fusion-solar";
+        fingerprint.slaveId = slaveId;
+        fingerprint.registerType = QModbusDataUnit::HoldingRegisters;
+        fingerprint.registerAddress = 32080; // inverterActivePower
+        fingerprint.size = 2;
+        m_probe->addFingerprint(fingerprint);
+    }
+
+    connect(m_probe, &ModbusNetworkProbe::resultFound, this, [this](const ModbusNetworkProbe::Result &result){
+        foreach (const NetworkDeviceInfo &networkDeviceInfo, m_networkDeviceInfos) {
+            if (networkDeviceInfo.address() == result.address) {
+                checkNetworkDevice(networkDeviceInfo, result.slaveId);
+                return;
+            }
+        }
+    });
+
+    connect(m_probe, &ModbusNetworkProbe::finished, this, [this](){
+        m_probeFinished = true;
+        finishDiscoveryIfDone();
+    });
+
+    // Give the connections still initializing once all hosts have been probed a chance to finish,
+    // but don't wait forever for a device which never answers
+    m_gracePeriodTimer.setInterval(5000);
+    m_gracePeriodTimer.setSingleShot(true);
+    connect(&m_gracePeriodTimer, &QTimer::timeout, this, [this](){
+        qCDebug(dcHuawei()) << "Discovery: Grace period timer triggered.";
+        finishDiscovery();
+    });
 }
 
 void HuaweiFusionSolarDiscovery::startDiscovery()
 {
     qCInfo(dcHuawei()) << "Discovery: Start searching for Huawei FusionSolar SmartDongle in the network...";
     m_startDateTime = QDateTime::currentDateTime();
+    m_probeFinished = false;
+    m_finished = false;
+
     NetworkDeviceDiscoveryReply *discoveryReply = m_networkDeviceDiscovery->discover();
-    connect(discoveryReply, &NetworkDeviceDiscoveryReply::networkDeviceInfoAdded, this, &HuaweiFusionSolarDiscovery::checkNetworkDevice);
+    connect(discoveryReply, &NetworkDeviceDiscoveryReply::networkDeviceInfoAdded, this, [this](const NetworkDeviceInfo &networkDeviceInfo){
+        m_networkDeviceInfos.append(networkDeviceInfo);
+        m_probe->probe(networkDeviceInfo.address());
+    });
     connect(discoveryReply, &NetworkDeviceDiscoveryReply::finished, discoveryReply, &NetworkDeviceDiscoveryReply::deleteLater);
     connect(discoveryReply, &NetworkDeviceDiscoveryReply::finished, this, [=](){
-        // Finish with some delay so the last added network device information objects still can be checked.
-        QTimer::singleShot(3000, this, [this](){
-            qCDebug(dcHuawei()) << "Discovery: Grace period timer triggered.";
-            finishDiscovery();
-        });
+        m_networkDeviceInfos = discoveryReply->networkDeviceInfos();
+
+        // Probe network device infos not probed already...
+        foreach (const NetworkDeviceInfo &networkDeviceInfo, m_networkDeviceInfos)
+            m_probe->probe(networkDeviceInfo.address());
+
+        // The probe finishes once all pending hosts have been checked
+        m_probe->finish();
     });
 }
 
@@ -82,58 +129,66 @@ void HuaweiFusionSolarDiscovery::testNextConnection(const QHostAddress &address)
     }
 }
 
-void HuaweiFusionSolarDiscovery::checkNetworkDevice(const NetworkDeviceInfo &networkDeviceInfo)
+void HuaweiFusionSolarDiscovery::checkNetworkDevice(const NetworkDeviceInfo &networkDeviceInfo, quint16 slaveId)
 {
-    QQueue<HuaweiFusionSolar *> connectionQueue;
-    foreach (quint16 slaveId, m_slaveIds) {
-        HuaweiFusionSolar *connection = new HuaweiFusionSolar(networkDeviceInfo.address(), m_port, slaveId, this);
-        m_connections.append(connection);
-        connectionQueue.enqueue(connection);
-
-        connect(connection, &HuaweiFusionSolar::reachableChanged, this, [=](bool reachable){
-            if (!reachable) {
-                // Disconnected ... done with this connection
-                cleanupConnection(connection);
-                return;
-            }
+    HuaweiFusionSolar *connection = new HuaweiFusionSolar(networkDeviceInfo.address(), m_port, slaveId, this);
+    m_connections.append(connection);
+    m_pendingConnectionAttempts[networkDeviceInfo.address()].enqueue(connection);
 
-            // Todo: initialize and check if available
-            connect(connection, &HuaweiFusionSolar::initializationFinished, this, [=](bool success){
-                Result result;
-                result.networkDeviceInfo = networkDeviceInfo;
-                result.slaveId = slaveId;
-
-                if (success) {
-                    qCDebug(dcHuawei()) << "Huawei init finished successfully:" << connection->model() << connection->serialNumber() << connection->productNumber();
-                    result.modelName = connection->model();
-                    result.serialNumber = connection->serialNumber();
-                }
+    connect(connection, &HuaweiFusionSolar::reachableChanged, this, [=](bool reachable){
+        if (!reachable) {
+            // Disconnected ... done with this connection
+            cleanupConnection(connection);
+            return;
+        }
+
+        // Todo: initialize and check if available
+        connect(connection, &HuaweiFusionSolar::initializationFinished, this, [=](bool success){
+            Result result;
+            result.networkDeviceInfo = networkDeviceInfo;
+            result.slaveId = slaveId;
+
+            if (success) {
+                qCDebug(dcHuawei()) << "Huawei init finished successfully:" << connection->model() << connection->serialNumber() << connection->productNumber();
+                result.modelName = connection->model();
+                result.serialNumber = connection->serialNumber();
+            }
 
-                qCInfo(dcHuawei()) << "Discovery: --> Found" << networkDeviceInfo << "slave ID:" << slaveId;
-                m_results.append(result);
-            });
+            qCInfo(dcHuawei()) << "Discovery: --> Found" << networkDeviceInfo << "slave ID:" << slaveId;
+            m_results.append(result);
 
-            connection->initialize();
+            // Done with this connection
+            cleanupConnection(connection);
         });
 
-        // If we get any error...skip this host...
-        connect(connection->modbusTcpMaster(), &ModbusTcpMaster::connectionErrorOccurred, this, [=](QModbusDevice::Error error){
-            if (error != QModbusDevice::NoError) {
-                qCDebug(dcHuawei()) << "Discovery: Connection error on" << networkDeviceInfo.address().toString() << "Continue...";;
-                cleanupConnection(connection);
-            }
-        });
+        connection->initialize();
+    });
 
-        // If check reachability failed...skip this host...
-        connect(connection, &HuaweiFusionSolar::checkReachabilityFailed, this, [=](){
-            qCDebug(dcHuawei()) << "Discovery: Check reachability failed on" << networkDeviceInfo.address().toString() << "Continue...";;
+    // If we get any error...skip this host...
+    connect(connection->modbusTcpMaster(), &ModbusTcpMaster::connectionErrorOccurred, this, [=](QModbusDevice::Error error){
+        if (error != QModbusDevice::NoError) {
+            qCDebug(dcHuawei()) << "Discovery: Connection error on" << networkDeviceInfo.address().toString() << "Continue...";;
             cleanupConnection(connection);
-        });
+        }
+    });
+
+    // If check reachability failed...skip this host...
+    connect(connection, &HuaweiFusionSolar::checkReachabilityFailed, this, [=](){
+        qCDebug(dcHuawei()) << "Discovery: Check reachability failed on" << networkDeviceInfo.address().toString() << "Continue...";;
+        cleanupConnection(connection);
+    });
 
+    // The connections to one host are tested one after the other
+    int hostConnections = 0;
+    foreach (HuaweiFusionSolar *hostConnection, m_connections) {
+        if (hostConnection->modbusTcpMaster()->hostAddress() == networkDeviceInfo.address()) {
+            hostConnections++;
+        }
     }
 
-    m_pendingConnectionAttempts[networkDeviceInfo.address()] = connectionQueue;
-    testNextConnection(networkDeviceInfo.address());
+    if (hostConnections == m_pendingConnectionAttempts.value(networkDeviceInfo.address()).count()) {
+        testNextConnection(networkDeviceInfo.address());
+    }
 }
 
 void HuaweiFusionSolarDiscovery::cleanupConnection(HuaweiFusionSolar *connection)
@@ -145,12 +200,33 @@ void HuaweiFusionSolarDiscovery::cleanupConnection(HuaweiFusionSolar *connection
     }
 
     testNextConnection(connection->modbusTcpMaster()->hostAddress());
+    finishDiscoveryIfDone();
+}
+
+void HuaweiFusionSolarDiscovery::finishDiscoveryIfDone()
+{
+    if (m_finished || !m_probeFinished)
+        return;
+
+    if (m_connections.isEmpty()) {
+        finishDiscovery();
+    } else if (!m_gracePeriodTimer.isActive()) {
+        m_gracePeriodTimer.start();
+    }
 }
 
 void HuaweiFusionSolarDiscovery::finishDiscovery()
 {
     qint64 durationMilliSeconds = QDateTime::currentMSecsSinceEpoch() - m_startDateTime.toMSecsSinceEpoch();
 
+    // Make sure we finish only once
+    if (m_finished)
+        return;
+
+    m_finished = true;
+    m_gracePeriodTimer.stop();
+    m_pendingConnectionAttempts.clear();
+
     // Cleanup any leftovers...we don't care any more
     foreach (HuaweiFusionSolar *connection, m_connections)
         cleanupConnection(connection);
@@ -32,9 +32,11 @@
 #define HUAWEIFUSIONSOLARDISCOVERY_H
 
 #include <QObject>
+#include <QTimer>
 
 #include <network/networkdevicediscovery.h>
 
+#include "modbusnetworkprobe.h"
 #include "huaweifusionsolar.h"
 
 class HuaweiFusionSolarDiscovery : public QObject
@@ -63,14 +65,21 @@ private:
     QList<quint16> m_slaveIds;
     QDateTime m_startDateTime;
 
+    ModbusNetworkProbe *m_probe = nullptr;
+    bool m_probeFinished = false;
+    bool m_finished = false;
+    QTimer m_gracePeriodTimer;
+
+    NetworkDeviceInfos m_networkDeviceInfos;
     QHash<QHostAddress, QQueue<HuaweiFusionSolar *>> m_pendingConnectionAttempts;
     QList<HuaweiFusionSolar *> m_connections;
     QList<Result> m_results;
 
     void testNextConnection(const QHostAddress &address);
 
-    void checkNetworkDevice(const NetworkDeviceInfo &networkDeviceInfo);
+    void checkNetworkDevice(const NetworkDeviceInfo &networkDeviceInfo, quint16 slaveId);
     void cleanupConnection(HuaweiFusionSolar *connection);
+    void finishDiscoveryIfDone();
 
     void finishDiscovery();
 
@@ -37,7 +37,12 @@
 
 IntegrationPluginKostal::IntegrationPluginKostal()
 {
-
+    m_stateFilter.setRule(QString("voltagePhaseA"), ModbusStateFilter::voltageRule());
+    m_stateFilter.setRule(QString("voltagePhaseB"), ModbusStateFilter::voltageRule());
+    m_stateFilter.setRule(QString("voltagePhaseC"), ModbusStateFilter::voltageRule());
+    m_stateFilter.setRule(QString("voltage"), ModbusStateFilter::voltageRule());
+    m_stateFilter.setRule(QString("frequency"), ModbusStateFilter::frequencyRule());
+    m_stateFilter.setRule(QString("temperature"), ModbusStateFilter::temperatureRule());
 }
 
 void IntegrationPluginKostal::discoverThings(ThingDiscoveryInfo *info)
@@ -289,6 +294,8 @@ void IntegrationPluginKostal::thingRemoved(Thing *thing)
         delete connection;
     }
 
+    m_stateFilter.resetThing(thing->id());
+
     // Unregister related hardware resources
     if (m_monitors.contains(thing))
         hardwareManager()->networkDeviceDiscovery()->unregisterMonitor(m_monitors.take(thing));
@@ -394,9 +401,9 @@ void IntegrationPluginKostal::setupKostalConnection(ThingSetupInfo *info)
             thing->setStateValue(kostalInverterPhaseCCurrentStateTypeId, kostalConnection->currentPhase3());
 
             // Voltage
-            thing->setStateValue(kostalInverterVoltagePhaseAStateTypeId, kostalConnection->voltagePhase1());
-            thing->setStateValue(kostalInverterVoltagePhaseBStateTypeId, kostalConnection->voltagePhase2());
-            thing->setStateValue(kostalInverterVoltagePhaseCStateTypeId, kostalConnection->voltagePhase3());
+            m_stateFilter.setStateValue(thing, kostalInverterVoltagePhaseAStateTypeId, kostalConnection->voltagePhase1());
+            m_stateFilter.setStateValue(thing, kostalInverterVoltagePhaseBStateTypeId, kostalConnection->voltagePhase2());
+            m_stateFilter.setStateValue(thing, kostalInverterVoltagePhaseCStateTypeId, kostalConnection->voltagePhase3());
 
             // Phase power
             thing->setStateValue(kostalInverterCurrentPowerPhaseAStateTypeId, kostalConnection->activePowerPhase1());
@@ -404,7 +411,7 @@ void IntegrationPluginKostal::setupKostalConnection(ThingSetupInfo *info)
             thing->setStateValue(kostalInverterCurrentPowerPhaseCStateTypeId, kostalConnection->activePowerPhase3());
 
             // Others
-            thing->setStateValue(kostalInverterFrequencyStateTypeId, kostalConnection->gridFrequencyInverter());
+            m_stateFilter.setStateValue(thing, kostalInverterFrequencyStateTypeId, kostalConnection->gridFrequencyInverter());
             thing->setStateValue(kostalInverterTotalEnergyProducedStateTypeId, kostalConnection->totalYield() / 1000.0); // kWh
 
             // Power
@@ -415,8 +422,8 @@ void IntegrationPluginKostal::setupKostalConnection(ThingSetupInfo *info)
             if (batteryThings.count() == 1) {
                 Thing *batteryThing = batteryThings.first();
 
-                batteryThing->setStateValue(kostalBatteryVoltageStateTypeId, kostalConnection->batteryVoltage());
-                batteryThing->setStateValue(kostalBatteryTemperatureStateTypeId, kostalConnection->batteryTemperature());
+                m_stateFilter.setStateValue(batteryThing, kostalBatteryVoltageStateTypeId, kostalConnection->batteryVoltage());
+                m_stateFilter.setStateValue(batteryThing, kostalBatteryTemperatureStateTypeId, kostalConnection->batteryTemperature());
                 batteryThing->setStateValue(kostalBatteryBatteryLevelStateTypeId, kostalConnection->batteryStateOfCharge());
                 batteryThing->setStateValue(kostalBatteryBatteryCriticalStateTypeId, kostalConnection->batteryStateOfCharge() < 5);
 
@@ -445,16 +452,16 @@ void IntegrationPluginKostal::setupKostalConnection(ThingSetupInfo *info)
                 meterThing->setStateValue(kostalMeterCurrentPhaseCStateTypeId, kostalConnection->powerMeterCurrentPhase3());
 
                 // Voltage
-                meterThing->setStateValue(kostalMeterVoltagePhaseAStateTypeId, kostalConnection->powerMeterVoltagePhase1());
-                meterThing->setStateValue(kostalMeterVoltagePhaseBStateTypeId, kostalConnection->powerMeterVoltagePhase2());
-                meterThing->setStateValue(kostalMeterVoltagePhaseCStateTypeId, kostalConnection->powerMeterVoltagePhase3());
+                m_stateFilter.setStateValue(meterThing, kostalMeterVoltagePhaseAStateTypeId, kostalConnection->powerMeterVoltagePhase1());
+                m_stateFilter.setStateValue(meterThing, kostalMeterVoltagePhaseBStateTypeId, kostalConnection->powerMeterVoltagePhase2());
+                m_stateFilter.setStateValue(meterThing, kostalMeterVoltagePhaseCStateTypeId, kostalConnection->powerMeterVoltagePhase3());
 
                 // Current
                 meterThing->setStateValue(kostalMeterCurrentPowerPhaseAStateTypeId, kostalConnection->powerMeterActivePowerPhase1());
                 meterThing->setStateValue(kostalMeterCurrentPowerPhaseBStateTypeId, kostalConnection->powerMeterActivePowerPhase2());
                 meterThing->setStateValue(kostalMeterCurrentPowerPhaseCStateTypeId, kostalConnection->powerMeterActivePowerPhase3());
 
-                meterThing->setStateValue(kostalMeterFrequencyStateTypeId, kostalConnection->gridFrequencyPowerMeter());
+                m_stateFilter.setStateValue(meterThing, kostalMeterFrequencyStateTypeId, kostalConnection->gridFrequencyPowerMeter());
 
                 meterThing->setStateValue(kostalMeterTotalEnergyConsumedStateTypeId, kostalConnection->totalHomeConsumptionFromGrid() / 1000.0); // kWh
                 meterThing->setStateValue(kostalMeterTotalEnergyProducedStateTypeId, kostalConnection->totalEnergyAcToGrid() / 1000.0); // kWh
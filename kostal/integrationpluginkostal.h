@@ -38,6 +38,7 @@
 #include "extern-plugininfo.h"
 
 #include "kostalmodbustcpconnection.h"
+#include "modbusstatefilter.h"
 
 class IntegrationPluginKostal: public IntegrationPlugin
 {
@@ -58,6 +59,7 @@ private:
     PluginTimer *m_pluginTimer = nullptr;
     QHash<Thing *, KostalModbusTcpConnection *> m_kostalConnections;
     QHash<Thing *, NetworkDeviceMonitor *> m_monitors;
+    ModbusStateFilter m_stateFilter;
 
     void setupKostalConnection(ThingSetupInfo *info);
 
@@ -31,13 +31,52 @@
 #include "kostaldiscovery.h"
 #include "extern-plugininfo.h"
 
+#include <modbusdatautils.h>
+
 KostalDiscovery::KostalDiscovery(NetworkDeviceDiscovery *networkDeviceDiscovery, quint16 port, quint16 modbusAddress, QObject *parent) :
     QObject{parent},
     m_networkDeviceDiscovery{networkDeviceDiscovery},
     m_port{port},
     m_modbusAddress{modbusAddress}
 {
+    // Only hosts answering with the Kostal manufacturer string get a full connection
+    m_probe = new ModbusNetworkProbe(this);
+    m_probe->addPort(m_port);
+
+    ModbusNetworkProbe::Fingerprint fingerprint;
+    fingerprint.name = "kostal";
+    fingerprint.slaveId = m_modbusAddress;
+    fingerprint.registerType = QModbusDataUnit::HoldingRegisters;
+    fingerprint.registerAddress = 535; // inverterManufacturer
+    fingerprint.size = 16;
+    fingerprint.validator = [](const QVector<quint16> &values) {
+        return ModbusDataUtils::convertToString(values, ModbusDataUtils::ByteOrderLittleEndian).contains("KOSTAL", Qt::CaseInsensitive)
+                || ModbusDataUtils::convertToString(values, ModbusDataUtils::ByteOrderBigEndian).contains("KOSTAL", Qt::CaseInsensitive);
+    };
+    m_probe->addFingerprint(fingerprint);
+
+    connect(m_probe, &ModbusNetworkProbe::resultFound, this, [this](const ModbusNetworkProbe::Result &result){
+        foreach (const NetworkDeviceInfo &networkDeviceInfo, m_networkDeviceInfos) {
+            if (networkDeviceInfo.address() == result.address) {
+                checkNetworkDevice(networkDeviceInfo);
+                return;
+            }
+        }
+    });
 
+    connect(m_probe, &ModbusNetworkProbe::finished, this, [this](){
+        m_probeFinished = true;
+        finishDiscoveryIfDone();
+    });
+
+    // Give the connections still initializing once all hosts have been probed a chance to finish,
+    // but don't wait forever for a device which never answers
+    m_gracePeriodTimer.setInterval(5000);
+    m_gracePeriodTimer.setSingleShot(true);
+    connect(&m_gracePeriodTimer, &QTimer::timeout, this, [this](){
+        qCDebug(dcKostal()) << "Discovery: Grace period timer triggered.";
+        finishDiscovery();
+    });
 }
 
 void KostalDiscovery::startDiscovery()
@@ -45,27 +84,28 @@ void KostalDiscovery::startDiscovery()
     qCInfo(dcKostal()) << "Discovery: Start searching for Kostal inverters in the network...";
     NetworkDeviceDiscoveryReply *discoveryReply = m_networkDeviceDiscovery->discover();
 
-    // Imedialty check any new device gets discovered
-    connect(discoveryReply, &NetworkDeviceDiscoveryReply::networkDeviceInfoAdded, this, &KostalDiscovery::checkNetworkDevice);
+    m_startDateTime = QDateTime::currentDateTime();
+    m_probeFinished = false;
+    m_finished = false;
+
+    // Imedialty probe any new device gets discovered
+    connect(discoveryReply, &NetworkDeviceDiscoveryReply::networkDeviceInfoAdded, this, [this](const NetworkDeviceInfo &networkDeviceInfo){
+        m_networkDeviceInfos.append(networkDeviceInfo);
+        m_probe->probe(networkDeviceInfo.address());
+    });
 
     // Check what might be left on finished
-        connect(discoveryReply, &NetworkDeviceDiscoveryReply::finished, discoveryReply, &NetworkDeviceDiscoveryReply::deleteLater);
+    connect(discoveryReply, &NetworkDeviceDiscoveryReply::finished, discoveryReply, &NetworkDeviceDiscoveryReply::deleteLater);
     connect(discoveryReply, &NetworkDeviceDiscoveryReply::finished, this, [=](){
         qCDebug(dcKostal()) << "Discovery: Network discovery finished. Found" << discoveryReply->networkDeviceInfos().count() << "network devices";
         m_networkDeviceInfos = discoveryReply->networkDeviceInfos();
 
-        // Send a report request to nework device info not sent already...
-        foreach (const NetworkDeviceInfo &networkDeviceInfo, m_networkDeviceInfos) {
-            if (!m_verifiedNetworkDeviceInfos.contains(networkDeviceInfo)) {
-                checkNetworkDevice(networkDeviceInfo);
-            }
-        }
+        // Probe network device infos not probed already...
+        foreach (const NetworkDeviceInfo &networkDeviceInfo, m_networkDeviceInfos)
+            m_probe->probe(networkDeviceInfo.address());
 
-        // Give the last connections added right before the network discovery finished a chance to check the device...
-        QTimer::singleShot(3000, this, [this](){
-            qCDebug(dcKostal()) << "Discovery: Grace period timer triggered.";
-            finishDiscovery();
-        });
+        // The probe finishes once all pending hosts have been checked
+        m_probe->finish();
     });
 }
 
@@ -155,12 +195,33 @@ void KostalDiscovery::cleanupConnection(KostalModbusTcpConnection *connection)
     m_connections.removeAll(connection);
     connection->disconnectDevice();
     connection->deleteLater();
+
+    finishDiscoveryIfDone();
+}
+
+void KostalDiscovery::finishDiscoveryIfDone()
+{
+    if (m_finished || !m_probeFinished)
+        return;
+
+    if (m_connections.isEmpty()) {
+        finishDiscovery();
+    } else if (!m_gracePeriodTimer.isActive()) {
+        m_gracePeriodTimer.start();
+    }
 }
 
 void KostalDiscovery::finishDiscovery()
 {
     qint64 durationMilliSeconds = QDateTime::currentMSecsSinceEpoch() - m_startDateTime.toMSecsSinceEpoch();
 
+    // Make sure we finish only once
+    if (m_finished)
+        return;
+
+    m_finished = true;
+    m_gracePeriodTimer.stop();
+
     // Cleanup any leftovers...we don't care any more
     foreach (KostalModbusTcpConnection *connection, m_connections)
         cleanupConnection(connection);
@@ -36,6 +36,7 @@
 
 #include <network/networkdevicediscovery.h>
 
+#include "modbusnetworkprobe.h"
 #include "kostalmodbustcpconnection.h"
 
 class KostalDiscovery : public QObject
@@ -67,6 +68,11 @@ private:
 
     QDateTime m_startDateTime;
 
+    ModbusNetworkProbe *m_probe = nullptr;
+    bool m_probeFinished = false;
+    bool m_finished = false;
+    QTimer m_gracePeriodTimer;
+
     NetworkDeviceInfos m_networkDeviceInfos;
     NetworkDeviceInfos m_verifiedNetworkDeviceInfos;
 
@@ -76,6 +82,7 @@ private:
 
     void checkNetworkDevice(const NetworkDeviceInfo &networkDeviceInfo);
     void cleanupConnection(KostalModbusTcpConnection *connection);
+    void finishDiscoveryIfDone();
 
     void finishDiscovery();
 };
@@ -17,11 +17,25 @@ gcc {
 
 HEADERS += \
     modbusdatautils.h \
-    modbustcpmaster.h
+    modbusfuture.h \
+    modbusiothreadpool.h \
+    modbusnetworkprobe.h \
+    modbusrtuscheduler.h \
+    modbusrtuslavescanner.h \
+    modbusstatefilter.h \
+    modbustcpmaster.h \
+    modbusupdatecycle.h
 
 SOURCES += \
     modbusdatautils.cpp \
-    modbustcpmaster.cpp
+    modbusfuture.cpp \
+    modbusiothreadpool.cpp \
+    modbusnetworkprobe.cpp \
+    modbusrtuscheduler.cpp \
+    modbusrtuslavescanner.cpp \
+    modbusstatefilter.cpp \
+    modbustcpmaster.cpp \
+    modbusupdatecycle.cpp
 
 
 # define install target
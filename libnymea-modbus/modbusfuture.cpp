@@ -0,0 +1,138 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+*
+* Copyright 2013 - 2022, nymea GmbH
+* Contact: contact@nymea.io
+*
+* This file is part of nymea.
+* This project including source code and documentation is protected by
+* copyright law, and remains the property of nymea GmbH. All rights, including
+* reproduction, publication, editing and translation, are reserved. The use of
+* this project is subject to the terms of a license agreement to be concluded
+* with nymea GmbH in accordance with the terms of use of nymea GmbH, available
+* under https://nymea.io/license
+*
+* GNU Lesser General Public License Usage
+* Alternatively, this project may be redistributed and/or modified under the
+* terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; version 3. This project is distributed in the hope that
+* it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+* warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this project. If not, see <https://www.gnu.org/licenses/>.
+*
+* For any further details and any questions please contact us under
+* contact@nymea.io or see our FAQ/Licensing Information on
+* https://nymea.io/license/faq
+*
+* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "modbusfuture.h"
+
+#include <QTimer>
+#include <QSharedPointer>
+#include <QFutureInterface>
+
+static void finishRequest(QFutureInterface<ModbusRequestResult> &futureInterface, const ModbusRequestResult &result)
+{
+    // The reply might finish, time out or get destroyed, only the first one counts
+    if (futureInterface.isFinished())
+        return;
+
+    futureInterface.reportResult(result);
+    futureInterface.reportFinished();
+}
+
+static ModbusRequestResult resultFromReply(QModbusReply *reply)
+{
+    ModbusRequestResult result;
+    result.error = reply->error();
+    result.errorString = reply->errorString();
+    result.response = reply->rawResult();
+    result.unit = reply->result();
+    return result;
+}
+
+QFuture<ModbusRequestResult> ModbusFuture::fromReply(QModbusReply *reply, int timeout)
+{
+    QFutureInterface<ModbusRequestResult> futureInterface;
+    futureInterface.reportStarted();
+    QFuture<ModbusRequestResult> future = futureInterface.future();
+
+    if (!reply) {
+        ModbusRequestResult result;
+        result.error = QModbusDevice::UnknownError;
+        result.errorString = QStringLiteral("Could not send the modbus request.");
+        finishRequest(futureInterface, result);
+        return future;
+    }
+
+    if (reply->isFinished()) {
+        // Broadcast replies return immediatly
+        finishRequest(futureInterface, resultFromReply(reply));
+        reply->deleteLater();
+        return future;
+    }
+
+    QObject::connect(reply, &QModbusReply::finished, reply, [reply, futureInterface]() mutable {
+        finishRequest(futureInterface, resultFromReply(reply));
+        reply->deleteLater();
+    });
+
+    QObject::connect(reply, &QObject::destroyed, [futureInterface]() mutable {
+        ModbusRequestResult result;
+        result.error = QModbusDevice::ReplyAbortedError;
+        result.errorString = QStringLiteral("The modbus reply has been deleted before it finished.");
+        finishRequest(futureInterface, result);
+    });
+
+    if (timeout > 0) {
+        QTimer::singleShot(timeout, reply, [reply, futureInterface]() mutable {
+            ModbusRequestResult result;
+            result.error = QModbusDevice::TimeoutError;
+            result.errorString = QStringLiteral("The modbus request timed out.");
+            finishRequest(futureInterface, result);
+            reply->deleteLater();
+        });
+    }
+
+    return future;
+}
+
+QFuture<QList<ModbusRequestResult>> ModbusFuture::whenAll(const QList<QFuture<ModbusRequestResult>> &futures)
+{
+    QFutureInterface<QList<ModbusRequestResult>> futureInterface;
+    futureInterface.reportStarted();
+    QFuture<QList<ModbusRequestResult>> future = futureInterface.future();
+
+    if (futures.isEmpty()) {
+        futureInterface.reportResult(QList<ModbusRequestResult>());
+        futureInterface.reportFinished();
+        return future;
+    }
+
+    // Parent of all watchers, deleted once the last future finished
+    QObject *context = new QObject();
+    QSharedPointer<int> pendingCount(new int(futures.count()));
+
+    foreach (const QFuture<ModbusRequestResult> &requestFuture, futures) {
+        QFutureWatcher<ModbusRequestResult> *watcher = new QFutureWatcher<ModbusRequestResult>(context);
+        QObject::connect(watcher, &QFutureWatcherBase::finished, context, [context, futures, pendingCount, futureInterface]() mutable {
+            (*pendingCount)--;
+            if (*pendingCount > 0)
+                return;
+
+            QList<ModbusRequestResult> results;
+            foreach (const QFuture<ModbusRequestResult> &finishedFuture, futures)
+                results.append(finishedFuture.result());
+
+            futureInterface.reportResult(results);
+            futureInterface.reportFinished();
+            context->deleteLater();
+        });
+        watcher->setFuture(requestFuture);
+    }
+
+    return future;
+}
@@ -0,0 +1,82 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+*
+* Copyright 2013 - 2022, nymea GmbH
+* Contact: contact@nymea.io
+*
+* This file is part of nymea.
+* This project including source code and documentation is protected by
+* copyright law, and remains the property of nymea GmbH. All rights, including
+* reproduction, publication, editing and translation, are reserved. The use of
+* this project is subject to the terms of a license agreement to be concluded
+* with nymea GmbH in accordance with the terms of use of nymea GmbH, available
+* under https://nymea.io/license
+*
+* GNU Lesser General Public License Usage
+* Alternatively, this project may be redistributed and/or modified under the
+* terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; version 3. This project is distributed in the hope that
+* it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+* warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this project. If not, see <https://www.gnu.org/licenses/>.
+*
+* For any further details and any questions please contact us under
+* contact@nymea.io or see our FAQ/Licensing Information on
+* https://nymea.io/license/faq
+*
+* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef MODBUSFUTURE_H
+#define MODBUSFUTURE_H
+
+#include <QList>
+#include <QFuture>
+#include <QObject>
+#include <QFutureWatcher>
+#include <QModbusReply>
+#include <QModbusDataUnit>
+#include <QModbusResponse>
+
+typedef struct ModbusRequestResult {
+    QModbusDevice::Error error = QModbusDevice::NoError;
+    QString errorString;
+    QModbusResponse response;
+    QModbusDataUnit unit;
+} ModbusRequestResult;
+
+// Future based modbus requests. Instead of wiring the finished, errorOccurred and deleteLater
+// handling of each QModbusReply, the reply gets wrapped into a QFuture which finishes once the
+// reply finished, failed or the optional timeout in ms elapsed. The reply gets deleted internally.
+//
+// QFuture<ModbusRequestResult> power = master->readAsync(powerUnit, slaveId, 3000);
+// QFuture<ModbusRequestResult> energy = master->readAsync(energyUnit, slaveId, 3000);
+// ModbusFuture::onFinished(ModbusFuture::whenAll({power, energy}), this, [](const QList<ModbusRequestResult> &results){
+//     ...
+// });
+
+class ModbusFuture
+{
+public:
+    static QFuture<ModbusRequestResult> fromReply(QModbusReply *reply, int timeout = 0);
+
+    // Finishes once all given futures finished, the results have the same order as the futures
+    static QFuture<QList<ModbusRequestResult>> whenAll(const QList<QFuture<ModbusRequestResult>> &futures);
+
+    // Calls the functor with the result once the future finished. The functor will not be called
+    // if the context object has been deleted in the meantime.
+    template <typename T, typename Functor>
+    static void onFinished(const QFuture<T> &future, QObject *context, Functor functor)
+    {
+        QFutureWatcher<T> *watcher = new QFutureWatcher<T>(context);
+        QObject::connect(watcher, &QFutureWatcherBase::finished, context, [watcher, functor](){
+            functor(watcher->future().result());
+            watcher->deleteLater();
+        });
+        watcher->setFuture(future);
+    }
+
+};
+
+#endif // MODBUSFUTURE_H
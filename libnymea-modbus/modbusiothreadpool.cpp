@@ -0,0 +1,117 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+*
+* Copyright 2013 - 2022, nymea GmbH
+* Contact: contact@nymea.io
+*
+* This file is part of nymea.
+* This project including source code and documentation is protected by
+* copyright law, and remains the property of nymea GmbH. All rights, including
+* reproduction, publication, editing and translation, are reserved. The use of
+* this project is subject to the terms of a license agreement to be concluded
+* with nymea GmbH in accordance with the terms of use of nymea GmbH, available
+* under https://nymea.io/license
+*
+* GNU Lesser General Public License Usage
+* Alternatively, this project may be redistributed and/or modified under the
+* terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; version 3. This project is distributed in the hope that
+* it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+* warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this project. If not, see <https://www.gnu.org/licenses/>.
+*
+* For any further details and any questions please contact us under
+* contact@nymea.io or see our FAQ/Licensing Information on
+* https://nymea.io/license/faq
+*
+* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "modbusiothreadpool.h"
+
+#include <QCoreApplication>
+
+Q_LOGGING_CATEGORY(dcModbusIoThreadPool, "ModbusIoThreadPool")
+
+ModbusIoThreadPool *ModbusIoThreadPool::s_instance = nullptr;
+
+ModbusIoThreadPool *ModbusIoThreadPool::instance()
+{
+    if (!s_instance)
+        s_instance = new ModbusIoThreadPool(QCoreApplication::instance());
+
+    return s_instance;
+}
+
+ModbusIoThreadPool::ModbusIoThreadPool(QObject *parent) :
+    QObject(parent)
+{
+
+}
+
+ModbusIoThreadPool::~ModbusIoThreadPool()
+{
+    foreach (QThread *thread, m_threads) {
+        thread->quit();
+        thread->wait();
+        delete thread;
+    }
+
+    s_instance = nullptr;
+}
+
+int ModbusIoThreadPool::maximumThreadCount() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_maximumThreadCount;
+}
+
+void ModbusIoThreadPool::setMaximumThreadCount(int maximumThreadCount)
+{
+    QMutexLocker locker(&m_mutex);
+    m_maximumThreadCount = qMax(1, maximumThreadCount);
+}
+
+QThread *ModbusIoThreadPool::ioThread(const QString &bus)
+{
+    QMutexLocker locker(&m_mutex);
+    if (m_busThreads.contains(bus))
+        return m_busThreads.value(bus);
+
+    QThread *thread = nullptr;
+    if (m_threads.count() < m_maximumThreadCount) {
+        thread = new QThread();
+        thread->setObjectName(QString("modbus-io-%1").arg(m_threads.count()));
+        thread->start();
+        m_threads.append(thread);
+        qCDebug(dcModbusIoThreadPool()) << "Started I/O thread" << thread->objectName();
+    } else {
+        // Assign the bus to the thread serving the least buses
+        foreach (QThread *candidate, m_threads) {
+            if (!thread || m_busThreads.keys(candidate).count() < m_busThreads.keys(thread).count()) {
+                thread = candidate;
+            }
+        }
+    }
+
+    qCDebug(dcModbusIoThreadPool()) << "Assigned bus" << bus << "to I/O thread" << thread->objectName();
+    m_busThreads.insert(bus, thread);
+    return thread;
+}
+
+bool ModbusIoThreadPool::moveToIoThread(QObject *object, const QString &bus)
+{
+    if (object->parent()) {
+        qCWarning(dcModbusIoThreadPool()) << "Cannot move" << object << "into an I/O thread because it has a parent.";
+        return false;
+    }
+
+    if (object->thread() != QThread::currentThread()) {
+        qCWarning(dcModbusIoThreadPool()) << "Cannot move" << object << "into an I/O thread because it can only be moved from the thread it lives in.";
+        return false;
+    }
+
+    object->moveToThread(ioThread(bus));
+    return true;
+}
@@ -0,0 +1,76 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+*
+* Copyright 2013 - 2022, nymea GmbH
+* Contact: contact@nymea.io
+*
+* This file is part of nymea.
+* This project including source code and documentation is protected by
+* copyright law, and remains the property of nymea GmbH. All rights, including
+* reproduction, publication, editing and translation, are reserved. The use of
+* this project is subject to the terms of a license agreement to be concluded
+* with nymea GmbH in accordance with the terms of use of nymea GmbH, available
+* under https://nymea.io/license
+*
+* GNU Lesser General Public License Usage
+* Alternatively, this project may be redistributed and/or modified under the
+* terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; version 3. This project is distributed in the hope that
+* it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+* warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this project. If not, see <https://www.gnu.org/licenses/>.
+*
+* For any further details and any questions please contact us under
+* contact@nymea.io or see our FAQ/Licensing Information on
+* https://nymea.io/license/faq
+*
+* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef MODBUSIOTHREADPOOL_H
+#define MODBUSIOTHREADPOOL_H
+
+#include <QHash>
+#include <QMutex>
+#include <QObject>
+#include <QThread>
+#include <QLoggingCategory>
+
+Q_DECLARE_LOGGING_CATEGORY(dcModbusIoThreadPool)
+
+// Provides dedicated threads for the modbus transport and decoding, so connections polling
+// many registers do not compete with the main event loop. Each bus (i.e. the host address of a
+// TCP device) gets assigned to one thread, buses are distributed over maximumThreadCount threads.
+//
+// Objects moved into an I/O thread must not have a parent and must be deleted using deleteLater().
+// Generated TCP connections forward connectDevice(), initialize() and update() calls from other
+// threads into their I/O thread and provide the values of an update cycle using the queued
+// snapshotUpdated() signal.
+
+class ModbusIoThreadPool : public QObject
+{
+    Q_OBJECT
+public:
+    static ModbusIoThreadPool *instance();
+
+    int maximumThreadCount() const;
+    void setMaximumThreadCount(int maximumThreadCount);
+
+    QThread *ioThread(const QString &bus);
+    bool moveToIoThread(QObject *object, const QString &bus);
+
+private:
+    explicit ModbusIoThreadPool(QObject *parent = nullptr);
+    ~ModbusIoThreadPool();
+
+    static ModbusIoThreadPool *s_instance;
+
+    mutable QMutex m_mutex;
+    int m_maximumThreadCount = 2;
+    QList<QThread *> m_threads;
+    QHash<QString, QThread *> m_busThreads;
+
+};
+
+#endif // MODBUSIOTHREADPOOL_H
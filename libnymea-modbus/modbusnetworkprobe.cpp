@@ -0,0 +1,337 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+*
+* Copyright 2013 - 2022, nymea GmbH
+* Contact: contact@nymea.io
+*
+* This file is part of nymea.
+* This project including source code and documentation is protected by
+* copyright law, and remains the property of nymea GmbH. All rights, including
+* reproduction, publication, editing and translation, are reserved. The use of
+* this project is subject to the terms of a license agreement to be concluded
+* with nymea GmbH in accordance with the terms of use of nymea GmbH, available
+* under https://nymea.io/license
+*
+* GNU Lesser General Public License Usage
+* Alternatively, this project may be redistributed and/or modified under the
+* terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; version 3. This project is distributed in the hope that
+* it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+* warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this project. If not, see <https://www.gnu.org/licenses/>.
+*
+* For any further details and any questions please contact us under
+* contact@nymea.io or see our FAQ/Licensing Information on
+* https://nymea.io/license/faq
+*
+* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+
+#include "modbusnetworkprobe.h"
+
+#include <QDateTime>
+
+Q_LOGGING_CATEGORY(dcModbusNetworkProbe, "ModbusNetworkProbe")
+
+QHash<QString, ModbusNetworkProbe::CacheEntry> ModbusNetworkProbe::s_cache;
+int ModbusNetworkProbe::s_cacheTimeout = 60000;
+
+ModbusNetworkProbe::ModbusNetworkProbe(QObject *parent) :
+    QObject(parent)
+{
+
+}
+
+ModbusNetworkProbe::~ModbusNetworkProbe()
+{
+    foreach (QModbusTcpClient *client, m_activeProbes.keys()) {
+        client->disconnect(this);
+        client->disconnectDevice();
+        client->deleteLater();
+    }
+    m_activeProbes.clear();
+}
+
+void ModbusNetworkProbe::addPort(quint16 port)
+{
+    if (!m_ports.contains(port)) {
+        m_ports.append(port);
+    }
+}
+
+void ModbusNetworkProbe::addFingerprint(const Fingerprint &fingerprint)
+{
+    m_fingerprints.append(fingerprint);
+}
+
+bool ModbusNetworkProbe::stopOnFirstMatch() const
+{
+    return m_stopOnFirstMatch;
+}
+
+void ModbusNetworkProbe::setStopOnFirstMatch(bool stopOnFirstMatch)
+{
+    m_stopOnFirstMatch = stopOnFirstMatch;
+}
+
+int ModbusNetworkProbe::maxConcurrentProbes() const
+{
+    return m_maxConcurrentProbes;
+}
+
+void ModbusNetworkProbe::setMaxConcurrentProbes(int maxConcurrentProbes)
+{
+    m_maxConcurrentProbes = qMax(1, maxConcurrentProbes);
+}
+
+int ModbusNetworkProbe::timeout() const
+{
+    return m_timeout;
+}
+
+void ModbusNetworkProbe::setTimeout(int timeout)
+{
+    m_timeout = timeout;
+}
+
+QList<ModbusNetworkProbe::Result> ModbusNetworkProbe::results() const
+{
+    return m_results;
+}
+
+int ModbusNetworkProbe::cacheTimeout()
+{
+    return s_cacheTimeout;
+}
+
+void ModbusNetworkProbe::setCacheTimeout(int cacheTimeout)
+{
+    s_cacheTimeout = cacheTimeout;
+}
+
+void ModbusNetworkProbe::probe(const QHostAddress &address)
+{
+    foreach (quint16 port, m_ports) {
+        QString key = targetKey(address, port);
+        if (m_knownTargets.contains(key))
+            continue;
+
+        m_knownTargets.insert(key);
+        m_pendingTargets.enqueue(qMakePair(address, port));
+    }
+
+    processQueue();
+}
+
+void ModbusNetworkProbe::finish()
+{
+    m_finishRequested = true;
+    processQueue();
+}
+
+void ModbusNetworkProbe::processQueue()
+{
+    while (m_activeProbes.count() < m_maxConcurrentProbes && !m_pendingTargets.isEmpty()) {
+        QPair<QHostAddress, quint16> target = m_pendingTargets.dequeue();
+        startProbe(target.first, target.second);
+    }
+
+    if (m_finishRequested && !m_finished && m_activeProbes.isEmpty() && m_pendingTargets.isEmpty()) {
+        m_finished = true;
+        qCDebug(dcModbusNetworkProbe()) << "Finished probing. Found" << m_results.count() << "devices";
+        emit finished();
+    }
+}
+
+void ModbusNetworkProbe::startProbe(const QHostAddress &address, quint16 port)
+{
+    CacheEntry entry;
+    if (cachedEntry(targetKey(address, port), &entry) && !entry.reachable) {
+        qCDebug(dcModbusNetworkProbe()) << "Skipping" << targetKey(address, port) << "since it was not reachable recently";
+        return;
+    }
+
+    // Use cached fingerprint results where possible and only probe what is left
+    Probe probe;
+    probe.address = address;
+    probe.port = port;
+    foreach (const Fingerprint &fingerprint, m_fingerprints) {
+        if (cachedEntry(fingerprintKey(address, port, fingerprint), &entry)) {
+            if (entry.matched) {
+                addResult(address, port, fingerprint, entry.values);
+                if (m_stopOnFirstMatch) {
+                    return;
+                }
+            }
+            continue;
+        }
+        probe.fingerprints.append(fingerprint);
+    }
+
+    if (probe.fingerprints.isEmpty())
+        return;
+
+    qCDebug(dcModbusNetworkProbe()) << "Start probing" << targetKey(address, port);
+    QModbusTcpClient *client = new QModbusTcpClient(this);
+    client->setConnectionParameter(QModbusDevice::NetworkPortParameter, port);
+    client->setConnectionParameter(QModbusDevice::NetworkAddressParameter, address.toString());
+    client->setTimeout(m_timeout);
+    client->setNumberOfRetries(0);
+    m_activeProbes.insert(client, probe);
+
+    connect(client, &QModbusTcpClient::stateChanged, this, [this, client](QModbusDevice::State state){
+        if (!m_activeProbes.contains(client))
+            return;
+
+        if (state == QModbusDevice::ConnectedState) {
+            m_activeProbes[client].connected = true;
+            checkNextFingerprint(client);
+        } else if (state == QModbusDevice::UnconnectedState) {
+            finishProbe(client);
+        }
+    });
+
+    connect(client, &QModbusTcpClient::errorOccurred, this, [this, client](QModbusDevice::Error error){
+        if (!m_activeProbes.contains(client))
+            return;
+
+        if (error == QModbusDevice::ConnectionError && !m_activeProbes.value(client).connected) {
+            cacheUnreachable(client);
+            finishProbe(client);
+        }
+    });
+
+    // The TCP connect itself has no timeout, don't wait for hosts dropping the SYN
+    QTimer::singleShot(m_timeout, client, [this, client](){
+        if (m_activeProbes.contains(client) && !m_activeProbes.value(client).connected) {
+            qCDebug(dcModbusNetworkProbe()) << "Connection timeout on" << targetKey(m_activeProbes.value(client).address, m_activeProbes.value(client).port);
+            cacheUnreachable(client);
+            finishProbe(client);
+        }
+    });
+
+    if (!client->connectDevice()) {
+        finishProbe(client);
+    }
+}
+
+void ModbusNetworkProbe::checkNextFingerprint(QModbusTcpClient *client)
+{
+    if (!m_activeProbes.contains(client))
+        return;
+
+    Probe &probe = m_activeProbes[client];
+    if (probe.fingerprints.isEmpty()) {
+        finishProbe(client);
+        return;
+    }
+
+    Fingerprint fingerprint = probe.fingerprints.takeFirst();
+    QHostAddress address = probe.address;
+    quint16 port = probe.port;
+
+    QModbusDataUnit request(fingerprint.registerType, fingerprint.registerAddress, fingerprint.size);
+    QModbusReply *reply = client->sendReadRequest(request, fingerprint.slaveId);
+    if (!reply) {
+        finishProbe(client);
+        return;
+    }
+
+    if (reply->isFinished()) {
+        reply->deleteLater(); // broadcast replies return immediately
+        checkNextFingerprint(client);
+        return;
+    }
+
+    connect(reply, &QModbusReply::finished, reply, &QModbusReply::deleteLater);
+    connect(reply, &QModbusReply::finished, this, [this, client, reply, address, port, fingerprint](){
+        if (!m_activeProbes.contains(client))
+            return;
+
+        // Only cache what the device actually answered. Errors and timeouts might be temporary
+        // and must not hide the device from the following discoveries.
+        CacheEntry entry;
+        if (reply->error() == QModbusDevice::NoError) {
+            entry.timestamp = QDateTime::currentMSecsSinceEpoch();
+            entry.values = reply->result().values();
+            entry.matched = !fingerprint.validator || fingerprint.validator(entry.values);
+            s_cache.insert(fingerprintKey(address, port, fingerprint), entry);
+        } else {
+            qCDebug(dcModbusNetworkProbe()) << "Fingerprint" << fingerprint.name << "failed on" << targetKey(address, port) << reply->errorString();
+        }
+
+        if (entry.matched) {
+            addResult(address, port, fingerprint, entry.values);
+            if (m_stopOnFirstMatch) {
+                finishProbe(client);
+                return;
+            }
+        }
+
+        checkNextFingerprint(client);
+    });
+}
+
+void ModbusNetworkProbe::finishProbe(QModbusTcpClient *client)
+{
+    if (!m_activeProbes.contains(client))
+        return;
+
+    m_activeProbes.remove(client);
+    client->disconnect(this);
+    client->disconnectDevice();
+    client->deleteLater();
+
+    // Continue with the next host outside of the current signal handler
+    QTimer::singleShot(0, this, [this](){ processQueue(); });
+}
+
+void ModbusNetworkProbe::cacheUnreachable(QModbusTcpClient *client)
+{
+    Probe probe = m_activeProbes.value(client);
+    CacheEntry entry;
+    entry.timestamp = QDateTime::currentMSecsSinceEpoch();
+    entry.reachable = false;
+    s_cache.insert(targetKey(probe.address, probe.port), entry);
+}
+
+void ModbusNetworkProbe::addResult(const QHostAddress &address, quint16 port, const Fingerprint &fingerprint, const QVector<quint16> &values)
+{
+    Result result;
+    result.address = address;
+    result.port = port;
+    result.slaveId = fingerprint.slaveId;
+    result.fingerprint = fingerprint.name;
+    result.values = values;
+    m_results.append(result);
+
+    qCDebug(dcModbusNetworkProbe()) << "Fingerprint" << fingerprint.name << "matched on" << targetKey(address, port) << "slave ID" << fingerprint.slaveId;
+    emit resultFound(result);
+}
+
+QString ModbusNetworkProbe::targetKey(const QHostAddress &address, quint16 port)
+{
+    return QString("%1:%2").arg(address.toString()).arg(port);
+}
+
+QString ModbusNetworkProbe::fingerprintKey(const QHostAddress &address, quint16 port, const Fingerprint &fingerprint)
+{
+    return QString("%1/%2/%3").arg(targetKey(address, port)).arg(fingerprint.slaveId).arg(fingerprint.name);
+}
+
+bool ModbusNetworkProbe::cachedEntry(const QString &key, CacheEntry *entry)
+{
+    if (!s_cache.contains(key))
+        return false;
+
+    CacheEntry cached = s_cache.value(key);
+    if (QDateTime::currentMSecsSinceEpoch() - cached.timestamp > s_cacheTimeout) {
+        s_cache.remove(key);
+        return false;
+    }
+
+    *entry = cached;
+    return true;
+}
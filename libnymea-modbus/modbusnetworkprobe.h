@@ -0,0 +1,149 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+*
+* Copyright 2013 - 2022, nymea GmbH
+* Contact: contact@nymea.io
+*
+* This file is part of nymea.
+* This project including source code and documentation is protected by
+* copyright law, and remains the property of nymea GmbH. All rights, including
+* reproduction, publication, editing and translation, are reserved. The use of
+* this project is subject to the terms of a license agreement to be concluded
+* with nymea GmbH in accordance with the terms of use of nymea GmbH, available
+* under https://nymea.io/license
+*
+* GNU Lesser General Public License Usage
+* Alternatively, this project may be redistributed and/or modified under the
+* terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; version 3. This project is distributed in the hope that
+* it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+* warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this project. If not, see <https://www.gnu.org/licenses/>.
+*
+* For any further details and any questions please contact us under
+* contact@nymea.io or see our FAQ/Licensing Information on
+* https://nymea.io/license/faq
+*
+* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+
+#ifndef MODBUSNETWORKPROBE_H
+#define MODBUSNETWORKPROBE_H
+
+#include <QSet>
+#include <QHash>
+#include <QQueue>
+#include <QTimer>
+#include <QObject>
+#include <QHostAddress>
+#include <QtSerialBus>
+#include <QLoggingCategory>
+
+#include <functional>
+
+Q_DECLARE_LOGGING_CATEGORY(dcModbusNetworkProbe)
+
+// Probes hosts in the network for modbus TCP devices using cheap fingerprint reads.
+// Each host:port gets exactly one socket, all fingerprints are read sequentially on it.
+// The number of hosts probed at the same time is limited and results are cached for
+// a short time, so running several discoveries back to back does not rescan the network.
+
+class ModbusNetworkProbe : public QObject
+{
+    Q_OBJECT
+public:
+    typedef std::function<bool(const QVector<quint16> &values)> Validator;
+
+    typedef struct Fingerprint {
+        QString name;
+        quint16 slaveId = 1;
+        QModbusDataUnit::RegisterType registerType = QModbusDataUnit::HoldingRegisters;
+        quint16 registerAddress = 0;
+        quint16 size = 1;
+        Validator validator = nullptr; // If not set, any valid reply is a match
+    } Fingerprint;
+
+    typedef struct Result {
+        QHostAddress address;
+        quint16 port;
+        quint16 slaveId;
+        QString fingerprint;
+        QVector<quint16> values;
+    } Result;
+
+    explicit ModbusNetworkProbe(QObject *parent = nullptr);
+    ~ModbusNetworkProbe();
+
+    void addPort(quint16 port);
+    void addFingerprint(const Fingerprint &fingerprint);
+
+    // Stop probing a host:port once a fingerprint matched
+    bool stopOnFirstMatch() const;
+    void setStopOnFirstMatch(bool stopOnFirstMatch);
+
+    int maxConcurrentProbes() const;
+    void setMaxConcurrentProbes(int maxConcurrentProbes);
+
+    int timeout() const;
+    void setTimeout(int timeout);
+
+    QList<Result> results() const;
+
+    static int cacheTimeout();
+    static void setCacheTimeout(int cacheTimeout);
+
+public slots:
+    void probe(const QHostAddress &address);
+    // No more hosts will be added, finished() will be emitted once all probes are done
+    void finish();
+
+signals:
+    void resultFound(const ModbusNetworkProbe::Result &result);
+    void finished();
+
+private:
+    typedef struct CacheEntry {
+        qint64 timestamp = 0;
+        bool reachable = true;
+        bool matched = false;
+        QVector<quint16> values;
+    } CacheEntry;
+
+    typedef struct Probe {
+        QHostAddress address;
+        quint16 port;
+        QList<Fingerprint> fingerprints;
+        bool connected = false;
+    } Probe;
+
+    QList<quint16> m_ports;
+    QList<Fingerprint> m_fingerprints;
+    bool m_stopOnFirstMatch = true;
+    int m_maxConcurrentProbes = 20;
+    int m_timeout = 1000;
+
+    QQueue<QPair<QHostAddress, quint16>> m_pendingTargets;
+    QSet<QString> m_knownTargets;
+    QHash<QModbusTcpClient *, Probe> m_activeProbes;
+    QList<Result> m_results;
+    bool m_finishRequested = false;
+    bool m_finished = false;
+
+    static QHash<QString, CacheEntry> s_cache;
+    static int s_cacheTimeout;
+
+    void processQueue();
+    void startProbe(const QHostAddress &address, quint16 port);
+    void checkNextFingerprint(QModbusTcpClient *client);
+    void finishProbe(QModbusTcpClient *client);
+    void cacheUnreachable(QModbusTcpClient *client);
+    void addResult(const QHostAddress &address, quint16 port, const Fingerprint &fingerprint, const QVector<quint16> &values);
+
+    static QString targetKey(const QHostAddress &address, quint16 port);
+    static QString fingerprintKey(const QHostAddress &address, quint16 port, const Fingerprint &fingerprint);
+    static bool cachedEntry(const QString &key, CacheEntry *entry);
+};
+
+#endif // MODBUSNETWORKPROBE_H
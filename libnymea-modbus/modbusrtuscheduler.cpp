@@ -0,0 +1,420 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+*
+* Copyright 2013 - 2022, nymea GmbH
+* Contact: contact@nymea.io
+*
+* This file is part of nymea.
+* This project including source code and documentation is protected by
+* copyright law, and remains the property of nymea GmbH. All rights, including
+* reproduction, publication, editing and translation, are reserved. The use of
+* this project is subject to the terms of a license agreement to be concluded
+* with nymea GmbH in accordance with the terms of use of nymea GmbH, available
+* under https://nymea.io/license
+*
+* GNU Lesser General Public License Usage
+* Alternatively, this project may be redistributed and/or modified under the
+* terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; version 3. This project is distributed in the hope that
+* it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+* warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this project. If not, see <https://www.gnu.org/licenses/>.
+*
+* For any further details and any questions please contact us under
+* contact@nymea.io or see our FAQ/Licensing Information on
+* https://nymea.io/license/faq
+*
+* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "modbusrtuscheduler.h"
+
+#include <math.h>
+
+Q_LOGGING_CATEGORY(dcModbusRtuScheduler, "ModbusRtuScheduler")
+
+QHash<ModbusRtuMaster *, ModbusRtuScheduler *> ModbusRtuScheduler::s_schedulers;
+
+ModbusRtuSchedulerReply::ModbusRtuSchedulerReply(int slaveAddress, int registerAddress, QObject *parent) :
+    ModbusRtuReply(parent),
+    m_slaveAddress(slaveAddress),
+    m_registerAddress(registerAddress)
+{
+
+}
+
+bool ModbusRtuSchedulerReply::isFinished() const
+{
+    return m_finished;
+}
+
+int ModbusRtuSchedulerReply::slaveAddress() const
+{
+    return m_slaveAddress;
+}
+
+int ModbusRtuSchedulerReply::registerAddress() const
+{
+    return m_registerAddress;
+}
+
+QString ModbusRtuSchedulerReply::errorString() const
+{
+    return m_errorString;
+}
+
+ModbusRtuReply::Error ModbusRtuSchedulerReply::error() const
+{
+    return m_error;
+}
+
+QVector<quint16> ModbusRtuSchedulerReply::result() const
+{
+    return m_result;
+}
+
+void ModbusRtuSchedulerReply::finish(ModbusRtuReply::Error error, const QString &errorString, const QVector<quint16> &result)
+{
+    if (m_finished)
+        return;
+
+    m_finished = true;
+    m_error = error;
+    m_errorString = errorString;
+    m_result = result;
+
+    if (m_error != ModbusRtuReply::NoError)
+        emit errorOccurred(m_error);
+
+    emit finished();
+}
+
+ModbusRtuScheduler *ModbusRtuScheduler::scheduler(ModbusRtuMaster *modbusRtuMaster)
+{
+    if (!modbusRtuMaster)
+        return nullptr;
+
+    if (!s_schedulers.contains(modbusRtuMaster)) {
+        ModbusRtuScheduler *scheduler = new ModbusRtuScheduler(modbusRtuMaster);
+        s_schedulers.insert(modbusRtuMaster, scheduler);
+        connect(modbusRtuMaster, &ModbusRtuMaster::destroyed, [modbusRtuMaster](){
+            s_schedulers.remove(modbusRtuMaster);
+        });
+    }
+
+    return s_schedulers.value(modbusRtuMaster);
+}
+
+ModbusRtuScheduler::ModbusRtuScheduler(ModbusRtuMaster *modbusRtuMaster) :
+    QObject(modbusRtuMaster),
+    m_modbusRtuMaster(modbusRtuMaster)
+{
+    m_frameGapTimer.setSingleShot(true);
+    m_frameGapTimer.setTimerType(Qt::PreciseTimer);
+    connect(&m_frameGapTimer, &QTimer::timeout, this, &ModbusRtuScheduler::sendNext);
+
+    m_replyWatchdog.setSingleShot(true);
+    connect(&m_replyWatchdog, &QTimer::timeout, this, &ModbusRtuScheduler::onReplyTimeout);
+
+    qCDebug(dcModbusRtuScheduler()) << "Created scheduler for" << m_modbusRtuMaster->serialPort() << m_modbusRtuMaster->baudrate() << "baud. Inter frame gap" << frameGap() << "ms";
+}
+
+ModbusRtuMaster *ModbusRtuScheduler::modbusRtuMaster() const
+{
+    return m_modbusRtuMaster;
+}
+
+int ModbusRtuScheduler::turnaroundDelay() const
+{
+    return m_turnaroundDelay;
+}
+
+void ModbusRtuScheduler::setTurnaroundDelay(int turnaroundDelay)
+{
+    m_turnaroundDelay = qMax(0, turnaroundDelay);
+}
+
+int ModbusRtuScheduler::maxMergeGap() const
+{
+    return m_maxMergeGap;
+}
+
+void ModbusRtuScheduler::setMaxMergeGap(int maxMergeGap)
+{
+    m_maxMergeGap = qMax(0, maxMergeGap);
+}
+
+int ModbusRtuScheduler::pendingRequests() const
+{
+    int count = 0;
+    foreach (const QQueue<Request> &queue, m_slaveQueues)
+        count += queue.count();
+
+    return count;
+}
+
+ModbusRtuReply *ModbusRtuScheduler::readCoil(int slaveAddress, int registerAddress, quint16 size)
+{
+    return enqueue(RequestTypeReadCoil, slaveAddress, registerAddress, size);
+}
+
+ModbusRtuReply *ModbusRtuScheduler::readDiscreteInput(int slaveAddress, int registerAddress, quint16 size)
+{
+    return enqueue(RequestTypeReadDiscreteInput, slaveAddress, registerAddress, size);
+}
+
+ModbusRtuReply *ModbusRtuScheduler::readInputRegister(int slaveAddress, int registerAddress, quint16 size)
+{
+    return enqueue(RequestTypeReadInputRegister, slaveAddress, registerAddress, size);
+}
+
+ModbusRtuReply *ModbusRtuScheduler::readHoldingRegister(int slaveAddress, int registerAddress, quint16 size)
+{
+    return enqueue(RequestTypeReadHoldingRegister, slaveAddress, registerAddress, size);
+}
+
+ModbusRtuReply *ModbusRtuScheduler::writeCoils(int slaveAddress, int registerAddress, const QVector<quint16> &values)
+{
+    return enqueue(RequestTypeWriteCoils, slaveAddress, registerAddress, values.count(), values);
+}
+
+ModbusRtuReply *ModbusRtuScheduler::writeHoldingRegisters(int slaveAddress, int registerAddress, const QVector<quint16> &values)
+{
+    return enqueue(RequestTypeWriteHoldingRegisters, slaveAddress, registerAddress, values.count(), values);
+}
+
+ModbusRtuReply *ModbusRtuScheduler::enqueue(RequestType type, int slaveAddress, int registerAddress, quint16 size, const QVector<quint16> &values)
+{
+    Request request;
+    request.type = type;
+    request.slaveAddress = slaveAddress;
+    request.registerAddress = registerAddress;
+    request.size = size;
+    request.values = values;
+    request.reply = new ModbusRtuSchedulerReply(slaveAddress, registerAddress, this);
+
+    if (!m_slaveOrder.contains(slaveAddress))
+        m_slaveOrder.append(slaveAddress);
+
+    m_slaveQueues[slaveAddress].enqueue(request);
+
+    // Note: never send synchronously, the caller has to be able to connect to the reply first
+    scheduleNext();
+    return request.reply;
+}
+
+void ModbusRtuScheduler::scheduleNext()
+{
+    if (m_busy || m_frameGapTimer.isActive())
+        return;
+
+    int remaining = 0;
+    if (m_lastFrameTimer.isValid())
+        remaining = qMax(0, frameGap() - static_cast<int>(m_lastFrameTimer.elapsed()));
+
+    m_frameGapTimer.start(remaining);
+}
+
+void ModbusRtuScheduler::sendNext()
+{
+    if (m_busy)
+        return;
+
+    // Pick the next slave with pending requests in round robin order
+    int slaveAddress = -1;
+    for (int i = 0; i < m_slaveOrder.count(); i++) {
+        int index = (m_nextSlaveIndex + i) % m_slaveOrder.count();
+        if (!m_slaveQueues.value(m_slaveOrder.at(index)).isEmpty()) {
+            slaveAddress = m_slaveOrder.at(index);
+            m_nextSlaveIndex = index + 1;
+            break;
+        }
+    }
+
+    if (slaveAddress < 0) {
+        // Nothing left to do
+        m_slaveQueues.clear();
+        m_slaveOrder.clear();
+        m_nextSlaveIndex = 0;
+        return;
+    }
+
+    QQueue<Request> &queue = m_slaveQueues[slaveAddress];
+    QList<Request> requests;
+    requests.append(queue.dequeue());
+
+    const Request first = requests.first();
+    int startAddress = first.registerAddress;
+    int endAddress = first.registerAddress + first.size;
+
+    // Merge reads of the same type which are close enough. Stop at the first write, reads
+    // queued after a write must see the written values.
+    if (isRead(first.type) && first.mergeable) {
+        int i = 0;
+        while (i < queue.count()) {
+            const Request &candidate = queue.at(i);
+            if (!isRead(candidate.type))
+                break;
+
+            int candidateStart = candidate.registerAddress;
+            int candidateEnd = candidate.registerAddress + candidate.size;
+            if (candidate.type == first.type
+                    && candidate.mergeable
+                    && candidateStart <= endAddress + m_maxMergeGap
+                    && candidateEnd >= startAddress - m_maxMergeGap
+                    && qMax(endAddress, candidateEnd) - qMin(startAddress, candidateStart) <= maxReadSize(first.type)) {
+                startAddress = qMin(startAddress, candidateStart);
+                endAddress = qMax(endAddress, candidateEnd);
+                requests.append(queue.takeAt(i));
+                continue;
+            }
+
+            i++;
+        }
+    }
+
+    ModbusRtuReply *reply = nullptr;
+    quint16 size = endAddress - startAddress;
+    switch (first.type) {
+    case RequestTypeReadCoil:
+        reply = m_modbusRtuMaster->readCoil(slaveAddress, startAddress, size);
+        break;
+    case RequestTypeReadDiscreteInput:
+        reply = m_modbusRtuMaster->readDiscreteInput(slaveAddress, startAddress, size);
+        break;
+    case RequestTypeReadInputRegister:
+        reply = m_modbusRtuMaster->readInputRegister(slaveAddress, startAddress, size);
+        break;
+    case RequestTypeReadHoldingRegister:
+        reply = m_modbusRtuMaster->readHoldingRegister(slaveAddress, startAddress, size);
+        break;
+    case RequestTypeWriteCoils:
+        reply = m_modbusRtuMaster->writeCoils(slaveAddress, startAddress, first.values);
+        break;
+    case RequestTypeWriteHoldingRegisters:
+        reply = m_modbusRtuMaster->writeHoldingRegisters(slaveAddress, startAddress, first.values);
+        break;
+    }
+
+    if (requests.count() > 1) {
+        qCDebug(dcModbusRtuScheduler()) << "Merged" << requests.count() << "requests for slave" << slaveAddress << "into" << first.type << startAddress << "size" << size;
+    }
+
+    if (!reply) {
+        finishRequests(requests, ModbusRtuReply::ConnectionError, "Could not send the request to the modbus RTU master");
+        m_lastFrameTimer.restart();
+        scheduleNext();
+        return;
+    }
+
+    m_busy = true;
+    m_currentReply = reply;
+    m_currentRequests = requests;
+    m_currentStartAddress = startAddress;
+    m_replyWatchdog.start(m_modbusRtuMaster->timeout() * (m_modbusRtuMaster->numberOfRetries() + 1) + 1000);
+
+    connect(reply, &ModbusRtuReply::finished, reply, &ModbusRtuReply::deleteLater);
+    connect(reply, &ModbusRtuReply::finished, this, &ModbusRtuScheduler::onReplyFinished);
+}
+
+void ModbusRtuScheduler::onReplyFinished()
+{
+    ModbusRtuReply *reply = qobject_cast<ModbusRtuReply *>(sender());
+    if (!reply || reply != m_currentReply)
+        return;
+
+    m_replyWatchdog.stop();
+    m_busy = false;
+    m_currentReply = nullptr;
+    m_lastFrameTimer.restart();
+
+    QList<Request> requests = m_currentRequests;
+    m_currentRequests.clear();
+
+    // The merged read might span registers the device does not map. Send the
+    // original requests again one by one, so only the invalid ones fail.
+    if (requests.count() > 1 && reply->error() != ModbusRtuReply::NoError
+            && reply->error() != ModbusRtuReply::TimeoutError && reply->error() != ModbusRtuReply::ConnectionError) {
+        int slaveAddress = requests.first().slaveAddress;
+        qCDebug(dcModbusRtuScheduler()) << "Merged read for slave" << slaveAddress << "failed with" << reply->error() << reply->errorString() << "Splitting it into" << requests.count() << "requests.";
+        if (!m_slaveOrder.contains(slaveAddress))
+            m_slaveOrder.append(slaveAddress);
+
+        QQueue<Request> &queue = m_slaveQueues[slaveAddress];
+        for (int i = requests.count() - 1; i >= 0; i--) {
+            Request request = requests.at(i);
+            request.mergeable = false;
+            queue.prepend(request);
+        }
+
+        scheduleNext();
+        return;
+    }
+
+    finishRequests(requests, reply->error(), reply->errorString(), m_currentStartAddress, reply->result());
+    scheduleNext();
+}
+
+void ModbusRtuScheduler::onReplyTimeout()
+{
+    qCWarning(dcModbusRtuScheduler()) << "The modbus RTU master did not finish the request in time. Continue with the next request.";
+    if (m_currentReply)
+        m_currentReply->disconnect(this);
+
+    m_busy = false;
+    m_currentReply = nullptr;
+    m_lastFrameTimer.restart();
+
+    QList<Request> requests = m_currentRequests;
+    m_currentRequests.clear();
+    finishRequests(requests, ModbusRtuReply::TimeoutError, "The modbus RTU master did not finish the request in time");
+    scheduleNext();
+}
+
+void ModbusRtuScheduler::finishRequests(const QList<Request> &requests, ModbusRtuReply::Error error, const QString &errorString, int registerAddress, const QVector<quint16> &values)
+{
+    foreach (const Request &request, requests) {
+        if (request.reply.isNull())
+            continue;
+
+        if (error != ModbusRtuReply::NoError || !isRead(request.type)) {
+            request.reply->finish(error, errorString);
+            continue;
+        }
+
+        int offset = request.registerAddress - registerAddress;
+        if (offset < 0 || offset + request.size > values.count()) {
+            request.reply->finish(ModbusRtuReply::ReadError, "The received data does not contain the requested registers");
+            continue;
+        }
+
+        request.reply->finish(ModbusRtuReply::NoError, QString(), values.mid(offset, request.size));
+    }
+}
+
+int ModbusRtuScheduler::frameGap() const
+{
+    // The modbus specification recommends a fixed 1.75 ms gap above 19200 baud
+    double frameGapMicroSeconds = 1750;
+    qint32 baudrate = m_modbusRtuMaster->baudrate();
+    if (baudrate > 0 && baudrate <= 19200) {
+        int bitsPerCharacter = 1 + m_modbusRtuMaster->dataBits() + (m_modbusRtuMaster->parity() == QSerialPort::NoParity ? 0 : 1) + m_modbusRtuMaster->stopBits();
+        frameGapMicroSeconds = 3.5 * bitsPerCharacter * 1000000.0 / baudrate;
+    }
+
+    return static_cast<int>(ceil(frameGapMicroSeconds / 1000.0)) + m_turnaroundDelay;
+}
+
+bool ModbusRtuScheduler::isRead(RequestType type)
+{
+    return type != RequestTypeWriteCoils && type != RequestTypeWriteHoldingRegisters;
+}
+
+int ModbusRtuScheduler::maxReadSize(RequestType type)
+{
+    if (type == RequestTypeReadCoil || type == RequestTypeReadDiscreteInput)
+        return 2000;
+
+    return 125;
+}
@@ -0,0 +1,168 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+*
+* Copyright 2013 - 2022, nymea GmbH
+* Contact: contact@nymea.io
+*
+* This file is part of nymea.
+* This project including source code and documentation is protected by
+* copyright law, and remains the property of nymea GmbH. All rights, including
+* reproduction, publication, editing and translation, are reserved. The use of
+* this project is subject to the terms of a license agreement to be concluded
+* with nymea GmbH in accordance with the terms of use of nymea GmbH, available
+* under https://nymea.io/license
+*
+* GNU Lesser General Public License Usage
+* Alternatively, this project may be redistributed and/or modified under the
+* terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; version 3. This project is distributed in the hope that
+* it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+* warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this project. If not, see <https://www.gnu.org/licenses/>.
+*
+* For any further details and any questions please contact us under
+* contact@nymea.io or see our FAQ/Licensing Information on
+* https://nymea.io/license/faq
+*
+* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef MODBUSRTUSCHEDULER_H
+#define MODBUSRTUSCHEDULER_H
+
+#include <QHash>
+#include <QQueue>
+#include <QTimer>
+#include <QObject>
+#include <QPointer>
+#include <QElapsedTimer>
+#include <QLoggingCategory>
+
+#include <hardware/modbus/modbusrtumaster.h>
+#include <hardware/modbus/modbusrtureply.h>
+
+Q_DECLARE_LOGGING_CATEGORY(dcModbusRtuScheduler)
+
+class ModbusRtuScheduler;
+
+// Reply handed out by the scheduler. It finishes once the bus request it has been
+// assigned to finished, which might be a read request merged with other requests.
+
+class ModbusRtuSchedulerReply : public ModbusRtuReply
+{
+    Q_OBJECT
+    friend class ModbusRtuScheduler;
+
+public:
+    bool isFinished() const override;
+    int slaveAddress() const override;
+    int registerAddress() const override;
+    QString errorString() const override;
+    ModbusRtuReply::Error error() const override;
+    QVector<quint16> result() const override;
+
+private:
+    explicit ModbusRtuSchedulerReply(int slaveAddress, int registerAddress, QObject *parent = nullptr);
+
+    int m_slaveAddress = 0;
+    int m_registerAddress = 0;
+    bool m_finished = false;
+    ModbusRtuReply::Error m_error = ModbusRtuReply::NoError;
+    QString m_errorString;
+    QVector<quint16> m_result;
+
+    void finish(ModbusRtuReply::Error error, const QString &errorString, const QVector<quint16> &result = QVector<quint16>());
+};
+
+// Orders all requests on one RTU bus. Requests are queued per slave and the slaves are
+// served round robin, so one chatty connection can not starve the others on the bus.
+// Queued reads of the same slave and register type close to each other are merged into one
+// bus request and only one request is on the wire at any time, with at least the 3.5 character
+// inter frame gap (plus the optional turnaround delay) between the frames.
+
+class ModbusRtuScheduler : public QObject
+{
+    Q_OBJECT
+public:
+    enum RequestType {
+        RequestTypeReadCoil,
+        RequestTypeReadDiscreteInput,
+        RequestTypeReadInputRegister,
+        RequestTypeReadHoldingRegister,
+        RequestTypeWriteCoils,
+        RequestTypeWriteHoldingRegisters
+    };
+    Q_ENUM(RequestType)
+
+    // Returns the scheduler for the given bus, all connections on the same master share it
+    static ModbusRtuScheduler *scheduler(ModbusRtuMaster *modbusRtuMaster);
+
+    ModbusRtuMaster *modbusRtuMaster() const;
+
+    // Additional time to wait after a frame for slow devices switching between send and receive
+    int turnaroundDelay() const;
+    void setTurnaroundDelay(int turnaroundDelay);
+
+    // Maximal number of registers between two reads for still merging them into one request.
+    // Disabled by default, only enable it if the device maps all registers within the gaps.
+    // A merged read failing with an exception gets split into the original requests.
+    int maxMergeGap() const;
+    void setMaxMergeGap(int maxMergeGap);
+
+    int pendingRequests() const;
+
+    ModbusRtuReply *readCoil(int slaveAddress, int registerAddress, quint16 size = 1);
+    ModbusRtuReply *readDiscreteInput(int slaveAddress, int registerAddress, quint16 size = 1);
+    ModbusRtuReply *readInputRegister(int slaveAddress, int registerAddress, quint16 size = 1);
+    ModbusRtuReply *readHoldingRegister(int slaveAddress, int registerAddress, quint16 size = 1);
+
+    ModbusRtuReply *writeCoils(int slaveAddress, int registerAddress, const QVector<quint16> &values);
+    ModbusRtuReply *writeHoldingRegisters(int slaveAddress, int registerAddress, const QVector<quint16> &values);
+
+private:
+    explicit ModbusRtuScheduler(ModbusRtuMaster *modbusRtuMaster);
+
+    typedef struct Request {
+        RequestType type;
+        int slaveAddress;
+        int registerAddress;
+        quint16 size;
+        QVector<quint16> values;
+        QPointer<ModbusRtuSchedulerReply> reply;
+        bool mergeable = true;
+    } Request;
+
+    static QHash<ModbusRtuMaster *, ModbusRtuScheduler *> s_schedulers;
+
+    ModbusRtuMaster *m_modbusRtuMaster = nullptr;
+    int m_turnaroundDelay = 0;
+    int m_maxMergeGap = 0;
+
+    QHash<int, QQueue<Request>> m_slaveQueues;
+    QList<int> m_slaveOrder;
+    int m_nextSlaveIndex = 0;
+
+    bool m_busy = false;
+    QTimer m_frameGapTimer;
+
+    // Catches master replies which never finish, otherwise the bus would stay busy forever
+    QTimer m_replyWatchdog;
+    QPointer<ModbusRtuReply> m_currentReply;
+    QList<Request> m_currentRequests;
+    int m_currentStartAddress = 0;
+    QElapsedTimer m_lastFrameTimer;
+
+    ModbusRtuReply *enqueue(RequestType type, int slaveAddress, int registerAddress, quint16 size, const QVector<quint16> &values = QVector<quint16>());
+    void scheduleNext();
+    void sendNext();
+    void onReplyFinished();
+    void onReplyTimeout();
+    void finishRequests(const QList<Request> &requests, ModbusRtuReply::Error error, const QString &errorString, int registerAddress = 0, const QVector<quint16> &values = QVector<quint16>());
+
+    int frameGap() const;
+    static bool isRead(RequestType type);
+    static int maxReadSize(RequestType type);
+};
+
+#endif // MODBUSRTUSCHEDULER_H
@@ -0,0 +1,226 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+*
+* Copyright 2013 - 2022, nymea GmbH
+* Contact: contact@nymea.io
+*
+* This file is part of nymea.
+* This project including source code and documentation is protected by
+* copyright law, and remains the property of nymea GmbH. All rights, including
+* reproduction, publication, editing and translation, are reserved. The use of
+* this project is subject to the terms of a license agreement to be concluded
+* with nymea GmbH in accordance with the terms of use of nymea GmbH, available
+* under https://nymea.io/license
+*
+* GNU Lesser General Public License Usage
+* Alternatively, this project may be redistributed and/or modified under the
+* terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; version 3. This project is distributed in the hope that
+* it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+* warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this project. If not, see <https://www.gnu.org/licenses/>.
+*
+* For any further details and any questions please contact us under
+* contact@nymea.io or see our FAQ/Licensing Information on
+* https://nymea.io/license/faq
+*
+* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "modbusrtuslavescanner.h"
+#include "modbusrtuscheduler.h"
+
+Q_LOGGING_CATEGORY(dcModbusRtuSlaveScanner, "ModbusRtuSlaveScanner")
+
+ModbusRtuSlaveScanner::ModbusRtuSlaveScanner(QObject *parent) :
+    QObject(parent)
+{
+    setSlaveIdRange(1, 247);
+}
+
+void ModbusRtuSlaveScanner::addMaster(ModbusRtuMaster *modbusRtuMaster)
+{
+    if (m_masters.contains(modbusRtuMaster))
+        return;
+
+    m_masters.append(modbusRtuMaster);
+    connect(modbusRtuMaster, &ModbusRtuMaster::destroyed, this, [this, modbusRtuMaster](){
+        m_masters.removeAll(modbusRtuMaster);
+        if (m_buses.contains(modbusRtuMaster)) {
+            m_buses[modbusRtuMaster].reply = nullptr;
+            finishBus(modbusRtuMaster);
+        }
+    });
+}
+
+void ModbusRtuSlaveScanner::setSlaveIds(const QList<quint16> &slaveIds)
+{
+    m_slaveIds = slaveIds;
+}
+
+void ModbusRtuSlaveScanner::setSlaveIdRange(quint16 firstSlaveId, quint16 lastSlaveId)
+{
+    m_slaveIds.clear();
+    for (quint16 slaveId = firstSlaveId; slaveId <= lastSlaveId; slaveId++) {
+        m_slaveIds.append(slaveId);
+    }
+}
+
+void ModbusRtuSlaveScanner::setProbeRegisters(QModbusDataUnit::RegisterType registerType, int registerAddress, quint16 size)
+{
+    m_registerType = registerType;
+    m_registerAddress = registerAddress;
+    m_size = size;
+}
+
+void ModbusRtuSlaveScanner::setValidator(const Validator &validator)
+{
+    m_validator = validator;
+}
+
+int ModbusRtuSlaveScanner::maxResultsPerMaster() const
+{
+    return m_maxResultsPerMaster;
+}
+
+void ModbusRtuSlaveScanner::setMaxResultsPerMaster(int maxResultsPerMaster)
+{
+    m_maxResultsPerMaster = maxResultsPerMaster;
+}
+
+QList<ModbusRtuSlaveScanner::Result> ModbusRtuSlaveScanner::results() const
+{
+    return m_results;
+}
+
+void ModbusRtuSlaveScanner::startScan()
+{
+    if (m_running) {
+        qCWarning(dcModbusRtuSlaveScanner()) << "Scan already running.";
+        return;
+    }
+
+    m_running = true;
+    m_results.clear();
+
+    foreach (ModbusRtuMaster *master, m_masters) {
+        if (!master->connected()) {
+            qCDebug(dcModbusRtuSlaveScanner()) << "Skipping modbus RTU master" << master->serialPort() << "since it is not connected.";
+            continue;
+        }
+
+        qCDebug(dcModbusRtuSlaveScanner()) << "Start scanning" << m_slaveIds.count() << "slave IDs on" << master->serialPort();
+
+        Bus bus;
+        bus.master = master;
+        m_buses.insert(master, bus);
+    }
+
+    if (m_buses.isEmpty()) {
+        m_running = false;
+        // Give the caller the chance to connect to the signal
+        QTimer::singleShot(0, this, &ModbusRtuSlaveScanner::finished);
+        return;
+    }
+
+    foreach (ModbusRtuMaster *master, m_buses.keys()) {
+        probeNext(master);
+    }
+}
+
+void ModbusRtuSlaveScanner::abort()
+{
+    foreach (ModbusRtuMaster *master, m_buses.keys()) {
+        finishBus(master);
+    }
+}
+
+void ModbusRtuSlaveScanner::probeNext(ModbusRtuMaster *master)
+{
+    Bus &bus = m_buses[master];
+    if (bus.slaveIdIndex >= m_slaveIds.count()) {
+        finishBus(master);
+        return;
+    }
+
+    quint16 slaveId = m_slaveIds.at(bus.slaveIdIndex);
+
+    ModbusRtuScheduler *scheduler = ModbusRtuScheduler::scheduler(master);
+    ModbusRtuReply *reply = nullptr;
+    switch (m_registerType) {
+    case QModbusDataUnit::Coils:
+        reply = scheduler->readCoil(slaveId, m_registerAddress, m_size);
+        break;
+    case QModbusDataUnit::DiscreteInputs:
+        reply = scheduler->readDiscreteInput(slaveId, m_registerAddress, m_size);
+        break;
+    case QModbusDataUnit::InputRegisters:
+        reply = scheduler->readInputRegister(slaveId, m_registerAddress, m_size);
+        break;
+    default:
+        reply = scheduler->readHoldingRegister(slaveId, m_registerAddress, m_size);
+        break;
+    }
+
+    // The scheduler finishes every reply, also if the master never does
+    bus.reply = reply;
+    connect(reply, &ModbusRtuReply::finished, reply, &ModbusRtuReply::deleteLater);
+    connect(reply, &ModbusRtuReply::finished, this, [this, master, reply](){
+        if (!m_buses.contains(master) || m_buses.value(master).reply != reply)
+            return;
+
+        if (reply->error() != ModbusRtuReply::NoError) {
+            finishProbe(master, false);
+            return;
+        }
+
+        QVector<quint16> values = reply->result();
+        finishProbe(master, !m_validator || m_validator(values), values);
+    });
+}
+
+void ModbusRtuSlaveScanner::finishProbe(ModbusRtuMaster *master, bool found, const QVector<quint16> &values)
+{
+    if (!m_buses.contains(master))
+        return;
+
+    Bus &bus = m_buses[master];
+    bus.reply = nullptr;
+
+    quint16 slaveId = m_slaveIds.at(bus.slaveIdIndex);
+    bus.slaveIdIndex++;
+
+    if (found) {
+        Result result;
+        result.modbusUuid = master->modbusUuid();
+        result.slaveId = slaveId;
+        result.values = values;
+        m_results.append(result);
+        bus.resultCount++;
+
+        qCDebug(dcModbusRtuSlaveScanner()) << "Found slave" << slaveId << "on" << master->serialPort() << values;
+        emit slaveFound(result);
+
+        if (m_maxResultsPerMaster > 0 && bus.resultCount >= m_maxResultsPerMaster) {
+            finishBus(master);
+            return;
+        }
+    }
+
+    probeNext(master);
+}
+
+void ModbusRtuSlaveScanner::finishBus(ModbusRtuMaster *master)
+{
+    if (!m_buses.contains(master))
+        return;
+
+    Bus bus = m_buses.take(master);
+    qCDebug(dcModbusRtuSlaveScanner()) << "Finished scanning bus. Found" << bus.resultCount << "slaves.";
+
+    if (m_buses.isEmpty() && m_running) {
+        m_running = false;
+        emit finished();
+    }
+}
@@ -0,0 +1,118 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+*
+* Copyright 2013 - 2022, nymea GmbH
+* Contact: contact@nymea.io
+*
+* This file is part of nymea.
+* This project including source code and documentation is protected by
+* copyright law, and remains the property of nymea GmbH. All rights, including
+* reproduction, publication, editing and translation, are reserved. The use of
+* this project is subject to the terms of a license agreement to be concluded
+* with nymea GmbH in accordance with the terms of use of nymea GmbH, available
+* under https://nymea.io/license
+*
+* GNU Lesser General Public License Usage
+* Alternatively, this project may be redistributed and/or modified under the
+* terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; version 3. This project is distributed in the hope that
+* it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+* warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this project. If not, see <https://www.gnu.org/licenses/>.
+*
+* For any further details and any questions please contact us under
+* contact@nymea.io or see our FAQ/Licensing Information on
+* https://nymea.io/license/faq
+*
+* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef MODBUSRTUSLAVESCANNER_H
+#define MODBUSRTUSLAVESCANNER_H
+
+#include <QHash>
+#include <QTimer>
+#include <QObject>
+#include <QModbusDataUnit>
+#include <QLoggingCategory>
+
+#include <functional>
+
+#include <hardware/modbus/modbusrtumaster.h>
+#include <hardware/modbus/modbusrtureply.h>
+
+Q_DECLARE_LOGGING_CATEGORY(dcModbusRtuSlaveScanner)
+
+// Scans slave IDs on modbus RTU buses by reading one probe register block from each slave.
+// The requests on one bus are sent one after another using the bus scheduler, but all buses are
+// scanned at the same time. Results are reported as soon as they are found and the scan on a bus
+// can end early once the expected number of slaves responded. A slave which does not answer keeps
+// the bus busy for the timeout and all retries of the modbus RTU master, so restrict the slave IDs
+// to the possible ones where the device allows it.
+
+class ModbusRtuSlaveScanner : public QObject
+{
+    Q_OBJECT
+public:
+    typedef std::function<bool(const QVector<quint16> &values)> Validator;
+
+    typedef struct Result {
+        QUuid modbusUuid;
+        quint16 slaveId;
+        QVector<quint16> values;
+    } Result;
+
+    explicit ModbusRtuSlaveScanner(QObject *parent = nullptr);
+    ~ModbusRtuSlaveScanner() = default;
+
+    void addMaster(ModbusRtuMaster *modbusRtuMaster);
+
+    // Slave IDs scanned in the given order, default 1 - 247
+    void setSlaveIds(const QList<quint16> &slaveIds);
+    void setSlaveIdRange(quint16 firstSlaveId, quint16 lastSlaveId);
+
+    void setProbeRegisters(QModbusDataUnit::RegisterType registerType, int registerAddress, quint16 size = 1);
+    // If not set, any valid reply is a match
+    void setValidator(const Validator &validator);
+
+    // Stop scanning a bus once this number of slaves has been found on it, 0 scans all slave IDs
+    int maxResultsPerMaster() const;
+    void setMaxResultsPerMaster(int maxResultsPerMaster);
+
+    QList<Result> results() const;
+
+public slots:
+    void startScan();
+    void abort();
+
+signals:
+    void slaveFound(const ModbusRtuSlaveScanner::Result &result);
+    void finished();
+
+private:
+    typedef struct Bus {
+        ModbusRtuMaster *master = nullptr;
+        int slaveIdIndex = 0;
+        int resultCount = 0;
+        ModbusRtuReply *reply = nullptr;
+    } Bus;
+
+    QList<ModbusRtuMaster *> m_masters;
+    QList<quint16> m_slaveIds;
+    QModbusDataUnit::RegisterType m_registerType = QModbusDataUnit::HoldingRegisters;
+    int m_registerAddress = 0;
+    quint16 m_size = 1;
+    Validator m_validator = nullptr;
+    int m_maxResultsPerMaster = 0;
+
+    QHash<ModbusRtuMaster *, Bus> m_buses;
+    QList<Result> m_results;
+    bool m_running = false;
+
+    void probeNext(ModbusRtuMaster *master);
+    void finishProbe(ModbusRtuMaster *master, bool found, const QVector<quint16> &values = QVector<quint16>());
+    void finishBus(ModbusRtuMaster *master);
+};
+
+#endif // MODBUSRTUSLAVESCANNER_H
@@ -0,0 +1,163 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+*
+* Copyright 2013 - 2022, nymea GmbH
+* Contact: contact@nymea.io
+*
+* This file is part of nymea.
+* This project including source code and documentation is protected by
+* copyright law, and remains the property of nymea GmbH. All rights, including
+* reproduction, publication, editing and translation, are reserved. The use of
+* this project is subject to the terms of a license agreement to be concluded
+* with nymea GmbH in accordance with the terms of use of nymea GmbH, available
+* under https://nymea.io/license
+*
+* GNU Lesser General Public License Usage
+* Alternatively, this project may be redistributed and/or modified under the
+* terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; version 3. This project is distributed in the hope that
+* it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+* warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this project. If not, see <https://www.gnu.org/licenses/>.
+*
+* For any further details and any questions please contact us under
+* contact@nymea.io or see our FAQ/Licensing Information on
+* https://nymea.io/license/faq
+*
+* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "modbusstatefilter.h"
+
+ModbusStateFilter::ModbusStateFilter()
+{
+    m_clock.start();
+}
+
+ModbusStateFilter::Rule ModbusStateFilter::voltageRule()
+{
+    // Publish changes of 0.5 V, the heartbeat makes sure the shown value does not get stale
+    Rule rule;
+    rule.absoluteDeadband = 0.5;
+    rule.heartbeatInterval = 60000;
+    return rule;
+}
+
+ModbusStateFilter::Rule ModbusStateFilter::frequencyRule()
+{
+    Rule rule;
+    rule.absoluteDeadband = 0.02;
+    rule.heartbeatInterval = 60000;
+    return rule;
+}
+
+ModbusStateFilter::Rule ModbusStateFilter::temperatureRule()
+{
+    // Temperatures change slowly, a longer heartbeat is enough
+    Rule rule;
+    rule.absoluteDeadband = 0.5;
+    rule.heartbeatInterval = 300000;
+    return rule;
+}
+
+ModbusStateFilter::Rule ModbusStateFilter::defaultRule() const
+{
+    return m_defaultRule;
+}
+
+void ModbusStateFilter::setDefaultRule(const Rule &rule)
+{
+    m_defaultRule = rule;
+}
+
+void ModbusStateFilter::setRule(const StateTypeId &stateTypeId, const Rule &rule)
+{
+    m_stateTypeRules.insert(stateTypeId, rule);
+}
+
+void ModbusStateFilter::setRule(const QString &stateName, const Rule &rule)
+{
+    m_stateNameRules.insert(stateName, rule);
+    m_resolvedNameRules.clear();
+}
+
+bool ModbusStateFilter::setStateValue(Thing *thing, const StateTypeId &stateTypeId, const QVariant &value)
+{
+    QVariant currentValue = thing->stateValue(stateTypeId);
+    if (!isNumeric(value) || !isNumeric(currentValue)) {
+        thing->setStateValue(stateTypeId, value);
+        return true;
+    }
+
+    qint64 now = m_clock.elapsed();
+    QHash<StateTypeId, qint64> &lastPublished = m_lastPublished[thing->id()];
+    if (!lastPublished.contains(stateTypeId)) {
+        // First value since the filter knows this state, always publish it
+        lastPublished.insert(stateTypeId, now);
+        thing->setStateValue(stateTypeId, value);
+        return true;
+    }
+
+    Rule stateRule = rule(thing, stateTypeId);
+    qint64 elapsed = now - lastPublished.value(stateTypeId);
+    double current = currentValue.toDouble();
+    double delta = qAbs(value.toDouble() - current);
+    double deadband = qMax(stateRule.absoluteDeadband, stateRule.relativeDeadband * qAbs(current));
+
+    bool publish = false;
+    if (stateRule.heartbeatInterval > 0 && elapsed >= stateRule.heartbeatInterval) {
+        publish = true;
+    } else if (delta > 0 && delta >= deadband && elapsed >= stateRule.minimumInterval) {
+        publish = true;
+    }
+
+    if (!publish)
+        return false;
+
+    lastPublished.insert(stateTypeId, now);
+    thing->setStateValue(stateTypeId, value);
+    return true;
+}
+
+void ModbusStateFilter::resetThing(const ThingId &thingId)
+{
+    m_lastPublished.remove(thingId);
+}
+
+ModbusStateFilter::Rule ModbusStateFilter::rule(Thing *thing, const StateTypeId &stateTypeId)
+{
+    if (m_stateTypeRules.contains(stateTypeId))
+        return m_stateTypeRules.value(stateTypeId);
+
+    if (m_stateNameRules.isEmpty())
+        return m_defaultRule;
+
+    ThingClassId thingClassId = thing->thingClassId();
+    if (!m_resolvedNameRules.contains(thingClassId)) {
+        QHash<StateTypeId, Rule> resolvedRules;
+        foreach (const StateType &stateType, thing->thingClass().stateTypes()) {
+            if (m_stateNameRules.contains(stateType.name())) {
+                resolvedRules.insert(stateType.id(), m_stateNameRules.value(stateType.name()));
+            }
+        }
+        m_resolvedNameRules.insert(thingClassId, resolvedRules);
+    }
+
+    return m_resolvedNameRules[thingClassId].value(stateTypeId, m_defaultRule);
+}
+
+bool ModbusStateFilter::isNumeric(const QVariant &value) const
+{
+    switch (static_cast<QMetaType::Type>(value.type())) {
+    case QMetaType::Double:
+    case QMetaType::Float:
+    case QMetaType::Int:
+    case QMetaType::UInt:
+    case QMetaType::LongLong:
+    case QMetaType::ULongLong:
+        return true;
+    default:
+        return false;
+    }
+}
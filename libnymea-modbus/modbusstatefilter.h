@@ -0,0 +1,95 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+*
+* Copyright 2013 - 2022, nymea GmbH
+* Contact: contact@nymea.io
+*
+* This file is part of nymea.
+* This project including source code and documentation is protected by
+* copyright law, and remains the property of nymea GmbH. All rights, including
+* reproduction, publication, editing and translation, are reserved. The use of
+* this project is subject to the terms of a license agreement to be concluded
+* with nymea GmbH in accordance with the terms of use of nymea GmbH, available
+* under https://nymea.io/license
+*
+* GNU Lesser General Public License Usage
+* Alternatively, this project may be redistributed and/or modified under the
+* terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; version 3. This project is distributed in the hope that
+* it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+* warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this project. If not, see <https://www.gnu.org/licenses/>.
+*
+* For any further details and any questions please contact us under
+* contact@nymea.io or see our FAQ/Licensing Information on
+* https://nymea.io/license/faq
+*
+* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef MODBUSSTATEFILTER_H
+#define MODBUSSTATEFILTER_H
+
+#include <QHash>
+#include <QVariant>
+#include <QElapsedTimer>
+
+#include <integrations/thing.h>
+
+// Filters the state updates of a plugin before they get written to the thing. Numeric values
+// only get published if they moved out of the deadband of the current state value and the
+// minimum interval since the last publish passed. A heartbeat publishes the latest value
+// even if it stays within the deadband. Values of other types are always passed through.
+//
+// Rules can be set for a state type id or for a state type name, which is handy for plugins
+// with many thing classes sharing the same state names. Name rules get resolved to state type
+// ids once per thing class. The state type id rule wins.
+
+class ModbusStateFilter
+{
+public:
+    typedef struct Rule {
+        // Publish if the value changed at least by this absolute amount
+        double absoluteDeadband = 0;
+        // Publish if the value changed at least by this fraction of the current value, i.e. 0.01 for 1%
+        double relativeDeadband = 0;
+        // Minimum time in ms between two publishes of a value outside the deadband
+        int minimumInterval = 0;
+        // Publish the latest value after this time in ms even within the deadband, 0 disables the heartbeat
+        int heartbeatInterval = 0;
+    } Rule;
+
+    explicit ModbusStateFilter();
+
+    // Presets for values jittering on every refresh
+    static Rule voltageRule();
+    static Rule frequencyRule();
+    static Rule temperatureRule();
+
+    Rule defaultRule() const;
+    void setDefaultRule(const Rule &rule);
+
+    void setRule(const StateTypeId &stateTypeId, const Rule &rule);
+    void setRule(const QString &stateName, const Rule &rule);
+
+    // Returns true if the value has been written to the thing
+    bool setStateValue(Thing *thing, const StateTypeId &stateTypeId, const QVariant &value);
+
+    // Forget the publish times of the thing, i.e. once it has been removed or reconnected
+    void resetThing(const ThingId &thingId);
+
+private:
+    Rule m_defaultRule;
+    QHash<StateTypeId, Rule> m_stateTypeRules;
+    QHash<QString, Rule> m_stateNameRules;
+    QHash<ThingClassId, QHash<StateTypeId, Rule>> m_resolvedNameRules;
+
+    QElapsedTimer m_clock;
+    QHash<ThingId, QHash<StateTypeId, qint64>> m_lastPublished;
+
+    Rule rule(Thing *thing, const StateTypeId &stateTypeId);
+    bool isNumeric(const QVariant &value) const;
+};
+
+#endif // MODBUSSTATEFILTER_H
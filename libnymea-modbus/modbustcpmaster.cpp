@@ -32,6 +32,10 @@
 
 Q_LOGGING_CATEGORY(dcModbusTcpMaster, "ModbusTcpMaster")
 
+static const int s_requestTimeoutTick = 250;
+static const int s_requestTimeoutWheelSize = 32;
+static const int s_requestTimeoutGracePeriod = 1000;
+
 ModbusTcpMaster::ModbusTcpMaster(const QHostAddress &hostAddress, uint port, QObject *parent) :
     QObject(parent),
     m_hostAddress(hostAddress),
@@ -48,8 +52,14 @@ ModbusTcpMaster::ModbusTcpMaster(const QHostAddress &hostAddress, uint port, QOb
 
     m_reconnectTimer = new QTimer(this);
     m_reconnectTimer->setSingleShot(true);
-    m_reconnectTimer->setInterval(4000);
+    m_reconnectTimer->setInterval(m_reconnectInterval);
     connect(m_reconnectTimer, &QTimer::timeout, this, &ModbusTcpMaster::connectDevice);
+
+    m_requestClock.start();
+    m_requestTimeoutWheel.resize(s_requestTimeoutWheelSize);
+    m_requestTimeoutTimer = new QTimer(this);
+    m_requestTimeoutTimer->setInterval(s_requestTimeoutTick);
+    connect(m_requestTimeoutTimer, &QTimer::timeout, this, &ModbusTcpMaster::onRequestTimeoutTick);
 }
 
 ModbusTcpMaster::~ModbusTcpMaster()
@@ -103,7 +113,7 @@ bool ModbusTcpMaster::connectDevice()
     } else if (m_modbusTcpClient->state() != QModbusDevice::ConnectedState && m_modbusTcpClient->state() != QModbusDevice::ConnectingState) {
         // Restart the timer in case of connecting not finished yet or closing
         qCDebug(dcModbusTcpMaster()) << "Starting the re-connect mechanism timer";
-        m_reconnectTimer->start();
+        startReconnectTimer();
     } else {
         qCWarning(dcModbusTcpMaster()) << "Connect modbus TCP device" << connectionUrl() << "called, but the socket is currently in the" << m_modbusTcpClient->state();
     }
@@ -115,6 +125,7 @@ void ModbusTcpMaster::disconnectDevice()
 {
     // Stop the reconnect timer since disconnect was explicitly called
     m_reconnectTimer->stop();
+    m_reconnectAttempts = 0;
     m_modbusTcpClient->disconnectDevice();
 }
 
@@ -152,6 +163,26 @@ void ModbusTcpMaster::setTimeout(int timeout)
     m_modbusTcpClient->setTimeout(timeout);
 }
 
+int ModbusTcpMaster::reconnectInterval() const
+{
+    return m_reconnectInterval;
+}
+
+void ModbusTcpMaster::setReconnectInterval(int reconnectInterval)
+{
+    m_reconnectInterval = qMax(0, reconnectInterval);
+}
+
+int ModbusTcpMaster::maximumReconnectInterval() const
+{
+    return m_maximumReconnectInterval;
+}
+
+void ModbusTcpMaster::setMaximumReconnectInterval(int maximumReconnectInterval)
+{
+    m_maximumReconnectInterval = qMax(0, maximumReconnectInterval);
+}
+
 QString ModbusTcpMaster::errorString() const
 {
     return m_modbusTcpClient->errorString();
@@ -164,77 +195,15 @@ QModbusDevice::Error ModbusTcpMaster::error() const
 
 QUuid ModbusTcpMaster::readCoil(uint slaveAddress, uint registerAddress, uint size)
 {
-    QUuid requestId = QUuid::createUuid();
     QModbusDataUnit request = QModbusDataUnit(QModbusDataUnit::RegisterType::Coils, registerAddress, size);
-
-    if (QModbusReply *reply = m_modbusTcpClient->sendReadRequest(request, slaveAddress)) {
-        if (!reply->isFinished()) {
-            connect(reply, &QModbusReply::finished, reply, &QModbusReply::deleteLater);
-            connect(reply, &QModbusReply::finished, this, [reply, requestId, this] {
-                if (reply->error() == QModbusDevice::NoError) {
-                    emit readRequestExecuted(requestId, true);
-                    const QModbusDataUnit unit = reply->result();
-                    uint modbusAddress = unit.startAddress();
-                    emit receivedCoil(reply->serverAddress(), modbusAddress, unit.values());
-                } else {
-                    emit readRequestExecuted(requestId, false);
-                    qCWarning(dcModbusTcpMaster()) << "Read response error for device" << connectionUrl() << ":" << reply->error();
-                }
-            });
-
-            connect(reply, &QModbusReply::errorOccurred, this, [reply, requestId, this] (QModbusDevice::Error error){
-                qCWarning(dcModbusTcpMaster()) << "Modbus reply error for device" << connectionUrl() << ":" << error;
-                emit readRequestError(requestId, reply->errorString());
-            });
-
-            QTimer::singleShot(200, reply, &QModbusReply::deleteLater);
-        } else {
-            reply->deleteLater(); // broadcast replies return immediately
-            return QUuid();
-        }
-    } else {
-        qCWarning(dcModbusTcpMaster()) << "Read error for device" << connectionUrl() << ":" << m_modbusTcpClient->errorString();
-        return QUuid();
-    }
-    return requestId;
+    return sendTrackedRequest(RequestTypeReadCoils, request, slaveAddress);
 }
 
 QUuid ModbusTcpMaster::writeHoldingRegisters(uint slaveAddress, uint registerAddress, const QVector<quint16> &values)
 {
-    QUuid requestId = QUuid::createUuid();
     QModbusDataUnit request = QModbusDataUnit(QModbusDataUnit::RegisterType::HoldingRegisters, registerAddress, values.length());
     request.setValues(values);
-    if (QModbusReply *reply = m_modbusTcpClient->sendWriteRequest(request, slaveAddress)) {
-        if (!reply->isFinished()) {
-            connect(reply, &QModbusReply::finished, reply, &QModbusReply::deleteLater);
-            connect(reply, &QModbusReply::finished, this, [reply, requestId, this] {
-                if (reply->error() == QModbusDevice::NoError) {
-                    emit writeRequestExecuted(requestId, true);
-                    const QModbusDataUnit unit = reply->result();
-                    uint modbusAddress = unit.startAddress();
-                    emit receivedHoldingRegister(reply->serverAddress(), modbusAddress, unit.values());
-                } else {
-                    emit writeRequestExecuted(requestId, false);
-                    qCWarning(dcModbusTcpMaster()) << "Read response error for device" << connectionUrl() << ":" << reply->error();
-                }
-                reply->deleteLater();
-            });
-
-            connect(reply, &QModbusReply::errorOccurred, this, [reply, requestId, this] (QModbusDevice::Error error){
-                qCWarning(dcModbusTcpMaster()) << "Modbus replay error for device" << connectionUrl() << ":" << error;
-                emit writeRequestError(requestId, reply->errorString());
-            });
-
-            QTimer::singleShot(2000, reply, &QModbusReply::deleteLater);
-        } else {
-            reply->deleteLater(); // broadcast replies return immediately
-            return QUuid();
-        }
-    } else {
-        qCWarning(dcModbusTcpMaster()) << "Read error for device" << connectionUrl() << ":" << m_modbusTcpClient->errorString();
-        return QUuid();
-    }
-    return requestId;
+    return sendTrackedRequest(RequestTypeWriteHoldingRegisters, request, slaveAddress);
 }
 
 QModbusReply *ModbusTcpMaster::sendRawRequest(const QModbusRequest &request, int serverAddress)
@@ -257,178 +226,190 @@ QModbusReply *ModbusTcpMaster::sendWriteRequest(const QModbusDataUnit &write, in
     return m_modbusTcpClient->sendWriteRequest(write, serverAddress);
 }
 
-QUuid ModbusTcpMaster::readDiscreteInput(uint slaveAddress, uint registerAddress, uint size)
+QFuture<ModbusRequestResult> ModbusTcpMaster::readAsync(const QModbusDataUnit &read, int serverAddress, int timeout)
 {
-    QUuid requestId = QUuid::createUuid();
+    return ModbusFuture::fromReply(m_modbusTcpClient->sendReadRequest(read, serverAddress), timeout);
+}
 
-    QModbusDataUnit request = QModbusDataUnit(QModbusDataUnit::RegisterType::DiscreteInputs, registerAddress, size);
+QFuture<ModbusRequestResult> ModbusTcpMaster::readWriteAsync(const QModbusDataUnit &read, const QModbusDataUnit &write, int serverAddress, int timeout)
+{
+    return ModbusFuture::fromReply(m_modbusTcpClient->sendReadWriteRequest(read, write, serverAddress), timeout);
+}
 
-    if (QModbusReply *reply = m_modbusTcpClient->sendReadRequest(request, slaveAddress)) {
-        if (!reply->isFinished()) {
-            connect(reply, &QModbusReply::finished, reply, &QModbusReply::deleteLater);
-            connect(reply, &QModbusReply::finished, this, [reply, requestId, this] {
-                if (reply->error() == QModbusDevice::NoError) {
-                    emit readRequestExecuted(requestId, true);
-                    const QModbusDataUnit unit = reply->result();
-                    uint modbusAddress = unit.startAddress();
-                    emit receivedDiscreteInput(reply->serverAddress(), modbusAddress, unit.values());
-                } else {
-                    emit readRequestExecuted(requestId, false);
-                    qCWarning(dcModbusTcpMaster()) << "Read response error for device" << connectionUrl() << ":" << reply->error();
-                }
-            });
-
-            connect(reply, &QModbusReply::errorOccurred, this, [requestId, reply, this] (QModbusDevice::Error error){
-                qCWarning(dcModbusTcpMaster()) << "Modbus replay error for device" << connectionUrl() << ":" << error;
-                emit readRequestError(requestId, reply->errorString());
-            });
-
-            QTimer::singleShot(2000, reply, &QModbusReply::deleteLater);
-        } else {
-            reply->deleteLater(); // broadcast replies return immediately
-            return QUuid();
-        }
-    } else {
-        qCWarning(dcModbusTcpMaster()) << "Read error for device" << connectionUrl() << ":" << m_modbusTcpClient->errorString();
-        return QUuid();
-    }
-    return requestId;
+QFuture<ModbusRequestResult> ModbusTcpMaster::writeAsync(const QModbusDataUnit &write, int serverAddress, int timeout)
+{
+    return ModbusFuture::fromReply(m_modbusTcpClient->sendWriteRequest(write, serverAddress), timeout);
 }
 
-QUuid ModbusTcpMaster::readInputRegister(uint slaveAddress, uint registerAddress, uint size)
+QUuid ModbusTcpMaster::readDiscreteInput(uint slaveAddress, uint registerAddress, uint size)
 {
-    if (!m_modbusTcpClient) {
-        return QUuid();
-    }
+    QModbusDataUnit request = QModbusDataUnit(QModbusDataUnit::RegisterType::DiscreteInputs, registerAddress, size);
+    return sendTrackedRequest(RequestTypeReadDiscreteInputs, request, slaveAddress);
+}
 
-    QUuid requestId = QUuid::createUuid();
+QUuid ModbusTcpMaster::readInputRegister(uint slaveAddress, uint registerAddress, uint size)
+{
     QModbusDataUnit request = QModbusDataUnit(QModbusDataUnit::RegisterType::InputRegisters, registerAddress, size);
-
-    if (QModbusReply *reply = m_modbusTcpClient->sendReadRequest(request, slaveAddress)) {
-        if (!reply->isFinished()) {
-            connect(reply, &QModbusReply::finished, reply, &QModbusReply::deleteLater);
-            connect(reply, &QModbusReply::finished, this, [reply, requestId, this] {
-                reply->deleteLater();
-                if (reply->error() == QModbusDevice::NoError) {
-                    emit readRequestExecuted(requestId, true);
-                    const QModbusDataUnit unit = reply->result();
-                    uint modbusAddress = unit.startAddress();
-                    emit receivedInputRegister(reply->serverAddress(), modbusAddress, unit.values());
-                } else {
-                    emit readRequestExecuted(requestId, false);
-                    qCWarning(dcModbusTcpMaster()) << "Read response error for device" << connectionUrl() << ":" << reply->error();
-                }
-            });
-
-            connect(reply, &QModbusReply::errorOccurred, this, [reply, requestId, this] (QModbusDevice::Error error){
-                qCWarning(dcModbusTcpMaster()) << "Modbus reply error for device" << connectionUrl() << ":" << error;
-                emit readRequestError(requestId, reply->errorString());
-            });
-
-            QTimer::singleShot(2000, reply, &QModbusReply::deleteLater);
-
-        } else {
-            reply->deleteLater(); // broadcast replies return immediately
-            return QUuid();
-        }
-    } else {
-        qCWarning(dcModbusTcpMaster()) << "Read error for device" << connectionUrl() << ":" << m_modbusTcpClient->errorString();
-        return QUuid();
-    }
-    return requestId;
+    return sendTrackedRequest(RequestTypeReadInputRegisters, request, slaveAddress);
 }
 
 QUuid ModbusTcpMaster::readHoldingRegister(uint slaveAddress, uint registerAddress, uint size)
 {
-    QUuid requestId = QUuid::createUuid();
     QModbusDataUnit request = QModbusDataUnit(QModbusDataUnit::RegisterType::HoldingRegisters, registerAddress, size);
+    return sendTrackedRequest(RequestTypeReadHoldingRegisters, request, slaveAddress);
+}
 
-    if (QModbusReply *reply = m_modbusTcpClient->sendReadRequest(request, slaveAddress)) {
-        if (!reply->isFinished()) {
-            connect(reply, &QModbusReply::finished, reply, &QModbusReply::deleteLater);
-            connect(reply, &QModbusReply::finished, this, [reply, requestId, this] {
+QUuid ModbusTcpMaster::writeCoil(uint slaveAddress, uint registerAddress, bool value)
+{
+    return writeCoils(slaveAddress, registerAddress, QVector<quint16>() << static_cast<quint16>(value));
+}
+
+QUuid ModbusTcpMaster::writeCoils(uint slaveAddress, uint registerAddress, const QVector<quint16> &values)
+{
+    QModbusDataUnit request = QModbusDataUnit(QModbusDataUnit::RegisterType::Coils, registerAddress, values.length());
+    request.setValues(values);
+    return sendTrackedRequest(RequestTypeWriteCoils, request, slaveAddress);
+}
+
+QUuid ModbusTcpMaster::writeHoldingRegister(uint slaveAddress, uint registerAddress, quint16 value)
+{
+    return writeHoldingRegisters(slaveAddress, registerAddress, QVector<quint16>() << value);
+}
 
-                if (reply->error() == QModbusDevice::NoError) {
-                    emit writeRequestExecuted(requestId, true);
-                    const QModbusDataUnit unit = reply->result();
-                    uint modbusAddress = unit.startAddress();
-                    emit receivedHoldingRegister(reply->serverAddress(), modbusAddress, unit.values());
+QUuid ModbusTcpMaster::sendTrackedRequest(RequestType type, const QModbusDataUnit &request, uint slaveAddress)
+{
+    if (!m_modbusTcpClient)
+        return QUuid();
 
-                } else {
-                    emit writeRequestExecuted(requestId, false);
-                    qCWarning(dcModbusTcpMaster()) << "Read response error for device" << connectionUrl() << ":" << reply->error();
-                    emit readRequestError(requestId, reply->errorString());
-                }
-                reply->deleteLater();
-            });
+    bool write = (type == RequestTypeWriteCoils || type == RequestTypeWriteHoldingRegisters);
+    QModbusReply *reply = write ? m_modbusTcpClient->sendWriteRequest(request, slaveAddress) : m_modbusTcpClient->sendReadRequest(request, slaveAddress);
+    if (!reply) {
+        qCWarning(dcModbusTcpMaster()) << (write ? "Write error for device" : "Read error for device") << connectionUrl() << ":" << m_modbusTcpClient->errorString();
+        return QUuid();
+    }
 
-            connect(reply, &QModbusReply::errorOccurred, this, [reply, requestId, this] (QModbusDevice::Error error){
+    if (reply->isFinished()) {
+        reply->deleteLater(); // broadcast replies return immediately
+        return QUuid();
+    }
 
-                qCWarning(dcModbusTcpMaster()) << "Modbus reply error for device" << connectionUrl() << ":" << error;
-                emit readRequestError(requestId, reply->errorString());
-            });
+    // Request ids only need to be unique within the process, a counter is much cheaper than QUuid::createUuid()
+    static QAtomicInt requestCounter;
+    PendingRequest pendingRequest;
+    pendingRequest.requestId = QUuid(static_cast<uint>(requestCounter.fetchAndAddRelaxed(1) + 1), 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+    pendingRequest.type = type;
+    pendingRequest.deadline = m_requestClock.elapsed() + m_timeout * (m_numberOfRetries + 1) + s_requestTimeoutGracePeriod;
+    m_pendingRequests.insert(reply, pendingRequest);
+    scheduleRequestTimeout(reply, pendingRequest.deadline);
+
+    // The tracker owns the reply from now on, it gets deleted once finished or timed out
+    connect(reply, &QModbusReply::finished, this, [this, reply](){
+        finishRequest(reply);
+    });
+
+    return pendingRequest.requestId;
+}
 
-            QTimer::singleShot(2000, reply, &QModbusReply::deleteLater);
+void ModbusTcpMaster::finishRequest(QModbusReply *reply)
+{
+    if (!m_pendingRequests.contains(reply))
+        return;
+
+    PendingRequest pendingRequest = m_pendingRequests.take(reply);
+    reply->deleteLater();
+    if (m_pendingRequests.isEmpty())
+        m_requestTimeoutTimer->stop();
+
+    bool write = (pendingRequest.type == RequestTypeWriteCoils || pendingRequest.type == RequestTypeWriteHoldingRegisters);
+    if (reply->error() != QModbusDevice::NoError) {
+        qCWarning(dcModbusTcpMaster()) << "Modbus reply error for device" << connectionUrl() << ":" << reply->error() << reply->errorString();
+        if (write) {
+            emit writeRequestError(pendingRequest.requestId, reply->errorString());
         } else {
-            reply->deleteLater(); // broadcast replies return immediately
-            return QUuid();
+            emit readRequestError(pendingRequest.requestId, reply->errorString());
         }
+
+        emitRequestExecuted(pendingRequest, false);
+        return;
+    }
+
+    emitRequestExecuted(pendingRequest, true);
+
+    const QModbusDataUnit unit = reply->result();
+    switch (pendingRequest.type) {
+    case RequestTypeReadCoils:
+    case RequestTypeWriteCoils:
+        emit receivedCoil(reply->serverAddress(), unit.startAddress(), unit.values());
+        break;
+    case RequestTypeReadDiscreteInputs:
+        emit receivedDiscreteInput(reply->serverAddress(), unit.startAddress(), unit.values());
+        break;
+    case RequestTypeReadInputRegisters:
+        emit receivedInputRegister(reply->serverAddress(), unit.startAddress(), unit.values());
+        break;
+    case RequestTypeReadHoldingRegisters:
+    case RequestTypeWriteHoldingRegisters:
+        emit receivedHoldingRegister(reply->serverAddress(), unit.startAddress(), unit.values());
+        break;
+    }
+}
+
+void ModbusTcpMaster::emitRequestExecuted(const PendingRequest &pendingRequest, bool success)
+{
+    // Note: holding register reads have always been reported using writeRequestExecuted, keep it for compatibility
+    if (pendingRequest.type == RequestTypeReadCoils || pendingRequest.type == RequestTypeReadDiscreteInputs || pendingRequest.type == RequestTypeReadInputRegisters) {
+        emit readRequestExecuted(pendingRequest.requestId, success);
     } else {
-        qCWarning(dcModbusTcpMaster()) << "Read error for device" << connectionUrl() << ":" << m_modbusTcpClient->errorString();
-        return QUuid();
+        emit writeRequestExecuted(pendingRequest.requestId, success);
     }
-    return requestId;
 }
 
-QUuid ModbusTcpMaster::writeCoil(uint slaveAddress, uint registerAddress, bool value)
+void ModbusTcpMaster::scheduleRequestTimeout(QModbusReply *reply, qint64 deadline)
 {
-    return writeCoils(slaveAddress, registerAddress, QVector<quint16>() << static_cast<quint16>(value));
+    // All requests share one timer, each tick checks only the replies of the current wheel slot.
+    // Deadlines beyond the wheel range get checked once per round until they expired.
+    qint64 remainingTicks = qMax<qint64>(1, (deadline - m_requestClock.elapsed() + s_requestTimeoutTick - 1) / s_requestTimeoutTick);
+    int slot = (m_requestTimeoutWheelPosition + qMin<qint64>(remainingTicks, m_requestTimeoutWheel.count() - 1)) % m_requestTimeoutWheel.count();
+    m_requestTimeoutWheel[slot].append(reply);
+
+    if (!m_requestTimeoutTimer->isActive()) {
+        m_requestTimeoutTimer->start();
+    }
 }
 
-QUuid ModbusTcpMaster::writeCoils(uint slaveAddress, uint registerAddress, const QVector<quint16> &values)
+void ModbusTcpMaster::onRequestTimeoutTick()
 {
-    QUuid requestId = QUuid::createUuid();
-    QModbusDataUnit request = QModbusDataUnit(QModbusDataUnit::RegisterType::Coils, registerAddress, values.length());
-    request.setValues(values);
+    m_requestTimeoutWheelPosition = (m_requestTimeoutWheelPosition + 1) % m_requestTimeoutWheel.count();
+    QList<QModbusReply *> replies = m_requestTimeoutWheel[m_requestTimeoutWheelPosition];
+    m_requestTimeoutWheel[m_requestTimeoutWheelPosition].clear();
+
+    foreach (QModbusReply *reply, replies) {
+        // Finished requests are not removed from the wheel, they are just not pending any more
+        if (!m_pendingRequests.contains(reply))
+            continue;
+
+        if (m_pendingRequests.value(reply).deadline > m_requestClock.elapsed()) {
+            scheduleRequestTimeout(reply, m_pendingRequests.value(reply).deadline);
+            continue;
+        }
+
+        PendingRequest pendingRequest = m_pendingRequests.take(reply);
+        qCWarning(dcModbusTcpMaster()) << "Modbus request timed out for device" << connectionUrl();
+        reply->disconnect(this);
+        reply->deleteLater();
 
-    if (QModbusReply *reply = m_modbusTcpClient->sendWriteRequest(request, slaveAddress)) {
-        if (!reply->isFinished()) {
-            connect(reply, &QModbusReply::finished, reply, &QModbusReply::deleteLater);
-            connect(reply, &QModbusReply::finished, this, [reply, requestId, this] () {
-
-                if (reply->error() == QModbusDevice::NoError) {
-                    emit writeRequestExecuted(requestId, true);
-                    const QModbusDataUnit unit = reply->result();
-                    uint modbusAddress = unit.startAddress();
-                    emit receivedCoil(reply->serverAddress(), modbusAddress, unit.values());
-
-                } else {
-                    emit writeRequestExecuted(requestId, false);
-                    qCWarning(dcModbusTcpMaster()) << "Write response error for device" << connectionUrl() << ":" << reply->error();
-                }
-                reply->deleteLater();
-            });
-
-            connect(reply, &QModbusReply::errorOccurred, this, [reply, requestId, this] (QModbusDevice::Error error){
-                qCWarning(dcModbusTcpMaster()) << "Modbus reply error for device" << connectionUrl() << ":" << error;
-                emit writeRequestError(requestId, reply->errorString());
-            });
-
-            QTimer::singleShot(2000, reply, &QModbusReply::deleteLater);
+        if (pendingRequest.type == RequestTypeWriteCoils || pendingRequest.type == RequestTypeWriteHoldingRegisters) {
+            emit writeRequestError(pendingRequest.requestId, QStringLiteral("The modbus request timed out."));
         } else {
-            reply->deleteLater(); // broadcast replies return immediately
-            return QUuid();
+            emit readRequestError(pendingRequest.requestId, QStringLiteral("The modbus request timed out."));
         }
-    } else {
-        qCWarning(dcModbusTcpMaster()) << "Read error for device" << connectionUrl() << ":" << m_modbusTcpClient->errorString();
-        return QUuid();
+
+        emitRequestExecuted(pendingRequest, false);
     }
-    return requestId;
-}
 
-QUuid ModbusTcpMaster::writeHoldingRegister(uint slaveAddress, uint registerAddress, quint16 value)
-{
-    return writeHoldingRegisters(slaveAddress, registerAddress, QVector<quint16>() << value);
+    if (m_pendingRequests.isEmpty()) {
+        m_requestTimeoutTimer->stop();
+    }
 }
 
 void ModbusTcpMaster::onModbusErrorOccurred(QModbusDevice::Error error)
@@ -450,7 +431,23 @@ void ModbusTcpMaster::onModbusStateChanged(QModbusDevice::State state)
     // If the socket is unconnected (not connecting and not closing), start the reconnect timer
     if (m_connected) {
         m_reconnectTimer->stop();
+        m_reconnectAttempts = 0;
     } else if (state == QModbusDevice::UnconnectedState) {
-        m_reconnectTimer->start();
+        startReconnectTimer();
     }
 }
+
+void ModbusTcpMaster::startReconnectTimer()
+{
+    // Devices which only dropped the connection shortly (i.e. WLAN roaming) get a fast first
+    // attempt, devices which stay unreachable are retried less and less often.
+    int interval = m_reconnectInterval;
+    for (uint i = 0; i < m_reconnectAttempts && interval < m_maximumReconnectInterval; i++)
+        interval *= 2;
+
+    interval = qMin(qMax(interval, 0), m_maximumReconnectInterval);
+    m_reconnectAttempts++;
+
+    qCDebug(dcModbusTcpMaster()) << "Reconnecting" << connectionUrl() << "in" << interval << "ms";
+    m_reconnectTimer->start(interval);
+}
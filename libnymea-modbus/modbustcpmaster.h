@@ -32,12 +32,16 @@
 #define MODBUSTCPMASTER_H
 
 #include <QUuid>
+#include <QHash>
 #include <QTimer>
 #include <QObject>
+#include <QElapsedTimer>
 #include <QHostAddress>
 #include <QtSerialBus>
 #include <QLoggingCategory>
 
+#include "modbusfuture.h"
+
 Q_DECLARE_LOGGING_CATEGORY(dcModbusTcpMaster)
 
 class ModbusTcpMaster : public QObject
@@ -65,6 +69,14 @@ public:
     int timeout() const;
     void setTimeout(int timeout);
 
+    // The first reconnect attempt after losing the connection waits reconnectInterval ms,
+    // each further attempt doubles the interval up to maximumReconnectInterval ms.
+    int reconnectInterval() const;
+    void setReconnectInterval(int reconnectInterval);
+
+    int maximumReconnectInterval() const;
+    void setMaximumReconnectInterval(int maximumReconnectInterval);
+
     QString errorString() const;
     QModbusDevice::Error error() const;
 
@@ -85,6 +97,11 @@ public:
     QModbusReply *sendReadWriteRequest(const QModbusDataUnit &read, const QModbusDataUnit &write, int serverAddress);
     QModbusReply *sendWriteRequest(const QModbusDataUnit &write, int serverAddress);
 
+    // Future based requests, see ModbusFuture. A timeout > 0 limits the total time in ms including retries.
+    QFuture<ModbusRequestResult> readAsync(const QModbusDataUnit &read, int serverAddress, int timeout = 0);
+    QFuture<ModbusRequestResult> readWriteAsync(const QModbusDataUnit &read, const QModbusDataUnit &write, int serverAddress, int timeout = 0);
+    QFuture<ModbusRequestResult> writeAsync(const QModbusDataUnit &write, int serverAddress, int timeout = 0);
+
 public slots:
     bool connectDevice();
     void disconnectDevice();
@@ -98,11 +115,46 @@ protected:
     uint m_port;
     int m_timeout = 1000;
     int m_numberOfRetries = 3;
+    int m_reconnectInterval = 500;
+    int m_maximumReconnectInterval = 4000;
+    uint m_reconnectAttempts = 0;
     bool m_connected = false;
 
+    void startReconnectTimer();
+
+private:
+    enum RequestType {
+        RequestTypeReadCoils,
+        RequestTypeReadDiscreteInputs,
+        RequestTypeReadInputRegisters,
+        RequestTypeReadHoldingRegisters,
+        RequestTypeWriteCoils,
+        RequestTypeWriteHoldingRegisters
+    };
+
+    typedef struct PendingRequest {
+        QUuid requestId;
+        RequestType type = RequestTypeReadHoldingRegisters;
+        qint64 deadline = 0;
+    } PendingRequest;
+
+    // Requests sent using the QUuid based methods, each reply is owned by the tracker until it
+    // finished or timed out. Timeouts are checked using one timing wheel for all requests.
+    QHash<QModbusReply *, PendingRequest> m_pendingRequests;
+    QTimer *m_requestTimeoutTimer = nullptr;
+    QElapsedTimer m_requestClock;
+    QVector<QList<QModbusReply *>> m_requestTimeoutWheel;
+    int m_requestTimeoutWheelPosition = 0;
+
+    QUuid sendTrackedRequest(RequestType type, const QModbusDataUnit &request, uint slaveAddress);
+    void finishRequest(QModbusReply *reply);
+    void emitRequestExecuted(const PendingRequest &pendingRequest, bool success);
+    void scheduleRequestTimeout(QModbusReply *reply, qint64 deadline);
+
 private slots:
     void onModbusErrorOccurred(QModbusDevice::Error error);
     void onModbusStateChanged(QModbusDevice::State state);
+    void onRequestTimeoutTick();
 
 signals:
     void connectionStateChanged(bool status);
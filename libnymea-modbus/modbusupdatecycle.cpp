@@ -0,0 +1,165 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+*
+* Copyright 2013 - 2022, nymea GmbH
+* Contact: contact@nymea.io
+*
+* This file is part of nymea.
+* This project including source code and documentation is protected by
+* copyright law, and remains the property of nymea GmbH. All rights, including
+* reproduction, publication, editing and translation, are reserved. The use of
+* this project is subject to the terms of a license agreement to be concluded
+* with nymea GmbH in accordance with the terms of use of nymea GmbH, available
+* under https://nymea.io/license
+*
+* GNU Lesser General Public License Usage
+* Alternatively, this project may be redistributed and/or modified under the
+* terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; version 3. This project is distributed in the hope that
+* it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+* warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this project. If not, see <https://www.gnu.org/licenses/>.
+*
+* For any further details and any questions please contact us under
+* contact@nymea.io or see our FAQ/Licensing Information on
+* https://nymea.io/license/faq
+*
+* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "modbusupdatecycle.h"
+
+ModbusUpdateCycle::ModbusUpdateCycle()
+{
+
+}
+
+ModbusUpdateCycle::OverrunPolicy ModbusUpdateCycle::overrunPolicy() const
+{
+    return m_overrunPolicy;
+}
+
+void ModbusUpdateCycle::setOverrunPolicy(OverrunPolicy overrunPolicy)
+{
+    m_overrunPolicy = overrunPolicy;
+    m_updateQueued = false;
+    updateStretchedInterval();
+}
+
+ModbusUpdateCycle::Action ModbusUpdateCycle::requestUpdate(bool cycleRunning)
+{
+    // A queued update is no request of the caller, don't count it into the request interval
+    if (m_updateQueued && !cycleRunning) {
+        m_updateQueued = false;
+        return ActionStart;
+    }
+
+    if (m_requestTimer.isValid()) {
+        int interval = static_cast<int>(m_requestTimer.restart());
+        m_requestInterval = m_requestInterval == 0 ? interval : (m_requestInterval * 7 + interval) / 8;
+    } else {
+        m_requestTimer.start();
+    }
+
+    if (cycleRunning) {
+        m_overrunCount++;
+        if (m_overrunPolicy == OverrunPolicyQueueOne && !m_updateQueued) {
+            m_updateQueued = true;
+            return ActionQueue;
+        }
+
+        m_skippedCount++;
+        return ActionSkip;
+    }
+
+    if (m_overrunPolicy == OverrunPolicyStretch && m_stretchedInterval > 0 && m_cycleTimer.isValid() && m_cycleTimer.elapsed() < m_stretchedInterval) {
+        m_skippedCount++;
+        return ActionSkip;
+    }
+
+    return ActionStart;
+}
+
+void ModbusUpdateCycle::startCycle()
+{
+    m_cycleRunning = true;
+    m_cycleTimer.start();
+}
+
+bool ModbusUpdateCycle::finishCycle()
+{
+    if (!m_cycleRunning)
+        return false;
+
+    m_cycleRunning = false;
+    m_cycleCount++;
+    m_lastDuration = static_cast<int>(m_cycleTimer.elapsed());
+    m_averageDuration = m_cycleCount == 1 ? m_lastDuration : (m_averageDuration * 7 + m_lastDuration) / 8;
+    m_maximumDuration = qMax(m_maximumDuration, m_lastDuration);
+    updateStretchedInterval();
+
+    return m_updateQueued;
+}
+
+void ModbusUpdateCycle::abortCycle()
+{
+    m_cycleRunning = false;
+    m_updateQueued = false;
+}
+
+bool ModbusUpdateCycle::updateQueued() const
+{
+    return m_updateQueued;
+}
+
+uint ModbusUpdateCycle::cycleCount() const
+{
+    return m_cycleCount;
+}
+
+uint ModbusUpdateCycle::skippedCount() const
+{
+    return m_skippedCount;
+}
+
+uint ModbusUpdateCycle::overrunCount() const
+{
+    return m_overrunCount;
+}
+
+int ModbusUpdateCycle::lastDuration() const
+{
+    return m_lastDuration;
+}
+
+int ModbusUpdateCycle::averageDuration() const
+{
+    return m_averageDuration;
+}
+
+int ModbusUpdateCycle::maximumDuration() const
+{
+    return m_maximumDuration;
+}
+
+int ModbusUpdateCycle::requestInterval() const
+{
+    return m_requestInterval;
+}
+
+int ModbusUpdateCycle::stretchedInterval() const
+{
+    return m_stretchedInterval;
+}
+
+void ModbusUpdateCycle::updateStretchedInterval()
+{
+    // Leave 25% of the time idle between two cycles, stop stretching once the device keeps up again
+    int requiredInterval = m_averageDuration * 5 / 4;
+    if (m_overrunPolicy != OverrunPolicyStretch || requiredInterval <= m_requestInterval) {
+        m_stretchedInterval = 0;
+    } else {
+        m_stretchedInterval = requiredInterval;
+    }
+}
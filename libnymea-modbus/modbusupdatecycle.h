@@ -0,0 +1,115 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+*
+* Copyright 2013 - 2022, nymea GmbH
+* Contact: contact@nymea.io
+*
+* This file is part of nymea.
+* This project including source code and documentation is protected by
+* copyright law, and remains the property of nymea GmbH. All rights, including
+* reproduction, publication, editing and translation, are reserved. The use of
+* this project is subject to the terms of a license agreement to be concluded
+* with nymea GmbH in accordance with the terms of use of nymea GmbH, available
+* under https://nymea.io/license
+*
+* GNU Lesser General Public License Usage
+* Alternatively, this project may be redistributed and/or modified under the
+* terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; version 3. This project is distributed in the hope that
+* it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+* warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this project. If not, see <https://www.gnu.org/licenses/>.
+*
+* For any further details and any questions please contact us under
+* contact@nymea.io or see our FAQ/Licensing Information on
+* https://nymea.io/license/faq
+*
+* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef MODBUSUPDATECYCLE_H
+#define MODBUSUPDATECYCLE_H
+
+#include <QObject>
+#include <QElapsedTimer>
+
+// Keeps track of the update cycles of a generated modbus connection. Each update() request
+// gets checked against the running cycle and the overrun policy, the cycle durations and
+// the number of skipped or overrun requests are collected for diagnostics.
+
+class ModbusUpdateCycle
+{
+    Q_GADGET
+public:
+    enum OverrunPolicy {
+        // Drop update requests while a cycle is still running
+        OverrunPolicySkip,
+        // Remember one update request while a cycle is running and start it right after
+        OverrunPolicyQueueOne,
+        // Skip like OverrunPolicySkip, and additionally space the cycles by the time the device
+        // actually needs for a cycle, so a slow device does not get polled back to back
+        OverrunPolicyStretch
+    };
+    Q_ENUM(OverrunPolicy)
+
+    enum Action {
+        ActionStart,
+        ActionSkip,
+        ActionQueue
+    };
+    Q_ENUM(Action)
+
+    explicit ModbusUpdateCycle();
+
+    OverrunPolicy overrunPolicy() const;
+    void setOverrunPolicy(OverrunPolicy overrunPolicy);
+
+    // Called for each update request, cycleRunning tells if replies of the last cycle are still pending
+    Action requestUpdate(bool cycleRunning);
+
+    void startCycle();
+    // Returns true if a queued update should be started now
+    bool finishCycle();
+    // Drop the running cycle and any queued update, i.e. after a reconnect
+    void abortCycle();
+
+    bool updateQueued() const;
+
+    uint cycleCount() const;
+    uint skippedCount() const;
+    uint overrunCount() const;
+
+    // Durations in ms
+    int lastDuration() const;
+    int averageDuration() const;
+    int maximumDuration() const;
+
+    // The measured interval between update requests in ms
+    int requestInterval() const;
+
+    // The minimum interval between two cycle starts in ms if stretching, otherwise 0
+    int stretchedInterval() const;
+
+private:
+    OverrunPolicy m_overrunPolicy = OverrunPolicySkip;
+
+    QElapsedTimer m_cycleTimer;
+    QElapsedTimer m_requestTimer;
+    bool m_cycleRunning = false;
+    bool m_updateQueued = false;
+
+    uint m_cycleCount = 0;
+    uint m_skippedCount = 0;
+    uint m_overrunCount = 0;
+
+    int m_lastDuration = 0;
+    int m_averageDuration = 0;
+    int m_maximumDuration = 0;
+    int m_requestInterval = 0;
+    int m_stretchedInterval = 0;
+
+    void updateStretchedInterval();
+};
+
+#endif // MODBUSUPDATECYCLE_H
@@ -65,9 +65,9 @@ def writePropertyGetSetMethodImplementationsRtu(fileDescriptor, className, regis
             writeLine(fileDescriptor, '    QVector<quint16> values = %s;' % getConversionToValueMethod(registerDefinition))
             writeLine(fileDescriptor, '    qCDebug(dc%s()) << "--> Write \\"%s\\" register:" << %s << "size:" << %s << values;' % (className, registerDefinition['description'], registerDefinition['address'], registerDefinition['size']))
             if registerDefinition['registerType'] == 'holdingRegister':
-                writeLine(fileDescriptor, '    return m_modbusRtuMaster->writeHoldingRegisters(m_slaveId, %s, values);' % (registerDefinition['address']))
+                writeLine(fileDescriptor, '    return m_modbusRtuScheduler->writeHoldingRegisters(m_slaveId, %s, values);' % (registerDefinition['address']))
             elif registerDefinition['registerType'] == 'coils':
-                writeLine(fileDescriptor, '    return m_modbusRtuMaster->writeCoils(m_slaveId, %s, values);' % (registerDefinition['address']))
+                writeLine(fileDescriptor, '    return m_modbusRtuScheduler->writeCoils(m_slaveId, %s, values);' % (registerDefinition['address']))
             else:
                 logger.warning('Error: invalid register type for writing.')
                 exit(1)
@@ -77,6 +77,43 @@ def writePropertyGetSetMethodImplementationsRtu(fileDescriptor, className, regis
 
 ##############################################################
 
+def writeBlockWriteMethodDeclarationsRtu(fileDescriptor, blockDefinitions):
+    for blockDefinition in blockDefinitions:
+        if not isBlockWritable(blockDefinition):
+            continue
+
+        blockName = blockDefinition['id']
+        writeBlockWriteMethodDescription(fileDescriptor, blockDefinition)
+        writeLine(fileDescriptor, '    ModbusRtuReply *set%sBlock(%s);' % (blockName[0].upper() + blockName[1:], getBlockWriteParameters(blockDefinition)))
+        writeLine(fileDescriptor)
+
+
+def writeBlockWriteMethodImplementationsRtu(fileDescriptor, className, blockDefinitions):
+    for blockDefinition in blockDefinitions:
+        if not isBlockWritable(blockDefinition):
+            continue
+
+        blockName = blockDefinition['id']
+        blockRegisters = blockDefinition['registers']
+        blockStartAddress = blockRegisters[0]['address']
+        blockSize = 0
+        for blockRegister in blockRegisters:
+            blockSize += blockRegister['size']
+
+        writeLine(fileDescriptor, 'ModbusRtuReply *%s::set%sBlock(%s)' % (className, blockName[0].upper() + blockName[1:], getBlockWriteParameters(blockDefinition)))
+        writeLine(fileDescriptor, '{')
+        writeBlockWriteValues(fileDescriptor, blockDefinition)
+        writeLine(fileDescriptor, '    qCDebug(dc%s()) << "--> Write block \\"%s\\" registers from:" << %s << "size:" << %s << values;' % (className, blockName, blockStartAddress, blockSize))
+        if blockRegisters[0]['registerType'] == 'coils':
+            writeLine(fileDescriptor, '    return m_modbusRtuScheduler->writeCoils(m_slaveId, %s, values);' % (blockStartAddress))
+        else:
+            writeLine(fileDescriptor, '    return m_modbusRtuScheduler->writeHoldingRegisters(m_slaveId, %s, values);' % (blockStartAddress))
+
+        writeLine(fileDescriptor, '}')
+        writeLine(fileDescriptor)
+
+##############################################################
+
 def writePropertyUpdateMethodImplementationsRtu(fileDescriptor, className, registerDefinitions):
     for registerDefinition in registerDefinitions:
         if not 'readSchedule' in registerDefinition or registerDefinition['readSchedule'] == 'init':
@@ -142,14 +179,14 @@ def writeBlockUpdateMethodImplementationsRtu(fileDescriptor, className, blockDef
 
         # Build request depending on the register type
         if registerType == 'inputRegister':
-            writeLine(fileDescriptor, '    ModbusRtuReply *reply = m_modbusRtuMaster->readInputRegister(m_slaveId, %s, %s);' % (blockStartAddress, blockSize))
+            writeLine(fileDescriptor, '    ModbusRtuReply *reply = m_modbusRtuScheduler->readInputRegister(m_slaveId, %s, %s);' % (blockStartAddress, blockSize))
         elif registerType == 'discreteInputs':
-            writeLine(fileDescriptor, '    ModbusRtuReply *reply = m_modbusRtuMaster->readDiscreteInput(m_slaveId, %s, %s);' % (blockStartAddress, blockSize))
+            writeLine(fileDescriptor, '    ModbusRtuReply *reply = m_modbusRtuScheduler->readDiscreteInput(m_slaveId, %s, %s);' % (blockStartAddress, blockSize))
         elif registerType == 'coils':
-            writeLine(fileDescriptor, '    ModbusRtuReply *reply = m_modbusRtuMaster->readCoil(m_slaveId, %s, %s);' % (blockStartAddress, blockSize))
+            writeLine(fileDescriptor, '    ModbusRtuReply *reply = m_modbusRtuScheduler->readCoil(m_slaveId, %s, %s);' % (blockStartAddress, blockSize))
         else:
             #Default to holdingRegister
-            writeLine(fileDescriptor, '    ModbusRtuReply *reply = m_modbusRtuMaster->readHoldingRegister(m_slaveId, %s, %s);' % (blockStartAddress, blockSize))
+            writeLine(fileDescriptor, '    ModbusRtuReply *reply = m_modbusRtuScheduler->readHoldingRegister(m_slaveId, %s, %s);' % (blockStartAddress, blockSize))
 
         writeLine(fileDescriptor, '    if (!reply) {')
         writeLine(fileDescriptor, '        qCWarning(dc%s()) << "Error occurred while reading block \\"%s\\" registers";' % (className, blockName))
@@ -200,14 +237,14 @@ def writeInternalPropertyReadMethodImplementationsRtu(fileDescriptor, className,
 
         # Build request depending on the register type
         if registerDefinition['registerType'] == 'inputRegister':
-            writeLine(fileDescriptor, '    return m_modbusRtuMaster->readInputRegister(m_slaveId, %s, %s);' % (registerDefinition['address'], registerDefinition['size']))
+            writeLine(fileDescriptor, '    return m_modbusRtuScheduler->readInputRegister(m_slaveId, %s, %s);' % (registerDefinition['address'], registerDefinition['size']))
         elif registerDefinition['registerType'] == 'discreteInputs':
-            writeLine(fileDescriptor, '    return m_modbusRtuMaster->readDiscreteInput(m_slaveId, %s, %s);' % (registerDefinition['address'], registerDefinition['size']))
+            writeLine(fileDescriptor, '    return m_modbusRtuScheduler->readDiscreteInput(m_slaveId, %s, %s);' % (registerDefinition['address'], registerDefinition['size']))
         elif registerDefinition['registerType'] == 'coils':
-            writeLine(fileDescriptor, '    return m_modbusRtuMaster->readCoil(m_slaveId, %s, %s);' % (registerDefinition['address'], registerDefinition['size']))
+            writeLine(fileDescriptor, '    return m_modbusRtuScheduler->readCoil(m_slaveId, %s, %s);' % (registerDefinition['address'], registerDefinition['size']))
         else:
             #Default to holdingRegister
-            writeLine(fileDescriptor, '    return m_modbusRtuMaster->readHoldingRegister(m_slaveId, %s, %s);' % (registerDefinition['address'], registerDefinition['size']))
+            writeLine(fileDescriptor, '    return m_modbusRtuScheduler->readHoldingRegister(m_slaveId, %s, %s);' % (registerDefinition['address'], registerDefinition['size']))
 
         writeLine(fileDescriptor, '}')
         writeLine(fileDescriptor)
@@ -265,14 +302,14 @@ def writeInternalBlockReadMethodImplementationsRtu(fileDescriptor, className, bl
 
         # Build request depending on the register type
         if registerType == 'inputRegister':
-            writeLine(fileDescriptor, '    return m_modbusRtuMaster->readInputRegister(m_slaveId, %s, %s);' % (blockStartAddress, blockSize))
+            writeLine(fileDescriptor, '    return m_modbusRtuScheduler->readInputRegister(m_slaveId, %s, %s);' % (blockStartAddress, blockSize))
         elif registerType == 'discreteInputs':
-            writeLine(fileDescriptor, '    return m_modbusRtuMaster->readDiscreteInput(m_slaveId, %s, %s);' % (blockStartAddress, blockSize))
+            writeLine(fileDescriptor, '    return m_modbusRtuScheduler->readDiscreteInput(m_slaveId, %s, %s);' % (blockStartAddress, blockSize))
         elif registerType == 'coils':
-            writeLine(fileDescriptor, '    return m_modbusRtuMaster->readCoil(m_slaveId, %s, %s);' % (blockStartAddress, blockSize))
+            writeLine(fileDescriptor, '    return m_modbusRtuScheduler->readCoil(m_slaveId, %s, %s);' % (blockStartAddress, blockSize))
         else:
             #Default to holdingRegister
-            writeLine(fileDescriptor, '    return m_modbusRtuMaster->readHoldingRegister(m_slaveId, %s, %s);' % (blockStartAddress, blockSize))
+            writeLine(fileDescriptor, '    return m_modbusRtuScheduler->readHoldingRegister(m_slaveId, %s, %s);' % (blockStartAddress, blockSize))
 
         writeLine(fileDescriptor, '}')
         writeLine(fileDescriptor)
@@ -495,11 +532,7 @@ def writeUpdateMethodRtu(fileDescriptor, className, registerDefinitions, blockDe
         writeLine(fileDescriptor, '        return false;')
         writeLine(fileDescriptor, '    }')
         writeLine(fileDescriptor)
-        writeLine(fileDescriptor, '    if (!m_pendingUpdateReplies.isEmpty()) {')
-        writeLine(fileDescriptor, '        qCDebug(dc%s()) << "Tried to update the registers but there are still some update replies pending. Waiting for them to be finished...";' % className)
-        writeLine(fileDescriptor, '        return true;')
-        writeLine(fileDescriptor, '    }')
-        writeLine(fileDescriptor)
+        writeUpdateCycleCheck(fileDescriptor, className)
 
         writeLine(fileDescriptor, '    // Hardware resource available but communication not working. ')
         writeLine(fileDescriptor, '    // Try to read the check reachability register to re-evaluatoe the communication... ')
@@ -509,6 +542,7 @@ def writeUpdateMethodRtu(fileDescriptor, className, registerDefinitions, blockDe
         writeLine(fileDescriptor, '    }')
         writeLine(fileDescriptor)
 
+        writeLine(fileDescriptor, '    m_updateCycle.startCycle();')
         writeLine(fileDescriptor, '    ModbusRtuReply *reply = nullptr;')
 
         # Read individual registers
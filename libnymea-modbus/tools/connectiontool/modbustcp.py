@@ -194,6 +194,102 @@ def writeBlockUpdateMethodImplementationsTcp(fileDescriptor, className, blockDef
 
 ##############################################################
 
+def writeBlockWriteMethodDeclarationsTcp(fileDescriptor, blockDefinitions):
+    for blockDefinition in blockDefinitions:
+        if not isBlockWritable(blockDefinition):
+            continue
+
+        blockName = blockDefinition['id']
+        blockRegisters = blockDefinition['registers']
+        writeBlockWriteMethodDescription(fileDescriptor, blockDefinition)
+        writeLine(fileDescriptor, '    QModbusReply *set%sBlock(%s);' % (blockName[0].upper() + blockName[1:], getBlockWriteParameters(blockDefinition)))
+
+        # Write and read back the block within one request (FC23), the read values will be processed like a block update
+        if isBlockReadable(blockDefinition) and blockRegisters[0]['registerType'] == 'holdingRegister':
+            writeLine(fileDescriptor, '    QModbusReply *setAndRead%sBlock(%s);' % (blockName[0].upper() + blockName[1:], getBlockWriteParameters(blockDefinition)))
+
+        writeLine(fileDescriptor)
+
+
+def writeBlockWriteMethodImplementationsTcp(fileDescriptor, className, blockDefinitions):
+    for blockDefinition in blockDefinitions:
+        if not isBlockWritable(blockDefinition):
+            continue
+
+        blockName = blockDefinition['id']
+        blockRegisters = blockDefinition['registers']
+        blockStartAddress = blockRegisters[0]['address']
+        blockSize = 0
+        for blockRegister in blockRegisters:
+            blockSize += blockRegister['size']
+
+        registerType = 'HoldingRegisters'
+        if blockRegisters[0]['registerType'] == 'coils':
+            registerType = 'Coils'
+
+        writeLine(fileDescriptor, 'QModbusReply *%s::set%sBlock(%s)' % (className, blockName[0].upper() + blockName[1:], getBlockWriteParameters(blockDefinition)))
+        writeLine(fileDescriptor, '{')
+        writeBlockWriteValues(fileDescriptor, blockDefinition)
+        writeLine(fileDescriptor, '    qCDebug(dc%s()) << "--> Write block \\"%s\\" registers from:" << %s << "size:" << %s << values;' % (className, blockName, blockStartAddress, blockSize))
+        writeLine(fileDescriptor, '    QModbusDataUnit request = QModbusDataUnit(QModbusDataUnit::RegisterType::%s, %s, values.count());' % (registerType, blockStartAddress))
+        writeLine(fileDescriptor, '    request.setValues(values);')
+        writeLine(fileDescriptor, '    return m_modbusTcpMaster->sendWriteRequest(request, m_slaveId);')
+        writeLine(fileDescriptor, '}')
+        writeLine(fileDescriptor)
+
+        if not (isBlockReadable(blockDefinition) and blockRegisters[0]['registerType'] == 'holdingRegister'):
+            continue
+
+        writeLine(fileDescriptor, 'QModbusReply *%s::setAndRead%sBlock(%s)' % (className, blockName[0].upper() + blockName[1:], getBlockWriteParameters(blockDefinition)))
+        writeLine(fileDescriptor, '{')
+        writeBlockWriteValues(fileDescriptor, blockDefinition)
+        writeLine(fileDescriptor, '    qCDebug(dc%s()) << "--> Write and read block \\"%s\\" registers from:" << %s << "size:" << %s << values;' % (className, blockName, blockStartAddress, blockSize))
+        writeLine(fileDescriptor, '    QModbusDataUnit writeRequest = QModbusDataUnit(QModbusDataUnit::RegisterType::HoldingRegisters, %s, values.count());' % (blockStartAddress))
+        writeLine(fileDescriptor, '    writeRequest.setValues(values);')
+        writeLine(fileDescriptor, '    QModbusDataUnit readRequest = QModbusDataUnit(QModbusDataUnit::RegisterType::HoldingRegisters, %s, %s);' % (blockStartAddress, blockSize))
+        writeLine(fileDescriptor, '    QModbusReply *reply = m_modbusTcpMaster->sendReadWriteRequest(readRequest, writeRequest, m_slaveId);')
+        writeLine(fileDescriptor, '    if (!reply || reply->isFinished())')
+        writeLine(fileDescriptor, '        return reply;')
+        writeLine(fileDescriptor)
+        writeLine(fileDescriptor, '    connect(reply, &QModbusReply::finished, this, [this, reply](){')
+        writeLine(fileDescriptor, '        handleModbusError(reply->error());')
+        writeLine(fileDescriptor, '        if (reply->error() != QModbusDevice::NoError)')
+        writeLine(fileDescriptor, '            return;')
+        writeLine(fileDescriptor)
+        writeLine(fileDescriptor, '        const QVector<quint16> blockValues = reply->result().values();')
+        writeLine(fileDescriptor, '        qCDebug(dc%s()) << "<-- Response from writing and reading block \\"%s\\" register" << %s << "size:" << %s << blockValues;' % (className, blockName, blockStartAddress, blockSize))
+        writeLine(fileDescriptor, '        if (blockValues.size() != %s) {' % (blockSize))
+        writeLine(fileDescriptor, '            qCWarning(dc%s()) << "Reading back from \\"%s\\" block registers" << %s << "size:" << %s << "returned different size than requested. Ignoring incomplete data" << blockValues;' % (className, blockName, blockStartAddress, blockSize))
+        writeLine(fileDescriptor, '            return;')
+        writeLine(fileDescriptor, '        }')
+        writeLine(fileDescriptor)
+        offset = 0
+        for blockRegister in blockRegisters:
+            propertyName = blockRegister['id']
+            writeLine(fileDescriptor, '        process%sRegisterValues(blockValues.mid(%s, %s));' % (propertyName[0].upper() + propertyName[1:], offset, blockRegister['size']))
+            offset += blockRegister['size']
+
+        writeLine(fileDescriptor, '    });')
+        writeLine(fileDescriptor)
+        writeLine(fileDescriptor, '    return reply;')
+        writeLine(fileDescriptor, '}')
+        writeLine(fileDescriptor)
+
+##############################################################
+
+def writeIoThreadGuardTcp(fileDescriptor, methodCall, returnValue = None):
+    # Connections can be moved into a ModbusIoThreadPool thread, all requests must be sent from there
+    writeLine(fileDescriptor, '    if (QThread::currentThread() != thread()) {')
+    writeLine(fileDescriptor, '        QMetaObject::invokeMethod(this, [this](){ %s; }, Qt::QueuedConnection);' % methodCall)
+    if returnValue:
+        writeLine(fileDescriptor, '        return %s;' % returnValue)
+    else:
+        writeLine(fileDescriptor, '        return;')
+    writeLine(fileDescriptor, '    }')
+    writeLine(fileDescriptor)
+
+##############################################################
+
 def writeInternalPropertyReadMethodDeclarationsTcp(fileDescriptor, registerDefinitions):
     for registerDefinition in registerDefinitions:
         propertyName = registerDefinition['id']
@@ -342,9 +438,105 @@ def writeTestReachabilityImplementationsTcp(fileDescriptor, className, registerD
 
 ##############################################################
 
-def writeInitMethodImplementationTcp(fileDescriptor, className, registerDefinitions, blockDefinitions):
+def writeInitCacheMethodDeclarationsTcp(fileDescriptor):
+    writeLine(fileDescriptor, '    // If enabled, initialize() only re-reads the identity register once the device has been initialized successfully.')
+    writeLine(fileDescriptor, '    // All other init register values are kept as long as the identity register still returns the same value.')
+    writeLine(fileDescriptor, '    bool initCacheEnabled() const;')
+    writeLine(fileDescriptor, '    void setInitCacheEnabled(bool initCacheEnabled);')
+    writeLine(fileDescriptor, '    void invalidateInitCache();')
+    writeLine(fileDescriptor)
+
+##############################################################
+
+def writeInitCacheMembersTcp(fileDescriptor):
+    writeLine(fileDescriptor, '    bool m_initCacheEnabled = true;')
+    writeLine(fileDescriptor, '    bool m_initCacheValid = false;')
+    writeLine(fileDescriptor, '    QVector<quint16> m_initCacheIdentity;')
+
+##############################################################
+
+def writeInitCacheMethodImplementationsTcp(fileDescriptor, className):
+    writeLine(fileDescriptor, 'bool %s::initCacheEnabled() const' % (className))
+    writeLine(fileDescriptor, '{')
+    writeLine(fileDescriptor, '    return m_initCacheEnabled;')
+    writeLine(fileDescriptor, '}')
+    writeLine(fileDescriptor)
+    writeLine(fileDescriptor, 'void %s::setInitCacheEnabled(bool initCacheEnabled)' % (className))
+    writeLine(fileDescriptor, '{')
+    writeLine(fileDescriptor, '    m_initCacheEnabled = initCacheEnabled;')
+    writeLine(fileDescriptor, '    if (!m_initCacheEnabled)')
+    writeLine(fileDescriptor, '        invalidateInitCache();')
+    writeLine(fileDescriptor, '}')
+    writeLine(fileDescriptor)
+    writeLine(fileDescriptor, 'void %s::invalidateInitCache()' % (className))
+    writeLine(fileDescriptor, '{')
+    writeLine(fileDescriptor, '    m_initCacheValid = false;')
+    writeLine(fileDescriptor, '    m_initCacheIdentity.clear();')
+    writeLine(fileDescriptor, '}')
+    writeLine(fileDescriptor)
+
+##############################################################
+
+def writeInitCacheValidationTcp(fileDescriptor, className, identityRegister):
+    propertyName = identityRegister['id']
+    writeLine(fileDescriptor)
+    writeLine(fileDescriptor, '    if (m_initCacheEnabled && m_initCacheValid) {')
+    writeLine(fileDescriptor, '        // Parent object for the init process')
+    writeLine(fileDescriptor, '        m_initObject = new QObject(this);')
+    writeLine(fileDescriptor)
+    writeLine(fileDescriptor, '        // Already initialized once, make sure this is still the same device before using the cached init values')
+    writeLine(fileDescriptor, '        qCDebug(dc%s()) << "--> Validate cached init values by reading \\"%s\\" register:" << %s << "size:" << %s;' % (className, identityRegister['description'], identityRegister['address'], identityRegister['size']))
+    writeLine(fileDescriptor, '        QModbusReply *reply = read%s();' % (propertyName[0].upper() + propertyName[1:]))
+    writeLine(fileDescriptor, '        if (!reply) {')
+    writeLine(fileDescriptor, '            qCWarning(dc%s()) << "Error occurred while reading \\"%s\\" registers from" << m_modbusTcpMaster->hostAddress().toString() << m_modbusTcpMaster->errorString();' % (className, identityRegister['description']))
+    writeLine(fileDescriptor, '            finishInitialization(false);')
+    writeLine(fileDescriptor, '            return false;')
+    writeLine(fileDescriptor, '        }')
+    writeLine(fileDescriptor)
+    writeLine(fileDescriptor, '        if (reply->isFinished()) {')
+    writeLine(fileDescriptor, '            reply->deleteLater(); // Broadcast reply returns immediatly')
+    writeLine(fileDescriptor, '            finishInitialization(false);')
+    writeLine(fileDescriptor, '            return false;')
+    writeLine(fileDescriptor, '        }')
+    writeLine(fileDescriptor)
+    writeLine(fileDescriptor, '        m_pendingInitReplies.append(reply);')
+    writeLine(fileDescriptor, '        connect(reply, &QModbusReply::finished, reply, &QModbusReply::deleteLater);')
+    writeLine(fileDescriptor, '        connect(reply, &QModbusReply::finished, m_initObject, [this, reply](){')
+    writeLine(fileDescriptor, '            handleModbusError(reply->error());')
+    writeLine(fileDescriptor, '            m_pendingInitReplies.removeAll(reply);')
+    writeLine(fileDescriptor, '            if (reply->error() != QModbusDevice::NoError) {')
+    writeLine(fileDescriptor, '                finishInitialization(false);')
+    writeLine(fileDescriptor, '                return;')
+    writeLine(fileDescriptor, '            }')
+    writeLine(fileDescriptor)
+    writeLine(fileDescriptor, '            const QModbusDataUnit unit = reply->result();')
+    writeLine(fileDescriptor, '            qCDebug(dc%s()) << "<-- Response from validating \\"%s\\" register" << %s << "size:" << %s << unit.values();' % (className, identityRegister['description'], identityRegister['address'], identityRegister['size']))
+    writeLine(fileDescriptor, '            if (unit.values() == m_initCacheIdentity) {')
+    writeLine(fileDescriptor, '                qCDebug(dc%s()) << "Device identity unchanged. Using the cached init register values.";' % (className))
+    writeLine(fileDescriptor, '                finishInitialization(true);')
+    writeLine(fileDescriptor, '                return;')
+    writeLine(fileDescriptor, '            }')
+    writeLine(fileDescriptor)
+    writeLine(fileDescriptor, '            qCDebug(dc%s()) << "Device identity changed. Reading all init registers again.";' % (className))
+    writeLine(fileDescriptor, '            invalidateInitCache();')
+    writeLine(fileDescriptor, '            delete m_initObject;')
+    writeLine(fileDescriptor, '            m_initObject = nullptr;')
+    writeLine(fileDescriptor, '            initialize();')
+    writeLine(fileDescriptor, '        });')
+    writeLine(fileDescriptor)
+    writeLine(fileDescriptor, '        connect(reply, &QModbusReply::errorOccurred, m_initObject, [this, reply] (QModbusDevice::Error error){')
+    writeLine(fileDescriptor, '            qCWarning(dc%s()) << "Modbus reply error occurred while validating the cached init values from" << m_modbusTcpMaster->hostAddress().toString() << error << reply->errorString();' % (className))
+    writeLine(fileDescriptor, '        });')
+    writeLine(fileDescriptor)
+    writeLine(fileDescriptor, '        return true;')
+    writeLine(fileDescriptor, '    }')
+
+##############################################################
+
+def writeInitMethodImplementationTcp(fileDescriptor, className, registerDefinitions, blockDefinitions, identityRegister = None):
     writeLine(fileDescriptor, 'bool %s::initialize()' % (className))
     writeLine(fileDescriptor, '{')
+    writeIoThreadGuardTcp(fileDescriptor, 'initialize()', 'true')
     writeLine(fileDescriptor, '    if (!m_reachable) {')
     writeLine(fileDescriptor, '        qCWarning(dc%s()) << "Tried to initialize but the device is not to be reachable.";' % className)
     writeLine(fileDescriptor, '        return false;')
@@ -368,6 +560,11 @@ def writeInitMethodImplementationTcp(fileDescriptor, className, registerDefiniti
         writeLine(fileDescriptor, '        qCWarning(dc%s()) << "Tried to initialize but the init process is already running.";' % className)
         writeLine(fileDescriptor, '        return false;')
         writeLine(fileDescriptor, '    }')
+        if identityRegister:
+            writeInitCacheValidationTcp(fileDescriptor, className, identityRegister)
+            writeLine(fileDescriptor)
+            writeLine(fileDescriptor, '    m_initCacheIdentity.clear();')
+
         writeLine(fileDescriptor)
         writeLine(fileDescriptor, '    // Parent object for the init process')
         writeLine(fileDescriptor, '    m_initObject = new QObject(this);')
@@ -409,6 +606,8 @@ def writeInitMethodImplementationTcp(fileDescriptor, className, registerDefiniti
                 writeLine(fileDescriptor, '        qCDebug(dc%s()) << "<-- Response from init \\"%s\\" register" << %s << "size:" << %s << unit.values();' % (className, registerDefinition['description'], registerDefinition['address'], registerDefinition['size']))
                 writeLine(fileDescriptor, '        if (unit.values().size() == %s) {' % (registerDefinition['size']))
                 writeLine(fileDescriptor, '            process%sRegisterValues(unit.values());' % (propertyName[0].upper() + propertyName[1:]))
+                if identityRegister and identityRegister['id'] == propertyName:
+                    writeLine(fileDescriptor, '            m_initCacheIdentity = unit.values();')
                 writeLine(fileDescriptor, '        } else {')
                 writeLine(fileDescriptor, '            qCWarning(dc%s()) << "Reading from \\"%s\\" registers" << %s << "size:" << %s << "returned different size than requested. Ignoring incomplete data" << unit.values();' % (className, registerDefinition['description'], registerDefinition['address'], registerDefinition['size']))
                 writeLine(fileDescriptor, '        }')
@@ -479,6 +678,9 @@ def writeInitMethodImplementationTcp(fileDescriptor, className, registerDefiniti
                     propertyName = blockRegister['id']
                     propertyTyp = getCppDataType(blockRegister)
                     writeLine(fileDescriptor, '            process%sRegisterValues(blockValues.mid(%s, %s));' % (propertyName[0].upper() + propertyName[1:], offset, blockRegister['size']))
+                    if identityRegister and identityRegister['id'] == propertyName:
+                        writeLine(fileDescriptor, '            m_initCacheIdentity = blockValues.mid(%s, %s);' % (offset, blockRegister['size']))
+
                     offset += blockRegister['size']
 
                 writeLine(fileDescriptor, '        } else {')
@@ -509,6 +711,7 @@ def writeInitMethodImplementationTcp(fileDescriptor, className, registerDefiniti
 def writeUpdateMethodTcp(fileDescriptor, className, registerDefinitions, blockDefinitions):
     writeLine(fileDescriptor, 'bool %s::update()' % (className))
     writeLine(fileDescriptor, '{')
+    writeIoThreadGuardTcp(fileDescriptor, 'update()', 'true')
 
     # First check if there are any init registers
     updateRequired = False
@@ -526,11 +729,8 @@ def writeUpdateMethodTcp(fileDescriptor, className, registerDefinitions, blockDe
         writeLine(fileDescriptor, '    if (!m_modbusTcpMaster->connected())')
         writeLine(fileDescriptor, '        return false;')
         writeLine(fileDescriptor)
-        writeLine(fileDescriptor, '    if (!m_pendingUpdateReplies.isEmpty()) {')
-        writeLine(fileDescriptor, '        qCDebug(dc%s()) << "Tried to update but there are still some update replies pending. Waiting for them to be finished...";' % className)
-        writeLine(fileDescriptor, '        return true;')
-        writeLine(fileDescriptor, '    }')
-        writeLine(fileDescriptor)
+        writeUpdateCycleCheck(fileDescriptor, className)
+        writeLine(fileDescriptor, '    m_updateCycle.startCycle();')
         writeLine(fileDescriptor, '    QModbusReply *reply = nullptr;')
 
         # Read individual registers
@@ -384,7 +384,12 @@ def validateBlocks(blockDefinitions):
                     logger.warning('Error: block %s has invalid register order in register %s. There seems to be a gap between the registers.' % (blockName, blockRegister['id']))
                     exit(1)
 
-                if blockRegister['access'] != registerAccess:
+                # Write blocks without read schedule may combine RW and WO registers
+                accessMismatch = blockRegister['access'] != registerAccess
+                if accessMismatch and not 'readSchedule' in blockDefinition and 'W' in blockRegister['access'] and 'W' in registerAccess:
+                    accessMismatch = False
+
+                if accessMismatch:
                     logger.warning('Error: block %s has inconsistent register access in register %s. The block registers dont seem to have the same access rights.' % (blockName, blockRegister['id']))
                     exit(1)
 
@@ -425,6 +430,78 @@ def writeBlocksUpdateMethodDeclarations(fileDescriptor, blockDefinitions):
         writeLine(fileDescriptor)
 
 
+def isBlockWritable(blockDefinition):
+    # Block registers share the same register type, see validateBlocks()
+    blockRegisters = blockDefinition['registers']
+    for blockRegister in blockRegisters:
+        if not 'W' in blockRegister['access']:
+            return False
+
+    return blockRegisters[0]['registerType'] in ['holdingRegister', 'coils']
+
+
+def isBlockReadable(blockDefinition):
+    for blockRegister in blockDefinition['registers']:
+        if not 'R' in blockRegister['access']:
+            return False
+
+    return True
+
+
+def getIndividuallyScheduledRegisters(registerJson):
+    # Registers of blocks without read schedule get read one by one using their own read schedule
+    registerDefinitions = list(registerJson['registers'])
+    if not 'blocks' in registerJson:
+        return registerDefinitions
+
+    for blockDefinition in registerJson['blocks']:
+        if 'readSchedule' in blockDefinition:
+            continue
+
+        for blockRegister in blockDefinition['registers']:
+            if 'readSchedule' in blockRegister and 'R' in blockRegister['access']:
+                registerDefinitions.append(blockRegister)
+
+    return registerDefinitions
+
+
+def getBlockWriteParameters(blockDefinition):
+    parameters = []
+    for blockRegister in blockDefinition['registers']:
+        propertyTyp = getCppDataType(blockRegister)
+        if propertyTyp == 'QString':
+            parameters.append('const QString &%s' % blockRegister['id'])
+        else:
+            parameters.append('%s %s' % (propertyTyp, blockRegister['id']))
+
+    return ', '.join(parameters)
+
+
+def writeBlockWriteMethodDescription(fileDescriptor, blockDefinition):
+    blockRegisters = blockDefinition['registers']
+    blockSize = 0
+    for blockRegister in blockRegisters:
+        blockSize += blockRegister['size']
+
+    writeLine(fileDescriptor, '    /* Write block to start addess %s with size of %s registers containing following %s properties:' % (blockRegisters[0]['address'], blockSize, len(blockRegisters)))
+    for registerDefinition in blockRegisters:
+        if 'unit' in registerDefinition and registerDefinition['unit'] != '':
+            writeLine(fileDescriptor, '      - %s [%s] - Address: %s, Size: %s' % (registerDefinition['description'], registerDefinition['unit'], registerDefinition['address'], registerDefinition['size']))
+        else:
+            writeLine(fileDescriptor, '      - %s - Address: %s, Size: %s' % (registerDefinition['description'], registerDefinition['address'], registerDefinition['size']))
+    writeLine(fileDescriptor, '    */' )
+
+
+def writeBlockWriteValues(fileDescriptor, blockDefinition):
+    # Convert all properties into one register vector in order to write the block with a single request
+    writeLine(fileDescriptor, '    QVector<quint16> values;')
+    for blockRegister in blockDefinition['registers']:
+        if blockRegister['type'] == 'string':
+            writeLine(fileDescriptor, '    values << ModbusDataUtils::convertFromString(%s, %s, m_stringEndianness);' % (blockRegister['id'], blockRegister['size']))
+        else:
+            writeLine(fileDescriptor, '    values << %s;' % getConversionToValueMethod(blockRegister))
+
+
 def writeRegistersDebugLine(fileDescriptor, debugObjectParamName, registerDefinitions):
     for registerDefinition in registerDefinitions:
         if not 'R' in registerDefinition['access']:
@@ -490,6 +567,7 @@ def writePropertyProcessMethodImplementations(fileDescriptor, className, registe
         writeLine(fileDescriptor, 'void %s::process%sRegisterValues(const QVector<quint16> &values)' % (className, propertyName[0].upper() + propertyName[1:]))
         writeLine(fileDescriptor, '{')
         writeLine(fileDescriptor, '    %s received%s = %s;' % (propertyTyp, propertyName[0].upper() + propertyName[1:], getValueConversionMethod(registerDefinition)))
+        writeLine(fileDescriptor, '    m_valueTimestamps.insert(QStringLiteral("%s"), QDateTime::currentMSecsSinceEpoch());' % (propertyName))
         writeLine(fileDescriptor, '    emit %sReadFinished(received%s);' % (propertyName, propertyName[0].upper() + propertyName[1:]))
         writeLine(fileDescriptor)
         writeLine(fileDescriptor, '    if (m_%s != received%s) {' % (propertyName, propertyName[0].upper() + propertyName[1:]))
@@ -498,3 +576,110 @@ def writePropertyProcessMethodImplementations(fileDescriptor, className, registe
         writeLine(fileDescriptor, '    }')
         writeLine(fileDescriptor, '}')
         writeLine(fileDescriptor)
+
+
+def writeUpdateCycleMethodDeclarations(fileDescriptor):
+    writeLine(fileDescriptor, '    ModbusUpdateCycle::OverrunPolicy updateOverrunPolicy() const;')
+    writeLine(fileDescriptor, '    void setUpdateOverrunPolicy(ModbusUpdateCycle::OverrunPolicy updateOverrunPolicy);')
+    writeLine(fileDescriptor)
+    writeLine(fileDescriptor, '    // Duration and overrun statistics of the update cycles')
+    writeLine(fileDescriptor, '    ModbusUpdateCycle updateCycle() const;')
+    writeLine(fileDescriptor)
+    # Register addresses are not unique across register types, so the ages are accessed by register id
+    writeLine(fileDescriptor, '    // Time in ms since the value of the register with the given id has been received, -1 if it was never received')
+    writeLine(fileDescriptor, '    qint64 valueAge(const QString &registerId) const;')
+    writeLine(fileDescriptor)
+
+
+def writeSnapshotMethodDeclarations(fileDescriptor):
+    writeLine(fileDescriptor, '    // Values of all readable registers by register id. Once an update cycle finished, the snapshot')
+    writeLine(fileDescriptor, '    // gets emitted using snapshotUpdated() if connected, which is one signal instead of one per register.')
+    writeLine(fileDescriptor, '    QVariantMap snapshot() const;')
+    writeLine(fileDescriptor)
+
+
+def writeSnapshotMethodImplementation(fileDescriptor, className, registerJson):
+    registerDefinitions = list(registerJson['registers'])
+    if 'blocks' in registerJson:
+        for blockDefinition in registerJson['blocks']:
+            registerDefinitions += blockDefinition['registers']
+
+    writeLine(fileDescriptor, 'QVariantMap %s::snapshot() const' % (className))
+    writeLine(fileDescriptor, '{')
+    writeLine(fileDescriptor, '    QVariantMap snapshot;')
+    for registerDefinition in registerDefinitions:
+        if not 'R' in registerDefinition['access']:
+            continue
+
+        writeLine(fileDescriptor, '    snapshot.insert(QStringLiteral("%s"), QVariant::fromValue(m_%s));' % (registerDefinition['id'], registerDefinition['id']))
+
+    writeLine(fileDescriptor, '    return snapshot;')
+    writeLine(fileDescriptor, '}')
+    writeLine(fileDescriptor)
+
+
+def writeUpdateCycleMembers(fileDescriptor):
+    writeLine(fileDescriptor, '    ModbusUpdateCycle m_updateCycle;')
+    writeLine(fileDescriptor, '    QHash<QString, qint64> m_valueTimestamps;')
+
+
+def writeUpdateCycleMethodImplementations(fileDescriptor, className):
+    writeLine(fileDescriptor, 'ModbusUpdateCycle::OverrunPolicy %s::updateOverrunPolicy() const' % (className))
+    writeLine(fileDescriptor, '{')
+    writeLine(fileDescriptor, '    return m_updateCycle.overrunPolicy();')
+    writeLine(fileDescriptor, '}')
+    writeLine(fileDescriptor)
+
+    writeLine(fileDescriptor, 'void %s::setUpdateOverrunPolicy(ModbusUpdateCycle::OverrunPolicy updateOverrunPolicy)' % (className))
+    writeLine(fileDescriptor, '{')
+    writeLine(fileDescriptor, '    m_updateCycle.setOverrunPolicy(updateOverrunPolicy);')
+    writeLine(fileDescriptor, '}')
+    writeLine(fileDescriptor)
+
+    writeLine(fileDescriptor, 'ModbusUpdateCycle %s::updateCycle() const' % (className))
+    writeLine(fileDescriptor, '{')
+    writeLine(fileDescriptor, '    return m_updateCycle;')
+    writeLine(fileDescriptor, '}')
+    writeLine(fileDescriptor)
+
+    writeLine(fileDescriptor, 'qint64 %s::valueAge(const QString &registerId) const' % (className))
+    writeLine(fileDescriptor, '{')
+    writeLine(fileDescriptor, '    if (!m_valueTimestamps.contains(registerId))')
+    writeLine(fileDescriptor, '        return -1;')
+    writeLine(fileDescriptor)
+    writeLine(fileDescriptor, '    return QDateTime::currentMSecsSinceEpoch() - m_valueTimestamps.value(registerId);')
+    writeLine(fileDescriptor, '}')
+    writeLine(fileDescriptor)
+
+
+def writeUpdateCycleCheck(fileDescriptor, className):
+    writeLine(fileDescriptor, '    switch (m_updateCycle.requestUpdate(!m_pendingUpdateReplies.isEmpty())) {')
+    writeLine(fileDescriptor, '    case ModbusUpdateCycle::ActionSkip:')
+    writeLine(fileDescriptor, '        qCDebug(dc%s()) << "Skipping update request. Update replies pending:" << m_pendingUpdateReplies.count() << "Skipped:" << m_updateCycle.skippedCount() << "Average cycle duration:" << m_updateCycle.averageDuration() << "ms" << "Stretched interval:" << m_updateCycle.stretchedInterval() << "ms";' % className)
+    writeLine(fileDescriptor, '        return true;')
+    writeLine(fileDescriptor, '    case ModbusUpdateCycle::ActionQueue:')
+    writeLine(fileDescriptor, '        qCDebug(dc%s()) << "Tried to update but there are still some update replies pending. Starting the update once they are finished...";' % className)
+    writeLine(fileDescriptor, '        return true;')
+    writeLine(fileDescriptor, '    case ModbusUpdateCycle::ActionStart:')
+    writeLine(fileDescriptor, '        break;')
+    writeLine(fileDescriptor, '    }')
+    writeLine(fileDescriptor)
+
+
+def writeVerifyUpdateFinishedImplementation(fileDescriptor, className):
+    writeLine(fileDescriptor, 'void %s::verifyUpdateFinished()' % (className))
+    writeLine(fileDescriptor, '{')
+    writeLine(fileDescriptor, '    if (m_pendingUpdateReplies.isEmpty()) {')
+    writeLine(fileDescriptor, '        bool updateQueued = m_updateCycle.finishCycle();')
+    writeLine(fileDescriptor, '        qCDebug(dc%s()) << "Update cycle finished in" << m_updateCycle.lastDuration() << "ms";' % className)
+    writeLine(fileDescriptor, '        emit updateFinished();')
+    writeLine(fileDescriptor)
+    writeLine(fileDescriptor, '        if (isSignalConnected(QMetaMethod::fromSignal(&%s::snapshotUpdated)))' % className)
+    writeLine(fileDescriptor, '            emit snapshotUpdated(snapshot());')
+    writeLine(fileDescriptor)
+    writeLine(fileDescriptor, '        if (updateQueued) {')
+    writeLine(fileDescriptor, '            QTimer::singleShot(0, this, [this](){ update(); });')
+    writeLine(fileDescriptor, '        }')
+    writeLine(fileDescriptor, '    }')
+    writeLine(fileDescriptor, '}')
+    writeLine(fileDescriptor)
@@ -40,10 +40,13 @@ def writeTcpHeaderFile():
     writeLine(headerFile, '#ifndef %s_H' % className.upper())
     writeLine(headerFile, '#define %s_H' % className.upper())
     writeLine(headerFile)
+    writeLine(headerFile, '#include <QHash>')
     writeLine(headerFile, '#include <QObject>')
+    writeLine(headerFile, '#include <QVariantMap>')
     writeLine(headerFile)
     writeLine(headerFile, '#include <modbusdatautils.h>')
     writeLine(headerFile, '#include <modbustcpmaster.h>')
+    writeLine(headerFile, '#include <modbusupdatecycle.h>')
     writeLine(headerFile)
 
     # Begin of class
@@ -78,9 +81,20 @@ def writeTcpHeaderFile():
     writeLine(headerFile, '    ModbusDataUtils::ByteOrder stringEndianness() const;')
     writeLine(headerFile, '    void setStringEndianness(ModbusDataUtils::ByteOrder stringEndianness);')
     writeLine(headerFile)
+    writeUpdateCycleMethodDeclarations(headerFile)
+    writeSnapshotMethodDeclarations(headerFile)
     writeLine(headerFile, '    uint checkReachableRetries() const;')
     writeLine(headerFile, '    void setCheckReachableRetries(uint checkReachableRetries);')
     writeLine(headerFile)
+    writeLine(headerFile, '    // Retry delay in ms after the first failed reachability check, doubled on each further retry up to checkReachableRetryIntervalMax')
+    writeLine(headerFile, '    uint checkReachableRetryInterval() const;')
+    writeLine(headerFile, '    void setCheckReachableRetryInterval(uint checkReachableRetryInterval);')
+    writeLine(headerFile)
+    writeLine(headerFile, '    uint checkReachableRetryIntervalMax() const;')
+    writeLine(headerFile, '    void setCheckReachableRetryIntervalMax(uint checkReachableRetryIntervalMax);')
+    writeLine(headerFile)
+    if identityRegister:
+        writeInitCacheMethodDeclarationsTcp(headerFile)
 
     # Write registers get method declarations
     writePropertyGetSetMethodDeclarationsTcp(headerFile, registerJson['registers'])
@@ -90,6 +104,7 @@ def writeTcpHeaderFile():
 
         # Write block get/set method declarations
         writeBlocksUpdateMethodDeclarations(headerFile, registerJson['blocks'])
+        writeBlockWriteMethodDeclarationsTcp(headerFile, registerJson['blocks'])
 
     writePropertyUpdateMethodDeclarations(headerFile, registerJson['registers'])
     writeLine(headerFile)
@@ -128,6 +143,7 @@ def writeTcpHeaderFile():
     writeLine(headerFile)
     writeLine(headerFile, '    void initializationFinished(bool success);')
     writeLine(headerFile, '    void updateFinished();')
+    writeLine(headerFile, '    void snapshotUpdated(const QVariantMap &snapshot);')
     writeLine(headerFile)
     writeLine(headerFile, '    void endiannessChanged(ModbusDataUtils::ByteOrder endianness);')
     writeLine(headerFile, '    void stringEndiannessChanged(ModbusDataUtils::ByteOrder stringEndianness);')
@@ -170,13 +186,20 @@ def writeTcpHeaderFile():
     writeLine(headerFile, '    QModbusReply *m_checkRechableReply = nullptr;')
     writeLine(headerFile, '    uint m_checkReachableRetries = 0;')
     writeLine(headerFile, '    uint m_checkReachableRetriesCount = 0;')
+    writeLine(headerFile, '    uint m_checkReachableRetryInterval = 250;')
+    writeLine(headerFile, '    uint m_checkReachableRetryIntervalMax = 4000;')
     writeLine(headerFile, '    bool m_communicationWorking = false;')
     writeLine(headerFile, '    quint8 m_communicationFailedMax = %s;' % (errorLimitUntilNotReachable))
     writeLine(headerFile, '    quint8 m_communicationFailedCounter = 0;')
     writeLine(headerFile)
     writeLine(headerFile, '    QVector<QModbusReply *> m_pendingInitReplies;')
     writeLine(headerFile, '    QVector<QModbusReply *> m_pendingUpdateReplies;')
+    writeUpdateCycleMembers(headerFile)
     writeLine(headerFile)
+    if identityRegister:
+        writeInitCacheMembersTcp(headerFile)
+        writeLine(headerFile)
+
     writeLine(headerFile, '    QObject *m_initObject = nullptr;')
     writeLine(headerFile, '    void verifyInitFinished();')
     writeLine(headerFile, '    void finishInitialization(bool success);')
@@ -208,6 +231,9 @@ def writeTcpSourceFile():
     writeLine(sourceFile, '#include <loggingcategories.h>')
     writeLine(sourceFile, '#include <math.h>')
     writeLine(sourceFile, '#include <QTimer>')
+    writeLine(sourceFile, '#include <QThread>')
+    writeLine(sourceFile, '#include <QDateTime>')
+    writeLine(sourceFile, '#include <QMetaMethod>')
     writeLine(sourceFile, '#include <QModbusDevice>')
     writeLine(sourceFile, '#include <QModbusResponse>')
     writeLine(sourceFile)
@@ -267,6 +293,33 @@ def writeTcpSourceFile():
     writeLine(sourceFile, '}')
     writeLine(sourceFile)
 
+    writeLine(sourceFile, 'uint %s::checkReachableRetryInterval() const' % (className))
+    writeLine(sourceFile, '{')
+    writeLine(sourceFile, '    return m_checkReachableRetryInterval;')
+    writeLine(sourceFile, '}')
+    writeLine(sourceFile)
+
+    writeLine(sourceFile, 'void %s::setCheckReachableRetryInterval(uint checkReachableRetryInterval)' % (className))
+    writeLine(sourceFile, '{')
+    writeLine(sourceFile, '    m_checkReachableRetryInterval = checkReachableRetryInterval;')
+    writeLine(sourceFile, '}')
+    writeLine(sourceFile)
+
+    writeLine(sourceFile, 'uint %s::checkReachableRetryIntervalMax() const' % (className))
+    writeLine(sourceFile, '{')
+    writeLine(sourceFile, '    return m_checkReachableRetryIntervalMax;')
+    writeLine(sourceFile, '}')
+    writeLine(sourceFile)
+
+    writeLine(sourceFile, 'void %s::setCheckReachableRetryIntervalMax(uint checkReachableRetryIntervalMax)' % (className))
+    writeLine(sourceFile, '{')
+    writeLine(sourceFile, '    m_checkReachableRetryIntervalMax = checkReachableRetryIntervalMax;')
+    writeLine(sourceFile, '}')
+    writeLine(sourceFile)
+
+    if identityRegister:
+        writeInitCacheMethodImplementationsTcp(sourceFile, className)
+
     writeLine(sourceFile, 'ModbusDataUtils::ByteOrder %s::endianness() const' % (className))
     writeLine(sourceFile, '{')
     writeLine(sourceFile, '    return m_endianness;')
@@ -299,6 +352,9 @@ def writeTcpSourceFile():
     writeLine(sourceFile, '}')
     writeLine(sourceFile)
 
+    writeUpdateCycleMethodImplementations(sourceFile, className)
+    writeSnapshotMethodImplementation(sourceFile, className, registerJson)
+
     # Property get methods
     writePropertyGetSetMethodImplementationsTcp(sourceFile, className, registerJson['registers'])
     if 'blocks' in registerJson:
@@ -310,23 +366,26 @@ def writeTcpSourceFile():
     if 'blocks' in registerJson:
         blocks = registerJson['blocks']
 
-    writeInitMethodImplementationTcp(sourceFile, className, registerJson['registers'], blocks)
-    writeUpdateMethodTcp(sourceFile, className, registerJson['registers'], blocks)
+    writeInitMethodImplementationTcp(sourceFile, className, getIndividuallyScheduledRegisters(registerJson), blocks, identityRegister)
+    writeUpdateMethodTcp(sourceFile, className, getIndividuallyScheduledRegisters(registerJson), blocks)
 
     writeLine(sourceFile, 'bool %s::connectDevice()' % (className))
     writeLine(sourceFile, '{')
+    writeIoThreadGuardTcp(sourceFile, 'connectDevice()', 'true')
     writeLine(sourceFile, '    return m_modbusTcpMaster->connectDevice();')
     writeLine(sourceFile, '}')
     writeLine(sourceFile)
 
     writeLine(sourceFile, 'void %s::disconnectDevice()' % (className))
     writeLine(sourceFile, '{')
+    writeIoThreadGuardTcp(sourceFile, 'disconnectDevice()')
     writeLine(sourceFile, '    m_modbusTcpMaster->disconnectDevice();')
     writeLine(sourceFile, '}')
     writeLine(sourceFile)
 
     writeLine(sourceFile, 'bool %s::reconnectDevice()' % (className))
     writeLine(sourceFile, '{')
+    writeIoThreadGuardTcp(sourceFile, 'reconnectDevice()', 'true')
     writeLine(sourceFile, '    return m_modbusTcpMaster->reconnectDevice();')
     writeLine(sourceFile, '}')
     writeLine(sourceFile)
@@ -339,6 +398,7 @@ def writeTcpSourceFile():
 
         # Write block update method
         writeBlockUpdateMethodImplementationsTcp(sourceFile, className, registerJson['blocks'])
+        writeBlockWriteMethodImplementationsTcp(sourceFile, className, registerJson['blocks'])
 
     # Write internal protected property read method implementations
     writeInternalPropertyReadMethodImplementationsTcp(sourceFile, className, registerJson['registers'])
@@ -398,6 +458,11 @@ def writeTcpSourceFile():
     writeLine(sourceFile, '    m_initObject = nullptr;')
     writeLine(sourceFile, '    m_pendingInitReplies.clear();')
     writeLine(sourceFile)
+    if identityRegister:
+        writeLine(sourceFile, '    // Keep the init register values for validating them with a single read on the next reconnect')
+        writeLine(sourceFile, '    m_initCacheValid = success && !m_initCacheIdentity.isEmpty();')
+        writeLine(sourceFile)
+
     writeLine(sourceFile, '    emit initializationFinished(success);')
     writeLine(sourceFile, '}')
     writeLine(sourceFile)
@@ -410,6 +475,7 @@ def writeTcpSourceFile():
     writeLine(sourceFile, '            // Cleanup before starting to initialize')
     writeLine(sourceFile, '            m_pendingInitReplies.clear();')
     writeLine(sourceFile, '            m_pendingUpdateReplies.clear();')
+    writeLine(sourceFile, '            m_updateCycle.abortCycle();')
     writeLine(sourceFile, '            m_communicationWorking = false;')
     writeLine(sourceFile, '            m_communicationFailedCounter = 0;')
     writeLine(sourceFile, '            m_checkReachableRetriesCount = 0;')
@@ -426,21 +492,21 @@ def writeTcpSourceFile():
     writeLine(sourceFile, '}')
     writeLine(sourceFile)
 
-    writeLine(sourceFile, 'void %s::verifyUpdateFinished()' % (className))
-    writeLine(sourceFile, '{')
-    writeLine(sourceFile, '    if (m_pendingUpdateReplies.isEmpty()) {')
-    writeLine(sourceFile, '        emit updateFinished();')
-    writeLine(sourceFile, '    }')
-    writeLine(sourceFile, '}')
-    writeLine(sourceFile)
+    writeVerifyUpdateFinishedImplementation(sourceFile, className)
 
     writeLine(sourceFile, 'void %s::onReachabilityCheckFailed()' % (className))
     writeLine(sourceFile, '{')
     writeLine(sourceFile, '    m_checkReachableRetriesCount++;')
     writeLine(sourceFile)
     writeLine(sourceFile, '    if (m_checkReachableRetriesCount <= m_checkReachableRetries) {')
-    writeLine(sourceFile, '        qCDebug(dc%s()) << "Reachability test failed. Retry in on second" << m_checkReachableRetriesCount << "/" << m_checkReachableRetries;' % (className))
-    writeLine(sourceFile, '        QTimer::singleShot(1000, this, &%s::testReachability);' % (className))
+    writeLine(sourceFile, '        // Start with a short delay, devices which just reconnected often need only a moment')
+    writeLine(sourceFile, '        uint retryInterval = m_checkReachableRetryInterval;')
+    writeLine(sourceFile, '        for (uint i = 1; i < m_checkReachableRetriesCount && retryInterval < m_checkReachableRetryIntervalMax; i++)')
+    writeLine(sourceFile, '            retryInterval *= 2;')
+    writeLine(sourceFile)
+    writeLine(sourceFile, '        retryInterval = qMin(retryInterval, m_checkReachableRetryIntervalMax);')
+    writeLine(sourceFile, '        qCDebug(dc%s()) << "Reachability test failed. Retry in" << retryInterval << "ms" << m_checkReachableRetriesCount << "/" << m_checkReachableRetries;' % (className))
+    writeLine(sourceFile, '        QTimer::singleShot(retryInterval, this, &%s::testReachability);' % (className))
     writeLine(sourceFile, '        return;')
     writeLine(sourceFile, '    }')
     writeLine(sourceFile)
@@ -489,9 +555,13 @@ def writeRtuHeaderFile():
     writeLine(headerFile, '#ifndef %s_H' % className.upper())
     writeLine(headerFile, '#define %s_H' % className.upper())
     writeLine(headerFile)
+    writeLine(headerFile, '#include <QHash>')
     writeLine(headerFile, '#include <QObject>')
+    writeLine(headerFile, '#include <QVariantMap>')
     writeLine(headerFile)
     writeLine(headerFile, '#include <modbusdatautils.h>')
+    writeLine(headerFile, '#include <modbusrtuscheduler.h>')
+    writeLine(headerFile, '#include <modbusupdatecycle.h>')
     writeLine(headerFile, '#include <hardware/modbus/modbusrtumaster.h>')
 
     writeLine(headerFile)
@@ -530,6 +600,8 @@ def writeRtuHeaderFile():
     writeLine(headerFile, '    ModbusDataUtils::ByteOrder stringEndianness() const;')
     writeLine(headerFile, '    void setStringEndianness(ModbusDataUtils::ByteOrder stringEndianness);')
     writeLine(headerFile)
+    writeUpdateCycleMethodDeclarations(headerFile)
+    writeSnapshotMethodDeclarations(headerFile)
 
     # Write registers get method declarations
     writePropertyGetSetMethodDeclarationsRtu(headerFile, registerJson['registers'])
@@ -539,6 +611,7 @@ def writeRtuHeaderFile():
 
         # Write block get/set method declarations
         writeBlocksUpdateMethodDeclarations(headerFile, registerJson['blocks'])
+        writeBlockWriteMethodDeclarationsRtu(headerFile, registerJson['blocks'])
 
     writePropertyUpdateMethodDeclarations(headerFile, registerJson['registers'])
     writeLine(headerFile)
@@ -569,6 +642,7 @@ def writeRtuHeaderFile():
     writeLine(headerFile)
     writeLine(headerFile, '    void initializationFinished(bool success);')
     writeLine(headerFile, '    void updateFinished();')
+    writeLine(headerFile, '    void snapshotUpdated(const QVariantMap &snapshot);')
     writeLine(headerFile)
     writeLine(headerFile, '    void endiannessChanged(ModbusDataUtils::ByteOrder endianness);')
     writeLine(headerFile, '    void stringEndiannessChanged(ModbusDataUtils::ByteOrder stringEndianness);')
@@ -603,6 +677,7 @@ def writeRtuHeaderFile():
     # Private members
     writeLine(headerFile, 'private:')
     writeLine(headerFile, '    ModbusRtuMaster *m_modbusRtuMaster = nullptr;')
+    writeLine(headerFile, '    ModbusRtuScheduler *m_modbusRtuScheduler = nullptr;')
     writeLine(headerFile, '    ModbusDataUtils::ByteOrder m_endianness = ModbusDataUtils::ByteOrder%s;' % endianness)
     writeLine(headerFile, '    ModbusDataUtils::ByteOrder m_stringEndianness = ModbusDataUtils::ByteOrder%s;' % stringEndianness)
     writeLine(headerFile, '    quint16 m_slaveId = 1;')
@@ -617,6 +692,7 @@ def writeRtuHeaderFile():
     writeLine(headerFile)
     writeLine(headerFile, '    QVector<ModbusRtuReply *> m_pendingInitReplies;')
     writeLine(headerFile, '    QVector<ModbusRtuReply *> m_pendingUpdateReplies;')
+    writeUpdateCycleMembers(headerFile)
     writeLine(headerFile)
     writeLine(headerFile, '    QObject *m_initObject = nullptr;')
     writeLine(headerFile, '    void verifyInitFinished();')
@@ -648,6 +724,8 @@ def writeRtuSourceFile():
     writeLine(sourceFile, '#include <loggingcategories.h>')
     writeLine(sourceFile, '#include <math.h>')
     writeLine(sourceFile, '#include <QTimer>')
+    writeLine(sourceFile, '#include <QDateTime>')
+    writeLine(sourceFile, '#include <QMetaMethod>')
     writeLine(sourceFile)
     writeLine(sourceFile, 'NYMEA_LOGGING_CATEGORY(dc%s, "%s")' % (className, className))
     writeLine(sourceFile)
@@ -658,11 +736,15 @@ def writeRtuSourceFile():
     writeLine(sourceFile, '    m_modbusRtuMaster(modbusRtuMaster),')
     writeLine(sourceFile, '    m_slaveId(slaveId)')
     writeLine(sourceFile, '{')
+    writeLine(sourceFile, '    // All connections on this bus share the same scheduler')
+    writeLine(sourceFile, '    m_modbusRtuScheduler = ModbusRtuScheduler::scheduler(m_modbusRtuMaster);')
+    writeLine(sourceFile)
     writeLine(sourceFile, '    connect(m_modbusRtuMaster, &ModbusRtuMaster::connectedChanged, this, [=](bool connected){')
     writeLine(sourceFile, '        if (connected) {')
     writeLine(sourceFile, '            qCDebug(dc%s()) << "Modbus RTU resource" << m_modbusRtuMaster->serialPort() << "connected again. Start testing if the connection is reachable...";' % (className))
     writeLine(sourceFile, '            m_pendingInitReplies.clear();')
     writeLine(sourceFile, '            m_pendingUpdateReplies.clear();')
+    writeLine(sourceFile, '            m_updateCycle.abortCycle();')
     writeLine(sourceFile, '            m_communicationWorking = false;')
     writeLine(sourceFile, '            m_communicationFailedCounter = 0;')
     writeLine(sourceFile, '            m_checkReachableRetriesCount = 0;')
@@ -749,6 +831,9 @@ def writeRtuSourceFile():
     writeLine(sourceFile, '}')
     writeLine(sourceFile)
 
+    writeUpdateCycleMethodImplementations(sourceFile, className)
+    writeSnapshotMethodImplementation(sourceFile, className, registerJson)
+
     # Property get methods
     writePropertyGetSetMethodImplementationsRtu(sourceFile, className, registerJson['registers'])
     if 'blocks' in registerJson:
@@ -760,8 +845,8 @@ def writeRtuSourceFile():
     if 'blocks' in registerJson:
         blocks = registerJson['blocks']
 
-    writeInitMethodImplementationRtu(sourceFile, className, registerJson['registers'], blocks)
-    writeUpdateMethodRtu(sourceFile, className, registerJson['registers'], blocks)
+    writeInitMethodImplementationRtu(sourceFile, className, getIndividuallyScheduledRegisters(registerJson), blocks)
+    writeUpdateMethodRtu(sourceFile, className, getIndividuallyScheduledRegisters(registerJson), blocks)
 
     # Write update methods
     writePropertyUpdateMethodImplementationsRtu(sourceFile, className, registerJson['registers'])
@@ -771,6 +856,7 @@ def writeRtuSourceFile():
 
         # Write block update method
         writeBlockUpdateMethodImplementationsRtu(sourceFile, className, registerJson['blocks'])
+        writeBlockWriteMethodImplementationsRtu(sourceFile, className, registerJson['blocks'])
 
     # Write internal protected property read method implementations
     writeInternalPropertyReadMethodImplementationsRtu(sourceFile, className, registerJson['registers'])
@@ -835,13 +921,7 @@ def writeRtuSourceFile():
     writeLine(sourceFile, '}')
     writeLine(sourceFile)
 
-    writeLine(sourceFile, 'void %s::verifyUpdateFinished()' % (className))
-    writeLine(sourceFile, '{')
-    writeLine(sourceFile, '    if (m_pendingUpdateReplies.isEmpty()) {')
-    writeLine(sourceFile, '        emit updateFinished();')
-    writeLine(sourceFile, '    }')
-    writeLine(sourceFile, '}')
-    writeLine(sourceFile)
+    writeVerifyUpdateFinishedImplementation(sourceFile, className)
 
     writeLine(sourceFile, 'void %s::onReachabilityCheckFailed()' % (className))
     writeLine(sourceFile, '{')
@@ -977,6 +1057,34 @@ else:
     logger.debug('Verified successfully checkReachableRegister: %s' % checkReachableRegister['id'])
 
 
+# Optional identity register used to validate the cached init register values on reconnect
+identityRegister = None
+if 'identityRegister' in registerJson:
+    for registerDefinition in registerJson['registers']:
+        if registerDefinition['id'] == registerJson['identityRegister'] and registerDefinition.get('readSchedule') == 'init':
+            identityRegister = registerDefinition
+            break
+
+    if 'blocks' in registerJson:
+        for blockDefinition in registerJson['blocks']:
+            if blockDefinition.get('readSchedule') != 'init':
+                continue
+
+            for registerDefinition in blockDefinition['registers']:
+                if registerDefinition['id'] == registerJson['identityRegister']:
+                    identityRegister = registerDefinition
+                    break
+
+    if not identityRegister:
+        logger.warning('Error: Could not find the given \"identityRegister\". Please make sure the specified register matches the \"id\" of a register with \"readSchedule\": \"init\".')
+        exit(1)
+
+    if not 'R' in identityRegister['access']:
+        logger.warning('Error: The specified \"identityRegister\" is not readable.')
+        exit(1)
+
+    logger.debug('Verified successfully identityRegister: %s' % identityRegister['id'])
+
 # Inform about parsed and validated configs if debugging enabled
 logger.debug('Script path: %s' % scriptPath)
 logger.debug('Output directory: %s' % outputDirectory)
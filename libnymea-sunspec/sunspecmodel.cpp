@@ -102,19 +102,28 @@ void SunSpecModel::init()
     m_initTimer.start();
 }
 
+quint32 SunSpecModel::blockReadId() const
+{
+    return m_blockReadId;
+}
+
 void SunSpecModel::readBlockData()
 {
+    quint32 readId = ++m_blockReadId;
+
     // Read the block data, start register + 2 header reisters (id, length)
     QModbusDataUnit request = QModbusDataUnit(QModbusDataUnit::RegisterType::HoldingRegisters, m_modbusStartRegister, m_modelLength + 2);
     QModbusReply *reply = m_connection->sendReadRequest(request, m_connection->slaveId());
     if (!reply) {
         qCDebug(dcSunSpecModelData()) << "Read block data error: " << m_connection->modbusTcpClient()->errorString();
+        emit blockReadFinished(false, readId);
         return;
     }
 
     if (reply->isFinished()) {
         qCWarning(dcSunSpecModelData()) << "Read block data error: " << m_connection->modbusTcpClient()->errorString();
         reply->deleteLater(); // broadcast replies return immediately
+        emit blockReadFinished(false, readId);
         return;
     }
 
@@ -122,6 +131,7 @@ void SunSpecModel::readBlockData()
     connect(reply, &QModbusReply::finished, this, [=]() {
         if (reply->error() != QModbusDevice::NoError) {
             qCWarning(dcSunSpec()) << name() << description() << "Read block data response error:" << reply->error();
+            emit blockReadFinished(false, readId);
             return;
         }
 
@@ -132,6 +142,7 @@ void SunSpecModel::readBlockData()
 
         if (m_blockData.count() != m_modelLength + 2) {
             qCWarning(dcSunSpecModelData()) << "Received invalid block data count from read block data request. Model lenght:" << m_modelLength << "Response block count:" << m_blockData.count();
+            emit blockReadFinished(false, readId);
             return;
         }
 
@@ -150,6 +161,7 @@ void SunSpecModel::readBlockData()
 
         // Inform about the new block data
         emit blockUpdated();
+        emit blockReadFinished(true, readId);
     });
 
     connect(reply, &QModbusReply::errorOccurred, this, [this, reply] (QModbusDevice::Error error) {
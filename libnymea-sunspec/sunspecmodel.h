@@ -89,6 +89,9 @@ public:
     virtual void init();
     virtual void readBlockData();
 
+    // Id of the last read started with readBlockData(), blockReadFinished() reports the id of the finished read
+    quint32 blockReadId() const;
+
     bool operator==(const SunSpecModel &other) const;
 
 protected:
@@ -103,6 +106,7 @@ protected:
     SunSpecDataPoint::ByteOrder m_byteOrder = SunSpecDataPoint::ByteOrderLittleEndian;
 
     bool m_initialized = false;
+    quint32 m_blockReadId = 0;
 
     QVector<quint16> m_blockData;
     QHash<QString, SunSpecDataPoint> m_dataPoints;
@@ -118,6 +122,8 @@ signals:
     void blockDataChanged(const QVector<quint16> blockData);
 
     void blockUpdated();
+    // Emitted once for each readBlockData() call, also if the request failed
+    void blockReadFinished(bool success, quint32 readId);
 
 };
 
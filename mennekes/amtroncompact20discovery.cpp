@@ -32,8 +32,9 @@
 #include "extern-plugininfo.h"
 
 #include <modbusdatautils.h>
+#include <modbusrtuslavescanner.h>
 
-QList<int> slaveIdCandidates = {50, 11, 12, 13, 14};
+QList<quint16> slaveIdCandidates = {50, 11, 12, 13, 14};
 
 AmtronCompact20Discovery::AmtronCompact20Discovery(ModbusRtuHardwareResource *modbusRtuResource, QObject *parent):
     QObject{parent},
@@ -59,42 +60,36 @@ void AmtronCompact20Discovery::startDiscovery()
         return;
     }
 
+    // Scan all candidate masters at the same time, the slave IDs on each bus one after another
+    ModbusRtuSlaveScanner *scanner = new ModbusRtuSlaveScanner(this);
+    scanner->setSlaveIds(slaveIdCandidates);
+    scanner->setProbeRegisters(QModbusDataUnit::InputRegisters, 0x13, 8);
+
     foreach (ModbusRtuMaster *master, candidateMasters) {
         if (master->connected()) {
-            tryConnect(master, 0);
+            scanner->addMaster(master);
         } else {
             qCWarning(dcMennekes()) << "Modbus RTU master" << master->modbusUuid().toString() << "is not connected.";
         }
     }
-}
-
-QList<AmtronCompact20Discovery::Result> AmtronCompact20Discovery::discoveryResults() const
-{
-    return m_discoveryResults;
-}
-
-void AmtronCompact20Discovery::tryConnect(ModbusRtuMaster *master, quint16 slaveIdIndex)
-{
-    quint8 slaveId = slaveIdCandidates.at(slaveIdIndex);
-    qCDebug(dcMennekes()) << "Scanning modbus RTU master" << master->modbusUuid() << "Slave ID:" << slaveId;
-
-    ModbusRtuReply *reply = master->readInputRegister(slaveId, 0x13, 8);
-    connect(reply, &ModbusRtuReply::finished, this, [=](){
 
-        if (reply->error() == ModbusRtuReply::NoError) {
+    connect(scanner, &ModbusRtuSlaveScanner::slaveFound, this, [this](const ModbusRtuSlaveScanner::Result &scanResult){
+        QString serialNumber = ModbusDataUtils::convertToString(scanResult.values, ModbusDataUtils::ByteOrderBigEndian).remove(QRegExp("^_*"));
+        qCDebug(dcMennekes()) << "Discovery: Found wallbox on" << scanResult.modbusUuid.toString() << "Slave ID:" << scanResult.slaveId << serialNumber;
 
-            QString serialNumber = ModbusDataUtils::convertToString(reply->result(), ModbusDataUtils::ByteOrderBigEndian).remove(QRegExp("^_*"));
-            qCDebug(dcMennekes()) << "Test reply finished!" << reply->error() << serialNumber;
+        Result result {scanResult.modbusUuid, serialNumber, scanResult.slaveId};
+        m_discoveryResults.append(result);
+    });
 
-            Result result {master->modbusUuid(), serialNumber, slaveId};
-            m_discoveryResults.append(result);
+    connect(scanner, &ModbusRtuSlaveScanner::finished, this, [this, scanner](){
+        scanner->deleteLater();
+        emit discoveryFinished(true);
+    });
 
-        }
+    scanner->startScan();
+}
 
-        if (slaveIdIndex < slaveIdCandidates.count() - 1) {
-            tryConnect(master, slaveIdIndex+1);
-        } else {
-            emit discoveryFinished(true);
-        }
-    });
+QList<AmtronCompact20Discovery::Result> AmtronCompact20Discovery::discoveryResults() const
+{
+    return m_discoveryResults;
 }
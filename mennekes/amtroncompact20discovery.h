@@ -53,9 +53,6 @@ public:
 signals:
     void discoveryFinished(bool modbusRtuMasterAvailable);
 
-private slots:
-    void tryConnect(ModbusRtuMaster *master, quint16 slaveIdIndex);
-
 private:
     ModbusRtuHardwareResource *m_modbusRtuResource = nullptr;
 
@@ -31,12 +31,44 @@
 #include "amtronecudiscovery.h"
 #include "extern-plugininfo.h"
 
+#include <modbusdatautils.h>
+
 AmtronECUDiscovery::AmtronECUDiscovery(NetworkDeviceDiscovery *networkDeviceDiscovery, QObject *parent) :
     QObject{parent},
     m_networkDeviceDiscovery{networkDeviceDiscovery}
 {
+    // Only hosts answering with a valid firmware version get a full connection
+    m_probe = new ModbusNetworkProbe(this);
+    m_probe->addPort(502);
+
+    ModbusNetworkProbe::Fingerprint fingerprint;
+    fingerprint.name = "amtron-ecu";
+    fingerprint.slaveId = 0xff;
+    fingerprint.registerType = QModbusDataUnit::HoldingRegisters;
+    fingerprint.registerAddress = 100; // firmwareVersion
+    fingerprint.size = 2;
+    fingerprint.validator = [](const QVector<quint16> &values) {
+        return ModbusDataUtils::convertToUInt32(values, ModbusDataUtils::ByteOrderBigEndian) != 0;
+    };
+    m_probe->addFingerprint(fingerprint);
+
+    connect(m_probe, &ModbusNetworkProbe::resultFound, this, [this](const ModbusNetworkProbe::Result &result){
+        foreach (const NetworkDeviceInfo &networkDeviceInfo, m_networkDeviceInfos) {
+            if (networkDeviceInfo.address() == result.address) {
+                checkNetworkDevice(networkDeviceInfo);
+                return;
+            }
+        }
+    });
+
+    connect(m_probe, &ModbusNetworkProbe::finished, this, [this](){
+        m_probeFinished = true;
+        finishDiscoveryIfDone();
+    });
+
+    // Give the connections still initializing once all hosts have been probed a chance to finish
     m_gracePeriodTimer.setSingleShot(true);
-    m_gracePeriodTimer.setInterval(3000);
+    m_gracePeriodTimer.setInterval(5000);
     connect(&m_gracePeriodTimer, &QTimer::timeout, this, [this](){
         qCDebug(dcMennekes()) << "Discovery: Grace period timer triggered.";
         finishDiscovery();
@@ -48,11 +80,23 @@ void AmtronECUDiscovery::startDiscovery()
     qCInfo(dcMennekes()) << "Discovery: Searching for AMTRON wallboxes in the network...";
     NetworkDeviceDiscoveryReply *discoveryReply = m_networkDeviceDiscovery->discover();
 
-    connect(discoveryReply, &NetworkDeviceDiscoveryReply::networkDeviceInfoAdded, this, &AmtronECUDiscovery::checkNetworkDevice);
+    m_startDateTime = QDateTime::currentDateTime();
+    m_probeFinished = false;
+    m_finished = false;
+
+    connect(discoveryReply, &NetworkDeviceDiscoveryReply::networkDeviceInfoAdded, this, [this](const NetworkDeviceInfo &networkDeviceInfo){
+        m_networkDeviceInfos.append(networkDeviceInfo);
+        m_probe->probe(networkDeviceInfo.address());
+    });
 
     connect(discoveryReply, &NetworkDeviceDiscoveryReply::finished, this, [=](){
         qCDebug(dcMennekes()) << "Discovery: Network discovery finished. Found" << discoveryReply->networkDeviceInfos().count() << "network devices";
-        m_gracePeriodTimer.start();
+        m_networkDeviceInfos = discoveryReply->networkDeviceInfos();
+        foreach (const NetworkDeviceInfo &networkDeviceInfo, m_networkDeviceInfos)
+            m_probe->probe(networkDeviceInfo.address());
+
+        // The probe finishes once all pending hosts have been checked
+        m_probe->finish();
         discoveryReply->deleteLater();
     });
 }
@@ -118,12 +162,33 @@ void AmtronECUDiscovery::cleanupConnection(AmtronECUModbusTcpConnection *connect
     m_connections.removeAll(connection);
     connection->disconnectDevice();
     connection->deleteLater();
+
+    finishDiscoveryIfDone();
+}
+
+void AmtronECUDiscovery::finishDiscoveryIfDone()
+{
+    if (m_finished || !m_probeFinished)
+        return;
+
+    if (m_connections.isEmpty()) {
+        finishDiscovery();
+    } else if (!m_gracePeriodTimer.isActive()) {
+        m_gracePeriodTimer.start();
+    }
 }
 
 void AmtronECUDiscovery::finishDiscovery()
 {
     qint64 durationMilliSeconds = QDateTime::currentMSecsSinceEpoch() - m_startDateTime.toMSecsSinceEpoch();
 
+    // Make sure we finish only once
+    if (m_finished)
+        return;
+
+    m_finished = true;
+    m_gracePeriodTimer.stop();
+
     // Cleanup any leftovers...we don't care any more
     foreach (AmtronECUModbusTcpConnection *connection, m_connections)
         cleanupConnection(connection);
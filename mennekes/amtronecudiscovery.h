@@ -36,6 +36,7 @@
 
 #include <network/networkdevicediscovery.h>
 
+#include "modbusnetworkprobe.h"
 #include "amtronecumodbustcpconnection.h"
 
 class AmtronECUDiscovery : public QObject
@@ -62,12 +63,18 @@ private:
     QTimer m_gracePeriodTimer;
     QDateTime m_startDateTime;
 
+    ModbusNetworkProbe *m_probe = nullptr;
+    bool m_probeFinished = false;
+    bool m_finished = false;
+
+    NetworkDeviceInfos m_networkDeviceInfos;
     QList<AmtronECUModbusTcpConnection *> m_connections;
 
     QList<Result> m_discoveryResults;
 
     void checkNetworkDevice(const NetworkDeviceInfo &networkDeviceInfo);
     void cleanupConnection(AmtronECUModbusTcpConnection *connection);
+    void finishDiscoveryIfDone();
 
     void finishDiscovery();
 };
@@ -394,10 +394,14 @@ void IntegrationPluginMennekes::executeAction(ThingActionInfo *info)
     if (info->thing()->thingClassId() == amtronCompact20ThingClassId) {
         AmtronCompact20ModbusRtuConnection *amtronCompact20Connection = m_amtronCompact20Connections.value(info->thing());
 
+        // Charging release, phases and solar mode share the functions block (3331 - 3333). It gets written
+        // as a whole, keeping the other functions at their last read values.
         if (info->action().actionTypeId() == amtronCompact20PowerActionTypeId) {
             bool power = info->action().paramValue(amtronCompact20PowerActionPowerParamTypeId).toBool();
 
-            ModbusRtuReply *reply = amtronCompact20Connection->setChargingReleaseEnergyManager(power ? 1 : 0);
+            ModbusRtuReply *reply = amtronCompact20Connection->setFunctionsBlock(amtronCompact20Connection->solarChargingMode(),
+                                                                                 amtronCompact20Connection->requestedPhases(),
+                                                                                 power ? 1 : 0);
             connect(reply, &ModbusRtuReply::finished, info, [info, reply, power](){
                 if (reply->error() == ModbusRtuReply::NoError) {
                     info->thing()->setStateValue(amtronCompact20PowerStateTypeId, power);
@@ -430,7 +434,9 @@ void IntegrationPluginMennekes::executeAction(ThingActionInfo *info)
         if (info->action().actionTypeId() == amtronCompact20DesiredPhaseCountActionTypeId) {
             int desiredPhaseCount = info->action().paramValue(amtronCompact20DesiredPhaseCountActionDesiredPhaseCountParamTypeId).toInt();
 
-            ModbusRtuReply *reply = amtronCompact20Connection->setRequestedPhases(desiredPhaseCount == 1 ? AmtronCompact20ModbusRtuConnection::PhaseModeSingle : AmtronCompact20ModbusRtuConnection::PhaseModeAll);
+            ModbusRtuReply *reply = amtronCompact20Connection->setFunctionsBlock(amtronCompact20Connection->solarChargingMode(),
+                                                                                 desiredPhaseCount == 1 ? AmtronCompact20ModbusRtuConnection::PhaseModeSingle : AmtronCompact20ModbusRtuConnection::PhaseModeAll,
+                                                                                 amtronCompact20Connection->chargingReleaseEnergyManager());
             connect(reply, &ModbusRtuReply::finished, info, [info, reply, desiredPhaseCount](){
                 if (reply->error() == ModbusRtuReply::NoError) {
                     info->thing()->setStateValue(amtronCompact20DesiredPhaseCountStateTypeId, desiredPhaseCount);
@@ -442,7 +448,9 @@ void IntegrationPluginMennekes::executeAction(ThingActionInfo *info)
         }
         if (info->action().actionTypeId() == amtronCompact20SolarChargingModeActionTypeId) {
             QString solarChargingMode = info->action().paramValue(amtronCompact20SolarChargingModeActionSolarChargingModeParamTypeId).toString();
-            ModbusRtuReply *reply = amtronCompact20Connection->setSolarChargingMode(solarChargingModeMap.key(solarChargingMode));
+            ModbusRtuReply *reply = amtronCompact20Connection->setFunctionsBlock(solarChargingModeMap.key(solarChargingMode),
+                                                                                 amtronCompact20Connection->requestedPhases(),
+                                                                                 amtronCompact20Connection->chargingReleaseEnergyManager());
             connect(reply, &ModbusRtuReply::finished, info, [info, reply, solarChargingMode](){
                 if (reply->error() == ModbusRtuReply::NoError) {
                     info->thing()->setStateValue(amtronCompact20SolarChargingModeStateTypeId, solarChargingMode);
@@ -36,6 +36,8 @@
 #include <hardware/modbus/modbusrtumaster.h>
 #include <hardware/modbus/modbusrtuhardwareresource.h>
 
+#include <algorithm>
+
 IntegrationPluginModbusCommander::IntegrationPluginModbusCommander()
 {
 }
@@ -314,6 +316,7 @@ void IntegrationPluginModbusCommander::setupThing(ThingSetupInfo *info)
                || (thing->thingClassId() == holdingRegisterThingClassId)
                || (thing->thingClassId() == inputRegisterThingClassId)) {
         qCDebug(dcModbusCommander()) << "Setting up modbus register" << thing->name();
+        indexRegisterThing(thing);
         info->finish(Thing::ThingErrorNoError);
 
     } else {
@@ -329,16 +332,7 @@ void IntegrationPluginModbusCommander::postSetupThing(Thing *thing)
         int refreshTime = configValue(modbusCommanderPluginUpdateIntervalParamTypeId).toInt();
         qCDebug(dcModbusCommander()) << "Starting refresh timer with interval" << refreshTime << "s";
         m_refreshTimer = hardwareManager()->pluginTimerManager()->registerTimer(refreshTime);
-        connect(m_refreshTimer, &PluginTimer::timeout, this, [this] {
-            foreach (Thing *thing, myThings()) {
-                if ((thing->thingClassId() == coilThingClassId) ||
-                        (thing->thingClassId() == discreteInputThingClassId) ||
-                        (thing->thingClassId() == holdingRegisterThingClassId) ||
-                        (thing->thingClassId() == inputRegisterThingClassId)) {
-                    readRegister(thing);
-                }
-            }
-        });
+        connect(m_refreshTimer, &PluginTimer::timeout, this, &IntegrationPluginModbusCommander::readRegisters);
     }
 
     if ((thing->thingClassId() == modbusRTUClientThingClassId) ||
@@ -389,6 +383,8 @@ void IntegrationPluginModbusCommander::thingRemoved(Thing *thing)
         m_modbusTCPMasters.take(thing)->deleteLater();
     } else if (thing->thingClassId() == modbusRTUClientThingClassId) {
         m_modbusRtuMasters.take(thing)->deleteLater();
+    } else {
+        unindexRegisterThing(thing);
     }
 
     if (myThings().empty()) {
@@ -436,8 +432,11 @@ void IntegrationPluginModbusCommander::onRequestExecuted(QUuid requestId, bool s
     }
 
     if (m_readRequests.contains(requestId)){
-        Thing *thing = m_readRequests.take(requestId);
-        thing->setStateValue(m_connectedStateTypeId.value(thing->thingClassId()), success);
+        foreach (Thing *thing, m_readRequests.take(requestId)) {
+            if (thing) {
+                thing->setStateValue(m_connectedStateTypeId.value(thing->thingClassId()), success);
+            }
+        }
     }
 }
 
@@ -450,81 +449,95 @@ void IntegrationPluginModbusCommander::onRequestError(QUuid requestId, const QSt
     }
 
     if (m_readRequests.contains(requestId)){
-        Thing *thing = m_readRequests.take(requestId);
-        thing->setStateValue(m_connectedStateTypeId.value(thing->thingClassId()), false);
+        foreach (Thing *thing, m_readRequests.take(requestId)) {
+            if (thing) {
+                thing->setStateValue(m_connectedStateTypeId.value(thing->thingClassId()), false);
+            }
+        }
     }
 }
 
 void IntegrationPluginModbusCommander::onReceivedCoil(quint32 slaveAddress, quint32 modbusRegister, const QVector<quint16> &values)
 {
-    auto modbus = sender();
-    if (m_modbusTCPMasters.values().contains(static_cast<ModbusTcpMaster *>(modbus))) {
-        Thing *parent = m_modbusTCPMasters.key(static_cast<ModbusTcpMaster *>(modbus));
-        foreach (Thing *thing, myThings().filterByParentId(parent->id())) {
-            if (thing->thingClassId() == coilThingClassId) {
-                if ((thing->paramValue(m_slaveAddressParamTypeId.value(thing->thingClassId())) == slaveAddress)
-                        && (thing->paramValue(m_registerAddressParamTypeId.value(thing->thingClassId())) == modbusRegister)) {
-                    thing->setStateValue(m_valueStateTypeId.value(thing->thingClassId()), values[0]);
-                    thing->setStateValue(m_connectedStateTypeId.value(thing->thingClassId()), true);
-                    return;
-                }
-            }
-        }
-    }
+    dispatchReceivedValues(static_cast<ModbusTcpMaster *>(sender()), QModbusDataUnit::Coils, slaveAddress, modbusRegister, values);
 }
 
 void IntegrationPluginModbusCommander::onReceivedDiscreteInput(quint32 slaveAddress, quint32 modbusRegister, const QVector<quint16> &values)
 {
-    auto modbus = sender();
+    dispatchReceivedValues(static_cast<ModbusTcpMaster *>(sender()), QModbusDataUnit::DiscreteInputs, slaveAddress, modbusRegister, values);
+}
 
-    if (m_modbusTCPMasters.values().contains(static_cast<ModbusTcpMaster *>(modbus))) {
-        Thing *parent = m_modbusTCPMasters.key(static_cast<ModbusTcpMaster *>(modbus));
-        foreach (Thing *thing, myThings().filterByParentId(parent->id())) {
-            if (thing->thingClassId() == discreteInputThingClassId) {
-                if ((thing->paramValue(m_slaveAddressParamTypeId.value(thing->thingClassId())) == slaveAddress)
-                        && (thing->paramValue(m_registerAddressParamTypeId.value(thing->thingClassId())) == modbusRegister)) {
-                    thing->setStateValue(m_valueStateTypeId.value(thing->thingClassId()), values[0]);
-                    thing->setStateValue(m_connectedStateTypeId.value(thing->thingClassId()), true);
-                    return;
-                }
-            }
-        }
+void IntegrationPluginModbusCommander::onReceivedHoldingRegister(uint slaveAddress, uint modbusRegister, const QVector<quint16> &values)
+{
+    dispatchReceivedValues(static_cast<ModbusTcpMaster *>(sender()), QModbusDataUnit::HoldingRegisters, slaveAddress, modbusRegister, values);
+}
+
+void IntegrationPluginModbusCommander::onReceivedInputRegister(uint slaveAddress, uint modbusRegister, const QVector<quint16> &values)
+{
+    dispatchReceivedValues(static_cast<ModbusTcpMaster *>(sender()), QModbusDataUnit::InputRegisters, slaveAddress, modbusRegister, values);
+}
+
+RegisterKey IntegrationPluginModbusCommander::registerKey(Thing *thing) const
+{
+    RegisterKey key;
+    key.parentId = thing->parentId();
+    key.slaveAddress = thing->paramValue(m_slaveAddressParamTypeId.value(thing->thingClassId())).toUInt();
+    key.registerAddress = thing->paramValue(m_registerAddressParamTypeId.value(thing->thingClassId())).toUInt();
+    if (thing->thingClassId() == coilThingClassId) {
+        key.registerType = QModbusDataUnit::Coils;
+    } else if (thing->thingClassId() == discreteInputThingClassId) {
+        key.registerType = QModbusDataUnit::DiscreteInputs;
+    } else if (thing->thingClassId() == holdingRegisterThingClassId) {
+        key.registerType = QModbusDataUnit::HoldingRegisters;
+    } else {
+        key.registerType = QModbusDataUnit::InputRegisters;
     }
+    return key;
 }
 
-void IntegrationPluginModbusCommander::onReceivedHoldingRegister(uint slaveAddress, uint modbusRegister, const QVector<quint16> &values)
+void IntegrationPluginModbusCommander::indexRegisterThing(Thing *thing)
 {
-    auto modbus = sender();
+    // In case of a reconfiguration the parameters might have changed
+    unindexRegisterThing(thing);
 
-    if (m_modbusTCPMasters.values().contains(static_cast<ModbusTcpMaster *>(modbus))) {
-        Thing *parent = m_modbusTCPMasters.key(static_cast<ModbusTcpMaster *>(modbus));
-        foreach (Thing *thing, myThings().filterByParentId(parent->id())) {
-            if (thing->thingClassId() == holdingRegisterThingClassId) {
-                if ((thing->paramValue(m_slaveAddressParamTypeId.value(thing->thingClassId())) == slaveAddress)
-                        && (thing->paramValue(m_registerAddressParamTypeId.value(thing->thingClassId())) == modbusRegister)) {
-                    thing->setStateValue(m_valueStateTypeId.value(thing->thingClassId()), values[0]);
-                    thing->setStateValue(m_connectedStateTypeId.value(thing->thingClassId()), true);
-                    return;
-                }
-            }
-        }
+    RegisterKey key = registerKey(thing);
+    if (m_registerThings.contains(key)) {
+        qCWarning(dcModbusCommander()) << "There is already a thing for slave" << key.slaveAddress << "register" << key.registerAddress << "on this client." << thing->name() << "will not receive values from reads of the other thing.";
     }
+    m_registerThings.insert(key, thing);
+    m_registerKeys.insert(thing, key);
 }
 
-void IntegrationPluginModbusCommander::onReceivedInputRegister(uint slaveAddress, uint modbusRegister, const QVector<quint16> &values)
+void IntegrationPluginModbusCommander::unindexRegisterThing(Thing *thing)
 {
-    auto modbus = sender();
+    if (!m_registerKeys.contains(thing))
+        return;
 
-    if (m_modbusTCPMasters.values().contains(static_cast<ModbusTcpMaster *>(modbus))) {
-        Thing *parent = m_modbusTCPMasters.key(static_cast<ModbusTcpMaster *>(modbus));
-        foreach (Thing *thing, myThings().filterByParentId(parent->id())) {
-            if (thing->thingClassId() == inputRegisterThingClassId) {
-                if ((thing->paramValue(m_slaveAddressParamTypeId.value(thing->thingClassId())) == slaveAddress)
-                        && (thing->paramValue(m_registerAddressParamTypeId.value(thing->thingClassId())) == modbusRegister)) {
-                    thing->setStateValue(m_valueStateTypeId.value(thing->thingClassId()), values[0]);
-                    thing->setStateValue(m_connectedStateTypeId.value(thing->thingClassId()), true);
-                    return;
-                }
+    RegisterKey key = m_registerKeys.take(thing);
+    if (m_registerThings.value(key) == thing) {
+        m_registerThings.remove(key);
+    }
+}
+
+void IntegrationPluginModbusCommander::dispatchReceivedValues(ModbusTcpMaster *modbus, QModbusDataUnit::RegisterType registerType, uint slaveAddress, uint modbusRegister, const QVector<quint16> &values)
+{
+    if (values.isEmpty())
+        return;
+
+    // Note: multiple clients with the same address share one master
+    foreach (Thing *parent, m_modbusTCPMasters.keys(modbus)) {
+        RegisterKey key;
+        key.parentId = parent->id();
+        key.slaveAddress = slaveAddress;
+        key.registerType = registerType;
+
+        // Merged range reads contain the values of multiple things
+        for (int i = 0; i < values.count(); i++) {
+            key.registerAddress = modbusRegister + i;
+            Thing *thing = m_registerThings.value(key);
+            if (thing) {
+                thing->setStateValue(m_valueStateTypeId.value(thing->thingClassId()), values[i]);
+                thing->setStateValue(m_connectedStateTypeId.value(thing->thingClassId()), true);
             }
         }
     }
@@ -633,7 +646,7 @@ void IntegrationPluginModbusCommander::readRegister(Thing *thing)
     }
 
     if (!requestId.isNull()) {
-        m_readRequests.insert(requestId, thing);
+        m_readRequests.insert(requestId, {thing});
         QTimer::singleShot(5000, this, [requestId, this] {m_readRequests.remove(requestId);});
     } else {
         // Request returned without an id
@@ -641,6 +654,146 @@ void IntegrationPluginModbusCommander::readRegister(Thing *thing)
     }
 }
 
+void IntegrationPluginModbusCommander::readRegisters()
+{
+    uint maxGap = configValue(modbusCommanderPluginMaxReadGapParamTypeId).toUInt();
+
+    // Group the register things by client, slave and register type
+    QHash<RegisterKey, QList<Thing *> > groups;
+    foreach (Thing *thing, m_registerKeys.keys()) {
+        RegisterKey groupKey = m_registerKeys.value(thing);
+        groupKey.registerAddress = 0;
+        groups[groupKey].append(thing);
+    }
+
+    foreach (const RegisterKey &groupKey, groups.keys()) {
+        Thing *parent = myThings().findById(groupKey.parentId);
+        if (!parent)
+            continue;
+
+        QList<Thing *> things = groups.value(groupKey);
+        std::sort(things.begin(), things.end(), [this](Thing *a, Thing *b){
+            return m_registerKeys.value(a).registerAddress < m_registerKeys.value(b).registerAddress;
+        });
+
+        uint maxSize = (groupKey.registerType == QModbusDataUnit::Coils || groupKey.registerType == QModbusDataUnit::DiscreteInputs) ? 2000 : 125;
+
+        // Merge the sorted addresses into ranges
+        RegisterKey rangeKey = groupKey;
+        uint rangeEnd = 0;
+        QList<Thing *> rangeThings;
+        foreach (Thing *thing, things) {
+            uint registerAddress = m_registerKeys.value(thing).registerAddress;
+            if (!rangeThings.isEmpty() && (registerAddress > rangeEnd + maxGap || registerAddress + 1 - rangeKey.registerAddress > maxSize)) {
+                readRegisterRange(parent, rangeKey, rangeEnd - rangeKey.registerAddress, rangeThings);
+                rangeThings.clear();
+            }
+
+            if (rangeThings.isEmpty())
+                rangeKey.registerAddress = registerAddress;
+
+            rangeEnd = registerAddress + 1;
+            rangeThings.append(thing);
+        }
+
+        if (!rangeThings.isEmpty()) {
+            readRegisterRange(parent, rangeKey, rangeEnd - rangeKey.registerAddress, rangeThings);
+        }
+    }
+}
+
+void IntegrationPluginModbusCommander::readRegisterRange(Thing *parent, const RegisterKey &rangeKey, uint size, const QList<Thing *> &things)
+{
+    if (things.count() == 1) {
+        readRegister(things.first());
+        return;
+    }
+
+    QList<QPointer<Thing> > rangeThings;
+    foreach (Thing *thing, things)
+        rangeThings.append(thing);
+
+    qCDebug(dcModbusCommander()) << "Reading" << things.count() << "things from slave" << rangeKey.slaveAddress << "register" << rangeKey.registerAddress << "size" << size;
+
+    if (parent->thingClassId() == modbusTCPClientThingClassId) {
+        ModbusTcpMaster *modbus = m_modbusTCPMasters.value(parent);
+        if (!modbus || !modbus->connected())
+            return; // Send requests only if the modbus interface is connected
+
+        QUuid requestId;
+        switch (rangeKey.registerType) {
+        case QModbusDataUnit::Coils:
+            requestId = modbus->readCoil(rangeKey.slaveAddress, rangeKey.registerAddress, size);
+            break;
+        case QModbusDataUnit::DiscreteInputs:
+            requestId = modbus->readDiscreteInput(rangeKey.slaveAddress, rangeKey.registerAddress, size);
+            break;
+        case QModbusDataUnit::HoldingRegisters:
+            requestId = modbus->readHoldingRegister(rangeKey.slaveAddress, rangeKey.registerAddress, size);
+            break;
+        default:
+            requestId = modbus->readInputRegister(rangeKey.slaveAddress, rangeKey.registerAddress, size);
+            break;
+        }
+
+        if (requestId.isNull()) {
+            foreach (Thing *thing, things)
+                thing->setStateValue(m_connectedStateTypeId.value(thing->thingClassId()), false);
+
+            return;
+        }
+
+        // The values get dispatched to the things in onReceived...
+        m_readRequests.insert(requestId, rangeThings);
+        QTimer::singleShot(5000, this, [requestId, this] {m_readRequests.remove(requestId);});
+
+    } else if (parent->thingClassId() == modbusRTUClientThingClassId) {
+        ModbusRtuMaster *modbusMaster = m_modbusRtuMasters.value(parent);
+        if (!modbusMaster || !modbusMaster->connected())
+            return; // Send requests only if the modbus interface is connected
+
+        ModbusRtuReply *reply = nullptr;
+        switch (rangeKey.registerType) {
+        case QModbusDataUnit::Coils:
+            reply = modbusMaster->readCoil(rangeKey.slaveAddress, rangeKey.registerAddress, size);
+            break;
+        case QModbusDataUnit::DiscreteInputs:
+            reply = modbusMaster->readDiscreteInput(rangeKey.slaveAddress, rangeKey.registerAddress, size);
+            break;
+        case QModbusDataUnit::HoldingRegisters:
+            reply = modbusMaster->readHoldingRegister(rangeKey.slaveAddress, rangeKey.registerAddress, size);
+            break;
+        default:
+            reply = modbusMaster->readInputRegister(rangeKey.slaveAddress, rangeKey.registerAddress, size);
+            break;
+        }
+
+        connect(reply, &ModbusRtuReply::finished, reply, &ModbusRtuReply::deleteLater);
+        connect(reply, &ModbusRtuReply::finished, modbusMaster, [=](){
+            if (reply->error() != ModbusRtuReply::NoError) {
+                qCWarning(dcModbusCommander()) << "Failed to read registers from" << modbusMaster << "slave:" << rangeKey.slaveAddress << "register:" << rangeKey.registerAddress << "size:" << size;
+            }
+
+            QVector<quint16> result = reply->result();
+            foreach (Thing *thing, rangeThings) {
+                if (!thing)
+                    continue;
+
+                if (reply->error() != ModbusRtuReply::NoError) {
+                    thing->setStateValue(m_connectedStateTypeId.value(thing->thingClassId()), false);
+                    continue;
+                }
+
+                int offset = m_registerKeys.value(thing).registerAddress - rangeKey.registerAddress;
+                if (offset >= 0 && offset < result.count()) {
+                    thing->setStateValue(m_valueStateTypeId.value(thing->thingClassId()), result.at(offset));
+                }
+                thing->setStateValue(m_connectedStateTypeId.value(thing->thingClassId()), true);
+            }
+        });
+    }
+}
+
 void IntegrationPluginModbusCommander::writeRegister(Thing *thing, ThingActionInfo *info)
 {
     Thing *parent = myThings().findById(thing->parentId());
@@ -38,9 +38,27 @@
 #include <modbustcpmaster.h>
 
 #include <QUuid>
+#include <QPointer>
 #include <QSerialPort>
 #include <QSerialPortInfo>
 
+typedef struct RegisterKey {
+    ThingId parentId;
+    uint slaveAddress;
+    QModbusDataUnit::RegisterType registerType;
+    uint registerAddress;
+
+    bool operator==(const RegisterKey &other) const {
+        return parentId == other.parentId && slaveAddress == other.slaveAddress
+                && registerType == other.registerType && registerAddress == other.registerAddress;
+    }
+} RegisterKey;
+
+inline uint qHash(const RegisterKey &key, uint seed = 0)
+{
+    return qHash(key.parentId, seed) ^ qHash((key.slaveAddress << 24) ^ (static_cast<uint>(key.registerType) << 20) ^ key.registerAddress, seed);
+}
+
 class IntegrationPluginModbusCommander: public IntegrationPlugin
 {
     Q_OBJECT
@@ -64,9 +82,20 @@ private:
     QHash<Thing*, ModbusTcpMaster*> m_modbusTCPMasters;
     QHash<Thing *, ModbusRtuMaster *> m_modbusRtuMasters;
     QHash<QUuid, ThingActionInfo*> m_asyncActions;
-    QHash<QUuid, Thing*> m_readRequests;
+    QHash<QUuid, QList<QPointer<Thing> > > m_readRequests;
+
+    // Register things indexed by parent, slave, register type and address for dispatching replies
+    QHash<RegisterKey, Thing *> m_registerThings;
+    QHash<Thing *, RegisterKey> m_registerKeys;
+    RegisterKey registerKey(Thing *thing) const;
+    void indexRegisterThing(Thing *thing);
+    void unindexRegisterThing(Thing *thing);
+    void dispatchReceivedValues(ModbusTcpMaster *modbus, QModbusDataUnit::RegisterType registerType, uint slaveAddress, uint modbusRegister, const QVector<quint16> &values);
 
     void readRegister(Thing *thing);
+    // Reads all register things merged into contiguous ranges per client, slave and register type
+    void readRegisters();
+    void readRegisterRange(Thing *parent, const RegisterKey &rangeKey, uint size, const QList<Thing *> &things);
     void writeRegister(Thing *thing, ThingActionInfo *info);
 
     QHash<ThingClassId, ParamTypeId> m_slaveAddressParamTypeId;
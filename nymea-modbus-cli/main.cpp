@@ -34,21 +34,63 @@
 
 #include <QDebug>
 #include <QObject>
+#include <QSocketNotifier>
 #include <QSerialPort>
 #include <QHostAddress>
 #include <QSerialPortInfo>
 #include <QModbusTcpClient>
 #include <QModbusRtuSerialMaster>
 
+#include <csignal>
+#include <unistd.h>
+#include <sys/socket.h>
+
+#include "modbuspoller.h"
+
 void sendRequest(quint16 modbusServerAddress, QModbusDataUnit::RegisterType registerType, quint16 registerAddress, quint16 length, const QByteArray &writeData, QModbusClient *client);
-QString exceptionCodeToString(QModbusPdu::ExceptionCode exception);
+
+// Socket pair the signal handler writes to, the event loop quits once it becomes readable
+static int s_quitSignalSockets[2] = {-1, -1};
+
+void onQuitSignal(int)
+{
+    // Only async signal safe calls are allowed in here
+    char signal = 1;
+    ssize_t written = ::write(s_quitSignalSockets[0], &signal, sizeof(signal));
+    Q_UNUSED(written)
+}
+
+void installQuitSignalHandler(QCoreApplication *application)
+{
+    if (s_quitSignalSockets[0] >= 0)
+        return;
+
+    if (::socketpair(AF_UNIX, SOCK_STREAM, 0, s_quitSignalSockets) != 0) {
+        qWarning() << "Could not create the signal socket pair, SIGINT and SIGTERM will not print the statistics.";
+        s_quitSignalSockets[0] = -1;
+        s_quitSignalSockets[1] = -1;
+        return;
+    }
+
+    QSocketNotifier *notifier = new QSocketNotifier(s_quitSignalSockets[1], QSocketNotifier::Read, application);
+    QObject::connect(notifier, &QSocketNotifier::activated, application, [notifier](){
+        char signal;
+        ssize_t bytesRead = ::read(s_quitSignalSockets[1], &signal, sizeof(signal));
+        Q_UNUSED(bytesRead)
+        notifier->setEnabled(false);
+        QCoreApplication::quit();
+    });
+
+    std::signal(SIGINT, onQuitSignal);
+    std::signal(SIGTERM, onQuitSignal);
+}
 
 int main(int argc, char *argv[])
 {
     QCoreApplication application(argc, argv);
     application.setApplicationName("nymea-modbus-cli");
     application.setOrganizationName("nymea");
-    application.setApplicationVersion("1.2.0");
+    application.setApplicationVersion("1.3.0");
 
     QString description = QString("\nTool for testing and reading Modbus TCP or RTU registers.\n\n");
     description.append(QString("Copyright %1 2016 - 2023 nymea GmbH <contact@nymea.io>\n\n").arg(QChar(0xA9)));
@@ -78,6 +120,16 @@ int main(int argc, char *argv[])
     description.append("nymea-modbus-cli --serial /dev/ttyUSB0 --baudrate 9600 -r 1000 -l 2\n\n");
 
 
+    description.append("Polling and dumping\n");
+    description.append("-----------------------------------------\n");
+    description.append("Example polling 10 holding registers from address 1000 as fast as possible 100 times and print latency statistics:\n");
+    description.append("nymea-modbus-cli -a 192.168.0.10 -r 1000 -l 10 --poll --interval 0 --count 100 --quiet\n\n");
+    description.append("Example dumping the first 10000 input registers into a CSV file:\n");
+    description.append("nymea-modbus-cli -a 192.168.0.10 -t input -r 0 -l 10000 --dump registers.csv\n\n");
+    description.append("Example polling all registers of a connection definition every 5 seconds:\n");
+    description.append("nymea-modbus-cli -a 192.168.0.10 --registers-json huawei-registers.json --poll --interval 5000\n\n");
+
+
     QCommandLineParser parser;
     parser.addHelpOption();
     parser.addVersionOption();
@@ -135,6 +187,41 @@ int main(int argc, char *argv[])
     QCommandLineOption writeOption(QStringList() << "w" << "write", QString("The data to be written to the given register."), "data");
     parser.addOption(writeOption);
 
+    QCommandLineOption timeoutOption(QStringList() << "timeout", QString("The timeout of a request in ms. Default is 3000 for TCP and 500 for RTU."), "ms");
+    parser.addOption(timeoutOption);
+
+    QCommandLineOption retriesOption(QStringList() << "retries", QString("The number of retries of a request. Default is 3."), "retries");
+    retriesOption.setDefaultValue("3");
+    parser.addOption(retriesOption);
+
+    // Polling
+    QCommandLineOption pollOption(QStringList() << "poll", QString("Poll the registers continuously and print latency statistics when finished."));
+    parser.addOption(pollOption);
+
+    QCommandLineOption intervalOption(QStringList() << "interval", QString("The interval between the start of two poll cycles in ms. Use 0 to poll as fast as possible. Default is 1000."), "ms");
+    intervalOption.setDefaultValue("1000");
+    parser.addOption(intervalOption);
+
+    QCommandLineOption countOption(QStringList() << "count", QString("The number of poll cycles. Use 0 to poll until the process gets stopped. Default is 0."), "count");
+    countOption.setDefaultValue("0");
+    parser.addOption(countOption);
+
+    QCommandLineOption registersJsonOption(QStringList() << "registers-json", QString("Use the registers and blocks of a connection definition (*-registers.json) as read plan instead of the register range."), "file");
+    parser.addOption(registersJsonOption);
+
+    QCommandLineOption chunkSizeOption(QStringList() << "chunk-size", QString("The maximum number of registers per request. Larger ranges get split. Default is the maximum allowed by the protocol (125 registers, 2000 coils)."), "size");
+    parser.addOption(chunkSizeOption);
+
+    QCommandLineOption dumpOption(QStringList() << "dump", QString("Write all read values into the given file."), "file");
+    parser.addOption(dumpOption);
+
+    QCommandLineOption formatOption(QStringList() << "format", QString("The format of the dump file. Allowed values are [csv, binary]. Binary writes the raw register values in big endian. Default is csv."), "format");
+    formatOption.setDefaultValue("csv");
+    parser.addOption(formatOption);
+
+    QCommandLineOption quietOption(QStringList() << "q" << "quiet", QString("Do not print the read values while polling or dumping."));
+    parser.addOption(quietOption);
+
     QCommandLineOption debugOption(QStringList() << "d" << "debug", QString("Print more information."));
     parser.addOption(debugOption);
 
@@ -183,24 +270,120 @@ int main(int argc, char *argv[])
         exit(EXIT_FAILURE);
     }
 
-    quint16 registerAddress = parser.value(registerOption).toUInt(&valueOk);
-    if (!valueOk) {
-        qCritical() << "Error: invalid register number:" << parser.value(registerOption);
-        exit(EXIT_FAILURE);
+    bool pollerMode = parser.isSet(pollOption) || parser.isSet(dumpOption) || parser.isSet(registersJsonOption);
+
+    quint16 registerAddress = 0;
+    if (!parser.isSet(registersJsonOption)) {
+        uint registerValue = parser.value(registerOption).toUInt(&valueOk);
+        if (!valueOk || registerValue > 0xFFFF) {
+            qCritical() << "Error: invalid register number:" << parser.value(registerOption);
+            exit(EXIT_FAILURE);
+        }
+        registerAddress = static_cast<quint16>(registerValue);
     }
 
-    quint16 length = parser.value(lengthOption).toUInt(&valueOk);
-    if (!valueOk) {
+    // In poller mode the range gets split into chunks, so it may cover the entire address space
+    uint length = parser.value(lengthOption).toUInt(&valueOk);
+    if (!valueOk || length < 1 || length > (pollerMode ? 0x10000u : 0xFFFFu)) {
         qCritical() << "Error: invalid register length number:" << parser.value(lengthOption);
         exit(EXIT_FAILURE);
     }
 
     QByteArray writeData;
     if (parser.isSet(writeOption)) {
+        if (pollerMode) {
+            qCritical() << "Error: invalid paramter combination. Writing is not supported while polling or dumping.";
+            exit(EXIT_FAILURE);
+        }
+
         writeData = parser.value(writeOption).toLocal8Bit();
         qDebug() << "Write data:" << writeData;
     }
 
+    int retries = parser.value(retriesOption).toInt(&valueOk);
+    if (!valueOk || retries < 0) {
+        qCritical() << "Error: invalid number of retries:" << parser.value(retriesOption);
+        exit(EXIT_FAILURE);
+    }
+
+    int timeout = 0;
+    if (parser.isSet(timeoutOption)) {
+        timeout = parser.value(timeoutOption).toInt(&valueOk);
+        if (!valueOk || timeout <= 0) {
+            qCritical() << "Error: invalid timeout:" << parser.value(timeoutOption);
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    // Build the poller for the given client, the read plan is either the register range or the registers JSON file
+    auto createPoller = [&](QModbusClient *client) -> ModbusPoller * {
+        ModbusPoller *poller = new ModbusPoller(client, modbusServerAddress, &application);
+
+        // By default the maximum allowed for the register type of each range
+        uint chunkSize = 0;
+        if (parser.isSet(chunkSizeOption)) {
+            chunkSize = parser.value(chunkSizeOption).toUInt(&valueOk);
+            if (!valueOk || chunkSize < 1) {
+                qCritical() << "Error: invalid chunk size:" << parser.value(chunkSizeOption);
+                exit(EXIT_FAILURE);
+            }
+        }
+
+        if (parser.isSet(registersJsonOption)) {
+            if (!poller->loadRegisterJson(parser.value(registersJsonOption), chunkSize)) {
+                qCritical().noquote() << "Error:" << poller->errorString();
+                exit(EXIT_FAILURE);
+            }
+        } else {
+            poller->addRange(registerType, registerAddress, length, chunkSize);
+        }
+
+        int interval = parser.value(intervalOption).toInt(&valueOk);
+        if (!valueOk || interval < 0) {
+            qCritical() << "Error: invalid interval:" << parser.value(intervalOption);
+            exit(EXIT_FAILURE);
+        }
+
+        uint count = parser.value(countOption).toUInt(&valueOk);
+        if (!valueOk) {
+            qCritical() << "Error: invalid count:" << parser.value(countOption);
+            exit(EXIT_FAILURE);
+        }
+
+        poller->setInterval(interval);
+        poller->setCycles(parser.isSet(pollOption) ? count : 1);
+        poller->setPrintValues(!parser.isSet(quietOption));
+
+        if (parser.isSet(dumpOption)) {
+            ModbusPoller::OutputFormat format = ModbusPoller::OutputFormatCsv;
+            QString formatString = parser.value(formatOption).toLower();
+            if (formatString == "csv") {
+                format = ModbusPoller::OutputFormatCsv;
+            } else if (formatString == "binary") {
+                format = ModbusPoller::OutputFormatBinary;
+            } else {
+                qCritical() << "Error: invalid dump format:" << parser.value(formatOption) << "Please select on of the valid values: [csv, binary].";
+                exit(EXIT_FAILURE);
+            }
+
+            if (!poller->setOutputFile(parser.value(dumpOption), format)) {
+                qCritical().noquote() << "Error:" << poller->errorString();
+                exit(EXIT_FAILURE);
+            }
+        }
+
+        qDebug() << "Read plan contains" << poller->requests().count() << "requests";
+
+        QObject::connect(poller, &ModbusPoller::finished, &application, [&application, poller](){
+            application.exit(poller->hasErrors() ? EXIT_FAILURE : EXIT_SUCCESS);
+        });
+
+        // Print the statistics also if the polling gets interrupted
+        QObject::connect(&application, &QCoreApplication::aboutToQuit, poller, &ModbusPoller::stop);
+        installQuitSignalHandler(&application);
+        return poller;
+    };
+
     // TCP
     if (parser.isSet(addressOption)) {
         // TCP connection
@@ -216,8 +399,10 @@ int main(int argc, char *argv[])
         QModbusTcpClient *client = new QModbusTcpClient(nullptr);
         client->setConnectionParameter(QModbusDevice::NetworkAddressParameter, address.toString());
         client->setConnectionParameter(QModbusDevice::NetworkPortParameter, port);
-        client->setTimeout(3000);
-        client->setNumberOfRetries(3);
+        client->setTimeout(timeout > 0 ? timeout : 3000);
+        client->setNumberOfRetries(retries);
+
+        ModbusPoller *poller = pollerMode ? createPoller(client) : nullptr;
 
         QObject::connect(client, &QModbusTcpClient::stateChanged, &application, [=](QModbusDevice::State state){
             if (verbose) qDebug() << "Connection state changed" << state;
@@ -225,10 +410,18 @@ int main(int argc, char *argv[])
                 return;
 
             qDebug() << "Connected successfully to" << QString("%1:%2").arg(address.toString()).arg(port);
-            sendRequest(modbusServerAddress, registerType, registerAddress, length, writeData, client);
+            if (poller) {
+                poller->start();
+            } else {
+                sendRequest(modbusServerAddress, registerType, registerAddress, length, writeData, client);
+            }
         });
 
         QObject::connect(client, &QModbusTcpClient::errorOccurred, &application, [=](QModbusDevice::Error error){
+            // Request errors are part of the statistics while polling
+            if (poller && error != QModbusDevice::ConnectionError)
+                return;
+
             qWarning() << "Modbus error occurred:" << error << client->errorString();
             exit(EXIT_FAILURE);
         });
@@ -296,8 +489,10 @@ int main(int argc, char *argv[])
         client->setConnectionParameter(QModbusDevice::SerialDataBitsParameter, dataBits);
         client->setConnectionParameter(QModbusDevice::SerialStopBitsParameter, stopBits);
         client->setConnectionParameter(QModbusDevice::SerialParityParameter, parity);
-        client->setNumberOfRetries(3);
-        client->setTimeout(500);
+        client->setNumberOfRetries(retries);
+        client->setTimeout(timeout > 0 ? timeout : 500);
+
+        ModbusPoller *poller = pollerMode ? createPoller(client) : nullptr;
 
         QObject::connect(client, &QModbusTcpClient::stateChanged, &application, [=](QModbusDevice::State state){
             qDebug() << "Connection state changed" << state;
@@ -305,13 +500,22 @@ int main(int argc, char *argv[])
                 return;
 
             qDebug() << "Connected successfully to" << serialPortName << baudrate << dataBits << stopBits << parity << "modbus server address:" << modbusServerAddress;
-            sendRequest(modbusServerAddress, registerType, registerAddress, length, writeData, client);
+            if (poller) {
+                poller->start();
+            } else {
+                sendRequest(modbusServerAddress, registerType, registerAddress, length, writeData, client);
+            }
         });
 
         QObject::connect(client, &QModbusRtuSerialMaster::errorOccurred, &application, [=](QModbusDevice::Error error){
-            if (error != QModbusDevice::NoError) {
-                exit(EXIT_FAILURE);
-            }
+            if (error == QModbusDevice::NoError)
+                return;
+
+            // Request errors are part of the statistics while polling
+            if (poller && error != QModbusDevice::ConnectionError)
+                return;
+
+            exit(EXIT_FAILURE);
         });
 
         if (!client->connectDevice()) {
@@ -345,7 +549,7 @@ void sendRequest(quint16 modbusServerAddress, QModbusDataUnit::RegisterType regi
             if (reply->error() != QModbusDevice::NoError) {
                 QModbusResponse response = reply->rawResult();
                 if (reply->error() == QModbusDevice::ProtocolError && response.isException()) {
-                    qCritical()  << "Modbus reply finished with error" << reply->error() << reply->errorString() << exceptionCodeToString(response.exceptionCode());
+                    qCritical()  << "Modbus reply finished with error" << reply->error() << reply->errorString() << ModbusPoller::exceptionCodeToString(response.exceptionCode());
                 } else {
                     qCritical()  << "Modbus reply finished with error" << reply->error() << reply->errorString();
                 }
@@ -365,7 +569,7 @@ void sendRequest(quint16 modbusServerAddress, QModbusDataUnit::RegisterType regi
         QObject::connect(reply, &QModbusReply::errorOccurred, client, [=] (QModbusDevice::Error error){
             QModbusResponse response = reply->rawResult();
             if (reply->error() == QModbusDevice::ProtocolError && response.isException()) {
-                qCritical()  << "Modbus reply error occurred" << error << reply->errorString() << exceptionCodeToString(response.exceptionCode());
+                qCritical()  << "Modbus reply error occurred" << error << reply->errorString() << ModbusPoller::exceptionCodeToString(response.exceptionCode());
             } else {
                 qCritical()  << "Modbus reply error occurred" << error << reply->errorString();
             }
@@ -395,7 +599,7 @@ void sendRequest(quint16 modbusServerAddress, QModbusDataUnit::RegisterType regi
             if (reply->error() != QModbusDevice::NoError) {
                 QModbusResponse response = reply->rawResult();
                 if (reply->error() == QModbusDevice::ProtocolError && response.isException()) {
-                    qCritical()  << "Modbus reply finished with error" << reply->error() << reply->errorString() << exceptionCodeToString(response.exceptionCode());
+                    qCritical()  << "Modbus reply finished with error" << reply->error() << reply->errorString() << ModbusPoller::exceptionCodeToString(response.exceptionCode());
                 } else {
                     qCritical()  << "Modbus reply finished with error" << reply->error() << reply->errorString();
                 }
@@ -415,52 +619,10 @@ void sendRequest(quint16 modbusServerAddress, QModbusDataUnit::RegisterType regi
         QObject::connect(reply, &QModbusReply::errorOccurred, client, [=] (QModbusDevice::Error error){
             QModbusResponse response = reply->rawResult();
             if (reply->error() == QModbusDevice::ProtocolError && response.isException()) {
-                qCritical()  << "Modbus reply error occurred" << error << reply->errorString() << exceptionCodeToString(response.exceptionCode());
+                qCritical()  << "Modbus reply error occurred" << error << reply->errorString() << ModbusPoller::exceptionCodeToString(response.exceptionCode());
             } else {
                 qCritical()  << "Modbus reply error occurred" << error << reply->errorString();
             }
         });
     }
 }
-
-QString exceptionCodeToString(QModbusPdu::ExceptionCode exception)
-{
-    QString exceptionString;
-    switch (exception) {
-    case QModbusPdu::IllegalFunction:
-        exceptionString = "Illegal function";
-        break;
-    case QModbusPdu::IllegalDataAddress:
-        exceptionString = "Illegal data address";
-        break;
-    case QModbusPdu::IllegalDataValue:
-        exceptionString = "Illegal data value";
-        break;
-    case QModbusPdu::ServerDeviceFailure:
-        exceptionString = "Server device failure";
-        break;
-    case QModbusPdu::Acknowledge:
-        exceptionString = "Acknowledge";
-        break;
-    case QModbusPdu::ServerDeviceBusy:
-        exceptionString = "Server device busy";
-        break;
-    case QModbusPdu::NegativeAcknowledge:
-        exceptionString = "Negative acknowledge";
-        break;
-    case QModbusPdu::MemoryParityError:
-        exceptionString = "Memory parity error";
-        break;
-    case QModbusPdu::GatewayPathUnavailable:
-        exceptionString = "Gateway path unavailable";
-        break;
-    case QModbusPdu::GatewayTargetDeviceFailedToRespond:
-        exceptionString = "Gateway target device failed to respond";
-        break;
-    case QModbusPdu::ExtendedException:
-        exceptionString = "Extended exception";
-        break;
-    }
-
-    return exceptionString;
-}
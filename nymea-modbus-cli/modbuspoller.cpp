@@ -0,0 +1,452 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+*
+* Copyright 2013 - 2022, nymea GmbH
+* Contact: contact@nymea.io
+*
+* This file is part of nymea.
+* This project including source code and documentation is protected by
+* copyright law, and remains the property of nymea GmbH. All rights, including
+* reproduction, publication, editing and translation, are reserved. The use of
+* this project is subject to the terms of a license agreement to be concluded
+* with nymea GmbH in accordance with the terms of use of nymea GmbH, available
+* under https://nymea.io/license
+*
+* GNU Lesser General Public License Usage
+* Alternatively, this project may be redistributed and/or modified under the
+* terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; version 3. This project is distributed in the hope that
+* it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+* warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this project. If not, see <https://www.gnu.org/licenses/>.
+*
+* For any further details and any questions please contact us under
+* contact@nymea.io or see our FAQ/Licensing Information on
+* https://nymea.io/license/faq
+*
+* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "modbuspoller.h"
+
+#include <QDebug>
+#include <QDateTime>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QJsonDocument>
+#include <QModbusReply>
+
+#include <cmath>
+#include <algorithm>
+
+ModbusPoller::ModbusPoller(QModbusClient *client, quint16 serverAddress, QObject *parent) :
+    QObject(parent),
+    m_client(client),
+    m_serverAddress(serverAddress)
+{
+    m_cycleTimer.setSingleShot(true);
+    connect(&m_cycleTimer, &QTimer::timeout, this, &ModbusPoller::startCycle);
+}
+
+QList<ModbusPoller::Request> ModbusPoller::requests() const
+{
+    return m_requests;
+}
+
+void ModbusPoller::addRange(QModbusDataUnit::RegisterType registerType, quint16 startAddress, uint length, uint chunkSize, const QString &name)
+{
+    if (chunkSize == 0)
+        chunkSize = maximumChunkSize(registerType);
+
+    chunkSize = qBound(1u, chunkSize, maximumChunkSize(registerType));
+
+    // Never read beyond the end of the address space
+    uint endAddress = qMin(static_cast<uint>(startAddress) + length, 0x10000u);
+    uint address = startAddress;
+    while (address < endAddress) {
+        Request request;
+        request.name = name;
+        request.registerType = registerType;
+        request.startAddress = static_cast<quint16>(address);
+        request.length = static_cast<quint16>(qMin(chunkSize, endAddress - address));
+        m_requests.append(request);
+        address += request.length;
+    }
+}
+
+bool ModbusPoller::loadRegisterJson(const QString &fileName, uint chunkSize)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        m_errorString = QString("Could not open %1: %2").arg(fileName).arg(file.errorString());
+        return false;
+    }
+
+    QJsonParseError error;
+    QJsonDocument jsonDoc = QJsonDocument::fromJson(file.readAll(), &error);
+    if (error.error != QJsonParseError::NoError) {
+        m_errorString = QString("Could not parse %1: %2 at offset %3").arg(fileName).arg(error.errorString()).arg(error.offset);
+        return false;
+    }
+
+    QVariantMap definition = jsonDoc.toVariant().toMap();
+
+    // Single registers, write only registers can not be read
+    foreach (const QVariant &registerVariant, definition.value("registers").toList()) {
+        QVariantMap registerMap = registerVariant.toMap();
+        if (registerMap.value("access").toString() == "WO")
+            continue;
+
+        QModbusDataUnit::RegisterType registerType = registerTypeFromString(registerMap.value("registerType").toString());
+        if (registerType == QModbusDataUnit::Invalid) {
+            m_errorString = QString("Invalid register type %1 for register %2").arg(registerMap.value("registerType").toString()).arg(registerMap.value("id").toString());
+            return false;
+        }
+
+        addRange(registerType, registerMap.value("address").toUInt(), registerMap.value("size").toUInt(), chunkSize, registerMap.value("id").toString());
+    }
+
+    // Blocks are read with one request like the generated connection does
+    foreach (const QVariant &blockVariant, definition.value("blocks").toList()) {
+        QVariantMap blockMap = blockVariant.toMap();
+        QVariantList blockRegisters = blockMap.value("registers").toList();
+        if (blockRegisters.isEmpty())
+            continue;
+
+        QVariantMap firstRegister = blockRegisters.first().toMap();
+        QVariantMap lastRegister = blockRegisters.last().toMap();
+        QModbusDataUnit::RegisterType registerType = registerTypeFromString(firstRegister.value("registerType").toString());
+        if (registerType == QModbusDataUnit::Invalid) {
+            m_errorString = QString("Invalid register type %1 for block %2").arg(firstRegister.value("registerType").toString()).arg(blockMap.value("id").toString());
+            return false;
+        }
+
+        uint startAddress = firstRegister.value("address").toUInt();
+        uint length = lastRegister.value("address").toUInt() + lastRegister.value("size").toUInt() - startAddress;
+        addRange(registerType, startAddress, length, chunkSize, blockMap.value("id").toString());
+    }
+
+    if (m_requests.isEmpty()) {
+        m_errorString = QString("No readable registers found in %1").arg(fileName);
+        return false;
+    }
+
+    return true;
+}
+
+void ModbusPoller::setInterval(int interval)
+{
+    m_interval = qMax(0, interval);
+}
+
+void ModbusPoller::setCycles(uint cycles)
+{
+    m_cycles = cycles;
+}
+
+void ModbusPoller::setPrintValues(bool printValues)
+{
+    m_printValues = printValues;
+}
+
+bool ModbusPoller::setOutputFile(const QString &fileName, OutputFormat format)
+{
+    m_outputFormat = format;
+    m_outputFile.setFileName(fileName);
+    if (!m_outputFile.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        m_errorString = QString("Could not open %1: %2").arg(fileName).arg(m_outputFile.errorString());
+        return false;
+    }
+
+    m_outputStream.setDevice(&m_outputFile);
+    if (m_outputFormat == OutputFormatCsv) {
+        m_outputFile.write("cycle,timestamp,name,type,register,value\n");
+    }
+
+    return true;
+}
+
+QString ModbusPoller::errorString() const
+{
+    return m_errorString;
+}
+
+bool ModbusPoller::hasErrors() const
+{
+    return m_timeoutCount > 0 || m_errorCount > 0;
+}
+
+uint ModbusPoller::maximumChunkSize(QModbusDataUnit::RegisterType registerType)
+{
+    // Limited by the maximal PDU size of 253 bytes
+    switch (registerType) {
+    case QModbusDataUnit::Coils:
+    case QModbusDataUnit::DiscreteInputs:
+        return 2000;
+    default:
+        return 125;
+    }
+}
+
+QString ModbusPoller::exceptionCodeToString(QModbusPdu::ExceptionCode exception)
+{
+    QString exceptionString;
+    switch (exception) {
+    case QModbusPdu::IllegalFunction:
+        exceptionString = "Illegal function";
+        break;
+    case QModbusPdu::IllegalDataAddress:
+        exceptionString = "Illegal data address";
+        break;
+    case QModbusPdu::IllegalDataValue:
+        exceptionString = "Illegal data value";
+        break;
+    case QModbusPdu::ServerDeviceFailure:
+        exceptionString = "Server device failure";
+        break;
+    case QModbusPdu::Acknowledge:
+        exceptionString = "Acknowledge";
+        break;
+    case QModbusPdu::ServerDeviceBusy:
+        exceptionString = "Server device busy";
+        break;
+    case QModbusPdu::NegativeAcknowledge:
+        exceptionString = "Negative acknowledge";
+        break;
+    case QModbusPdu::MemoryParityError:
+        exceptionString = "Memory parity error";
+        break;
+    case QModbusPdu::GatewayPathUnavailable:
+        exceptionString = "Gateway path unavailable";
+        break;
+    case QModbusPdu::GatewayTargetDeviceFailedToRespond:
+        exceptionString = "Gateway target device failed to respond";
+        break;
+    case QModbusPdu::ExtendedException:
+        exceptionString = "Extended exception";
+        break;
+    }
+
+    return exceptionString;
+}
+
+void ModbusPoller::start()
+{
+    if (m_running)
+        return;
+
+    if (m_requests.isEmpty()) {
+        qCritical() << "Nothing to read. The read plan is empty.";
+        emit finished();
+        return;
+    }
+
+    qDebug() << "Start polling" << m_requests.count() << "requests" << (m_cycles == 0 ? QString("until stopped") : QString("%1 times").arg(m_cycles)) << "interval" << m_interval << "ms";
+    m_running = true;
+    m_currentCycle = 0;
+    m_totalElapsedTimer.start();
+    startCycle();
+}
+
+void ModbusPoller::stop()
+{
+    if (!m_running)
+        return;
+
+    m_running = false;
+    m_cycleTimer.stop();
+
+    if (m_outputFile.isOpen()) {
+        m_outputFile.close();
+        qInfo().noquote() << "Wrote values to" << m_outputFile.fileName();
+    }
+
+    printStatistics();
+    emit finished();
+}
+
+void ModbusPoller::startCycle()
+{
+    if (!m_running)
+        return;
+
+    m_cycleElapsedTimer.start();
+    m_currentRequest = 0;
+    sendNextRequest();
+}
+
+void ModbusPoller::sendNextRequest()
+{
+    if (!m_running)
+        return;
+
+    if (m_currentRequest >= m_requests.count()) {
+        finishCycle();
+        return;
+    }
+
+    Request request = m_requests.at(m_currentRequest);
+    QModbusDataUnit dataUnit(request.registerType, request.startAddress, request.length);
+
+    m_requestCount++;
+    QElapsedTimer requestTimer;
+    requestTimer.start();
+    QModbusReply *reply = m_client->sendReadRequest(dataUnit, m_serverAddress);
+    if (!reply) {
+        qWarning() << "Failed to send read request" << request.registerType << request.startAddress << "length" << request.length << m_client->errorString();
+        m_errorCount++;
+        writeEmptyValues(request);
+        m_currentRequest++;
+        QTimer::singleShot(0, this, &ModbusPoller::sendNextRequest);
+        return;
+    }
+
+    if (reply->isFinished()) {
+        processReply(reply, request, requestTimer.nsecsElapsed() / 1000);
+        reply->deleteLater();
+        m_currentRequest++;
+        QTimer::singleShot(0, this, &ModbusPoller::sendNextRequest);
+        return;
+    }
+
+    connect(reply, &QModbusReply::finished, reply, &QModbusReply::deleteLater);
+    connect(reply, &QModbusReply::finished, this, [=]() {
+        processReply(reply, request, requestTimer.nsecsElapsed() / 1000);
+        m_currentRequest++;
+        sendNextRequest();
+    });
+}
+
+void ModbusPoller::finishCycle()
+{
+    m_currentCycle++;
+    qint64 cycleDuration = m_cycleElapsedTimer.elapsed();
+    qDebug() << "Cycle" << m_currentCycle << "finished in" << cycleDuration << "ms";
+
+    if (m_cycles != 0 && m_currentCycle >= m_cycles) {
+        stop();
+        return;
+    }
+
+    // The interval is measured from cycle start to cycle start
+    qint64 remainingTime = m_interval - cycleDuration;
+    if (m_interval > 0 && remainingTime < 0) {
+        qWarning() << "Cycle" << m_currentCycle << "took" << cycleDuration << "ms and exceeded the interval of" << m_interval << "ms";
+        m_overrunCount++;
+    }
+
+    m_cycleTimer.start(static_cast<int>(qMax<qint64>(0, remainingTime)));
+}
+
+void ModbusPoller::processReply(QModbusReply *reply, const Request &request, qint64 latency)
+{
+    if (reply->error() != QModbusDevice::NoError) {
+        QModbusResponse response = reply->rawResult();
+        if (reply->error() == QModbusDevice::ProtocolError && response.isException()) {
+            qWarning() << "Modbus reply finished with error" << request.registerType << request.startAddress << "length" << request.length << reply->error() << reply->errorString() << exceptionCodeToString(response.exceptionCode());
+        } else {
+            qWarning() << "Modbus reply finished with error" << request.registerType << request.startAddress << "length" << request.length << reply->error() << reply->errorString();
+        }
+
+        if (reply->error() == QModbusDevice::TimeoutError) {
+            m_timeoutCount++;
+        } else {
+            m_errorCount++;
+        }
+
+        writeEmptyValues(request);
+        return;
+    }
+
+    m_latencies.append(latency);
+
+    const QModbusDataUnit unit = reply->result();
+    m_registerCount += unit.valueCount();
+
+    if (m_printValues) {
+        for (uint i = 0; i < unit.valueCount(); i++) {
+            quint16 registerValue = unit.values().at(i);
+            quint16 registerNumber = unit.startAddress() + i;
+            qInfo() << "-->" << registerNumber << ":" << QString("0x%1").arg(registerValue, 4, 16, QLatin1Char('0')) << registerValue;
+        }
+    }
+
+    writeValues(request, unit.values());
+}
+
+void ModbusPoller::writeValues(const Request &request, const QVector<quint16> &values)
+{
+    if (!m_outputFile.isOpen())
+        return;
+
+    if (m_outputFormat == OutputFormatBinary) {
+        // Raw register values in big endian, in the order of the read plan
+        foreach (quint16 value, values)
+            m_outputStream << value;
+
+        return;
+    }
+
+    QString timestamp = QDateTime::currentDateTime().toString(Qt::ISODateWithMs);
+    for (int i = 0; i < values.count(); i++) {
+        m_outputFile.write(QString("%1,%2,%3,%4,%5,%6\n").arg(m_currentCycle).arg(timestamp).arg(request.name).arg(request.registerType).arg(request.startAddress + i).arg(values.at(i)).toUtf8());
+    }
+}
+
+void ModbusPoller::writeEmptyValues(const Request &request)
+{
+    // Keep the offsets of the binary dump intact for failed requests
+    if (m_outputFile.isOpen() && m_outputFormat == OutputFormatBinary) {
+        writeValues(request, QVector<quint16>(request.length, 0));
+    }
+}
+
+void ModbusPoller::printStatistics() const
+{
+    double totalSeconds = m_totalElapsedTimer.elapsed() / 1000.0;
+
+    qInfo().noquote() << "-----------------------------------------";
+    qInfo().noquote() << QString("Cycles: %1, requests: %2, succeeded: %3, timeouts: %4, errors: %5").arg(m_currentCycle).arg(m_requestCount).arg(m_latencies.count()).arg(m_timeoutCount).arg(m_errorCount);
+    if (m_interval > 0 && m_cycles != 1)
+        qInfo().noquote() << QString("Interval overruns: %1").arg(m_overrunCount);
+
+    if (m_latencies.isEmpty())
+        return;
+
+    QVector<qint64> latencies = m_latencies;
+    std::sort(latencies.begin(), latencies.end());
+
+    qint64 sum = 0;
+    foreach (qint64 latency, latencies)
+        sum += latency;
+
+    int p99Index = qMax(0, static_cast<int>(std::ceil(latencies.count() * 0.99)) - 1);
+    qInfo().noquote() << QString("Latency [ms]: min %1, avg %2, p99 %3, max %4")
+                         .arg(latencies.first() / 1000.0, 0, 'f', 3)
+                         .arg(sum / 1000.0 / latencies.count(), 0, 'f', 3)
+                         .arg(latencies.at(p99Index) / 1000.0, 0, 'f', 3)
+                         .arg(latencies.last() / 1000.0, 0, 'f', 3);
+
+    if (totalSeconds > 0) {
+        qInfo().noquote() << QString("Throughput: %1 requests/s, %2 registers/s in %3 s")
+                             .arg(m_requestCount / totalSeconds, 0, 'f', 1)
+                             .arg(m_registerCount / totalSeconds, 0, 'f', 1)
+                             .arg(totalSeconds, 0, 'f', 3);
+    }
+}
+
+QModbusDataUnit::RegisterType ModbusPoller::registerTypeFromString(const QString &registerType)
+{
+    if (registerType == "inputRegister") {
+        return QModbusDataUnit::InputRegisters;
+    } else if (registerType == "holdingRegister") {
+        return QModbusDataUnit::HoldingRegisters;
+    } else if (registerType == "discreteInputs") {
+        return QModbusDataUnit::DiscreteInputs;
+    } else if (registerType == "coils") {
+        return QModbusDataUnit::Coils;
+    }
+
+    return QModbusDataUnit::Invalid;
+}
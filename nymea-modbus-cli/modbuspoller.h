@@ -0,0 +1,137 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+*
+* Copyright 2013 - 2022, nymea GmbH
+* Contact: contact@nymea.io
+*
+* This file is part of nymea.
+* This project including source code and documentation is protected by
+* copyright law, and remains the property of nymea GmbH. All rights, including
+* reproduction, publication, editing and translation, are reserved. The use of
+* this project is subject to the terms of a license agreement to be concluded
+* with nymea GmbH in accordance with the terms of use of nymea GmbH, available
+* under https://nymea.io/license
+*
+* GNU Lesser General Public License Usage
+* Alternatively, this project may be redistributed and/or modified under the
+* terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; version 3. This project is distributed in the hope that
+* it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+* warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this project. If not, see <https://www.gnu.org/licenses/>.
+*
+* For any further details and any questions please contact us under
+* contact@nymea.io or see our FAQ/Licensing Information on
+* https://nymea.io/license/faq
+*
+* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef MODBUSPOLLER_H
+#define MODBUSPOLLER_H
+
+#include <QFile>
+#include <QTimer>
+#include <QObject>
+#include <QVector>
+#include <QDataStream>
+#include <QElapsedTimer>
+#include <QModbusClient>
+
+// Executes a plan of read requests sequentially on a modbus client, either once or
+// repeatedly in a fixed interval, and collects latency statistics for each request.
+// The received values can be printed and/or written to a CSV or binary output file.
+
+class ModbusPoller : public QObject
+{
+    Q_OBJECT
+public:
+    enum OutputFormat {
+        OutputFormatCsv,
+        OutputFormatBinary
+    };
+    Q_ENUM(OutputFormat)
+
+    typedef struct Request {
+        QString name;
+        QModbusDataUnit::RegisterType registerType = QModbusDataUnit::HoldingRegisters;
+        quint16 startAddress = 0;
+        quint16 length = 1;
+    } Request;
+
+    explicit ModbusPoller(QModbusClient *client, quint16 serverAddress, QObject *parent = nullptr);
+
+    QList<Request> requests() const;
+
+    // Add a register range, split into requests of at most chunkSize registers. A chunk size of 0
+    // uses the maximum allowed for the register type.
+    void addRange(QModbusDataUnit::RegisterType registerType, quint16 startAddress, uint length, uint chunkSize, const QString &name = QString());
+
+    // Use the registers and blocks of a *-registers.json connection definition as read plan, the
+    // chunk size is applied like in addRange() for the register type of each register and block
+    bool loadRegisterJson(const QString &fileName, uint chunkSize);
+
+    // Interval between the start of two cycles in ms, 0 polls as fast as possible
+    void setInterval(int interval);
+
+    // Number of cycles to run, 0 polls until stopped
+    void setCycles(uint cycles);
+
+    void setPrintValues(bool printValues);
+
+    bool setOutputFile(const QString &fileName, OutputFormat format);
+
+    QString errorString() const;
+    bool hasErrors() const;
+
+    static uint maximumChunkSize(QModbusDataUnit::RegisterType registerType);
+    static QString exceptionCodeToString(QModbusPdu::ExceptionCode exception);
+
+public slots:
+    void start();
+    void stop();
+
+signals:
+    void finished();
+
+private:
+    QModbusClient *m_client = nullptr;
+    quint16 m_serverAddress = 1;
+    QList<Request> m_requests;
+    int m_interval = 1000;
+    uint m_cycles = 1;
+    bool m_printValues = true;
+    QString m_errorString;
+
+    QFile m_outputFile;
+    QDataStream m_outputStream;
+    OutputFormat m_outputFormat = OutputFormatCsv;
+
+    QTimer m_cycleTimer;
+    QElapsedTimer m_cycleElapsedTimer;
+    QElapsedTimer m_totalElapsedTimer;
+    bool m_running = false;
+    uint m_currentCycle = 0;
+    int m_currentRequest = 0;
+
+    // Statistics
+    QVector<qint64> m_latencies; // us
+    uint m_requestCount = 0;
+    uint m_timeoutCount = 0;
+    uint m_errorCount = 0;
+    uint m_overrunCount = 0;
+    quint64 m_registerCount = 0;
+
+    void startCycle();
+    void sendNextRequest();
+    void finishCycle();
+    void processReply(QModbusReply *reply, const Request &request, qint64 latency);
+    void writeValues(const Request &request, const QVector<quint16> &values);
+    void writeEmptyValues(const Request &request);
+    void printStatistics() const;
+
+    static QModbusDataUnit::RegisterType registerTypeFromString(const QString &registerType);
+};
+
+#endif // MODBUSPOLLER_H
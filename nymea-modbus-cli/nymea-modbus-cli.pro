@@ -15,8 +15,12 @@ gcc {
     greaterThan(COMPILER_MAJOR_VERSION, 7): QMAKE_CXXFLAGS += -Wno-deprecated-copy
 }
 
+HEADERS += \
+        modbuspoller.h
+
 SOURCES += \
-        main.cpp
+        main.cpp \
+        modbuspoller.cpp
 
 target.path = $$[QT_INSTALL_PREFIX]/bin
 INSTALLS += target
@@ -0,0 +1,108 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+*
+* Copyright 2013 - 2024, nymea GmbH
+* Contact: contact@nymea.io
+*
+* This file is part of nymea.
+* This project including source code and documentation is protected by
+* copyright law, and remains the property of nymea GmbH. All rights, including
+* reproduction, publication, editing and translation, are reserved. The use of
+* this project is subject to the terms of a license agreement to be concluded
+* with nymea GmbH in accordance with the terms of use of nymea GmbH, available
+* under https://nymea.io/license
+*
+* GNU Lesser General Public License Usage
+* Alternatively, this project may be redistributed and/or modified under the
+* terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; version 3. This project is distributed in the hope that
+* it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+* warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this project. If not, see <https://www.gnu.org/licenses/>.
+*
+* For any further details and any questions please contact us under
+* contact@nymea.io or see our FAQ/Licensing Information on
+* https://nymea.io/license/faq
+*
+* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "faultinjection.h"
+
+#include <QtGlobal>
+#include <QModbusPdu>
+#include <QRandomGenerator>
+
+int FaultInjection::latency() const
+{
+    return m_latency;
+}
+
+void FaultInjection::setLatency(int latency)
+{
+    m_latency = qMax(0, latency);
+}
+
+int FaultInjection::jitter() const
+{
+    return m_jitter;
+}
+
+void FaultInjection::setJitter(int jitter)
+{
+    m_jitter = qMax(0, jitter);
+}
+
+double FaultInjection::timeoutRate() const
+{
+    return m_timeoutRate;
+}
+
+void FaultInjection::setTimeoutRate(double timeoutRate)
+{
+    m_timeoutRate = qBound(0.0, timeoutRate, 100.0);
+}
+
+double FaultInjection::exceptionRate() const
+{
+    return m_exceptionRate;
+}
+
+void FaultInjection::setExceptionRate(double exceptionRate)
+{
+    m_exceptionRate = qBound(0.0, exceptionRate, 100.0);
+}
+
+bool FaultInjection::isActive() const
+{
+    return m_latency > 0 || m_jitter > 0 || m_timeoutRate > 0 || m_exceptionRate > 0;
+}
+
+int FaultInjection::nextDelay() const
+{
+    if (m_jitter == 0)
+        return m_latency;
+
+    return qMax(0, m_latency + QRandomGenerator::global()->bounded(-m_jitter, m_jitter + 1));
+}
+
+FaultInjection::Fault FaultInjection::nextFault() const
+{
+    double random = QRandomGenerator::global()->generateDouble() * 100;
+    if (random < m_timeoutRate)
+        return FaultTimeout;
+
+    if (random < m_timeoutRate + m_exceptionRate)
+        return FaultException;
+
+    return FaultNone;
+}
+
+QByteArray FaultInjection::exceptionPdu(quint8 functionCode)
+{
+    QByteArray pdu;
+    pdu.append(static_cast<char>(functionCode | QModbusPdu::ExceptionByte));
+    pdu.append(static_cast<char>(QModbusPdu::ServerDeviceBusy));
+    return pdu;
+}
@@ -0,0 +1,79 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+*
+* Copyright 2013 - 2024, nymea GmbH
+* Contact: contact@nymea.io
+*
+* This file is part of nymea.
+* This project including source code and documentation is protected by
+* copyright law, and remains the property of nymea GmbH. All rights, including
+* reproduction, publication, editing and translation, are reserved. The use of
+* this project is subject to the terms of a license agreement to be concluded
+* with nymea GmbH in accordance with the terms of use of nymea GmbH, available
+* under https://nymea.io/license
+*
+* GNU Lesser General Public License Usage
+* Alternatively, this project may be redistributed and/or modified under the
+* terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; version 3. This project is distributed in the hope that
+* it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+* warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this project. If not, see <https://www.gnu.org/licenses/>.
+*
+* For any further details and any questions please contact us under
+* contact@nymea.io or see our FAQ/Licensing Information on
+* https://nymea.io/license/faq
+*
+* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef FAULTINJECTION_H
+#define FAULTINJECTION_H
+
+#include <QByteArray>
+
+// Decides for each response of a simulated device how long it gets delayed
+// and whether it gets dropped (timeout) or replaced by an exception.
+
+class FaultInjection
+{
+public:
+    enum Fault {
+        FaultNone,
+        FaultTimeout,
+        FaultException
+    };
+
+    FaultInjection() = default;
+
+    // Response latency in ms, each response gets delayed by latency +- jitter
+    int latency() const;
+    void setLatency(int latency);
+
+    int jitter() const;
+    void setJitter(int jitter);
+
+    // Probabilities in percent
+    double timeoutRate() const;
+    void setTimeoutRate(double timeoutRate);
+
+    double exceptionRate() const;
+    void setExceptionRate(double exceptionRate);
+
+    bool isActive() const;
+
+    int nextDelay() const;
+    Fault nextFault() const;
+
+    // Server device busy exception PDU for the given request function code
+    static QByteArray exceptionPdu(quint8 functionCode);
+
+private:
+    int m_latency = 0;
+    int m_jitter = 0;
+    double m_timeoutRate = 0;
+    double m_exceptionRate = 0;
+};
+
+#endif // FAULTINJECTION_H
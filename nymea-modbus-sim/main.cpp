@@ -0,0 +1,347 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+*
+* Copyright 2013 - 2024, nymea GmbH
+* Contact: contact@nymea.io
+*
+* This file is part of nymea.
+* This project including source code and documentation is protected by
+* copyright law, and remains the property of nymea GmbH. All rights, including
+* reproduction, publication, editing and translation, are reserved. The use of
+* this project is subject to the terms of a license agreement to be concluded
+* with nymea GmbH in accordance with the terms of use of nymea GmbH, available
+* under https://nymea.io/license
+*
+* GNU Lesser General Public License Usage
+* Alternatively, this project may be redistributed and/or modified under the
+* terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; version 3. This project is distributed in the hope that
+* it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+* warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this project. If not, see <https://www.gnu.org/licenses/>.
+*
+* For any further details and any questions please contact us under
+* contact@nymea.io or see our FAQ/Licensing Information on
+* https://nymea.io/license/faq
+*
+* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QCommandLineOption>
+
+#include <QSet>
+#include <QDebug>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QHostAddress>
+#include <QSocketNotifier>
+#include <QModbusTcpServer>
+#include <QModbusRtuSerialSlave>
+#include <QLoggingCategory>
+
+#include <csignal>
+#include <unistd.h>
+#include <sys/socket.h>
+
+#include "ptybridge.h"
+#include "tcpfaultproxy.h"
+#include "faultinjection.h"
+#include "valueanimation.h"
+#include "simulateddevice.h"
+
+// Socket pair the signal handler writes to, the event loop quits once it becomes readable
+static int s_quitSignalSockets[2] = {-1, -1};
+
+void onQuitSignal(int)
+{
+    // Only async signal safe calls are allowed in here
+    char signal = 1;
+    ssize_t written = ::write(s_quitSignalSockets[0], &signal, sizeof(signal));
+    Q_UNUSED(written)
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication application(argc, argv);
+    application.setApplicationName("nymea-modbus-sim");
+    application.setOrganizationName("nymea");
+    application.setApplicationVersion("1.0.0");
+
+    QString description = QString("\nTool for simulating Modbus TCP or RTU devices defined by register JSON files.\n\n");
+    description.append(QString("Copyright %1 2024 nymea GmbH <contact@nymea.io>\n\n").arg(QChar(0xA9)));
+
+    description.append("TCP\n");
+    description.append("-----------------------------------------\n");
+    description.append("Each simulated device listens on its own port, starting at the given port.\n\n");
+    description.append("Example simulating 100 Huawei inverters on the ports 5020 - 5119:\n");
+    description.append("nymea-modbus-sim -p 5020 -n 100 huawei-fusion-solar-registers.json\n\n");
+
+    description.append("RTU\n");
+    description.append("-----------------------------------------\n");
+    description.append("Each simulated device gets its own pseudo terminal, the clients open <link><n>.\n\n");
+    description.append("Example simulating a Senseair S8 with a ramping CO2 value on /tmp/ttySim0:\n");
+    description.append("nymea-modbus-sim --pty /tmp/ttySim --animate spaceCo2=ramp:400:2000:60 s8-registers.json\n\n");
+
+    description.append("Animations\n");
+    description.append("-----------------------------------------\n");
+    description.append("const:<value>               Fixed value\n");
+    description.append("ramp:<min>:<max>:<period>   Sawtooth from min to max within period seconds\n");
+    description.append("sine:<min>:<max>:<period>   Sine wave between min and max with period seconds\n");
+    description.append("noise:<center>:<amplitude>  Random value within center +- amplitude\n");
+    description.append("trace:<file>[:<step>]       Values from a file, advancing every step seconds (default 1)\n\n");
+    description.append("Values are given in the unit of the register, static scale factors get applied.\n");
+
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    parser.addVersionOption();
+    parser.setApplicationDescription(description);
+    parser.addPositionalArgument("registers", "The register JSON files of the devices to simulate.", "<*-registers.json...>");
+
+    // TCP
+    QCommandLineOption addressOption(QStringList() << "a" << "address", QString("TCP: The address to listen on. Default is any."), "address");
+    parser.addOption(addressOption);
+
+    QCommandLineOption portOption(QStringList() << "p" << "port", QString("TCP: The port of the first simulated device. Default is 5020."), "port");
+    portOption.setDefaultValue("5020");
+    parser.addOption(portOption);
+
+    // RTU
+    QCommandLineOption ptyOption(QStringList() << "pty", QString("RTU: Simulate RTU devices on pseudo terminals linked to <link><n> instead of TCP."), "link");
+    parser.addOption(ptyOption);
+
+    // General
+    QCommandLineOption modbusServerAddressOption(QStringList() << "m" << "modbus-address", QString("The modbus server address (slave ID) of the simulated devices. Default is 1."), "id");
+    modbusServerAddressOption.setDefaultValue("1");
+    parser.addOption(modbusServerAddressOption);
+
+    QCommandLineOption instancesOption(QStringList() << "n" << "instances", QString("The number of simulated devices per register file. Default is 1."), "count");
+    instancesOption.setDefaultValue("1");
+    parser.addOption(instancesOption);
+
+    QCommandLineOption animateOption(QStringList() << "animate", QString("Animate the register with the given id. Can be used multiple times."), "id=animation");
+    parser.addOption(animateOption);
+
+    QCommandLineOption updateIntervalOption(QStringList() << "update-interval", QString("The interval of the value animations in ms. Default is 1000."), "ms");
+    updateIntervalOption.setDefaultValue("1000");
+    parser.addOption(updateIntervalOption);
+
+    // Fault injection
+    QCommandLineOption latencyOption(QStringList() << "latency", QString("Delay each response by the given time in ms. Default is 0."), "ms");
+    latencyOption.setDefaultValue("0");
+    parser.addOption(latencyOption);
+
+    QCommandLineOption jitterOption(QStringList() << "jitter", QString("Vary the latency randomly by up to the given time in ms. Default is 0."), "ms");
+    jitterOption.setDefaultValue("0");
+    parser.addOption(jitterOption);
+
+    QCommandLineOption timeoutRateOption(QStringList() << "timeout-rate", QString("The percentage of responses which get dropped. Default is 0."), "percent");
+    timeoutRateOption.setDefaultValue("0");
+    parser.addOption(timeoutRateOption);
+
+    QCommandLineOption exceptionRateOption(QStringList() << "exception-rate", QString("The percentage of responses which get replaced by a server device busy exception. Default is 0."), "percent");
+    exceptionRateOption.setDefaultValue("0");
+    parser.addOption(exceptionRateOption);
+
+    QCommandLineOption debugOption(QStringList() << "d" << "debug", QString("Print more information."));
+    parser.addOption(debugOption);
+
+    parser.process(application);
+
+    bool verbose = parser.isSet(debugOption);
+    if (!verbose) QLoggingCategory::setFilterRules("*.debug=false");
+
+    QStringList registerFiles = parser.positionalArguments();
+    if (registerFiles.isEmpty()) {
+        qCritical() << "Error: no register JSON file given.";
+        parser.showHelp(EXIT_FAILURE);
+    }
+
+    bool valueOk = false;
+    quint16 modbusServerAddress = parser.value(modbusServerAddressOption).toUInt(&valueOk);
+    if (modbusServerAddress < 1 || modbusServerAddress > 247 || !valueOk) {
+        qCritical() << "Error: invalid modbus server address (slave ID):" << parser.value(modbusServerAddressOption);
+        exit(EXIT_FAILURE);
+    }
+
+    int instances = parser.value(instancesOption).toInt(&valueOk);
+    if (instances < 1 || !valueOk) {
+        qCritical() << "Error: invalid number of instances:" << parser.value(instancesOption);
+        exit(EXIT_FAILURE);
+    }
+
+    int updateInterval = parser.value(updateIntervalOption).toInt(&valueOk);
+    if (updateInterval < 1 || !valueOk) {
+        qCritical() << "Error: invalid update interval:" << parser.value(updateIntervalOption);
+        exit(EXIT_FAILURE);
+    }
+
+    FaultInjection faultInjection;
+    faultInjection.setLatency(parser.value(latencyOption).toInt());
+    faultInjection.setJitter(parser.value(jitterOption).toInt());
+    faultInjection.setTimeoutRate(parser.value(timeoutRateOption).toDouble());
+    faultInjection.setExceptionRate(parser.value(exceptionRateOption).toDouble());
+
+    QHash<QString, ValueAnimation> animations;
+    foreach (const QString &animationString, parser.values(animateOption)) {
+        int separatorIndex = animationString.indexOf('=');
+        if (separatorIndex <= 0) {
+            qCritical() << "Error: invalid animation:" << animationString << "Expected <id>=<animation>";
+            exit(EXIT_FAILURE);
+        }
+
+        QString errorString;
+        ValueAnimation animation = ValueAnimation::fromString(animationString.mid(separatorIndex + 1), &errorString);
+        if (!animation.isValid()) {
+            qCritical().noquote() << "Error:" << errorString;
+            exit(EXIT_FAILURE);
+        }
+
+        animations.insert(animationString.left(separatorIndex), animation);
+    }
+
+    QHostAddress address = QHostAddress::Any;
+    if (parser.isSet(addressOption)) {
+        address = QHostAddress(parser.value(addressOption));
+        if (address.isNull()) {
+            qCritical() << "Error: invalid address:" << parser.value(addressOption);
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    quint16 port = parser.value(portOption).toUInt(&valueOk);
+    if (!valueOk || port == 0) {
+        qCritical() << "Error: invalid port:" << parser.value(portOption);
+        exit(EXIT_FAILURE);
+    }
+
+    // Each TCP device gets its own port counting up from the given one
+    int deviceCount = registerFiles.count() * instances;
+    if (!parser.isSet(ptyOption) && port + deviceCount - 1 > 65535) {
+        qCritical() << "Error: the ports for" << deviceCount << "devices starting at" << port << "exceed 65535";
+        exit(EXIT_FAILURE);
+    }
+
+    QList<SimulatedDevice *> devices;
+    QSet<QString> animatedRegisters;
+    int deviceIndex = 0;
+    foreach (const QString &registerFile, registerFiles) {
+        for (int i = 0; i < instances; i++) {
+            QModbusServer *server = nullptr;
+            TcpFaultProxy *proxy = nullptr;
+            quint16 devicePort = 0;
+            QString location;
+
+            if (parser.isSet(ptyOption)) {
+                PtyBridge *ptyBridge = new PtyBridge(faultInjection, &application);
+                if (!ptyBridge->open(parser.value(ptyOption) + QString::number(deviceIndex))) {
+                    qCritical().noquote() << "Error:" << ptyBridge->errorString();
+                    exit(EXIT_FAILURE);
+                }
+
+                server = new QModbusRtuSerialSlave();
+                server->setConnectionParameter(QModbusDevice::SerialPortNameParameter, ptyBridge->serverPortName());
+                location = ptyBridge->clientPortName();
+            } else {
+                devicePort = static_cast<quint16>(port + deviceIndex);
+                quint16 serverPort = devicePort;
+                QHostAddress serverAddress = address;
+
+                // The fault proxy takes the public port, the server listens internally on a port
+                // picked by the system and the proxy starts once the server is bound
+                if (faultInjection.isActive()) {
+                    serverPort = 0;
+                    serverAddress = QHostAddress::LocalHost;
+                    proxy = new TcpFaultProxy(faultInjection, &application);
+                }
+
+                server = new QModbusTcpServer();
+                server->setConnectionParameter(QModbusDevice::NetworkAddressParameter, serverAddress.toString());
+                server->setConnectionParameter(QModbusDevice::NetworkPortParameter, serverPort);
+                location = QString("%1:%2").arg(address.toString()).arg(devicePort);
+            }
+
+            server->setServerAddress(modbusServerAddress);
+
+            SimulatedDevice *device = new SimulatedDevice(server, &application);
+            if (!device->loadRegisterJson(registerFile)) {
+                qCritical().noquote() << "Error:" << device->errorString();
+                exit(EXIT_FAILURE);
+            }
+
+            foreach (const QString &registerId, animations.keys()) {
+                if (device->setAnimation(registerId, animations.value(registerId))) {
+                    animatedRegisters.insert(registerId);
+                }
+            }
+
+            QObject::connect(server, &QModbusServer::errorOccurred, &application, [=](QModbusDevice::Error error){
+                if (error != QModbusDevice::NoError) {
+                    qWarning().noquote() << "Modbus error occurred on" << location << error << server->errorString();
+                }
+            });
+
+            if (!server->connectDevice()) {
+                qCritical().noquote() << "Error: could not start" << device->name() << "on" << location << server->errorString();
+                exit(EXIT_FAILURE);
+            }
+
+            if (proxy) {
+                quint16 serverPort = TcpFaultProxy::listeningPort(qobject_cast<QModbusTcpServer *>(server));
+                if (serverPort == 0 || !proxy->listen(address, devicePort, serverPort)) {
+                    qCritical().noquote() << "Error: could not listen on port" << devicePort << proxy->errorString();
+                    exit(EXIT_FAILURE);
+                }
+            }
+
+            qInfo().noquote() << "Simulating" << device->name() << "on" << location << "modbus server address:" << modbusServerAddress;
+            devices.append(device);
+            deviceIndex++;
+        }
+    }
+
+    foreach (const QString &registerId, animations.keys()) {
+        if (!animatedRegisters.contains(registerId)) {
+            qWarning().noquote() << "Warning: none of the simulated devices has a register" << registerId;
+        }
+    }
+
+    if (faultInjection.isActive()) {
+        qInfo().noquote() << QString("Fault injection: latency %1 ms +- %2 ms, timeouts %3 %, exceptions %4 %").arg(faultInjection.latency()).arg(faultInjection.jitter()).arg(faultInjection.timeoutRate()).arg(faultInjection.exceptionRate());
+    }
+
+    QElapsedTimer elapsedTimer;
+    elapsedTimer.start();
+
+    QTimer updateTimer;
+    updateTimer.setInterval(updateInterval);
+    QObject::connect(&updateTimer, &QTimer::timeout, &application, [&devices, &elapsedTimer](){
+        foreach (SimulatedDevice *device, devices) {
+            device->update(elapsedTimer.elapsed());
+        }
+    });
+
+    if (!animations.isEmpty())
+        updateTimer.start();
+
+    // Make sure the pty links get removed
+    if (::socketpair(AF_UNIX, SOCK_STREAM, 0, s_quitSignalSockets) == 0) {
+        QSocketNotifier *quitNotifier = new QSocketNotifier(s_quitSignalSockets[1], QSocketNotifier::Read, &application);
+        QObject::connect(quitNotifier, &QSocketNotifier::activated, &application, [quitNotifier](){
+            char signal;
+            ssize_t bytesRead = ::read(s_quitSignalSockets[1], &signal, sizeof(signal));
+            Q_UNUSED(bytesRead)
+            quitNotifier->setEnabled(false);
+            QCoreApplication::quit();
+        });
+
+        std::signal(SIGINT, onQuitSignal);
+        std::signal(SIGTERM, onQuitSignal);
+    } else {
+        qWarning() << "Could not create the signal socket pair, the pty links will not be removed on SIGINT and SIGTERM.";
+    }
+
+    return application.exec();
+}
@@ -0,0 +1,278 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+*
+* Copyright 2013 - 2024, nymea GmbH
+* Contact: contact@nymea.io
+*
+* This file is part of nymea.
+* This project including source code and documentation is protected by
+* copyright law, and remains the property of nymea GmbH. All rights, including
+* reproduction, publication, editing and translation, are reserved. The use of
+* this project is subject to the terms of a license agreement to be concluded
+* with nymea GmbH in accordance with the terms of use of nymea GmbH, available
+* under https://nymea.io/license
+*
+* GNU Lesser General Public License Usage
+* Alternatively, this project may be redistributed and/or modified under the
+* terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; version 3. This project is distributed in the hope that
+* it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+* warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this project. If not, see <https://www.gnu.org/licenses/>.
+*
+* For any further details and any questions please contact us under
+* contact@nymea.io or see our FAQ/Licensing Information on
+* https://nymea.io/license/faq
+*
+* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "ptybridge.h"
+
+#include <QFile>
+#include <QDebug>
+#include <QDateTime>
+#include <QFileInfo>
+
+#include <pty.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+#include <termios.h>
+
+PtyBridge::PtyBridge(const FaultInjection &faultInjection, QObject *parent) :
+    QObject(parent),
+    m_faultInjection(faultInjection)
+{
+    m_deliveryTimer = new QTimer(this);
+    m_deliveryTimer->setSingleShot(true);
+    connect(m_deliveryTimer, &QTimer::timeout, this, &PtyBridge::deliverResponses);
+}
+
+PtyBridge::~PtyBridge()
+{
+    close();
+}
+
+bool PtyBridge::open(const QString &linkPath)
+{
+    if (!openPty(&m_serverMaster, &m_serverSlave, &m_serverPortName) || !openPty(&m_clientMaster, &m_clientSlave, &m_clientPortName)) {
+        close();
+        return false;
+    }
+
+    if (!linkPath.isEmpty()) {
+        // Replace stale links from previous runs, but never a real file
+        QFileInfo linkInfo(linkPath);
+        if (linkInfo.isSymLink())
+            QFile::remove(linkPath);
+
+        if (!QFile::link(m_clientPortName, linkPath)) {
+            m_errorString = QString("Could not create the link %1 to %2").arg(linkPath).arg(m_clientPortName);
+            close();
+            return false;
+        }
+
+        m_linkPath = linkPath;
+    }
+
+    m_serverNotifier = new QSocketNotifier(m_serverMaster, QSocketNotifier::Read, this);
+    connect(m_serverNotifier, &QSocketNotifier::activated, this, &PtyBridge::onServerDataAvailable);
+
+    m_clientNotifier = new QSocketNotifier(m_clientMaster, QSocketNotifier::Read, this);
+    connect(m_clientNotifier, &QSocketNotifier::activated, this, &PtyBridge::onClientDataAvailable);
+
+    openWriteChannel(&m_serverWrite, m_serverMaster);
+    openWriteChannel(&m_clientWrite, m_clientMaster);
+    return true;
+}
+
+void PtyBridge::close()
+{
+    delete m_serverNotifier;
+    m_serverNotifier = nullptr;
+    delete m_clientNotifier;
+    m_clientNotifier = nullptr;
+    closeWriteChannel(&m_serverWrite);
+    closeWriteChannel(&m_clientWrite);
+
+    m_deliveryTimer->stop();
+    m_pendingResponses.clear();
+
+    if (!m_linkPath.isEmpty()) {
+        QFile::remove(m_linkPath);
+        m_linkPath.clear();
+    }
+
+    // The slave ends are kept open, otherwise reading from the master fails once a port gets closed
+    foreach (int fileDescriptor, QList<int>() << m_serverMaster << m_serverSlave << m_clientMaster << m_clientSlave) {
+        if (fileDescriptor >= 0) {
+            ::close(fileDescriptor);
+        }
+    }
+
+    m_serverMaster = m_serverSlave = m_clientMaster = m_clientSlave = -1;
+}
+
+QString PtyBridge::serverPortName() const
+{
+    return m_serverPortName;
+}
+
+QString PtyBridge::clientPortName() const
+{
+    return m_linkPath.isEmpty() ? m_clientPortName : m_linkPath;
+}
+
+QString PtyBridge::errorString() const
+{
+    return m_errorString;
+}
+
+bool PtyBridge::openPty(int *master, int *slave, QString *portName)
+{
+    if (openpty(master, slave, nullptr, nullptr, nullptr) < 0) {
+        m_errorString = QString("Could not open pseudo terminal: %1").arg(strerror(errno));
+        return false;
+    }
+
+    struct termios attributes;
+    if (tcgetattr(*slave, &attributes) == 0) {
+        cfmakeraw(&attributes);
+        tcsetattr(*slave, TCSANOW, &attributes);
+    }
+
+    fcntl(*master, F_SETFL, fcntl(*master, F_GETFL) | O_NONBLOCK);
+    *portName = QString::fromLocal8Bit(ttyname(*slave));
+    return true;
+}
+
+void PtyBridge::openWriteChannel(WriteChannel *channel, int fileDescriptor)
+{
+    channel->fileDescriptor = fileDescriptor;
+    channel->notifier = new QSocketNotifier(fileDescriptor, QSocketNotifier::Write, this);
+    channel->notifier->setEnabled(false);
+    connect(channel->notifier, &QSocketNotifier::activated, this, [this, channel](){
+        flush(channel);
+    });
+}
+
+void PtyBridge::closeWriteChannel(WriteChannel *channel)
+{
+    delete channel->notifier;
+    channel->notifier = nullptr;
+    channel->buffer.clear();
+    channel->fileDescriptor = -1;
+}
+
+void PtyBridge::onServerDataAvailable()
+{
+    // The RTU server writes each response with a single write
+    QByteArray frame = readAvailable(m_serverMaster);
+    if (frame.size() < 4)
+        return;
+
+    switch (m_faultInjection.nextFault()) {
+    case FaultInjection::FaultTimeout:
+        qDebug() << "Dropping response on" << clientPortName();
+        return;
+    case FaultInjection::FaultException: {
+        qDebug() << "Replacing response with an exception on" << clientPortName();
+        QByteArray adu = frame.left(1) + FaultInjection::exceptionPdu(static_cast<quint8>(frame.at(1)));
+        quint16 crc = crc16(adu);
+        adu.append(static_cast<char>(crc & 0xFF));
+        adu.append(static_cast<char>(crc >> 8));
+        frame = adu;
+        break;
+    }
+    case FaultInjection::FaultNone:
+        break;
+    }
+
+    qint64 deliveryTime = QDateTime::currentMSecsSinceEpoch() + m_faultInjection.nextDelay();
+    if (!m_pendingResponses.isEmpty())
+        deliveryTime = qMax(deliveryTime, m_pendingResponses.last().first);
+
+    m_pendingResponses.enqueue(qMakePair(deliveryTime, frame));
+    deliverResponses();
+}
+
+void PtyBridge::onClientDataAvailable()
+{
+    writeData(&m_serverWrite, readAvailable(m_clientMaster));
+}
+
+void PtyBridge::deliverResponses()
+{
+    qint64 now = QDateTime::currentMSecsSinceEpoch();
+    while (!m_pendingResponses.isEmpty() && m_pendingResponses.head().first <= now)
+        writeData(&m_clientWrite, m_pendingResponses.dequeue().second);
+
+    if (!m_pendingResponses.isEmpty() && !m_deliveryTimer->isActive())
+        m_deliveryTimer->start(static_cast<int>(m_pendingResponses.head().first - now));
+}
+
+QByteArray PtyBridge::readAvailable(int fileDescriptor)
+{
+    QByteArray data;
+    char buffer[512];
+    ssize_t count = 0;
+    while ((count = ::read(fileDescriptor, buffer, sizeof(buffer))) > 0)
+        data.append(buffer, static_cast<int>(count));
+
+    return data;
+}
+
+void PtyBridge::writeData(WriteChannel *channel, const QByteArray &data)
+{
+    if (channel->fileDescriptor < 0)
+        return;
+
+    channel->buffer.append(data);
+
+    // Keep the order, the notifier continues once the pseudo terminal accepts data again
+    if (!channel->notifier->isEnabled())
+        flush(channel);
+}
+
+void PtyBridge::flush(WriteChannel *channel)
+{
+    while (!channel->buffer.isEmpty()) {
+        ssize_t count = ::write(channel->fileDescriptor, channel->buffer.constData(), static_cast<size_t>(channel->buffer.size()));
+        if (count < 0) {
+            if (errno == EINTR)
+                continue;
+
+            if (errno == EAGAIN) {
+                channel->notifier->setEnabled(true);
+                return;
+            }
+
+            qWarning() << "Could not write to pseudo terminal:" << strerror(errno);
+            channel->buffer.clear();
+            break;
+        }
+        channel->buffer.remove(0, static_cast<int>(count));
+    }
+
+    channel->notifier->setEnabled(false);
+}
+
+quint16 PtyBridge::crc16(const QByteArray &data)
+{
+    quint16 crc = 0xFFFF;
+    foreach (char byte, data) {
+        crc ^= static_cast<quint8>(byte);
+        for (int i = 0; i < 8; i++) {
+            if (crc & 0x0001) {
+                crc = (crc >> 1) ^ 0xA001;
+            } else {
+                crc >>= 1;
+            }
+        }
+    }
+
+    return crc;
+}
@@ -0,0 +1,100 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+*
+* Copyright 2013 - 2024, nymea GmbH
+* Contact: contact@nymea.io
+*
+* This file is part of nymea.
+* This project including source code and documentation is protected by
+* copyright law, and remains the property of nymea GmbH. All rights, including
+* reproduction, publication, editing and translation, are reserved. The use of
+* this project is subject to the terms of a license agreement to be concluded
+* with nymea GmbH in accordance with the terms of use of nymea GmbH, available
+* under https://nymea.io/license
+*
+* GNU Lesser General Public License Usage
+* Alternatively, this project may be redistributed and/or modified under the
+* terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; version 3. This project is distributed in the hope that
+* it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+* warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this project. If not, see <https://www.gnu.org/licenses/>.
+*
+* For any further details and any questions please contact us under
+* contact@nymea.io or see our FAQ/Licensing Information on
+* https://nymea.io/license/faq
+*
+* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef PTYBRIDGE_H
+#define PTYBRIDGE_H
+
+#include <QQueue>
+#include <QTimer>
+#include <QObject>
+#include <QSocketNotifier>
+
+#include "faultinjection.h"
+
+// Creates two connected pseudo terminals for a simulated modbus RTU device.
+// The modbus RTU server opens the server port, the client (i.e. the nymea RTU master)
+// opens the client port. Responses from the server get the configured faults applied.
+
+class PtyBridge : public QObject
+{
+    Q_OBJECT
+public:
+    explicit PtyBridge(const FaultInjection &faultInjection, QObject *parent = nullptr);
+    ~PtyBridge();
+
+    // Optionally creates a symlink to the client port at linkPath
+    bool open(const QString &linkPath = QString());
+    void close();
+
+    QString serverPortName() const;
+    QString clientPortName() const;
+    QString errorString() const;
+
+private:
+    // Data which could not be written yet, the write notifier is enabled until it is written
+    typedef struct WriteChannel {
+        int fileDescriptor = -1;
+        QByteArray buffer;
+        QSocketNotifier *notifier = nullptr;
+    } WriteChannel;
+
+    FaultInjection m_faultInjection;
+    QString m_errorString;
+    QString m_linkPath;
+
+    int m_serverMaster = -1;
+    int m_serverSlave = -1;
+    int m_clientMaster = -1;
+    int m_clientSlave = -1;
+    QString m_serverPortName;
+    QString m_clientPortName;
+
+    QSocketNotifier *m_serverNotifier = nullptr;
+    QSocketNotifier *m_clientNotifier = nullptr;
+    WriteChannel m_serverWrite;
+    WriteChannel m_clientWrite;
+
+    QTimer *m_deliveryTimer = nullptr;
+    QQueue<QPair<qint64, QByteArray>> m_pendingResponses;
+
+    bool openPty(int *master, int *slave, QString *portName);
+    void openWriteChannel(WriteChannel *channel, int fileDescriptor);
+    void closeWriteChannel(WriteChannel *channel);
+    void onServerDataAvailable();
+    void onClientDataAvailable();
+    void deliverResponses();
+
+    static QByteArray readAvailable(int fileDescriptor);
+    void writeData(WriteChannel *channel, const QByteArray &data);
+    void flush(WriteChannel *channel);
+    static quint16 crc16(const QByteArray &data);
+};
+
+#endif // PTYBRIDGE_H
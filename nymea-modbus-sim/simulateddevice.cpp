@@ -0,0 +1,239 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+*
+* Copyright 2013 - 2024, nymea GmbH
+* Contact: contact@nymea.io
+*
+* This file is part of nymea.
+* This project including source code and documentation is protected by
+* copyright law, and remains the property of nymea GmbH. All rights, including
+* reproduction, publication, editing and translation, are reserved. The use of
+* this project is subject to the terms of a license agreement to be concluded
+* with nymea GmbH in accordance with the terms of use of nymea GmbH, available
+* under https://nymea.io/license
+*
+* GNU Lesser General Public License Usage
+* Alternatively, this project may be redistributed and/or modified under the
+* terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; version 3. This project is distributed in the hope that
+* it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+* warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this project. If not, see <https://www.gnu.org/licenses/>.
+*
+* For any further details and any questions please contact us under
+* contact@nymea.io or see our FAQ/Licensing Information on
+* https://nymea.io/license/faq
+*
+* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "simulateddevice.h"
+
+#include <QFile>
+#include <QDebug>
+#include <QJsonDocument>
+
+#include <cmath>
+
+SimulatedDevice::SimulatedDevice(QModbusServer *server, QObject *parent) :
+    QObject(parent),
+    m_server(server)
+{
+    m_server->setParent(this);
+}
+
+bool SimulatedDevice::loadRegisterJson(const QString &fileName)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        m_errorString = QString("Could not open %1: %2").arg(fileName).arg(file.errorString());
+        return false;
+    }
+
+    QJsonParseError error;
+    QJsonDocument jsonDoc = QJsonDocument::fromJson(file.readAll(), &error);
+    if (error.error != QJsonParseError::NoError) {
+        m_errorString = QString("Could not parse %1: %2 at offset %3").arg(fileName).arg(error.errorString()).arg(error.offset);
+        return false;
+    }
+
+    QVariantMap definition = jsonDoc.toVariant().toMap();
+    m_name = definition.value("className").toString();
+
+    // Same defaults as the connection generator
+    if (definition.value("endianness", "BigEndian").toString() == "LittleEndian")
+        m_endianness = ModbusDataUtils::ByteOrderLittleEndian;
+
+    if (definition.value("stringEndianness", "BigEndian").toString() == "LittleEndian")
+        m_stringEndianness = ModbusDataUtils::ByteOrderLittleEndian;
+
+    // Enum default values are referenced by <EnumName><Key>
+    QHash<QString, int> enumValues;
+    foreach (const QVariant &enumVariant, definition.value("enums").toList()) {
+        QVariantMap enumMap = enumVariant.toMap();
+        foreach (const QVariant &valueVariant, enumMap.value("values").toList()) {
+            QVariantMap valueMap = valueVariant.toMap();
+            enumValues.insert(enumMap.value("name").toString() + valueMap.value("key").toString(), valueMap.value("value").toInt());
+        }
+    }
+
+    QVariantList registerVariants = definition.value("registers").toList();
+    foreach (const QVariant &blockVariant, definition.value("blocks").toList())
+        registerVariants.append(blockVariant.toMap().value("registers").toList());
+
+    foreach (const QVariant &registerVariant, registerVariants) {
+        QVariantMap registerMap = registerVariant.toMap();
+
+        Register reg;
+        reg.id = registerMap.value("id").toString();
+        reg.registerType = registerTypeFromString(registerMap.value("registerType").toString());
+        reg.address = registerMap.value("address").toUInt();
+        reg.size = registerMap.value("size").toUInt();
+        reg.dataType = registerMap.value("type").toString();
+        reg.staticScaleFactor = registerMap.value("staticScaleFactor", 0).toInt();
+        if (reg.registerType == QModbusDataUnit::Invalid || reg.size == 0) {
+            m_errorString = QString("Invalid register definition %1 in %2").arg(reg.id).arg(fileName);
+            return false;
+        }
+
+        QVariant defaultValue = registerMap.value("defaultValue", 0);
+        if (enumValues.contains(defaultValue.toString())) {
+            reg.defaultValue = enumValues.value(defaultValue.toString());
+        } else {
+            reg.defaultValue = defaultValue;
+        }
+
+        m_registers.append(reg);
+    }
+
+    // One data unit per register type covering all defined registers. Reading
+    // outside of it results in an illegal data address exception like on real devices.
+    QHash<QModbusDataUnit::RegisterType, QPair<uint, uint>> ranges;
+    foreach (const Register &reg, m_registers) {
+        uint start = reg.address;
+        uint end = static_cast<uint>(reg.address) + reg.size;
+        if (ranges.contains(reg.registerType)) {
+            start = qMin(start, ranges.value(reg.registerType).first);
+            end = qMax(end, ranges.value(reg.registerType).second);
+        }
+        ranges.insert(reg.registerType, qMakePair(start, end));
+    }
+
+    QModbusDataUnitMap dataUnitMap;
+    foreach (QModbusDataUnit::RegisterType registerType, ranges.keys()) {
+        QPair<uint, uint> range = ranges.value(registerType);
+        dataUnitMap.insert(registerType, QModbusDataUnit(registerType, static_cast<int>(range.first), static_cast<quint16>(qMin(range.second - range.first, 0xFFFFu))));
+    }
+
+    if (!m_server->setMap(dataUnitMap)) {
+        m_errorString = QString("Could not set the register map of %1: %2").arg(fileName).arg(m_server->errorString());
+        return false;
+    }
+
+    foreach (const Register &reg, m_registers)
+        writeValue(reg, reg.defaultValue);
+
+    qDebug() << "Loaded" << m_registers.count() << "registers of" << m_name << "from" << fileName;
+    return true;
+}
+
+QString SimulatedDevice::name() const
+{
+    return m_name;
+}
+
+QModbusServer *SimulatedDevice::server() const
+{
+    return m_server;
+}
+
+QList<SimulatedDevice::Register> SimulatedDevice::registers() const
+{
+    return m_registers;
+}
+
+bool SimulatedDevice::setAnimation(const QString &registerId, const ValueAnimation &animation)
+{
+    foreach (const Register &reg, m_registers) {
+        if (reg.id == registerId) {
+            m_animations.insert(registerId, animation);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+QString SimulatedDevice::errorString() const
+{
+    return m_errorString;
+}
+
+void SimulatedDevice::update(qint64 elapsed)
+{
+    if (m_animations.isEmpty())
+        return;
+
+    foreach (const Register &reg, m_registers) {
+        if (!m_animations.contains(reg.id))
+            continue;
+
+        writeValue(reg, m_animations.value(reg.id).value(elapsed));
+    }
+}
+
+void SimulatedDevice::writeValue(const Register &reg, const QVariant &value)
+{
+    QVector<quint16> values = encodeValue(reg, value);
+    values.resize(reg.size);
+    if (!m_server->setData(QModbusDataUnit(reg.registerType, reg.address, values))) {
+        qWarning() << "Could not set value" << value << "of register" << reg.id << m_server->errorString();
+    }
+}
+
+QVector<quint16> SimulatedDevice::encodeValue(const Register &reg, const QVariant &value) const
+{
+    if (reg.registerType == QModbusDataUnit::Coils || reg.registerType == QModbusDataUnit::DiscreteInputs)
+        return QVector<quint16>(reg.size, value.toDouble() != 0 ? 1 : 0);
+
+    if (reg.dataType == "string")
+        return ModbusDataUtils::convertFromString(value.toString(), reg.size, m_stringEndianness);
+
+    // Values are given in the unit of the register, the device sends the unscaled raw value
+    double scaledValue = value.toDouble() / std::pow(10, reg.staticScaleFactor);
+    qint64 rawValue = std::llround(scaledValue);
+
+    if (reg.dataType == "int16") {
+        return ModbusDataUtils::convertFromInt16(static_cast<qint16>(rawValue));
+    } else if (reg.dataType == "uint32") {
+        return ModbusDataUtils::convertFromUInt32(static_cast<quint32>(rawValue), m_endianness);
+    } else if (reg.dataType == "int32") {
+        return ModbusDataUtils::convertFromInt32(static_cast<qint32>(rawValue), m_endianness);
+    } else if (reg.dataType == "uint64") {
+        return ModbusDataUtils::convertFromUInt64(static_cast<quint64>(rawValue), m_endianness);
+    } else if (reg.dataType == "int64") {
+        return ModbusDataUtils::convertFromInt64(rawValue, m_endianness);
+    } else if (reg.dataType == "float") {
+        return ModbusDataUtils::convertFromFloat32(static_cast<float>(scaledValue), m_endianness);
+    } else if (reg.dataType == "float64") {
+        return ModbusDataUtils::convertFromFloat64(scaledValue, m_endianness);
+    }
+
+    return ModbusDataUtils::convertFromUInt16(static_cast<quint16>(rawValue));
+}
+
+QModbusDataUnit::RegisterType SimulatedDevice::registerTypeFromString(const QString &registerType)
+{
+    if (registerType == "inputRegister") {
+        return QModbusDataUnit::InputRegisters;
+    } else if (registerType == "holdingRegister") {
+        return QModbusDataUnit::HoldingRegisters;
+    } else if (registerType == "discreteInputs") {
+        return QModbusDataUnit::DiscreteInputs;
+    } else if (registerType == "coils") {
+        return QModbusDataUnit::Coils;
+    }
+
+    return QModbusDataUnit::Invalid;
+}
@@ -0,0 +1,92 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+*
+* Copyright 2013 - 2024, nymea GmbH
+* Contact: contact@nymea.io
+*
+* This file is part of nymea.
+* This project including source code and documentation is protected by
+* copyright law, and remains the property of nymea GmbH. All rights, including
+* reproduction, publication, editing and translation, are reserved. The use of
+* this project is subject to the terms of a license agreement to be concluded
+* with nymea GmbH in accordance with the terms of use of nymea GmbH, available
+* under https://nymea.io/license
+*
+* GNU Lesser General Public License Usage
+* Alternatively, this project may be redistributed and/or modified under the
+* terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; version 3. This project is distributed in the hope that
+* it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+* warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this project. If not, see <https://www.gnu.org/licenses/>.
+*
+* For any further details and any questions please contact us under
+* contact@nymea.io or see our FAQ/Licensing Information on
+* https://nymea.io/license/faq
+*
+* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef SIMULATEDDEVICE_H
+#define SIMULATEDDEVICE_H
+
+#include <QHash>
+#include <QObject>
+#include <QVariant>
+#include <QModbusServer>
+
+#include <modbusdatautils.h>
+
+#include "valueanimation.h"
+
+// Serves the registers of a *-registers.json connection definition on a modbus server.
+// All registers start with their default value, animated registers get updated on update().
+
+class SimulatedDevice : public QObject
+{
+    Q_OBJECT
+public:
+    typedef struct Register {
+        QString id;
+        QModbusDataUnit::RegisterType registerType = QModbusDataUnit::HoldingRegisters;
+        quint16 address = 0;
+        quint16 size = 1;
+        QString dataType;
+        int staticScaleFactor = 0;
+        QVariant defaultValue;
+    } Register;
+
+    explicit SimulatedDevice(QModbusServer *server, QObject *parent = nullptr);
+
+    bool loadRegisterJson(const QString &fileName);
+
+    QString name() const;
+    QModbusServer *server() const;
+    QList<Register> registers() const;
+
+    bool setAnimation(const QString &registerId, const ValueAnimation &animation);
+
+    QString errorString() const;
+
+public slots:
+    // Update all animated registers for the given time in ms since the simulation started
+    void update(qint64 elapsed);
+
+private:
+    QModbusServer *m_server = nullptr;
+    QString m_name;
+    QString m_errorString;
+    ModbusDataUtils::ByteOrder m_endianness = ModbusDataUtils::ByteOrderBigEndian;
+    ModbusDataUtils::ByteOrder m_stringEndianness = ModbusDataUtils::ByteOrderBigEndian;
+
+    QList<Register> m_registers;
+    QHash<QString, ValueAnimation> m_animations;
+
+    void writeValue(const Register &reg, const QVariant &value);
+    QVector<quint16> encodeValue(const Register &reg, const QVariant &value) const;
+
+    static QModbusDataUnit::RegisterType registerTypeFromString(const QString &registerType);
+};
+
+#endif // SIMULATEDDEVICE_H
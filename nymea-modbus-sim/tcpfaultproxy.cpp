@@ -0,0 +1,179 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+*
+* Copyright 2013 - 2024, nymea GmbH
+* Contact: contact@nymea.io
+*
+* This file is part of nymea.
+* This project including source code and documentation is protected by
+* copyright law, and remains the property of nymea GmbH. All rights, including
+* reproduction, publication, editing and translation, are reserved. The use of
+* this project is subject to the terms of a license agreement to be concluded
+* with nymea GmbH in accordance with the terms of use of nymea GmbH, available
+* under https://nymea.io/license
+*
+* GNU Lesser General Public License Usage
+* Alternatively, this project may be redistributed and/or modified under the
+* terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; version 3. This project is distributed in the hope that
+* it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+* warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this project. If not, see <https://www.gnu.org/licenses/>.
+*
+* For any further details and any questions please contact us under
+* contact@nymea.io or see our FAQ/Licensing Information on
+* https://nymea.io/license/faq
+*
+* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "tcpfaultproxy.h"
+
+#include <QDebug>
+#include <QDateTime>
+
+TcpFaultProxy::TcpFaultProxy(const FaultInjection &faultInjection, QObject *parent) :
+    QObject(parent),
+    m_faultInjection(faultInjection)
+{
+    m_tcpServer = new QTcpServer(this);
+    connect(m_tcpServer, &QTcpServer::newConnection, this, &TcpFaultProxy::onNewConnection);
+}
+
+TcpFaultProxy::~TcpFaultProxy()
+{
+    foreach (Connection *connection, m_connections.values())
+        closeConnection(connection);
+}
+
+bool TcpFaultProxy::listen(const QHostAddress &address, quint16 port, quint16 serverPort)
+{
+    m_serverPort = serverPort;
+    return m_tcpServer->listen(address, port);
+}
+
+QString TcpFaultProxy::errorString() const
+{
+    return m_tcpServer->errorString();
+}
+
+quint16 TcpFaultProxy::listeningPort(QModbusTcpServer *server)
+{
+    // QModbusTcpServer does not report the port it is bound to, but owns the listening QTcpServer
+    QTcpServer *tcpServer = server->findChild<QTcpServer *>();
+    if (!tcpServer || !tcpServer->isListening())
+        return 0;
+
+    return tcpServer->serverPort();
+}
+
+void TcpFaultProxy::onNewConnection()
+{
+    while (m_tcpServer->hasPendingConnections()) {
+        Connection *connection = new Connection();
+        connection->client = m_tcpServer->nextPendingConnection();
+        connection->server = new QTcpSocket(this);
+        connection->deliveryTimer = new QTimer(this);
+        connection->deliveryTimer->setSingleShot(true);
+        m_connections.insert(connection->client, connection);
+
+        qDebug() << "Client connected from" << connection->client->peerAddress().toString() << "to port" << m_tcpServer->serverPort();
+
+        // Requests are forwarded immediately, only the responses are affected by the faults
+        connect(connection->client, &QTcpSocket::readyRead, this, [connection](){
+            if (connection->server->state() == QAbstractSocket::ConnectedState) {
+                connection->server->write(connection->client->readAll());
+            }
+        });
+        connect(connection->server, &QTcpSocket::connected, this, [connection](){
+            connection->server->write(connection->client->readAll());
+        });
+        connect(connection->server, &QTcpSocket::readyRead, this, [this, connection](){
+            connection->responseBuffer.append(connection->server->readAll());
+            processResponses(connection);
+        });
+        connect(connection->deliveryTimer, &QTimer::timeout, this, [this, connection](){
+            deliverResponses(connection);
+        });
+
+        connect(connection->client, &QTcpSocket::disconnected, this, [this, connection](){
+            closeConnection(connection);
+        });
+        connect(connection->server, &QTcpSocket::disconnected, this, [this, connection](){
+            closeConnection(connection);
+        });
+
+        connection->server->connectToHost(QHostAddress::LocalHost, m_serverPort);
+    }
+}
+
+void TcpFaultProxy::processResponses(Connection *connection)
+{
+    // MBAP header: transaction id (2), protocol id (2), length (2), unit id (1) followed by the PDU.
+    // The length field contains the number of bytes following it.
+    while (connection->responseBuffer.size() >= 8) {
+        int length = (static_cast<quint8>(connection->responseBuffer.at(4)) << 8) | static_cast<quint8>(connection->responseBuffer.at(5));
+        if (connection->responseBuffer.size() < 6 + length)
+            return;
+
+        QByteArray frame = connection->responseBuffer.left(6 + length);
+        connection->responseBuffer.remove(0, 6 + length);
+
+        switch (m_faultInjection.nextFault()) {
+        case FaultInjection::FaultTimeout:
+            qDebug() << "Dropping response on port" << m_tcpServer->serverPort();
+            continue;
+        case FaultInjection::FaultException: {
+            qDebug() << "Replacing response with an exception on port" << m_tcpServer->serverPort();
+            QByteArray pdu = FaultInjection::exceptionPdu(static_cast<quint8>(frame.at(7)));
+            frame = frame.left(7) + pdu;
+            frame[4] = 0;
+            frame[5] = static_cast<char>(pdu.size() + 1);
+            break;
+        }
+        case FaultInjection::FaultNone:
+            break;
+        }
+
+        // Keep the order of the responses even with jitter
+        qint64 deliveryTime = QDateTime::currentMSecsSinceEpoch() + m_faultInjection.nextDelay();
+        if (!connection->pendingResponses.isEmpty())
+            deliveryTime = qMax(deliveryTime, connection->pendingResponses.last().first);
+
+        connection->pendingResponses.enqueue(qMakePair(deliveryTime, frame));
+    }
+
+    deliverResponses(connection);
+}
+
+void TcpFaultProxy::deliverResponses(Connection *connection)
+{
+    qint64 now = QDateTime::currentMSecsSinceEpoch();
+    while (!connection->pendingResponses.isEmpty() && connection->pendingResponses.head().first <= now)
+        connection->client->write(connection->pendingResponses.dequeue().second);
+
+    if (!connection->pendingResponses.isEmpty() && !connection->deliveryTimer->isActive())
+        connection->deliveryTimer->start(static_cast<int>(connection->pendingResponses.head().first - now));
+}
+
+void TcpFaultProxy::closeConnection(Connection *connection)
+{
+    if (!m_connections.contains(connection->client))
+        return;
+
+    m_connections.remove(connection->client);
+    qDebug() << "Client disconnected from port" << m_tcpServer->serverPort();
+
+    connection->client->disconnect(this);
+    connection->server->disconnect(this);
+    connection->deliveryTimer->disconnect(this);
+
+    connection->client->abort();
+    connection->server->abort();
+
+    connection->client->deleteLater();
+    connection->server->deleteLater();
+    connection->deliveryTimer->deleteLater();
+    delete connection;
+}
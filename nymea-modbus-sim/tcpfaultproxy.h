@@ -0,0 +1,82 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+*
+* Copyright 2013 - 2024, nymea GmbH
+* Contact: contact@nymea.io
+*
+* This file is part of nymea.
+* This project including source code and documentation is protected by
+* copyright law, and remains the property of nymea GmbH. All rights, including
+* reproduction, publication, editing and translation, are reserved. The use of
+* this project is subject to the terms of a license agreement to be concluded
+* with nymea GmbH in accordance with the terms of use of nymea GmbH, available
+* under https://nymea.io/license
+*
+* GNU Lesser General Public License Usage
+* Alternatively, this project may be redistributed and/or modified under the
+* terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; version 3. This project is distributed in the hope that
+* it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+* warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this project. If not, see <https://www.gnu.org/licenses/>.
+*
+* For any further details and any questions please contact us under
+* contact@nymea.io or see our FAQ/Licensing Information on
+* https://nymea.io/license/faq
+*
+* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef TCPFAULTPROXY_H
+#define TCPFAULTPROXY_H
+
+#include <QHash>
+#include <QQueue>
+#include <QTimer>
+#include <QObject>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QHostAddress>
+#include <QModbusTcpServer>
+
+#include "faultinjection.h"
+
+// Sits between the modbus TCP clients and the internal modbus TCP server of a
+// simulated device and applies the configured latency, timeouts and exceptions
+// to each response frame.
+
+class TcpFaultProxy : public QObject
+{
+    Q_OBJECT
+public:
+    explicit TcpFaultProxy(const FaultInjection &faultInjection, QObject *parent = nullptr);
+    ~TcpFaultProxy();
+
+    bool listen(const QHostAddress &address, quint16 port, quint16 serverPort);
+    QString errorString() const;
+
+    // The port a connected modbus TCP server listens on, i.e. if it got started on port 0
+    static quint16 listeningPort(QModbusTcpServer *server);
+
+private:
+    typedef struct Connection {
+        QTcpSocket *client = nullptr;
+        QTcpSocket *server = nullptr;
+        QTimer *deliveryTimer = nullptr;
+        QByteArray responseBuffer;
+        QQueue<QPair<qint64, QByteArray>> pendingResponses;
+    } Connection;
+
+    FaultInjection m_faultInjection;
+    QTcpServer *m_tcpServer = nullptr;
+    quint16 m_serverPort = 0;
+    QHash<QTcpSocket *, Connection *> m_connections;
+
+    void onNewConnection();
+    void processResponses(Connection *connection);
+    void deliverResponses(Connection *connection);
+    void closeConnection(Connection *connection);
+};
+
+#endif // TCPFAULTPROXY_H
@@ -0,0 +1,154 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+*
+* Copyright 2013 - 2024, nymea GmbH
+* Contact: contact@nymea.io
+*
+* This file is part of nymea.
+* This project including source code and documentation is protected by
+* copyright law, and remains the property of nymea GmbH. All rights, including
+* reproduction, publication, editing and translation, are reserved. The use of
+* this project is subject to the terms of a license agreement to be concluded
+* with nymea GmbH in accordance with the terms of use of nymea GmbH, available
+* under https://nymea.io/license
+*
+* GNU Lesser General Public License Usage
+* Alternatively, this project may be redistributed and/or modified under the
+* terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; version 3. This project is distributed in the hope that
+* it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+* warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this project. If not, see <https://www.gnu.org/licenses/>.
+*
+* For any further details and any questions please contact us under
+* contact@nymea.io or see our FAQ/Licensing Information on
+* https://nymea.io/license/faq
+*
+* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "valueanimation.h"
+
+#include <QFile>
+#include <QTextStream>
+#include <QStringList>
+#include <QRandomGenerator>
+
+#include <cmath>
+
+ValueAnimation ValueAnimation::fromString(const QString &specification, QString *errorString)
+{
+    ValueAnimation animation;
+    QStringList tokens = specification.split(':');
+    QString type = tokens.takeFirst().toLower();
+
+    // Trace files are the only animation with a non numeric parameter
+    if (type == "trace") {
+        if (tokens.isEmpty() || tokens.count() > 2) {
+            if (errorString) *errorString = QString("Invalid trace animation \"%1\". Expected trace:<file>[:<step>]").arg(specification);
+            return ValueAnimation();
+        }
+
+        QFile file(tokens.at(0));
+        if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+            if (errorString) *errorString = QString("Could not open trace file %1: %2").arg(file.fileName()).arg(file.errorString());
+            return ValueAnimation();
+        }
+
+        QTextStream stream(&file);
+        while (!stream.atEnd()) {
+            QString line = stream.readLine().trimmed();
+            if (line.isEmpty() || line.startsWith('#'))
+                continue;
+
+            bool valueOk = false;
+            double value = line.split(',').last().trimmed().toDouble(&valueOk);
+            // Skip CSV headers
+            if (!valueOk)
+                continue;
+
+            animation.m_trace.append(value);
+        }
+
+        if (animation.m_trace.isEmpty()) {
+            if (errorString) *errorString = QString("The trace file %1 does not contain any values").arg(file.fileName());
+            return ValueAnimation();
+        }
+
+        animation.m_period = 1;
+        if (tokens.count() == 2) {
+            bool valueOk = false;
+            animation.m_period = tokens.at(1).toDouble(&valueOk);
+            if (!valueOk || animation.m_period <= 0) {
+                if (errorString) *errorString = QString("Invalid trace step \"%1\"").arg(tokens.at(1));
+                return ValueAnimation();
+            }
+        }
+
+        animation.m_type = TypeTrace;
+        return animation;
+    }
+
+    QVector<double> parameters;
+    foreach (const QString &token, tokens) {
+        bool valueOk = false;
+        double parameter = token.toDouble(&valueOk);
+        if (!valueOk) {
+            if (errorString) *errorString = QString("Invalid animation parameter \"%1\" in \"%2\"").arg(token).arg(specification);
+            return ValueAnimation();
+        }
+        parameters.append(parameter);
+    }
+
+    if (type == "const" && parameters.count() == 1) {
+        animation.m_type = TypeConstant;
+        animation.m_min = parameters.at(0);
+    } else if ((type == "ramp" || type == "sine") && parameters.count() == 3 && parameters.at(2) > 0) {
+        animation.m_type = type == "ramp" ? TypeRamp : TypeSine;
+        animation.m_min = parameters.at(0);
+        animation.m_max = parameters.at(1);
+        animation.m_period = parameters.at(2);
+    } else if (type == "noise" && parameters.count() == 2) {
+        animation.m_type = TypeNoise;
+        animation.m_min = parameters.at(0) - parameters.at(1);
+        animation.m_max = parameters.at(0) + parameters.at(1);
+    } else {
+        if (errorString) *errorString = QString("Invalid animation \"%1\". Valid animations are const:<value>, ramp:<min>:<max>:<period>, sine:<min>:<max>:<period>, noise:<center>:<amplitude> and trace:<file>[:<step>]").arg(specification);
+        return ValueAnimation();
+    }
+
+    return animation;
+}
+
+bool ValueAnimation::isValid() const
+{
+    return m_type != TypeInvalid;
+}
+
+ValueAnimation::Type ValueAnimation::type() const
+{
+    return m_type;
+}
+
+double ValueAnimation::value(qint64 elapsed) const
+{
+    double seconds = elapsed / 1000.0;
+
+    switch (m_type) {
+    case TypeInvalid:
+        return 0;
+    case TypeConstant:
+        return m_min;
+    case TypeRamp:
+        return m_min + (m_max - m_min) * std::fmod(seconds, m_period) / m_period;
+    case TypeSine:
+        return m_min + (m_max - m_min) * (1 + std::sin(2 * M_PI * seconds / m_period)) / 2;
+    case TypeNoise:
+        return m_min + (m_max - m_min) * QRandomGenerator::global()->generateDouble();
+    case TypeTrace:
+        return m_trace.at(static_cast<int>(static_cast<qint64>(seconds / m_period) % m_trace.count()));
+    }
+
+    return 0;
+}
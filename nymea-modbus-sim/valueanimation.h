@@ -0,0 +1,76 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+*
+* Copyright 2013 - 2024, nymea GmbH
+* Contact: contact@nymea.io
+*
+* This file is part of nymea.
+* This project including source code and documentation is protected by
+* copyright law, and remains the property of nymea GmbH. All rights, including
+* reproduction, publication, editing and translation, are reserved. The use of
+* this project is subject to the terms of a license agreement to be concluded
+* with nymea GmbH in accordance with the terms of use of nymea GmbH, available
+* under https://nymea.io/license
+*
+* GNU Lesser General Public License Usage
+* Alternatively, this project may be redistributed and/or modified under the
+* terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; version 3. This project is distributed in the hope that
+* it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+* warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this project. If not, see <https://www.gnu.org/licenses/>.
+*
+* For any further details and any questions please contact us under
+* contact@nymea.io or see our FAQ/Licensing Information on
+* https://nymea.io/license/faq
+*
+* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef VALUEANIMATION_H
+#define VALUEANIMATION_H
+
+#include <QString>
+#include <QVector>
+
+// Describes how a simulated register value changes over time.
+//
+// const:<value>                  Fixed value
+// ramp:<min>:<max>:<period>      Sawtooth from min to max within period seconds
+// sine:<min>:<max>:<period>      Sine wave between min and max with period seconds
+// noise:<center>:<amplitude>     Random value within center +- amplitude
+// trace:<file>[:<step>]          Values from a file (one value per line, the last
+//                                CSV column is used), advancing every step seconds
+
+class ValueAnimation
+{
+public:
+    enum Type {
+        TypeInvalid,
+        TypeConstant,
+        TypeRamp,
+        TypeSine,
+        TypeNoise,
+        TypeTrace
+    };
+
+    ValueAnimation() = default;
+
+    static ValueAnimation fromString(const QString &specification, QString *errorString = nullptr);
+
+    bool isValid() const;
+    Type type() const;
+
+    // The value for the given time in ms since the simulation started
+    double value(qint64 elapsed) const;
+
+private:
+    Type m_type = TypeInvalid;
+    double m_min = 0;
+    double m_max = 0;
+    double m_period = 1;
+    QVector<double> m_trace;
+};
+
+#endif // VALUEANIMATION_H
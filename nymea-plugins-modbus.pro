@@ -2,7 +2,9 @@ TEMPLATE = subdirs
 
 # Note: In the loop at the end of this file the plugin
 # dependency on the libs will be defined
-SUBDIRS += nymea-modbus-cli libnymea-modbus libnymea-sunspec
+SUBDIRS += nymea-modbus-cli nymea-modbus-sim libnymea-modbus libnymea-sunspec
+
+nymea-modbus-sim.depends = libnymea-modbus
 
 PLUGIN_DIRS = \
     alphainnotec            \
@@ -71,7 +73,7 @@ for(plugin, PLUGINS) {
         message("- $${plugin}")
         # Make sure the libs will be built before the plugins
         equals(plugin, "sunspec") {
-            $${plugin}.depends += libnymea-sunspec
+            $${plugin}.depends += libnymea-sunspec libnymea-modbus
         } else {
             $${plugin}.depends += libnymea-modbus
         }
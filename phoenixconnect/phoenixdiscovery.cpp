@@ -35,8 +35,35 @@ PhoenixDiscovery::PhoenixDiscovery(NetworkDeviceDiscovery *networkDeviceDiscover
     QObject{parent},
     m_networkDeviceDiscovery{networkDeviceDiscovery}
 {
+    // Only hosts answering on the firmware version register get a full connection
+    m_probe = new ModbusNetworkProbe(this);
+    m_probe->addPort(502);
+
+    ModbusNetworkProbe::Fingerprint fingerprint;
+    fingerprint.name = "phoenix";
+    fingerprint.slaveId = 0xff;
+    fingerprint.registerType = QModbusDataUnit::InputRegisters;
+    fingerprint.registerAddress = 105; // firmwareVersion
+    fingerprint.size = 2;
+    m_probe->addFingerprint(fingerprint);
+
+    connect(m_probe, &ModbusNetworkProbe::resultFound, this, [this](const ModbusNetworkProbe::Result &result){
+        foreach (const NetworkDeviceInfo &networkDeviceInfo, m_networkDeviceInfos) {
+            if (networkDeviceInfo.address() == result.address) {
+                checkNetworkDevice(networkDeviceInfo);
+                return;
+            }
+        }
+    });
+
+    connect(m_probe, &ModbusNetworkProbe::finished, this, [this](){
+        m_probeFinished = true;
+        finishDiscoveryIfDone();
+    });
+
+    // Give the connections still initializing once all hosts have been probed a chance to finish
     m_gracePeriodTimer.setSingleShot(true);
-    m_gracePeriodTimer.setInterval(3000);
+    m_gracePeriodTimer.setInterval(5000);
     connect(&m_gracePeriodTimer, &QTimer::timeout, this, [this](){
         qCDebug(dcPhoenixConnect()) << "Discovery: Grace period timer triggered.";
         finishDiscovery();
@@ -48,11 +75,31 @@ void PhoenixDiscovery::startDiscovery()
     qCInfo(dcPhoenixConnect()) << "Discovery: Searching for PhoenixConnect wallboxes in the network...";
     NetworkDeviceDiscoveryReply *discoveryReply = m_networkDeviceDiscovery->discover();
 
-    connect(discoveryReply, &NetworkDeviceDiscoveryReply::networkDeviceInfoAdded, this, &PhoenixDiscovery::checkNetworkDevice);
+    m_startDateTime = QDateTime::currentDateTime();
+    m_probeFinished = false;
+    m_finished = false;
+
+    connect(discoveryReply, &NetworkDeviceDiscoveryReply::networkDeviceInfoAdded, this, [this](const NetworkDeviceInfo &networkDeviceInfo){
+        if (!isCandidate(networkDeviceInfo))
+            return;
+
+        m_networkDeviceInfos.append(networkDeviceInfo);
+        m_probe->probe(networkDeviceInfo.address());
+    });
 
     connect(discoveryReply, &NetworkDeviceDiscoveryReply::finished, this, [=](){
         qCDebug(dcPhoenixConnect()) << "Discovery: Network discovery finished. Found" << discoveryReply->networkDeviceInfos().count() << "network devices";
-        m_gracePeriodTimer.start();
+        m_networkDeviceInfos.clear();
+        foreach (const NetworkDeviceInfo &networkDeviceInfo, discoveryReply->networkDeviceInfos()) {
+            if (!isCandidate(networkDeviceInfo))
+                continue;
+
+            m_networkDeviceInfos.append(networkDeviceInfo);
+            m_probe->probe(networkDeviceInfo.address());
+        }
+
+        // The probe finishes once all pending hosts have been checked
+        m_probe->finish();
         discoveryReply->deleteLater();
     });
 }
@@ -62,12 +109,13 @@ QList<PhoenixDiscovery::Result> PhoenixDiscovery::discoveryResults() const
     return m_discoveryResults;
 }
 
-void PhoenixDiscovery::checkNetworkDevice(const NetworkDeviceInfo &networkDeviceInfo)
+bool PhoenixDiscovery::isCandidate(const NetworkDeviceInfo &networkDeviceInfo) const
 {
-    if (networkDeviceInfo.macAddressManufacturer() != "wallbe GmbH" && networkDeviceInfo.macAddressManufacturer() != "Phoenix") {
-        return;
-    }
+    return networkDeviceInfo.macAddressManufacturer() == "wallbe GmbH" || networkDeviceInfo.macAddressManufacturer() == "Phoenix";
+}
 
+void PhoenixDiscovery::checkNetworkDevice(const NetworkDeviceInfo &networkDeviceInfo)
+{
     int port = 502;
     int slaveId = 0xff;
     qCDebug(dcPhoenixConnect()) << "Checking network device:" << networkDeviceInfo << "Port:" << port << "Slave ID:" << slaveId;
@@ -118,12 +166,33 @@ void PhoenixDiscovery::cleanupConnection(PhoenixModbusTcpConnection *connection)
     m_connections.removeAll(connection);
     connection->disconnectDevice();
     connection->deleteLater();
+
+    finishDiscoveryIfDone();
+}
+
+void PhoenixDiscovery::finishDiscoveryIfDone()
+{
+    if (m_finished || !m_probeFinished)
+        return;
+
+    if (m_connections.isEmpty()) {
+        finishDiscovery();
+    } else if (!m_gracePeriodTimer.isActive()) {
+        m_gracePeriodTimer.start();
+    }
 }
 
 void PhoenixDiscovery::finishDiscovery()
 {
     qint64 durationMilliSeconds = QDateTime::currentMSecsSinceEpoch() - m_startDateTime.toMSecsSinceEpoch();
 
+    // Make sure we finish only once
+    if (m_finished)
+        return;
+
+    m_finished = true;
+    m_gracePeriodTimer.stop();
+
     // Cleanup any leftovers...we don't care any more
     foreach (PhoenixModbusTcpConnection *connection, m_connections)
         cleanupConnection(connection);
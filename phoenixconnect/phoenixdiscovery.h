@@ -36,6 +36,7 @@
 
 #include <network/networkdevicediscovery.h>
 
+#include "modbusnetworkprobe.h"
 #include "phoenixmodbustcpconnection.h"
 
 class PhoenixDiscovery : public QObject
@@ -63,12 +64,19 @@ private:
     QTimer m_gracePeriodTimer;
     QDateTime m_startDateTime;
 
+    ModbusNetworkProbe *m_probe = nullptr;
+    bool m_probeFinished = false;
+    bool m_finished = false;
+
+    NetworkDeviceInfos m_networkDeviceInfos;
     QList<PhoenixModbusTcpConnection *> m_connections;
 
     QList<Result> m_discoveryResults;
 
+    bool isCandidate(const NetworkDeviceInfo &networkDeviceInfo) const;
     void checkNetworkDevice(const NetworkDeviceInfo &networkDeviceInfo);
     void cleanupConnection(PhoenixModbusTcpConnection *connection);
+    void finishDiscoveryIfDone();
 
     void finishDiscovery();
 };
@@ -658,15 +658,11 @@ void IntegrationPluginSma::postSetupThing(Thing *thing)
         setupRefreshTimer();
 
     } else if (thing->thingClassId() == modbusSolarInverterThingClassId) {
-        SmaSolarInverterModbusTcpConnection *connection = m_modbusSolarInverters.value(thing);
-        if (connection) {
-            thing->setStateValue("connected", connection->reachable());
-            if (!connection->reachable()) {
-                markSpeedwireMeterAsDisconnected(thing);
-            }
-        } else {
+        // The connection gets only added once initialized, reachable changes get handled by the connection signals.
+        // The getters can not be used here, since the connection might live in an I/O thread.
+        if (!m_modbusSolarInverters.contains(thing)) {
             thing->setStateValue("connected", false);
-            markSpeedwireMeterAsDisconnected(thing);
+            markModbusSolarInverterAsDisconnected(thing);
         }
 
         setupRefreshTimer();
@@ -696,6 +692,10 @@ void IntegrationPluginSma::thingRemoved(Thing *thing)
         m_modbusSolarInverters.take(thing)->deleteLater();
     }
 
+    if (thing->thingClassId() == modbusBatteryInverterThingClassId && m_modbusBatteryInverters.contains(thing)) {
+        m_modbusBatteryInverters.take(thing)->deleteLater();
+    }
+
     if (m_monitors.contains(thing)) {
         hardwareManager()->networkDeviceDiscovery()->unregisterMonitor(m_monitors.take(thing));
     }
@@ -783,7 +783,8 @@ void IntegrationPluginSma::setupModbusSolarInverterConnection(ThingSetupInfo *in
     quint16 slaveId = thing->paramValue(modbusSolarInverterThingSlaveIdParamTypeId).toUInt();
 
     qCDebug(dcSma()) << "Setting up SMA inverter on" << address.toString() << port << "unit ID:" << slaveId;
-    SmaSolarInverterModbusTcpConnection *connection = new SmaSolarInverterModbusTcpConnection(address, port, slaveId, this);
+    SmaSolarInverterModbusTcpConnection *connection = new SmaSolarInverterModbusTcpConnection(address, port, slaveId, modbusConnectionParent());
+    moveModbusConnection(connection, address);
     connect(info, &ThingSetupInfo::aborted, connection, &SmaSolarInverterModbusTcpConnection::deleteLater);
 
     // Reconnect on monitor reachable changed
@@ -794,8 +795,12 @@ void IntegrationPluginSma::setupModbusSolarInverterConnection(ThingSetupInfo *in
             return;
 
         if (reachable && !thing->stateValue("connected").toBool()) {
-            connection->modbusTcpMaster()->setHostAddress(monitor->networkDeviceInfo().address());
-            connection->connectDevice();
+            // Set the address within the thread of the connection
+            QHostAddress address = monitor->networkDeviceInfo().address();
+            QMetaObject::invokeMethod(connection, [connection, address](){
+                connection->modbusTcpMaster()->setHostAddress(address);
+                connection->connectDevice();
+            });
         } else if (!reachable) {
             // Note: We disable autoreconnect explicitly and we will
             // connect the device once the monitor says it is reachable again
@@ -836,14 +841,14 @@ void IntegrationPluginSma::setupModbusSolarInverterConnection(ThingSetupInfo *in
 
     connect(connection, &SmaSolarInverterModbusTcpConnection::initializationFinished, info, [=](bool success){
         if (!success) {
-            qCWarning(dcSma()) << "Connection init finished with errors" << thing->name() << connection->modbusTcpMaster()->hostAddress().toString();
+            qCWarning(dcSma()) << "Connection init finished with errors" << thing->name() << monitor->networkDeviceInfo().address().toString();
             hardwareManager()->networkDeviceDiscovery()->unregisterMonitor(monitor);
             connection->deleteLater();
             info->finish(Thing::ThingErrorHardwareFailure, QT_TR_NOOP("Could not initialize the communication with the inverter."));
             return;
         }
 
-        qCDebug(dcSma()) << "Connection init finished successfully" << connection;
+        qCDebug(dcSma()) << "Connection init finished successfully" << thing->name();
         m_modbusSolarInverters.insert(thing, connection);
         info->finish(Thing::ThingErrorNoError);
 
@@ -853,52 +858,65 @@ void IntegrationPluginSma::setupModbusSolarInverterConnection(ThingSetupInfo *in
             childThing->setStateValue("connected", true);
         }
 
-        connect(connection, &SmaSolarInverterModbusTcpConnection::updateFinished, thing, [=](){
-            qCDebug(dcSma()) << "Updated" << connection;
+        // Use the snapshot instead of the getters, the connection might live in an I/O thread
+        connect(connection, &SmaSolarInverterModbusTcpConnection::snapshotUpdated, thing, [=](const QVariantMap &snapshot){
+            qCDebug(dcSma()) << "Updated" << thing->name();
 
             // Grid voltage
-            if (isModbusValueValid(connection->gridVoltagePhaseA()))
-                thing->setStateValue(modbusSolarInverterVoltagePhaseAStateTypeId, connection->gridVoltagePhaseA() / 100.0);
+            quint32 gridVoltagePhaseA = snapshot.value("gridVoltagePhaseA").toUInt();
+            if (isModbusValueValid(gridVoltagePhaseA))
+                thing->setStateValue(modbusSolarInverterVoltagePhaseAStateTypeId, gridVoltagePhaseA / 100.0);
 
-            if (isModbusValueValid(connection->gridVoltagePhaseB()))
-                thing->setStateValue(modbusSolarInverterVoltagePhaseBStateTypeId, connection->gridVoltagePhaseB() / 100.0);
+            quint32 gridVoltagePhaseB = snapshot.value("gridVoltagePhaseB").toUInt();
+            if (isModbusValueValid(gridVoltagePhaseB))
+                thing->setStateValue(modbusSolarInverterVoltagePhaseBStateTypeId, gridVoltagePhaseB / 100.0);
 
-            if (isModbusValueValid(connection->gridVoltagePhaseC()))
-                thing->setStateValue(modbusSolarInverterVoltagePhaseCStateTypeId, connection->gridVoltagePhaseC() / 100.0);
+            quint32 gridVoltagePhaseC = snapshot.value("gridVoltagePhaseC").toUInt();
+            if (isModbusValueValid(gridVoltagePhaseC))
+                thing->setStateValue(modbusSolarInverterVoltagePhaseCStateTypeId, gridVoltagePhaseC / 100.0);
 
             // Grid current
-            if (isModbusValueValid(connection->gridCurrentPhaseA()))
-                thing->setStateValue(modbusSolarInverterCurrentPhaseAStateTypeId, connection->gridCurrentPhaseA() / 1000.0);
+            qint32 gridCurrentPhaseA = snapshot.value("gridCurrentPhaseA").toInt();
+            if (isModbusValueValid(gridCurrentPhaseA))
+                thing->setStateValue(modbusSolarInverterCurrentPhaseAStateTypeId, gridCurrentPhaseA / 1000.0);
 
-            if (isModbusValueValid(connection->gridCurrentPhaseB()))
-                thing->setStateValue(modbusSolarInverterCurrentPhaseBStateTypeId, connection->gridCurrentPhaseB() / 1000.0);
+            qint32 gridCurrentPhaseB = snapshot.value("gridCurrentPhaseB").toInt();
+            if (isModbusValueValid(gridCurrentPhaseB))
+                thing->setStateValue(modbusSolarInverterCurrentPhaseBStateTypeId, gridCurrentPhaseB / 1000.0);
 
-            if (isModbusValueValid(connection->gridCurrentPhaseC()))
-                thing->setStateValue(modbusSolarInverterCurrentPhaseCStateTypeId, connection->gridCurrentPhaseC() / 1000.0);
+            qint32 gridCurrentPhaseC = snapshot.value("gridCurrentPhaseC").toInt();
+            if (isModbusValueValid(gridCurrentPhaseC))
+                thing->setStateValue(modbusSolarInverterCurrentPhaseCStateTypeId, gridCurrentPhaseC / 1000.0);
 
             // Phase power
-            if (isModbusValueValid(connection->currentPowerPhaseA()))
-                thing->setStateValue(modbusSolarInverterCurrentPowerPhaseAStateTypeId, connection->currentPowerPhaseA());
+            qint32 currentPowerPhaseA = snapshot.value("currentPowerPhaseA").toInt();
+            if (isModbusValueValid(currentPowerPhaseA))
+                thing->setStateValue(modbusSolarInverterCurrentPowerPhaseAStateTypeId, currentPowerPhaseA);
 
-            if (isModbusValueValid(connection->currentPowerPhaseB()))
-                thing->setStateValue(modbusSolarInverterCurrentPowerPhaseBStateTypeId, connection->currentPowerPhaseB());
+            qint32 currentPowerPhaseB = snapshot.value("currentPowerPhaseB").toInt();
+            if (isModbusValueValid(currentPowerPhaseB))
+                thing->setStateValue(modbusSolarInverterCurrentPowerPhaseBStateTypeId, currentPowerPhaseB);
 
-            if (isModbusValueValid(connection->currentPowerPhaseC()))
-                thing->setStateValue(modbusSolarInverterCurrentPowerPhaseCStateTypeId, connection->currentPowerPhaseC());
+            qint32 currentPowerPhaseC = snapshot.value("currentPowerPhaseC").toInt();
+            if (isModbusValueValid(currentPowerPhaseC))
+                thing->setStateValue(modbusSolarInverterCurrentPowerPhaseCStateTypeId, currentPowerPhaseC);
 
             // Others
-            if (isModbusValueValid(connection->totalYield()))
-                thing->setStateValue(modbusSolarInverterTotalEnergyProducedStateTypeId, connection->totalYield() / 1000.0); // kWh
+            quint64 totalYield = snapshot.value("totalYield").toULongLong();
+            if (isModbusValueValid(totalYield))
+                thing->setStateValue(modbusSolarInverterTotalEnergyProducedStateTypeId, totalYield / 1000.0); // kWh
 
-            if (isModbusValueValid(connection->dailyYield()))
-                thing->setStateValue(modbusSolarInverterEnergyProducedTodayStateTypeId, connection->dailyYield() / 1000.0); // kWh
+            quint64 dailyYield = snapshot.value("dailyYield").toULongLong();
+            if (isModbusValueValid(dailyYield))
+                thing->setStateValue(modbusSolarInverterEnergyProducedTodayStateTypeId, dailyYield / 1000.0); // kWh
 
             // Power
-            if (isModbusValueValid(connection->currentPower()))
-                thing->setStateValue(modbusSolarInverterCurrentPowerStateTypeId, -connection->currentPower());
+            qint32 currentPower = snapshot.value("currentPower").toInt();
+            if (isModbusValueValid(currentPower))
+                thing->setStateValue(modbusSolarInverterCurrentPowerStateTypeId, -currentPower);
 
             // Version
-            thing->setStateValue(modbusSolarInverterFirmwareVersionStateTypeId, Sma::buildSoftwareVersionString(connection->softwarePackage()));
+            thing->setStateValue(modbusSolarInverterFirmwareVersionStateTypeId, Sma::buildSoftwareVersionString(snapshot.value("softwarePackage").toUInt()));
         });
 
         // Update registers
@@ -917,7 +935,8 @@ void IntegrationPluginSma::setupModbusBatteryInverterConnection(ThingSetupInfo *
     quint16 slaveId = thing->paramValue(modbusBatteryInverterThingSlaveIdParamTypeId).toUInt();
 
     qCDebug(dcSma()) << "Setting up SMA inverter on" << address.toString() << port << "unit ID:" << slaveId;
-    SmaBatteryInverterModbusTcpConnection *connection = new SmaBatteryInverterModbusTcpConnection(address, port, slaveId, this);
+    SmaBatteryInverterModbusTcpConnection *connection = new SmaBatteryInverterModbusTcpConnection(address, port, slaveId, modbusConnectionParent());
+    moveModbusConnection(connection, address);
     connect(info, &ThingSetupInfo::aborted, connection, &SmaBatteryInverterModbusTcpConnection::deleteLater);
 
     // Reconnect on monitor reachable changed
@@ -928,8 +947,12 @@ void IntegrationPluginSma::setupModbusBatteryInverterConnection(ThingSetupInfo *
             return;
 
         if (reachable && !thing->stateValue("connected").toBool()) {
-            connection->modbusTcpMaster()->setHostAddress(monitor->networkDeviceInfo().address());
-            connection->connectDevice();
+            // Set the address within the thread of the connection
+            QHostAddress address = monitor->networkDeviceInfo().address();
+            QMetaObject::invokeMethod(connection, [connection, address](){
+                connection->modbusTcpMaster()->setHostAddress(address);
+                connection->connectDevice();
+            });
         } else if (!reachable) {
             // Note: We disable autoreconnect explicitly and we will
             // connect the device once the monitor says it is reachable again
@@ -967,27 +990,30 @@ void IntegrationPluginSma::setupModbusBatteryInverterConnection(ThingSetupInfo *
 
     connect(connection, &SmaBatteryInverterModbusTcpConnection::initializationFinished, info, [=](bool success){
         if (!success) {
-            qCWarning(dcSma()) << "Connection init finished with errors" << thing->name() << connection->modbusTcpMaster()->hostAddress().toString();
+            qCWarning(dcSma()) << "Connection init finished with errors" << thing->name() << monitor->networkDeviceInfo().address().toString();
             hardwareManager()->networkDeviceDiscovery()->unregisterMonitor(monitor);
             connection->deleteLater();
             info->finish(Thing::ThingErrorHardwareFailure, QT_TR_NOOP("Could not initialize the communication with the battery inverter."));
             return;
         }
 
-        qCDebug(dcSma()) << "Connection init finished successfully" << connection;
+        qCDebug(dcSma()) << "Connection init finished successfully" << thing->name();
         m_modbusBatteryInverters.insert(thing, connection);
         info->finish(Thing::ThingErrorNoError);
 
         thing->setStateValue("connected", true);
 
-        connect(connection, &SmaBatteryInverterModbusTcpConnection::updateFinished, thing, [=](){
-            qCDebug(dcSma()) << "Updated" << connection;
-            thing->setStateValue(modbusBatteryInverterFirmwareVersionStateTypeId, Sma::buildSoftwareVersionString(connection->softwarePackage()));
+        // Use the snapshot instead of the getters, the connection might live in an I/O thread
+        connect(connection, &SmaBatteryInverterModbusTcpConnection::snapshotUpdated, thing, [=](const QVariantMap &snapshot){
+            qCDebug(dcSma()) << "Updated" << thing->name();
+            thing->setStateValue(modbusBatteryInverterFirmwareVersionStateTypeId, Sma::buildSoftwareVersionString(snapshot.value("softwarePackage").toUInt()));
 
-            thing->setStateValue(modbusBatteryInverterBatteryLevelStateTypeId, connection->batterySOC());
-            thing->setStateValue(modbusBatteryInverterBatteryCriticalStateTypeId, connection->batterySOC() <= 5);
-            thing->setStateValue(modbusBatteryInverterCurrentPowerStateTypeId, -connection->currentPower());
-            thing->setStateValue(modbusBatteryInverterChargingStateStateTypeId, connection->currentPower() == 0 ? "idle" : (connection->currentPower() > 0 ? "charging" : "discharging"));
+            quint32 batterySOC = snapshot.value("batterySOC").toUInt();
+            qint32 currentPower = snapshot.value("currentPower").toInt();
+            thing->setStateValue(modbusBatteryInverterBatteryLevelStateTypeId, batterySOC);
+            thing->setStateValue(modbusBatteryInverterBatteryCriticalStateTypeId, batterySOC <= 5);
+            thing->setStateValue(modbusBatteryInverterCurrentPowerStateTypeId, -currentPower);
+            thing->setStateValue(modbusBatteryInverterChargingStateStateTypeId, currentPower == 0 ? "idle" : (currentPower > 0 ? "charging" : "discharging"));
 
         });
 
@@ -998,6 +1024,24 @@ void IntegrationPluginSma::setupModbusBatteryInverterConnection(ThingSetupInfo *
     connection->connectDevice();
 }
 
+QObject *IntegrationPluginSma::modbusConnectionParent()
+{
+    // Connections in an I/O thread must not have a parent, they get deleted using deleteLater()
+    if (configValue(smaPluginModbusIoThreadsParamTypeId).toBool())
+        return nullptr;
+
+    return this;
+}
+
+void IntegrationPluginSma::moveModbusConnection(QObject *connection, const QHostAddress &address)
+{
+    // Changing the setting applies to connections set up afterwards
+    if (!configValue(smaPluginModbusIoThreadsParamTypeId).toBool())
+        return;
+
+    ModbusIoThreadPool::instance()->moveToIoThread(connection, address.toString());
+}
+
 SpeedwireInterface *IntegrationPluginSma::getSpeedwireInterface()
 {
     if (!m_speedwireInterface)
@@ -45,6 +45,8 @@
 #include "smasolarinvertermodbustcpconnection.h"
 #include "smabatteryinvertermodbustcpconnection.h"
 
+#include <modbusiothreadpool.h>
+
 class IntegrationPluginSma: public IntegrationPlugin {
     Q_OBJECT
     Q_PLUGIN_METADATA(IID "io.nymea.IntegrationPlugin" FILE "integrationpluginsma.json")
@@ -95,6 +97,9 @@ private:
     void markModbusSolarInverterAsDisconnected(Thing *thing);
     void markModbusBatteryInverterAsDisconnected(Thing *thing);
 
+    QObject *modbusConnectionParent();
+    void moveModbusConnection(QObject *connection, const QHostAddress &address);
+
     quint64 getLocalSerialNumber();
 
     // Sma modbus data validation
@@ -33,14 +33,46 @@
 
 #include "sma.h"
 
+#include <modbusdatautils.h>
+
 SmaModbusBatteryInverterDiscovery::SmaModbusBatteryInverterDiscovery(NetworkDeviceDiscovery *networkDeviceDiscovery, quint16 port, quint16 modbusAddress, QObject *parent):
     QObject(parent),
     m_networkDeviceDiscovery{networkDeviceDiscovery},
     m_port(port),
     m_modbusAddress(modbusAddress)
 {
+    // Only hosts reporting the battery inverter device class get a full connection
+    m_probe = new ModbusNetworkProbe(this);
+    m_probe->addPort(m_port);
+
+    ModbusNetworkProbe::Fingerprint fingerprint;
+    fingerprint.name = "sma-battery-inverter";
+    fingerprint.slaveId = m_modbusAddress;
+    fingerprint.registerType = QModbusDataUnit::HoldingRegisters;
+    fingerprint.registerAddress = 30051; // deviceClass
+    fingerprint.size = 2;
+    fingerprint.validator = [](const QVector<quint16> &values) {
+        return ModbusDataUtils::convertToUInt32(values, ModbusDataUtils::ByteOrderBigEndian) == Sma::DeviceClassBatteryInverter;
+    };
+    m_probe->addFingerprint(fingerprint);
+
+    connect(m_probe, &ModbusNetworkProbe::resultFound, this, [this](const ModbusNetworkProbe::Result &result){
+        foreach (const NetworkDeviceInfo &networkDeviceInfo, m_networkDeviceInfos) {
+            if (networkDeviceInfo.address() == result.address) {
+                checkNetworkDevice(networkDeviceInfo);
+                return;
+            }
+        }
+    });
+
+    connect(m_probe, &ModbusNetworkProbe::finished, this, [this](){
+        m_probeFinished = true;
+        finishDiscoveryIfDone();
+    });
+
+    // Give the connections still initializing once all hosts have been probed a chance to finish
     m_gracePeriodTimer.setSingleShot(true);
-    m_gracePeriodTimer.setInterval(3000);
+    m_gracePeriodTimer.setInterval(5000);
     connect(&m_gracePeriodTimer, &QTimer::timeout, this, [this](){
         qCDebug(dcSma()) << "Discovery: Grace period timer triggered.";
         finishDiscovery();
@@ -53,11 +85,23 @@ void SmaModbusBatteryInverterDiscovery::startDiscovery()
     qCInfo(dcSma()) << "Discovery: Searching for SMA battery inverters in the network...";
     NetworkDeviceDiscoveryReply *discoveryReply = m_networkDeviceDiscovery->discover();
 
-    connect(discoveryReply, &NetworkDeviceDiscoveryReply::networkDeviceInfoAdded, this, &SmaModbusBatteryInverterDiscovery::checkNetworkDevice);
+    m_startDateTime = QDateTime::currentDateTime();
+    m_probeFinished = false;
+    m_finished = false;
+
+    connect(discoveryReply, &NetworkDeviceDiscoveryReply::networkDeviceInfoAdded, this, [this](const NetworkDeviceInfo &networkDeviceInfo){
+        m_networkDeviceInfos.append(networkDeviceInfo);
+        m_probe->probe(networkDeviceInfo.address());
+    });
 
     connect(discoveryReply, &NetworkDeviceDiscoveryReply::finished, this, [=](){
         qCDebug(dcSma()) << "Discovery: Network discovery finished. Found" << discoveryReply->networkDeviceInfos().count() << "network devices";
-        m_gracePeriodTimer.start();
+        m_networkDeviceInfos = discoveryReply->networkDeviceInfos();
+        foreach (const NetworkDeviceInfo &networkDeviceInfo, m_networkDeviceInfos)
+            m_probe->probe(networkDeviceInfo.address());
+
+        // The probe finishes once all pending hosts have been checked
+        m_probe->finish();
         discoveryReply->deleteLater();
     });
 }
@@ -131,12 +175,33 @@ void SmaModbusBatteryInverterDiscovery::cleanupConnection(SmaBatteryInverterModb
     m_connections.removeAll(connection);
     connection->disconnectDevice();
     connection->deleteLater();
+
+    finishDiscoveryIfDone();
+}
+
+void SmaModbusBatteryInverterDiscovery::finishDiscoveryIfDone()
+{
+    if (m_finished || !m_probeFinished)
+        return;
+
+    if (m_connections.isEmpty()) {
+        finishDiscovery();
+    } else if (!m_gracePeriodTimer.isActive()) {
+        m_gracePeriodTimer.start();
+    }
 }
 
 void SmaModbusBatteryInverterDiscovery::finishDiscovery()
 {
     qint64 durationMilliSeconds = QDateTime::currentMSecsSinceEpoch() - m_startDateTime.toMSecsSinceEpoch();
 
+    // Make sure we finish only once
+    if (m_finished)
+        return;
+
+    m_finished = true;
+    m_gracePeriodTimer.stop();
+
     // Cleanup any leftovers...we don't care any more
     foreach (SmaBatteryInverterModbusTcpConnection *connection, m_connections)
         cleanupConnection(connection);
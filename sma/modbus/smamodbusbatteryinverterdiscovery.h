@@ -34,7 +34,9 @@
 #include <network/networkdevicediscovery.h>
 
 #include <QObject>
+#include <QTimer>
 
+#include "modbusnetworkprobe.h"
 #include "smabatteryinvertermodbustcpconnection.h"
 
 class SmaModbusBatteryInverterDiscovery : public QObject
@@ -67,12 +69,18 @@ private:
     QTimer m_gracePeriodTimer;
     QDateTime m_startDateTime;
 
+    ModbusNetworkProbe *m_probe = nullptr;
+    bool m_probeFinished = false;
+    bool m_finished = false;
+
+    NetworkDeviceInfos m_networkDeviceInfos;
     QList<SmaBatteryInverterModbusTcpConnection *> m_connections;
 
     QList<Result> m_discoveryResults;
 
     void checkNetworkDevice(const NetworkDeviceInfo &networkDeviceInfo);
     void cleanupConnection(SmaBatteryInverterModbusTcpConnection *connection);
+    void finishDiscoveryIfDone();
 
     void finishDiscovery();
 
@@ -33,6 +33,8 @@
 
 #include "sma.h"
 
+#include <modbusdatautils.h>
+
 
 SmaModbusSolarInverterDiscovery::SmaModbusSolarInverterDiscovery(NetworkDeviceDiscovery *networkDeviceDiscovery, quint16 port, quint16 modbusAddress,QObject *parent)
     : QObject{parent},
@@ -40,7 +42,43 @@ SmaModbusSolarInverterDiscovery::SmaModbusSolarInverterDiscovery(NetworkDeviceDi
       m_port{port},
       m_modbusAddress{modbusAddress}
 {
+    // Only hosts reporting the solar inverter device class get a full connection
+    m_probe = new ModbusNetworkProbe(this);
+    m_probe->addPort(m_port);
+
+    ModbusNetworkProbe::Fingerprint fingerprint;
+    fingerprint.name = "sma-solar-inverter";
+    fingerprint.slaveId = m_modbusAddress;
+    fingerprint.registerType = QModbusDataUnit::HoldingRegisters;
+    fingerprint.registerAddress = 30051; // deviceClass
+    fingerprint.size = 2;
+    fingerprint.validator = [](const QVector<quint16> &values) {
+        return ModbusDataUtils::convertToUInt32(values, ModbusDataUtils::ByteOrderBigEndian) == Sma::DeviceClassSolarInverter;
+    };
+    m_probe->addFingerprint(fingerprint);
+
+    connect(m_probe, &ModbusNetworkProbe::resultFound, this, [this](const ModbusNetworkProbe::Result &result){
+        foreach (const NetworkDeviceInfo &networkDeviceInfo, m_networkDeviceInfos) {
+            if (networkDeviceInfo.address() == result.address) {
+                checkNetworkDevice(networkDeviceInfo);
+                return;
+            }
+        }
+    });
 
+    connect(m_probe, &ModbusNetworkProbe::finished, this, [this](){
+        m_probeFinished = true;
+        finishDiscoveryIfDone();
+    });
+
+    // Give the connections still initializing once all hosts have been probed a chance to finish,
+    // but don't wait forever for a device which never answers
+    m_gracePeriodTimer.setInterval(5000);
+    m_gracePeriodTimer.setSingleShot(true);
+    connect(&m_gracePeriodTimer, &QTimer::timeout, this, [this](){
+        qCDebug(dcSma()) << "Discovery: Grace period timer triggered.";
+        finishDiscovery();
+    });
 }
 
 void SmaModbusSolarInverterDiscovery::startDiscovery()
@@ -48,26 +86,29 @@ void SmaModbusSolarInverterDiscovery::startDiscovery()
     qCInfo(dcSma()) << "Discovery: Start searching for SMA modbus inverters in the network...";
     NetworkDeviceDiscoveryReply *discoveryReply = m_networkDeviceDiscovery->discover();
 
-    // Imedialty check any new device gets discovered
-    connect(discoveryReply, &NetworkDeviceDiscoveryReply::networkDeviceInfoAdded, this, &SmaModbusSolarInverterDiscovery::checkNetworkDevice);
+    m_startDateTime = QDateTime::currentDateTime();
+    m_probeFinished = false;
+    m_finished = false;
+
+    // Imedialty probe any new device gets discovered
+    connect(discoveryReply, &NetworkDeviceDiscoveryReply::networkDeviceInfoAdded, this, [this](const NetworkDeviceInfo &networkDeviceInfo){
+        m_networkDeviceInfos.append(networkDeviceInfo);
+        m_probe->probe(networkDeviceInfo.address());
+    });
 
     // Check what might be left on finished
     connect(discoveryReply, &NetworkDeviceDiscoveryReply::finished, discoveryReply, &NetworkDeviceDiscoveryReply::deleteLater);
     connect(discoveryReply, &NetworkDeviceDiscoveryReply::finished, this, [=](){
         qCDebug(dcSma()) << "Discovery: Network discovery finished. Found" << discoveryReply->networkDeviceInfos().count() << "network devices";
 
-        // Send a report request to nework device info not sent already...
-        foreach (const NetworkDeviceInfo &networkDeviceInfo, discoveryReply->networkDeviceInfos()) {
-            if (!m_verifiedNetworkDeviceInfos.contains(networkDeviceInfo)) {
-                checkNetworkDevice(networkDeviceInfo);
-            }
-        }
+        m_networkDeviceInfos = discoveryReply->networkDeviceInfos();
 
-        // Give the last connections added right before the network discovery finished a chance to check the device...
-        QTimer::singleShot(3000, this, [this](){
-            qCDebug(dcSma()) << "Discovery: Grace period timer triggered.";
-            finishDiscovery();
-        });
+        // Probe network device infos not probed already...
+        foreach (const NetworkDeviceInfo &networkDeviceInfo, m_networkDeviceInfos)
+            m_probe->probe(networkDeviceInfo.address());
+
+        // The probe finishes once all pending hosts have been checked
+        m_probe->finish();
     });
 }
 
@@ -161,12 +202,33 @@ void SmaModbusSolarInverterDiscovery::cleanupConnection(SmaSolarInverterModbusTc
     m_connections.removeAll(connection);
     connection->disconnectDevice();
     connection->deleteLater();
+
+    finishDiscoveryIfDone();
+}
+
+void SmaModbusSolarInverterDiscovery::finishDiscoveryIfDone()
+{
+    if (m_finished || !m_probeFinished)
+        return;
+
+    if (m_connections.isEmpty()) {
+        finishDiscovery();
+    } else if (!m_gracePeriodTimer.isActive()) {
+        m_gracePeriodTimer.start();
+    }
 }
 
 void SmaModbusSolarInverterDiscovery::finishDiscovery()
 {
     qint64 durationMilliSeconds = QDateTime::currentMSecsSinceEpoch() - m_startDateTime.toMSecsSinceEpoch();
 
+    // Make sure we finish only once
+    if (m_finished)
+        return;
+
+    m_finished = true;
+    m_gracePeriodTimer.stop();
+
     // Cleanup any leftovers...we don't care any more
     foreach (SmaSolarInverterModbusTcpConnection *connection, m_connections)
         cleanupConnection(connection);
@@ -36,6 +36,7 @@
 
 #include <network/networkdevicediscovery.h>
 
+#include "modbusnetworkprobe.h"
 #include "smasolarinvertermodbustcpconnection.h"
 
 class SmaModbusSolarInverterDiscovery : public QObject
@@ -66,6 +67,13 @@ private:
     quint16 m_modbusAddress;
 
     QDateTime m_startDateTime;
+
+    ModbusNetworkProbe *m_probe = nullptr;
+    bool m_probeFinished = false;
+    bool m_finished = false;
+    QTimer m_gracePeriodTimer;
+
+    NetworkDeviceInfos m_networkDeviceInfos;
     NetworkDeviceInfos m_verifiedNetworkDeviceInfos;
 
     QList<SmaSolarInverterModbusTcpConnection *> m_connections;
@@ -74,6 +82,7 @@ private:
 
     void checkNetworkDevice(const NetworkDeviceInfo &networkDeviceInfo);
     void cleanupConnection(SmaSolarInverterModbusTcpConnection *connection);
+    void finishDiscoveryIfDone();
 
     void finishDiscovery();
 
@@ -41,11 +41,30 @@ SunnyWebBox::SunnyWebBox(NetworkAccessManager *networkAccessManager, const QHost
     m_hostAddresss(hostAddress)
 {
     qCDebug(dcSma()) << "SunnyWebBox: Creating Sunny Web Box connection";
+
+    m_requestTimeoutTimer.setInterval(m_requestTimeout);
+    m_requestTimeoutTimer.setSingleShot(true);
+    connect(&m_requestTimeoutTimer, &QTimer::timeout, this, [this](){
+        if (!m_currentReply)
+            return;
+
+        qCWarning(dcSma()) << "SunnyWebBox: Request timeout. Aborting request.";
+        // Note: abort() emits finished, which continues with the next request
+        m_currentReply->abort();
+    });
 }
 
 SunnyWebBox::~SunnyWebBox()
 {
     qCDebug(dcSma()) << "SunnyWebBox: Deleting Sunny Web Box connection";
+    m_requestQueue.clear();
+    if (m_currentReply) {
+        QNetworkReply *reply = m_currentReply;
+        m_currentReply = nullptr;
+        reply->disconnect(this);
+        reply->abort();
+        reply->deleteLater();
+    }
 }
 
 QString SunnyWebBox::getPlantOverview()
@@ -163,7 +182,7 @@ QNetworkReply *SunnyWebBox::sendRequest(const QHostAddress &address, const QStri
     QJsonDocument doc;
     QJsonObject obj;
     obj["format"] = "JSON";
-    obj["id"] = requestId;
+    obj["id"] = finalRequestId;
     obj["proc"] = procedure;
     obj["version"] = "1.0";
 
@@ -179,6 +198,8 @@ QNetworkReply *SunnyWebBox::sendRequest(const QHostAddress &address, const QStri
     url.setPort(80);
     QNetworkRequest request(url);
     request.setHeader(QNetworkRequest::KnownHeaders::ContentTypeHeader, "application/json");
+    // Keep the TCP connection open between the polls, the WebBox is slow in accepting new connections
+    request.setRawHeader("Connection", "keep-alive");
     QByteArray data = doc.toJson(QJsonDocument::JsonFormat::Compact);
     data.prepend("RPC=");
     return m_networkManager->post(request, data);
@@ -189,54 +210,59 @@ QString SunnyWebBox::generateRequestId()
     return QUuid::createUuid().toString().remove('{').remove('-').left(14);
 }
 
-void SunnyWebBox::parseMessage(const QString &messageId, const QString &messageType, const QVariantMap &result)
+void SunnyWebBox::parseMessage(const QString &messageId, const QString &messageType, const QJsonObject &result)
 {
     if (messageType == "GetPlantOverview") {
+        // Pick only the channels we are interested in directly from the JSON array
+        // and stop as soon as all of them have been found.
         Overview overview;
-        QVariantList overviewList = result.value("overview").toList();
+        overview.power = 0;
+        overview.dailyYield = 0;
+        overview.totalYield = 0;
+        int channelsFound = 0;
+        const QJsonArray overviewArray = result.value("overview").toArray();
         qCDebug(dcSma()) << "SunnyWebBox: GetPlantOverview";
-        foreach (const QVariant &value, overviewList) {
-            QVariantMap map = value.toMap();
-
-            if (map["meta"].toString() == "GriPwr") {
-                overview.power = map["value"].toString().toDouble();
-                QString unit = map["unit"].toString();
-                qCDebug(dcSma()) << "SunnyWebBox:       - Power" << overview.power << unit;
-            } else if (map["meta"].toString() == "GriEgyTdy") {
-                overview.dailyYield = map["value"].toString().toDouble();
-                QString unit = map["unit"].toString();
-                qCDebug(dcSma()) << "SunnyWebBox:       - Daily yield" << overview.dailyYield << unit;
-            } else if (map["meta"].toString() == "GriEgyTot") {
-                overview.totalYield = map["value"].toString().toDouble();
-                QString unit = map["unit"].toString();
-                qCDebug(dcSma()) << "SunnyWebBox:       - Total yield" << overview.totalYield << unit;
-            } else if (map["meta"].toString() == "OpStt") {
-                overview.status = map["value"].toString();
+        for (int i = 0; i < overviewArray.count() && channelsFound < 5; i++) {
+            const QJsonObject channelObject = overviewArray.at(i).toObject();
+            const QString meta = channelObject.value("meta").toString();
+            if (meta == "GriPwr") {
+                overview.power = channelObject.value("value").toString().toDouble();
+                qCDebug(dcSma()) << "SunnyWebBox:       - Power" << overview.power << channelObject.value("unit").toString();
+            } else if (meta == "GriEgyTdy") {
+                overview.dailyYield = channelObject.value("value").toString().toDouble();
+                qCDebug(dcSma()) << "SunnyWebBox:       - Daily yield" << overview.dailyYield << channelObject.value("unit").toString();
+            } else if (meta == "GriEgyTot") {
+                overview.totalYield = channelObject.value("value").toString().toDouble();
+                qCDebug(dcSma()) << "SunnyWebBox:       - Total yield" << overview.totalYield << channelObject.value("unit").toString();
+            } else if (meta == "OpStt") {
+                overview.status = channelObject.value("value").toString();
                 qCDebug(dcSma()) << "SunnyWebBox:       - Status" << overview.status;
-            } else if (map["meta"].toString() == "Msg") {
-                overview.error = map["value"].toString();
+            } else if (meta == "Msg") {
+                overview.error = channelObject.value("value").toString();
                 qCDebug(dcSma()) << "SunnyWebBox:       - Error" << overview.error;
+            } else {
+                continue;
             }
+            channelsFound++;
         }
         emit plantOverviewReceived(messageId, overview);
 
     } else if (messageType == "GetDevices") {
         QList<Device> devices;
-        QVariantList deviceList = result.value("devices").toList();
+        const QJsonArray devicesArray = result.value("devices").toArray();
         qCDebug(dcSma()) << "SunnyWebBox: GetDevices" << result.value("totalDevicesReturned").toInt();
-        foreach (const QVariant &value, deviceList) {
+        foreach (const QJsonValue &value, devicesArray) {
             Device device;
-            QVariantMap map = value.toMap();
-            device.name = map["name"].toString();
+            const QJsonObject deviceObject = value.toObject();
+            device.name = deviceObject.value("name").toString();
             qCDebug(dcSma()) << "SunnyWebBox:       - Name" << device.name;
-            device.key = map["key"].toString();
+            device.key = deviceObject.value("key").toString();
             qCDebug(dcSma()) << "SunnyWebBox:       - Key" << device.key;
-            QVariantList childrenList = map["children"].toList();
-            foreach (const QVariant &childValue, childrenList) {
+            foreach (const QJsonValue &childValue, deviceObject.value("children").toArray()) {
                 Device child;
-                QVariantMap childMap = childValue.toMap();
-                device.name = childMap["name"].toString();
-                device.key = childMap["key"].toString();
+                const QJsonObject childObject = childValue.toObject();
+                child.name = childObject.value("name").toString();
+                child.key = childObject.value("key").toString();
                 device.childrens.append(child);
             }
             devices.append(device);
@@ -247,44 +273,50 @@ void SunnyWebBox::parseMessage(const QString &messageId, const QString &messageT
     } else if (messageType == "GetProcessDataChannels" ||
                messageType == "GetProDataChannels") {
         foreach (const QString &deviceKey, result.keys()) {
-            QStringList processDataChannels = result.value(deviceKey).toStringList();
+            QStringList processDataChannels;
+            foreach (const QJsonValue &channelValue, result.value(deviceKey).toArray())
+                processDataChannels.append(channelValue.toString());
+
             if (!processDataChannels.isEmpty())
                 emit processDataChannelsReceived(messageId, deviceKey, processDataChannels);
         }
     } else if (messageType == "GetProcessData") {
-        QVariantList devicesList = result.value("devices").toList();
+        const QJsonArray devicesArray = result.value("devices").toArray();
         qCDebug(dcSma()) << "SunnyWebBox: GetProcessData response received";
-        foreach (const QVariant &value, devicesList) {
-
-            QString key = value.toMap().value("key").toString();
-            QVariantList channelsList =  value.toMap().value("channels").toList();
+        foreach (const QJsonValue &value, devicesArray) {
+            const QJsonObject deviceObject = value.toObject();
+            QString key = deviceObject.value("key").toString();
             QHash<QString, QVariant> channels;
-            foreach (const QVariant &channel, channelsList) {
-                channels.insert(channel.toMap().value("meta").toString(), channel.toMap().value("value"));
+            foreach (const QJsonValue &channelValue, deviceObject.value("channels").toArray()) {
+                const QJsonObject channelObject = channelValue.toObject();
+                channels.insert(channelObject.value("meta").toString(), channelObject.value("value").toVariant());
             }
             emit processDataReceived(messageId, key, channels);
         }
     } else if (messageType == "GetParameterChannels") {
         foreach (const QString &deviceKey, result.keys()) {
-            QStringList parameterChannels = result.value(deviceKey).toStringList();
+            QStringList parameterChannels;
+            foreach (const QJsonValue &channelValue, result.value(deviceKey).toArray())
+                parameterChannels.append(channelValue.toString());
+
             if (!parameterChannels.isEmpty())
                 emit parameterChannelsReceived(messageId, deviceKey, parameterChannels);
         }
     } else if (messageType == "GetParameter"|| messageType == "SetParameter") {
-        QVariantList devicesList = result.value("devices").toList();
-        foreach (const QVariant &value, devicesList) {
-
-            QString key = value.toMap().value("key").toString();
-            QVariantList channelsList =  value.toMap().value("channels").toList();
+        const QJsonArray devicesArray = result.value("devices").toArray();
+        foreach (const QJsonValue &value, devicesArray) {
+            const QJsonObject deviceObject = value.toObject();
+            QString key = deviceObject.value("key").toString();
             QList<Parameter> parameters;
-            foreach (const QVariant &channel, channelsList) {
+            foreach (const QJsonValue &channelValue, deviceObject.value("channels").toArray()) {
+               const QJsonObject channelObject = channelValue.toObject();
                Parameter parameter;
-               parameter.meta = channel.toMap().value("meta").toString();
-               parameter.name = channel.toMap().value("name").toString();
-               parameter.unit = channel.toMap().value("unit").toString();
-               parameter.min = channel.toMap().value("min").toDouble();
-               parameter.max = channel.toMap().value("max").toDouble();
-               parameter.value = channel.toMap().value("value").toDouble();
+               parameter.meta = channelObject.value("meta").toString();
+               parameter.name = channelObject.value("name").toString();
+               parameter.unit = channelObject.value("unit").toString();
+               parameter.min = channelObject.value("min").toVariant().toDouble();
+               parameter.max = channelObject.value("max").toVariant().toDouble();
+               parameter.value = channelObject.value("value").toVariant().toDouble();
                parameters.append(parameter);
             }
             emit parametersReceived(messageId, key, parameters);
@@ -310,47 +342,88 @@ QString SunnyWebBox::sendMessage(const QHostAddress &address, const QString &pro
 
 QString SunnyWebBox::sendMessage(const QHostAddress &address, const QString &procedure, const QJsonObject &params)
 {
-    QString requestId = generateRequestId();
-    QNetworkReply *reply = sendRequest(m_hostAddresss, procedure, params, requestId);
-    connect(reply, &QNetworkReply::finished, reply, &QNetworkReply::deleteLater);
-    connect(reply, &QNetworkReply::finished, this, [this, address, requestId, reply]{
-
-        if (reply->error() != QNetworkReply::NoError) {
-            setConnectionStatus(false);
-            return;
+    Q_UNUSED(address)
+
+    // If the same procedure with the same params is still waiting in the queue,
+    // there is no need to ask the WebBox twice. Both callers will get the same response.
+    foreach (const Request &request, m_requestQueue) {
+        if (request.procedure == procedure && request.params == params) {
+            qCDebug(dcSma()) << "SunnyWebBox: Request" << procedure << "already queued. Merging with request" << request.requestId;
+            return request.requestId;
         }
+    }
 
-        setConnectionStatus(true);
+    Request request;
+    request.requestId = generateRequestId();
+    request.procedure = procedure;
+    request.params = params;
+    m_requestQueue.enqueue(request);
 
-        QByteArray data = reply->readAll();
-        qCDebug(dcSma()) << "SunnyWebBox: Received reply" << data;
+    sendNextRequest();
+    return request.requestId;
+}
 
-        QJsonParseError error;
-        QJsonDocument doc = QJsonDocument::fromJson(data, &error);
-        if (error.error != QJsonParseError::NoError) {
-            qCWarning(dcSma()) << "SunnyWebBox: Could not parse JSON" << error.errorString();
-            return;
-        }
-        if (!doc.isObject()) {
-            qCWarning(dcSma()) << "SunnyWebBox: JSON is not an Object";
-            return;
-        }
-        QVariantMap map = doc.toVariant().toMap();
-        if (map["version"] != "1.0") {
-            qCWarning(dcSma()) << "SunnyWebBox: API version not supported" << map["version"];
-            return;
+void SunnyWebBox::sendNextRequest()
+{
+    if (m_currentReply || m_requestQueue.isEmpty())
+        return;
+
+    Request request = m_requestQueue.dequeue();
+    QNetworkReply *reply = sendRequest(m_hostAddresss, request.procedure, request.params, request.requestId);
+    m_currentReply = reply;
+    m_requestTimeoutTimer.start();
+
+    connect(reply, &QNetworkReply::finished, this, [this, reply]{
+        reply->deleteLater();
+        if (m_currentReply == reply) {
+            m_requestTimeoutTimer.stop();
+            m_currentReply = nullptr;
         }
 
-        if (map.contains("proc") && map.contains("result")) {
-            QString requestType = map["proc"].toString();
-            QString requestId = map["id"].toString();
-            QVariantMap result = map.value("result").toMap();
-            parseMessage(requestId, requestType, result);
-        } else if (map.contains("proc") && map.contains("error")) {
-        } else {
-            qCWarning(dcSma()) << "SunnyWebBox: Missing proc or result value";
-        }
+        processReply(reply);
+
+        // The WebBox only handles one request at the time properly
+        sendNextRequest();
     });
-    return requestId;
 }
 
+void SunnyWebBox::processReply(QNetworkReply *reply)
+{
+    if (reply->error() != QNetworkReply::NoError) {
+        qCDebug(dcSma()) << "SunnyWebBox: Request finished with error" << reply->errorString();
+        setConnectionStatus(false);
+        return;
+    }
+
+    setConnectionStatus(true);
+
+    QByteArray data = reply->readAll();
+    qCDebug(dcSma()) << "SunnyWebBox: Received reply" << data;
+
+    QJsonParseError error;
+    QJsonDocument doc = QJsonDocument::fromJson(data, &error);
+    if (error.error != QJsonParseError::NoError) {
+        qCWarning(dcSma()) << "SunnyWebBox: Could not parse JSON" << error.errorString();
+        return;
+    }
+    if (!doc.isObject()) {
+        qCWarning(dcSma()) << "SunnyWebBox: JSON is not an Object";
+        return;
+    }
+
+    QJsonObject object = doc.object();
+    if (object.value("version").toString() != "1.0") {
+        qCWarning(dcSma()) << "SunnyWebBox: API version not supported" << object.value("version");
+        return;
+    }
+
+    if (object.contains("proc") && object.contains("result")) {
+        QString requestType = object.value("proc").toString();
+        QString requestId = object.value("id").toString();
+        parseMessage(requestId, requestType, object.value("result").toObject());
+    } else if (object.contains("proc") && object.contains("error")) {
+        qCWarning(dcSma()) << "SunnyWebBox: Request" << object.value("proc").toString() << "finished with error" << object.value("error");
+    } else {
+        qCWarning(dcSma()) << "SunnyWebBox: Missing proc or result value";
+    }
+}
@@ -39,6 +39,8 @@
 #include <QHostAddress>
 #include <QUdpSocket>
 #include <QDateTime>
+#include <QTimer>
+#include <QQueue>
 
 class SunnyWebBox : public QObject
 {
@@ -96,15 +98,30 @@ public:
     static QString generateRequestId();
 
 private:
+    struct Request {
+        QString requestId;
+        QString procedure;
+        QJsonObject params;
+    };
+
     NetworkAccessManager *m_networkManager = nullptr;
     bool m_connected = false;
     QHostAddress m_hostAddresss;
     QString m_macAddress;
     QDateTime m_lastRequest;
 
+    // The WebBox handles only one procedure per POST and is slow, so all requests
+    // are serialized over one kept-alive connection and identical pending requests get merged.
+    QQueue<Request> m_requestQueue;
+    QNetworkReply *m_currentReply = nullptr;
+    QTimer m_requestTimeoutTimer;
+    int m_requestTimeout = 10000;
+
     QString sendMessage(const QHostAddress &address, const QString &procedure);
     QString sendMessage(const QHostAddress &address, const QString &procedure, const QJsonObject &params);
-    void parseMessage(const QString &messageId, const QString &messageType, const QVariantMap &result);
+    void sendNextRequest();
+    void processReply(QNetworkReply *reply);
+    void parseMessage(const QString &messageId, const QString &messageType, const QJsonObject &result);
     void setConnectionStatus(bool connected);
 
 signals:
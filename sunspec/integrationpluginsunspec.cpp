@@ -123,6 +123,15 @@ void IntegrationPluginSunSpec::init()
     m_serialNumberParamTypeIds.insert(sunspecSinglePhaseMeterThingClassId, sunspecSinglePhaseMeterThingSerialNumberParamTypeId);
     m_serialNumberParamTypeIds.insert(sunspecSplitPhaseMeterThingClassId, sunspecSplitPhaseMeterThingSerialNumberParamTypeId);
     m_serialNumberParamTypeIds.insert(sunspecThreePhaseMeterThingClassId, sunspecThreePhaseMeterThingSerialNumberParamTypeId);
+
+    m_refreshScheduler = new SunSpecRefreshScheduler(this);
+
+    foreach (const QString &stateName, QStringList() << "phaseVoltage" << "phaseANVoltage" << "phaseBNVoltage" << "phaseCNVoltage"
+             << "voltagePhaseA" << "voltagePhaseB" << "voltagePhaseC" << "lnACVoltage" << "voltageDc") {
+        m_stateFilter.setRule(stateName, ModbusStateFilter::voltageRule());
+    }
+    m_stateFilter.setRule(QString("frequency"), ModbusStateFilter::frequencyRule());
+    m_stateFilter.setRule(QString("cabinetTemperature"), ModbusStateFilter::temperatureRule());
 }
 
 void IntegrationPluginSunSpec::discoverThings(ThingDiscoveryInfo *info)
@@ -219,6 +228,7 @@ void IntegrationPluginSunSpec::setupThing(ThingSetupInfo *info)
         if (m_sunSpecConnections.contains(thing->id())) {
             qCDebug(dcSunSpec()) << "Reconfiguring existing thing" << thing->name();
             m_sunSpecConnections.take(thing->id())->deleteLater();
+            m_solarEdgeBatterySlots.remove(thing->id());
 
             if (m_monitors.contains(thing)) {
                 hardwareManager()->networkDeviceDiscovery()->unregisterMonitor(m_monitors.take(thing));
@@ -264,6 +274,7 @@ void IntegrationPluginSunSpec::setupThing(ThingSetupInfo *info)
                         if (success) {
                             qCDebug(dcSunSpec()) << "Discovery finished successfully during setup of" << connection << ". Found SunSpec data on base register" << connection->baseRegister();
                             m_sunSpecConnections.insert(info->thing()->id(), connection);
+                            m_sunSpecConnectionThings.insert(info->thing()->id(), info->thing());
                             info->finish(Thing::ThingErrorNoError);
                             processDiscoveryResult(info->thing(), connection);
                         } else {
@@ -292,6 +303,7 @@ void IntegrationPluginSunSpec::setupThing(ThingSetupInfo *info)
 
         } else {
             m_sunSpecConnections.insert(thing->id(), connection);
+            m_sunSpecConnectionThings.insert(thing->id(), thing);
 
             // Finish the setup in any case, not the initial setup and the monitor takes care about connecting
             info->finish(Thing::ThingErrorNoError);
@@ -312,6 +324,7 @@ void IntegrationPluginSunSpec::setupThing(ThingSetupInfo *info)
         Thing *thing = info->thing();
         uint modelId = thing->paramValue(m_modelIdParamTypeIds.value(thing->thingClassId())).toInt();
         int modbusStartRegister = thing->paramValue(m_modbusAddressParamTypeIds.value(thing->thingClassId())).toInt();
+        m_sunSpecModelThingsByAddress.insert(sunSpecModelThingKey(modelId, modbusStartRegister, thing->parentId()), thing);
         SunSpecConnection *connection = m_sunSpecConnections.value(thing->parentId());
         if (connection) {
             // Get the model from the connection if already available
@@ -319,6 +332,7 @@ void IntegrationPluginSunSpec::setupThing(ThingSetupInfo *info)
                 if (model->modelId() == modelId && model->modbusStartRegister() == modbusStartRegister) {
                     connect(model, &SunSpecModel::blockUpdated, this, &IntegrationPluginSunSpec::onInverterBlockUpdated);
                     m_sunSpecInverters.insert(thing, model);
+                    registerSunSpecModelThing(thing, model);
                     qCDebug(dcSunSpec()) << "Model initialized successfully for" << thing;
                 }
             }
@@ -331,12 +345,14 @@ void IntegrationPluginSunSpec::setupThing(ThingSetupInfo *info)
         Thing *thing = info->thing();
         uint modelId = thing->paramValue(m_modelIdParamTypeIds.value(thing->thingClassId())).toInt();
         int modbusStartRegister = thing->paramValue(m_modbusAddressParamTypeIds.value(thing->thingClassId())).toInt();
+        m_sunSpecModelThingsByAddress.insert(sunSpecModelThingKey(modelId, modbusStartRegister, thing->parentId()), thing);
         SunSpecConnection *connection = m_sunSpecConnections.value(thing->parentId());
         if (connection) {
             // Get the model from the connection
             foreach (SunSpecModel *model, connection->models()) {
                 if (model->modelId() == modelId && model->modbusStartRegister() == modbusStartRegister) {
                     m_sunSpecMeters.insert(thing, model);
+                    registerSunSpecModelThing(thing, model);
                     connect(model, &SunSpecModel::blockUpdated, this, &IntegrationPluginSunSpec::onMeterBlockUpdated);
                     qCDebug(dcSunSpec()) << "Model initialized successfully for" << thing;
                 }
@@ -351,12 +367,14 @@ void IntegrationPluginSunSpec::setupThing(ThingSetupInfo *info)
         Thing *thing = info->thing();
         uint modelId = thing->paramValue(m_modelIdParamTypeIds.value(thing->thingClassId())).toInt();
         int modbusStartRegister = thing->paramValue(m_modbusAddressParamTypeIds.value(thing->thingClassId())).toInt();
+        m_sunSpecModelThingsByAddress.insert(sunSpecModelThingKey(modelId, modbusStartRegister, thing->parentId()), thing);
         SunSpecConnection *connection = m_sunSpecConnections.value(thing->parentId());
         if (connection) {
             // Get the model from the connection
             foreach (SunSpecModel *model, connection->models()) {
                 if (model->modelId() == modelId && model->modbusStartRegister() == modbusStartRegister) {
                     m_sunSpecStorages.insert(thing, model);
+                    registerSunSpecModelThing(thing, model);
                     connect(model, &SunSpecModel::blockUpdated, this, &IntegrationPluginSunSpec::onStorageBlockUpdated);
                     qCDebug(dcSunSpec()) << "Model initialized successfully for" << thing;
                 }
@@ -393,12 +411,11 @@ void IntegrationPluginSunSpec::postSetupThing(Thing *thing)
         }
     }
 
-    // Create the refresh timer if not already set up
-    if (!m_refreshTimer) {
-        qCDebug(dcSunSpec()) << "Starting refresh timer";
-        int refreshTime = configValue(sunSpecPluginUpdateIntervalParamTypeId).toInt();
-        m_refreshTimer = hardwareManager()->pluginTimerManager()->registerTimer(refreshTime);
-        connect(m_refreshTimer, &PluginTimer::timeout, this, &IntegrationPluginSunSpec::onRefreshTimer);
+    // Start the refresh scheduler if not already running
+    if (!m_refreshScheduler->isRunning()) {
+        qCDebug(dcSunSpec()) << "Starting refresh scheduler";
+        m_refreshScheduler->setInterval(configValue(sunSpecPluginUpdateIntervalParamTypeId).toInt() * 1000);
+        m_refreshScheduler->start();
     }
 }
 
@@ -406,16 +423,34 @@ void IntegrationPluginSunSpec::thingRemoved(Thing *thing)
 {
     qCDebug(dcSunSpec()) << "Thing removed" << thing->name();
 
+    m_sunSpecConnectionThings.remove(thing->id());
+    m_solarEdgeBatterySlots.remove(thing->id());
+    if (m_modelIdParamTypeIds.contains(thing->thingClassId())) {
+        uint modelId = thing->paramValue(m_modelIdParamTypeIds.value(thing->thingClassId())).toUInt();
+        uint modbusAddress = thing->paramValue(m_modbusAddressParamTypeIds.value(thing->thingClassId())).toUInt();
+        m_sunSpecModelThingsByAddress.remove(sunSpecModelThingKey(modelId, modbusAddress, thing->parentId()));
+    }
+
     if (m_sunSpecConnections.contains(thing->id())) {
         m_sunSpecConnections.take(thing->id())->deleteLater();
     } else if (m_sunSpecThings.contains(thing)) {
-        m_sunSpecThings.take(thing)->deleteLater();
+        SunSpecThing *sunSpecThing = m_sunSpecThings.take(thing);
+        m_refreshScheduler->remove(sunSpecThing);
+        sunSpecThing->deleteLater();
     } else if (m_sunSpecInverters.contains(thing)) {
-        m_sunSpecInverters.remove(thing);
+        SunSpecModel *model = m_sunSpecInverters.take(thing);
+        m_sunSpecModelThings.remove(model);
+        m_refreshScheduler->remove(model);
+        m_stateFilter.resetThing(thing->id());
     } else if (m_sunSpecMeters.contains(thing)) {
-        m_sunSpecMeters.remove(thing);
+        SunSpecModel *model = m_sunSpecMeters.take(thing);
+        m_sunSpecModelThings.remove(model);
+        m_refreshScheduler->remove(model);
+        m_stateFilter.resetThing(thing->id());
     } else if (m_sunSpecStorages.contains(thing)) {
-        m_sunSpecStorages.remove(thing);
+        SunSpecModel *model = m_sunSpecStorages.take(thing);
+        m_sunSpecModelThings.remove(model);
+        m_refreshScheduler->remove(model);
     } else {
         Q_ASSERT_X(false, "thingRemoved", QString("Unhandled thingClassId: %1").arg(thing->thingClassId().toString()).toUtf8());
     }
@@ -425,9 +460,8 @@ void IntegrationPluginSunSpec::thingRemoved(Thing *thing)
     }
 
     if (myThings().isEmpty()) {
-        qCDebug(dcSunSpec()) << "Stopping refresh timer";
-        hardwareManager()->pluginTimerManager()->unregisterTimer(m_refreshTimer);
-        m_refreshTimer = nullptr;
+        qCDebug(dcSunSpec()) << "Stopping refresh scheduler";
+        m_refreshScheduler->stop();
     }
 }
 
@@ -526,6 +560,11 @@ void IntegrationPluginSunSpec::executeAction(ThingActionInfo *info)
 
 Thing *IntegrationPluginSunSpec::getThingForSunSpecModel(uint modelId, uint modbusAddress, const ThingId &parentId)
 {
+    SunSpecModelKey key = sunSpecModelThingKey(modelId, modbusAddress, parentId);
+    if (m_sunSpecModelThingsByAddress.contains(key))
+        return m_sunSpecModelThingsByAddress.value(key);
+
+    // Things loaded on startup might not be set up yet, fall back to the things list and index the result
     foreach (Thing *thing, myThings()) {
         if (!m_modelIdParamTypeIds.contains(thing->thingClassId()))
             continue;
@@ -533,6 +572,7 @@ Thing *IntegrationPluginSunSpec::getThingForSunSpecModel(uint modelId, uint modb
         uint thingModelId = thing->paramValue(m_modelIdParamTypeIds.value(thing->thingClassId())).toUInt();
         uint thingModbusAddress = thing->paramValue(m_modbusAddressParamTypeIds.value(thing->thingClassId())).toUInt();
         if (thingModelId == modelId && thingModbusAddress == modbusAddress && thing->parentId() == parentId) {
+            m_sunSpecModelThingsByAddress.insert(key, thing);
             return thing;
         }
     }
@@ -540,6 +580,41 @@ Thing *IntegrationPluginSunSpec::getThingForSunSpecModel(uint modelId, uint modb
     return nullptr;
 }
 
+SunSpecModelKey IntegrationPluginSunSpec::sunSpecModelThingKey(uint modelId, uint modbusAddress, const ThingId &parentId) const
+{
+    SunSpecModelKey key;
+    key.parentId = parentId;
+    key.modelId = modelId;
+    key.modbusAddress = modbusAddress;
+    return key;
+}
+
+void IntegrationPluginSunSpec::registerSunSpecModelThing(Thing *thing, SunSpecModel *model)
+{
+    m_sunSpecModelThings.insert(model, thing);
+
+    m_refreshScheduler->addModel(model, refreshDivider(model));
+
+    // The models get deleted together with their connection, i.e. on reconfigure
+    connect(model, &SunSpecModel::destroyed, this, [this, model](){
+        m_sunSpecModelThings.remove(model);
+    });
+}
+
+uint IntegrationPluginSunSpec::refreshDivider(SunSpecModel *model) const
+{
+    // Models holding only nameplate data or settings can be configured to be read less often,
+    // all others provide live values and get refreshed every interval
+    foreach (const QString &modelId, configValue(sunSpecPluginSettingsModelIdsParamTypeId).toString().split(',')) {
+        bool valueOk = false;
+        if (modelId.trimmed().toUInt(&valueOk) == model->modelId() && valueOk) {
+            return configValue(sunSpecPluginSettingsModelRefreshDividerParamTypeId).toUInt();
+        }
+    }
+
+    return 1;
+}
+
 bool IntegrationPluginSunSpec::sunspecThingAlreadyAdded(uint modelId, uint modbusAddress, const ThingId &parentId)
 {
     return getThingForSunSpecModel(modelId, modbusAddress, parentId)!= nullptr;
@@ -563,6 +638,7 @@ void IntegrationPluginSunSpec::processDiscoveryResult(Thing *thing, SunSpecConne
 
                 if (!m_sunSpecInverters.contains(modelThing)) {
                     m_sunSpecInverters.insert(modelThing, model);
+                    registerSunSpecModelThing(modelThing, model);
                     connect(model, &SunSpecModel::blockUpdated, this, &IntegrationPluginSunSpec::onInverterBlockUpdated);
                     qCDebug(dcSunSpec()) << "Model initialized successfully for" << modelThing;
                 }
@@ -572,6 +648,7 @@ void IntegrationPluginSunSpec::processDiscoveryResult(Thing *thing, SunSpecConne
 
                 if (!m_sunSpecMeters.contains(modelThing)) {
                     m_sunSpecMeters.insert(modelThing, model);
+                    registerSunSpecModelThing(modelThing, model);
                     connect(model, &SunSpecModel::blockUpdated, this, &IntegrationPluginSunSpec::onMeterBlockUpdated);
                     qCDebug(dcSunSpec()) << "Model initialized successfully for" << modelThing;
                 }
@@ -579,6 +656,7 @@ void IntegrationPluginSunSpec::processDiscoveryResult(Thing *thing, SunSpecConne
 
                 if (!m_sunSpecStorages.contains(modelThing)) {
                     m_sunSpecStorages.insert(modelThing, model);
+                    registerSunSpecModelThing(modelThing, model);
                     connect(model, &SunSpecModel::blockUpdated, this, &IntegrationPluginSunSpec::onStorageBlockUpdated);
                     qCDebug(dcSunSpec()) << "Model initialized successfully for" << modelThing;
                 }
@@ -756,6 +834,7 @@ void IntegrationPluginSunSpec::setupSolarEdgeBattery(ThingSetupInfo *info)
     SolarEdgeBattery *battery = new SolarEdgeBattery(thing, connection, modbusStartRegister, connection);
 
     m_sunSpecThings.insert(thing, battery);
+    m_refreshScheduler->addThing(battery);
     connect(battery, &SolarEdgeBattery::blockDataUpdated, this, &IntegrationPluginSunSpec::onSolarEdgeBatteryBlockUpdated);
     info->finish(Thing::ThingErrorNoError);
 
@@ -782,8 +861,37 @@ void IntegrationPluginSunSpec::searchSolarEdgeBatteries(SunSpecConnection *conne
     // Read the battery id to verify if the battery is connected.
     // Battery 1: start register 0xE100, device id register 0xE140
     // Battery 2: start register 0xE200, device id register 0xE240
-    searchSolarEdgeBattery(connection, parentThingId, 0xE100);
-    searchSolarEdgeBattery(connection, parentThingId, 0xE200);
+    // All slots get probed in parallel, slots already known to be empty or set up are skipped.
+    foreach (quint16 startRegister, QList<quint16>() << 0xE100 << 0xE200) {
+        if (m_solarEdgeBatterySlots.value(parentThingId).contains(startRegister)) {
+            BatterySlot slot = m_solarEdgeBatterySlots.value(parentThingId).value(startRegister);
+            if (!slot.present) {
+                if (slot.timestamp.secsTo(QDateTime::currentDateTime()) < s_emptyBatterySlotExpiry) {
+                    qCDebug(dcSunSpec()) << "No SolarEdge battery connected on register" << startRegister << "(cached)";
+                    continue;
+                }
+
+                qCDebug(dcSunSpec()) << "Empty SolarEdge battery slot on register" << startRegister << "expired, probing again";
+                searchSolarEdgeBattery(connection, parentThingId, startRegister);
+                continue;
+            }
+
+            bool batteryAdded = false;
+            foreach (Thing *batteryThing, myThings().filterByParentId(parentThingId).filterByThingClassId(solarEdgeBatteryThingClassId)) {
+                if (batteryThing->paramValue(solarEdgeBatteryThingModbusAddressParamTypeId).toUInt() == startRegister) {
+                    batteryAdded = true;
+                    break;
+                }
+            }
+
+            if (batteryAdded) {
+                qCDebug(dcSunSpec()) << "SolarEdge battery on register" << startRegister << "already set up";
+                continue;
+            }
+        }
+
+        searchSolarEdgeBattery(connection, parentThingId, startRegister);
+    }
 }
 
 void IntegrationPluginSunSpec::searchSolarEdgeBattery(SunSpecConnection *connection, const ThingId &parentThingId, quint16 startRegister)
@@ -798,7 +906,14 @@ void IntegrationPluginSunSpec::searchSolarEdgeBattery(SunSpecConnection *connect
         // Delete this object since we used it only for set up
         battery->deleteLater();
 
-        // If init failed, no battery connected
+        // If init failed, no battery connected. Don't remember slots which failed due to communication errors.
+        if (success || battery->slotEmpty()) {
+            BatterySlot slot;
+            slot.present = success;
+            slot.timestamp = QDateTime::currentDateTime();
+            m_solarEdgeBatterySlots[parentThingId].insert(startRegister, slot);
+        }
+
         if (!success) {
             qCDebug(dcSunSpec()) << "No SolarEdge battery connected on register" << startRegister << "- not creating thing.";
             return;
@@ -831,7 +946,7 @@ double IntegrationPluginSunSpec::calculateSolarEdgePvProduction(Thing *thing, do
     // on loading or discharging of the battery
 
     double pvPower = acPower;
-    Thing *parentThing = myThings().findById(thing->parentId());
+    Thing *parentThing = m_sunSpecConnectionThings.value(thing->parentId());
     if (parentThing && parentThing->thingClassId() == solarEdgeConnectionThingClassId) {
         SolarEdgeBattery *battery = nullptr;
         // This is a solar edge, let's see if we have a battery for this connection
@@ -1134,50 +1249,12 @@ void IntegrationPluginSunSpec::markThingStatesDisconnected(Thing *thing)
 
 }
 
-void IntegrationPluginSunSpec::onRefreshTimer()
-{
-    // Update meters
-    foreach (SunSpecModel *model, m_sunSpecMeters.values()) {
-        if (model->connection()->connected()) {
-            model->readBlockData();
-        }
-    }
-
-    // Update storage
-    foreach (SunSpecModel *model, m_sunSpecStorages.values()) {
-        if (model->connection()->connected()) {
-            model->readBlockData();
-        }
-    }
-
-    // Update all other sunspec thing blocks
-    foreach (SunSpecThing *sunSpecThing, m_sunSpecThings) {
-        if (sunSpecThing->connection()->connected()) {
-            sunSpecThing->readBlockData();
-        }
-    }
-
-    // Update inverters
-    foreach (SunSpecModel *model, m_sunSpecInverters.values()) {
-        if (model->connection()->connected()) {
-            model->readBlockData();
-        }
-    }
-}
-
 void IntegrationPluginSunSpec::onPluginConfigurationChanged(const ParamTypeId &paramTypeId, const QVariant &value)
 {
     // Check refresh schedule
     if (paramTypeId == sunSpecPluginUpdateIntervalParamTypeId) {
         qCDebug(dcSunSpec()) << "Update interval has changed" << value.toInt();
-        if (m_refreshTimer) {
-            int refreshTime = value.toInt();
-            m_refreshTimer->stop();
-            hardwareManager()->pluginTimerManager()->unregisterTimer(m_refreshTimer);
-            m_refreshTimer = hardwareManager()->pluginTimerManager()->registerTimer(refreshTime);
-            connect(m_refreshTimer, &PluginTimer::timeout, this, &IntegrationPluginSunSpec::onRefreshTimer);
-            m_refreshTimer->start();
-        }
+        m_refreshScheduler->setInterval(value.toInt() * 1000);
     } else if (paramTypeId == sunSpecPluginNumberOfRetriesParamTypeId) {
         qCDebug(dcSunSpec()) << "Updating number of retries" << value.toUInt();
         foreach (SunSpecConnection *connection, m_sunSpecConnections) {
@@ -1188,6 +1265,11 @@ void IntegrationPluginSunSpec::onPluginConfigurationChanged(const ParamTypeId &p
         foreach (SunSpecConnection *connection, m_sunSpecConnections) {
             connection->setTimeout(value.toUInt());
         }
+    } else if (paramTypeId == sunSpecPluginSettingsModelIdsParamTypeId || paramTypeId == sunSpecPluginSettingsModelRefreshDividerParamTypeId) {
+        qCDebug(dcSunSpec()) << "Settings models have changed" << value;
+        foreach (SunSpecModel *model, m_sunSpecModelThings.keys()) {
+            m_refreshScheduler->addModel(model, refreshDivider(model));
+        }
     } else {
         qCWarning(dcSunSpec()) << "Unknown plugin configuration" << paramTypeId << "Value" << value;
     }
@@ -1196,11 +1278,11 @@ void IntegrationPluginSunSpec::onPluginConfigurationChanged(const ParamTypeId &p
 void IntegrationPluginSunSpec::onInverterBlockUpdated()
 {
     SunSpecModel *model = qobject_cast<SunSpecModel *>(sender());
-    Thing *thing = m_sunSpecInverters.key(model);
+    Thing *thing = m_sunSpecModelThings.value(model);
     if (!thing) return;
 
     // Get parent thing
-    Thing *parentThing = myThings().findById(thing->parentId());
+    Thing *parentThing = m_sunSpecConnectionThings.value(thing->parentId());
     if (!parentThing)
         return;
 
@@ -1216,12 +1298,12 @@ void IntegrationPluginSunSpec::onInverterBlockUpdated()
         thing->setStateValue(sunspecSinglePhaseInverterCurrentPowerStateTypeId, currentPower);
         thing->setStateValue(sunspecSinglePhaseInverterTotalEnergyProducedStateTypeId, inverter->wattHours() / 1000.0);
         thing->setStateValue(sunspecSinglePhaseInverterTotalCurrentStateTypeId, inverter->amps());
-        thing->setStateValue(sunspecSinglePhaseInverterFrequencyStateTypeId, inverter->hz());
-        thing->setStateValue(sunspecSinglePhaseInverterCabinetTemperatureStateTypeId, inverter->cabinetTemperature());
-        thing->setStateValue(sunspecSinglePhaseInverterPhaseVoltageStateTypeId, inverter->phaseVoltageAn());
+        m_stateFilter.setStateValue(thing, sunspecSinglePhaseInverterFrequencyStateTypeId, inverter->hz());
+        m_stateFilter.setStateValue(thing, sunspecSinglePhaseInverterCabinetTemperatureStateTypeId, inverter->cabinetTemperature());
+        m_stateFilter.setStateValue(thing, sunspecSinglePhaseInverterPhaseVoltageStateTypeId, inverter->phaseVoltageAn());
         thing->setStateValue(sunspecSinglePhaseInverterOperatingStateStateTypeId, getInverterStateString(inverter->operatingState()));
         thing->setStateValue(sunspecSinglePhaseInverterErrorStateTypeId, getInverterErrorString(inverter->event1()));
-        thing->setStateValue(sunspecSinglePhaseInverterVoltageDcStateTypeId, inverter->dcVoltage());
+        m_stateFilter.setStateValue(thing, sunspecSinglePhaseInverterVoltageDcStateTypeId, inverter->dcVoltage());
         thing->setStateValue(sunspecSinglePhaseInverterCurrentDcStateTypeId, inverter->dcAmps());
         thing->setStateValue(sunspecSinglePhaseInverterCurrentPowerDcStateTypeId, -inverter->dcWatts());
         break;
@@ -1237,12 +1319,12 @@ void IntegrationPluginSunSpec::onInverterBlockUpdated()
         thing->setStateValue(sunspecSinglePhaseInverterCurrentPowerStateTypeId, currentPower);
         thing->setStateValue(sunspecSinglePhaseInverterTotalEnergyProducedStateTypeId, inverter->wattHours() / 1000.0);
         thing->setStateValue(sunspecSinglePhaseInverterTotalCurrentStateTypeId, inverter->amps());
-        thing->setStateValue(sunspecSinglePhaseInverterFrequencyStateTypeId, inverter->hz());
-        thing->setStateValue(sunspecSinglePhaseInverterCabinetTemperatureStateTypeId, inverter->cabinetTemperature());
-        thing->setStateValue(sunspecSinglePhaseInverterPhaseVoltageStateTypeId, inverter->phaseVoltageAn());
+        m_stateFilter.setStateValue(thing, sunspecSinglePhaseInverterFrequencyStateTypeId, inverter->hz());
+        m_stateFilter.setStateValue(thing, sunspecSinglePhaseInverterCabinetTemperatureStateTypeId, inverter->cabinetTemperature());
+        m_stateFilter.setStateValue(thing, sunspecSinglePhaseInverterPhaseVoltageStateTypeId, inverter->phaseVoltageAn());
         thing->setStateValue(sunspecSinglePhaseInverterOperatingStateStateTypeId, getInverterStateString(inverter->operatingState()));
         thing->setStateValue(sunspecSinglePhaseInverterErrorStateTypeId, getInverterErrorString(inverter->event1()));
-        thing->setStateValue(sunspecSinglePhaseInverterVoltageDcStateTypeId, inverter->dcVoltage());
+        m_stateFilter.setStateValue(thing, sunspecSinglePhaseInverterVoltageDcStateTypeId, inverter->dcVoltage());
         thing->setStateValue(sunspecSinglePhaseInverterCurrentDcStateTypeId, inverter->dcAmps());
         thing->setStateValue(sunspecSinglePhaseInverterCurrentPowerDcStateTypeId, -inverter->dcWatts());
         break;
@@ -1257,15 +1339,15 @@ void IntegrationPluginSunSpec::onInverterBlockUpdated()
         thing->setStateValue(sunspecSplitPhaseInverterCurrentPowerStateTypeId, currentPower);
         thing->setStateValue(sunspecSplitPhaseInverterTotalEnergyProducedStateTypeId, inverter->wattHours() / 1000.0);
         thing->setStateValue(sunspecSplitPhaseInverterTotalCurrentStateTypeId, inverter->amps());
-        thing->setStateValue(sunspecSplitPhaseInverterFrequencyStateTypeId, inverter->hz());
-        thing->setStateValue(sunspecSplitPhaseInverterCabinetTemperatureStateTypeId, inverter->cabinetTemperature());
-        thing->setStateValue(sunspecSplitPhaseInverterPhaseANVoltageStateTypeId, inverter->phaseVoltageAn());
-        thing->setStateValue(sunspecSplitPhaseInverterPhaseBNVoltageStateTypeId, inverter->phaseVoltageBn());
+        m_stateFilter.setStateValue(thing, sunspecSplitPhaseInverterFrequencyStateTypeId, inverter->hz());
+        m_stateFilter.setStateValue(thing, sunspecSplitPhaseInverterCabinetTemperatureStateTypeId, inverter->cabinetTemperature());
+        m_stateFilter.setStateValue(thing, sunspecSplitPhaseInverterPhaseANVoltageStateTypeId, inverter->phaseVoltageAn());
+        m_stateFilter.setStateValue(thing, sunspecSplitPhaseInverterPhaseBNVoltageStateTypeId, inverter->phaseVoltageBn());
         thing->setStateValue(sunspecSplitPhaseInverterPhaseACurrentStateTypeId, inverter->ampsPhaseA());
         thing->setStateValue(sunspecSplitPhaseInverterPhaseBCurrentStateTypeId, inverter->ampsPhaseB());
         thing->setStateValue(sunspecSplitPhaseInverterOperatingStateStateTypeId, getInverterStateString(inverter->operatingState()));
         thing->setStateValue(sunspecSplitPhaseInverterErrorStateTypeId, getInverterErrorString(inverter->event1()));
-        thing->setStateValue(sunspecSplitPhaseInverterVoltageDcStateTypeId, inverter->dcVoltage());
+        m_stateFilter.setStateValue(thing, sunspecSplitPhaseInverterVoltageDcStateTypeId, inverter->dcVoltage());
         thing->setStateValue(sunspecSplitPhaseInverterCurrentDcStateTypeId, inverter->dcAmps());
         thing->setStateValue(sunspecSplitPhaseInverterCurrentPowerDcStateTypeId, -inverter->dcWatts());
         break;
@@ -1280,15 +1362,15 @@ void IntegrationPluginSunSpec::onInverterBlockUpdated()
         thing->setStateValue(sunspecSplitPhaseInverterCurrentPowerStateTypeId, currentPower);
         thing->setStateValue(sunspecSplitPhaseInverterTotalEnergyProducedStateTypeId, inverter->wattHours() / 1000.0);
         thing->setStateValue(sunspecSplitPhaseInverterTotalCurrentStateTypeId, inverter->amps());
-        thing->setStateValue(sunspecSplitPhaseInverterFrequencyStateTypeId, inverter->hz());
-        thing->setStateValue(sunspecSplitPhaseInverterCabinetTemperatureStateTypeId, inverter->cabinetTemperature());
-        thing->setStateValue(sunspecSplitPhaseInverterPhaseANVoltageStateTypeId, inverter->phaseVoltageAn());
-        thing->setStateValue(sunspecSplitPhaseInverterPhaseBNVoltageStateTypeId, inverter->phaseVoltageBn());
+        m_stateFilter.setStateValue(thing, sunspecSplitPhaseInverterFrequencyStateTypeId, inverter->hz());
+        m_stateFilter.setStateValue(thing, sunspecSplitPhaseInverterCabinetTemperatureStateTypeId, inverter->cabinetTemperature());
+        m_stateFilter.setStateValue(thing, sunspecSplitPhaseInverterPhaseANVoltageStateTypeId, inverter->phaseVoltageAn());
+        m_stateFilter.setStateValue(thing, sunspecSplitPhaseInverterPhaseBNVoltageStateTypeId, inverter->phaseVoltageBn());
         thing->setStateValue(sunspecSplitPhaseInverterPhaseACurrentStateTypeId, inverter->ampsPhaseA());
         thing->setStateValue(sunspecSplitPhaseInverterPhaseBCurrentStateTypeId, inverter->ampsPhaseB());
         thing->setStateValue(sunspecSplitPhaseInverterOperatingStateStateTypeId, getInverterStateString(inverter->operatingState()));
         thing->setStateValue(sunspecSplitPhaseInverterErrorStateTypeId, getInverterErrorString(inverter->event1()));
-        thing->setStateValue(sunspecSplitPhaseInverterVoltageDcStateTypeId, inverter->dcVoltage());
+        m_stateFilter.setStateValue(thing, sunspecSplitPhaseInverterVoltageDcStateTypeId, inverter->dcVoltage());
         thing->setStateValue(sunspecSplitPhaseInverterCurrentDcStateTypeId, inverter->dcAmps());
         thing->setStateValue(sunspecSplitPhaseInverterCurrentPowerDcStateTypeId, -inverter->dcWatts());
         break;
@@ -1303,17 +1385,17 @@ void IntegrationPluginSunSpec::onInverterBlockUpdated()
         thing->setStateValue(sunspecThreePhaseInverterCurrentPowerStateTypeId, currentPower);
         thing->setStateValue(sunspecThreePhaseInverterTotalEnergyProducedStateTypeId, inverter->wattHours() / 1000.0);
         thing->setStateValue(sunspecThreePhaseInverterTotalCurrentStateTypeId, inverter->amps());
-        thing->setStateValue(sunspecThreePhaseInverterFrequencyStateTypeId, inverter->hz());
-        thing->setStateValue(sunspecThreePhaseInverterCabinetTemperatureStateTypeId, inverter->cabinetTemperature());
-        thing->setStateValue(sunspecThreePhaseInverterPhaseANVoltageStateTypeId, inverter->phaseVoltageAn());
-        thing->setStateValue(sunspecThreePhaseInverterPhaseBNVoltageStateTypeId, inverter->phaseVoltageBn());
-        thing->setStateValue(sunspecThreePhaseInverterPhaseCNVoltageStateTypeId, inverter->phaseVoltageCn());
+        m_stateFilter.setStateValue(thing, sunspecThreePhaseInverterFrequencyStateTypeId, inverter->hz());
+        m_stateFilter.setStateValue(thing, sunspecThreePhaseInverterCabinetTemperatureStateTypeId, inverter->cabinetTemperature());
+        m_stateFilter.setStateValue(thing, sunspecThreePhaseInverterPhaseANVoltageStateTypeId, inverter->phaseVoltageAn());
+        m_stateFilter.setStateValue(thing, sunspecThreePhaseInverterPhaseBNVoltageStateTypeId, inverter->phaseVoltageBn());
+        m_stateFilter.setStateValue(thing, sunspecThreePhaseInverterPhaseCNVoltageStateTypeId, inverter->phaseVoltageCn());
         thing->setStateValue(sunspecThreePhaseInverterPhaseACurrentStateTypeId, inverter->ampsPhaseA());
         thing->setStateValue(sunspecThreePhaseInverterPhaseBCurrentStateTypeId, inverter->ampsPhaseB());
         thing->setStateValue(sunspecThreePhaseInverterPhaseCCurrentStateTypeId, inverter->ampsPhaseC());
         thing->setStateValue(sunspecThreePhaseInverterOperatingStateStateTypeId, getInverterStateString(inverter->operatingState()));
         thing->setStateValue(sunspecThreePhaseInverterErrorStateTypeId, getInverterErrorString(inverter->event1()));
-        thing->setStateValue(sunspecThreePhaseInverterVoltageDcStateTypeId, inverter->dcVoltage());
+        m_stateFilter.setStateValue(thing, sunspecThreePhaseInverterVoltageDcStateTypeId, inverter->dcVoltage());
         thing->setStateValue(sunspecThreePhaseInverterCurrentDcStateTypeId, inverter->dcAmps());
         thing->setStateValue(sunspecThreePhaseInverterCurrentPowerDcStateTypeId, -inverter->dcWatts());
         break;
@@ -1328,17 +1410,17 @@ void IntegrationPluginSunSpec::onInverterBlockUpdated()
         thing->setStateValue(sunspecThreePhaseInverterCurrentPowerStateTypeId, currentPower);
         thing->setStateValue(sunspecThreePhaseInverterTotalEnergyProducedStateTypeId, inverter->wattHours() / 1000.0);
         thing->setStateValue(sunspecThreePhaseInverterTotalCurrentStateTypeId, inverter->amps());
-        thing->setStateValue(sunspecThreePhaseInverterFrequencyStateTypeId, inverter->hz());
-        thing->setStateValue(sunspecThreePhaseInverterCabinetTemperatureStateTypeId, inverter->cabinetTemperature());
-        thing->setStateValue(sunspecThreePhaseInverterPhaseANVoltageStateTypeId, inverter->phaseVoltageAn());
-        thing->setStateValue(sunspecThreePhaseInverterPhaseBNVoltageStateTypeId, inverter->phaseVoltageBn());
-        thing->setStateValue(sunspecThreePhaseInverterPhaseCNVoltageStateTypeId, inverter->phaseVoltageCn());
+        m_stateFilter.setStateValue(thing, sunspecThreePhaseInverterFrequencyStateTypeId, inverter->hz());
+        m_stateFilter.setStateValue(thing, sunspecThreePhaseInverterCabinetTemperatureStateTypeId, inverter->cabinetTemperature());
+        m_stateFilter.setStateValue(thing, sunspecThreePhaseInverterPhaseANVoltageStateTypeId, inverter->phaseVoltageAn());
+        m_stateFilter.setStateValue(thing, sunspecThreePhaseInverterPhaseBNVoltageStateTypeId, inverter->phaseVoltageBn());
+        m_stateFilter.setStateValue(thing, sunspecThreePhaseInverterPhaseCNVoltageStateTypeId, inverter->phaseVoltageCn());
         thing->setStateValue(sunspecThreePhaseInverterPhaseACurrentStateTypeId, inverter->ampsPhaseA());
         thing->setStateValue(sunspecThreePhaseInverterPhaseBCurrentStateTypeId, inverter->ampsPhaseB());
         thing->setStateValue(sunspecThreePhaseInverterPhaseCCurrentStateTypeId, inverter->ampsPhaseC());
         thing->setStateValue(sunspecThreePhaseInverterOperatingStateStateTypeId, getInverterStateString(inverter->operatingState()));
         thing->setStateValue(sunspecThreePhaseInverterErrorStateTypeId, getInverterErrorString(inverter->event1()));
-        thing->setStateValue(sunspecThreePhaseInverterVoltageDcStateTypeId, inverter->dcVoltage());
+        m_stateFilter.setStateValue(thing, sunspecThreePhaseInverterVoltageDcStateTypeId, inverter->dcVoltage());
         thing->setStateValue(sunspecThreePhaseInverterCurrentDcStateTypeId, inverter->dcAmps());
         thing->setStateValue(sunspecThreePhaseInverterCurrentPowerDcStateTypeId, -inverter->dcWatts());
         break;
@@ -1352,11 +1434,11 @@ void IntegrationPluginSunSpec::onInverterBlockUpdated()
 void IntegrationPluginSunSpec::onMeterBlockUpdated()
 {
     SunSpecModel *model = qobject_cast<SunSpecModel *>(sender());
-    Thing *thing = m_sunSpecMeters.key(model);
+    Thing *thing = m_sunSpecModelThings.value(model);
     if (!thing) return;
 
     // Get parent thing
-    Thing *parentThing = myThings().findById(thing->parentId());
+    Thing *parentThing = m_sunSpecConnectionThings.value(thing->parentId());
     if (!parentThing)
         return;
 
@@ -1369,8 +1451,8 @@ void IntegrationPluginSunSpec::onMeterBlockUpdated()
         thing->setStateValue(sunspecSinglePhaseMeterTotalEnergyProducedStateTypeId, meter->totalWattHoursExported() / 1000.0);
         thing->setStateValue(sunspecSinglePhaseMeterTotalEnergyConsumedStateTypeId, meter->totalWattHoursImported() / 1000.0);
         thing->setStateValue(sunspecSinglePhaseMeterCurrentPhaseAStateTypeId, -meter->ampsPhaseA());
-        thing->setStateValue(sunspecSinglePhaseMeterVoltagePhaseAStateTypeId, meter->phaseVoltageAn());
-        thing->setStateValue(sunspecSinglePhaseMeterFrequencyStateTypeId, meter->hz());
+        m_stateFilter.setStateValue(thing, sunspecSinglePhaseMeterVoltagePhaseAStateTypeId, meter->phaseVoltageAn());
+        m_stateFilter.setStateValue(thing, sunspecSinglePhaseMeterFrequencyStateTypeId, meter->hz());
         thing->setStateValue(sunspecSinglePhaseMeterVersionStateTypeId, model->commonModelInfo().versionString);
         break;
     }
@@ -1382,8 +1464,8 @@ void IntegrationPluginSunSpec::onMeterBlockUpdated()
         thing->setStateValue(sunspecSinglePhaseMeterTotalEnergyProducedStateTypeId, meter->totalWattHoursExported() / 1000.0);
         thing->setStateValue(sunspecSinglePhaseMeterTotalEnergyConsumedStateTypeId, meter->totalWattHoursImported() / 1000.0);
         thing->setStateValue(sunspecSinglePhaseMeterCurrentPhaseAStateTypeId, fixValueSign(meter->ampsPhaseA(), -meter->watts()));
-        thing->setStateValue(sunspecSinglePhaseMeterVoltagePhaseAStateTypeId, meter->phaseVoltageAn());
-        thing->setStateValue(sunspecSinglePhaseMeterFrequencyStateTypeId, meter->hz());
+        m_stateFilter.setStateValue(thing, sunspecSinglePhaseMeterVoltagePhaseAStateTypeId, meter->phaseVoltageAn());
+        m_stateFilter.setStateValue(thing, sunspecSinglePhaseMeterFrequencyStateTypeId, meter->hz());
         thing->setStateValue(sunspecSinglePhaseMeterVersionStateTypeId, model->commonModelInfo().versionString);
         break;
     }
@@ -1403,10 +1485,10 @@ void IntegrationPluginSunSpec::onMeterBlockUpdated()
         thing->setStateValue(sunspecSplitPhaseMeterCurrentPowerPhaseBStateTypeId, -meter->wattsPhaseB());
         thing->setStateValue(sunspecSplitPhaseMeterCurrentPhaseAStateTypeId, fixValueSign(meter->ampsPhaseA(), -meter->wattsPhaseA()));
         thing->setStateValue(sunspecSplitPhaseMeterCurrentPhaseBStateTypeId, fixValueSign(meter->ampsPhaseB(), -meter->wattsPhaseB()));
-        thing->setStateValue(sunspecSplitPhaseMeterLnACVoltageStateTypeId, meter->voltageLn());
-        thing->setStateValue(sunspecSplitPhaseMeterVoltagePhaseAStateTypeId, meter->phaseVoltageAn());
-        thing->setStateValue(sunspecSplitPhaseMeterVoltagePhaseBStateTypeId, meter->phaseVoltageBn());
-        thing->setStateValue(sunspecSplitPhaseMeterFrequencyStateTypeId, meter->hz());
+        m_stateFilter.setStateValue(thing, sunspecSplitPhaseMeterLnACVoltageStateTypeId, meter->voltageLn());
+        m_stateFilter.setStateValue(thing, sunspecSplitPhaseMeterVoltagePhaseAStateTypeId, meter->phaseVoltageAn());
+        m_stateFilter.setStateValue(thing, sunspecSplitPhaseMeterVoltagePhaseBStateTypeId, meter->phaseVoltageBn());
+        m_stateFilter.setStateValue(thing, sunspecSplitPhaseMeterFrequencyStateTypeId, meter->hz());
         thing->setStateValue(sunspecSplitPhaseMeterVersionStateTypeId, model->commonModelInfo().versionString);
         break;
     }
@@ -1426,10 +1508,10 @@ void IntegrationPluginSunSpec::onMeterBlockUpdated()
         thing->setStateValue(sunspecSplitPhaseMeterCurrentPowerPhaseBStateTypeId, -meter->wattsPhaseB());
         thing->setStateValue(sunspecSplitPhaseMeterCurrentPhaseAStateTypeId, fixValueSign(meter->ampsPhaseA(), -meter->wattsPhaseA()));
         thing->setStateValue(sunspecSplitPhaseMeterCurrentPhaseBStateTypeId, fixValueSign(meter->ampsPhaseB(), -meter->wattsPhaseB()));
-        thing->setStateValue(sunspecSplitPhaseMeterLnACVoltageStateTypeId, meter->voltageLn());
-        thing->setStateValue(sunspecSplitPhaseMeterVoltagePhaseAStateTypeId, meter->phaseVoltageAn());
-        thing->setStateValue(sunspecSplitPhaseMeterVoltagePhaseBStateTypeId, meter->phaseVoltageBn());
-        thing->setStateValue(sunspecSplitPhaseMeterFrequencyStateTypeId, meter->hz());
+        m_stateFilter.setStateValue(thing, sunspecSplitPhaseMeterLnACVoltageStateTypeId, meter->voltageLn());
+        m_stateFilter.setStateValue(thing, sunspecSplitPhaseMeterVoltagePhaseAStateTypeId, meter->phaseVoltageAn());
+        m_stateFilter.setStateValue(thing, sunspecSplitPhaseMeterVoltagePhaseBStateTypeId, meter->phaseVoltageBn());
+        m_stateFilter.setStateValue(thing, sunspecSplitPhaseMeterFrequencyStateTypeId, meter->hz());
         thing->setStateValue(sunspecSplitPhaseMeterVersionStateTypeId, model->commonModelInfo().versionString);
         break;
     }
@@ -1452,10 +1534,10 @@ void IntegrationPluginSunSpec::onMeterBlockUpdated()
         thing->setStateValue(sunspecThreePhaseMeterCurrentPhaseAStateTypeId, fixValueSign(meter->ampsPhaseA(), -meter->wattsPhaseA()));
         thing->setStateValue(sunspecThreePhaseMeterCurrentPhaseBStateTypeId, fixValueSign(meter->ampsPhaseB(), -meter->wattsPhaseB()));
         thing->setStateValue(sunspecThreePhaseMeterCurrentPhaseCStateTypeId, fixValueSign(meter->ampsPhaseC(), -meter->wattsPhaseC()));
-        thing->setStateValue(sunspecThreePhaseMeterVoltagePhaseAStateTypeId, meter->phaseVoltageAn());
-        thing->setStateValue(sunspecThreePhaseMeterVoltagePhaseBStateTypeId, meter->phaseVoltageBn());
-        thing->setStateValue(sunspecThreePhaseMeterVoltagePhaseCStateTypeId, meter->phaseVoltageCn());
-        thing->setStateValue(sunspecThreePhaseMeterFrequencyStateTypeId, meter->hz());
+        m_stateFilter.setStateValue(thing, sunspecThreePhaseMeterVoltagePhaseAStateTypeId, meter->phaseVoltageAn());
+        m_stateFilter.setStateValue(thing, sunspecThreePhaseMeterVoltagePhaseBStateTypeId, meter->phaseVoltageBn());
+        m_stateFilter.setStateValue(thing, sunspecThreePhaseMeterVoltagePhaseCStateTypeId, meter->phaseVoltageCn());
+        m_stateFilter.setStateValue(thing, sunspecThreePhaseMeterFrequencyStateTypeId, meter->hz());
         thing->setStateValue(sunspecThreePhaseMeterVersionStateTypeId, model->commonModelInfo().versionString);
         break;
     }
@@ -1478,10 +1560,10 @@ void IntegrationPluginSunSpec::onMeterBlockUpdated()
         thing->setStateValue(sunspecThreePhaseMeterCurrentPhaseAStateTypeId, fixValueSign(meter->ampsPhaseA(), -meter->wattsPhaseA()));
         thing->setStateValue(sunspecThreePhaseMeterCurrentPhaseBStateTypeId, fixValueSign(meter->ampsPhaseB(), -meter->wattsPhaseB()));
         thing->setStateValue(sunspecThreePhaseMeterCurrentPhaseCStateTypeId, fixValueSign(meter->ampsPhaseC(), -meter->wattsPhaseC()));
-        thing->setStateValue(sunspecThreePhaseMeterVoltagePhaseAStateTypeId, meter->phaseVoltageAn());
-        thing->setStateValue(sunspecThreePhaseMeterVoltagePhaseBStateTypeId, meter->phaseVoltageBn());
-        thing->setStateValue(sunspecThreePhaseMeterVoltagePhaseCStateTypeId, meter->phaseVoltageCn());
-        thing->setStateValue(sunspecThreePhaseMeterFrequencyStateTypeId, meter->hz());
+        m_stateFilter.setStateValue(thing, sunspecThreePhaseMeterVoltagePhaseAStateTypeId, meter->phaseVoltageAn());
+        m_stateFilter.setStateValue(thing, sunspecThreePhaseMeterVoltagePhaseBStateTypeId, meter->phaseVoltageBn());
+        m_stateFilter.setStateValue(thing, sunspecThreePhaseMeterVoltagePhaseCStateTypeId, meter->phaseVoltageCn());
+        m_stateFilter.setStateValue(thing, sunspecThreePhaseMeterFrequencyStateTypeId, meter->hz());
         thing->setStateValue(sunspecThreePhaseMeterVersionStateTypeId, model->commonModelInfo().versionString);
         break;
     }
@@ -1504,10 +1586,10 @@ void IntegrationPluginSunSpec::onMeterBlockUpdated()
         thing->setStateValue(sunspecThreePhaseMeterCurrentPhaseAStateTypeId, fixValueSign(meter->ampsPhaseA(), -meter->wattsPhaseA()));
         thing->setStateValue(sunspecThreePhaseMeterCurrentPhaseBStateTypeId, fixValueSign(meter->ampsPhaseB(), -meter->wattsPhaseB()));
         thing->setStateValue(sunspecThreePhaseMeterCurrentPhaseCStateTypeId, fixValueSign(meter->ampsPhaseC(), -meter->wattsPhaseC()));
-        thing->setStateValue(sunspecThreePhaseMeterVoltagePhaseAStateTypeId, meter->phaseVoltageAn());
-        thing->setStateValue(sunspecThreePhaseMeterVoltagePhaseBStateTypeId, meter->phaseVoltageBn());
-        thing->setStateValue(sunspecThreePhaseMeterVoltagePhaseCStateTypeId, meter->phaseVoltageCn());
-        thing->setStateValue(sunspecThreePhaseMeterFrequencyStateTypeId, meter->hz());
+        m_stateFilter.setStateValue(thing, sunspecThreePhaseMeterVoltagePhaseAStateTypeId, meter->phaseVoltageAn());
+        m_stateFilter.setStateValue(thing, sunspecThreePhaseMeterVoltagePhaseBStateTypeId, meter->phaseVoltageBn());
+        m_stateFilter.setStateValue(thing, sunspecThreePhaseMeterVoltagePhaseCStateTypeId, meter->phaseVoltageCn());
+        m_stateFilter.setStateValue(thing, sunspecThreePhaseMeterFrequencyStateTypeId, meter->hz());
         thing->setStateValue(sunspecThreePhaseMeterVersionStateTypeId, model->commonModelInfo().versionString);
         break;
     }
@@ -1530,10 +1612,10 @@ void IntegrationPluginSunSpec::onMeterBlockUpdated()
         thing->setStateValue(sunspecThreePhaseMeterCurrentPhaseAStateTypeId, fixValueSign(meter->ampsPhaseA(), -meter->wattsPhaseA()));
         thing->setStateValue(sunspecThreePhaseMeterCurrentPhaseBStateTypeId, fixValueSign(meter->ampsPhaseB(), -meter->wattsPhaseB()));
         thing->setStateValue(sunspecThreePhaseMeterCurrentPhaseCStateTypeId, fixValueSign(meter->ampsPhaseC(), -meter->wattsPhaseC()));
-        thing->setStateValue(sunspecThreePhaseMeterVoltagePhaseAStateTypeId, meter->phaseVoltageAn());
-        thing->setStateValue(sunspecThreePhaseMeterVoltagePhaseBStateTypeId, meter->phaseVoltageBn());
-        thing->setStateValue(sunspecThreePhaseMeterVoltagePhaseCStateTypeId, meter->phaseVoltageCn());
-        thing->setStateValue(sunspecThreePhaseMeterFrequencyStateTypeId, meter->hz());
+        m_stateFilter.setStateValue(thing, sunspecThreePhaseMeterVoltagePhaseAStateTypeId, meter->phaseVoltageAn());
+        m_stateFilter.setStateValue(thing, sunspecThreePhaseMeterVoltagePhaseBStateTypeId, meter->phaseVoltageBn());
+        m_stateFilter.setStateValue(thing, sunspecThreePhaseMeterVoltagePhaseCStateTypeId, meter->phaseVoltageCn());
+        m_stateFilter.setStateValue(thing, sunspecThreePhaseMeterFrequencyStateTypeId, meter->hz());
         thing->setStateValue(sunspecThreePhaseMeterVersionStateTypeId, model->commonModelInfo().versionString);
         break;
     }
@@ -1546,7 +1628,7 @@ void IntegrationPluginSunSpec::onMeterBlockUpdated()
 void IntegrationPluginSunSpec::onStorageBlockUpdated()
 {
     SunSpecModel *model = qobject_cast<SunSpecModel *>(sender());
-    Thing *thing = m_sunSpecStorages.key(model);
+    Thing *thing = m_sunSpecModelThings.value(model);
     if (!thing) return;
 
     SunSpecStorageModel *storage = qobject_cast<SunSpecStorageModel *>(model);
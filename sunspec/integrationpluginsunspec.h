@@ -33,15 +33,33 @@
 
 #include <integrations/integrationplugin.h>
 #include <network/networkdevicemonitor.h>
-#include <plugintimer.h>
 
 #include <sunspecconnection.h>
 #include <models/sunspecmodelfactory.h>
 
+#include <modbusstatefilter.h>
+
 #include "sunspecthing.h"
+#include "sunspecrefreshscheduler.h"
 #include "extern-plugininfo.h"
 
 #include <QUuid>
+#include <QDateTime>
+
+typedef struct SunSpecModelKey {
+    ThingId parentId;
+    uint modelId;
+    uint modbusAddress;
+
+    bool operator==(const SunSpecModelKey &other) const {
+        return parentId == other.parentId && modelId == other.modelId && modbusAddress == other.modbusAddress;
+    }
+} SunSpecModelKey;
+
+inline uint qHash(const SunSpecModelKey &key, uint seed = 0)
+{
+    return qHash(key.parentId, seed) ^ qHash((key.modelId << 16) ^ key.modbusAddress, seed);
+}
 
 class IntegrationPluginSunSpec: public IntegrationPlugin
 {
@@ -74,7 +92,7 @@ private:
     QHash<ThingClassId, ParamTypeId> m_deviceModelParamTypeIds;
     QHash<ThingClassId, ParamTypeId> m_serialNumberParamTypeIds;
 
-    PluginTimer *m_refreshTimer = nullptr;
+    SunSpecRefreshScheduler *m_refreshScheduler = nullptr;
 
     QHash<Thing *, NetworkDeviceMonitor *> m_monitors;
 
@@ -85,8 +103,27 @@ private:
     QHash<Thing *, SunSpecModel *> m_sunSpecMeters;
     QHash<Thing *, SunSpecModel *> m_sunSpecStorages;
 
+    // Reverse indexes, so block updates and discovery results don't need to scan all things
+    QHash<SunSpecModel *, Thing *> m_sunSpecModelThings;
+    QHash<SunSpecModelKey, Thing *> m_sunSpecModelThingsByAddress;
+    QHash<ThingId, Thing *> m_sunSpecConnectionThings;
+
+    // SolarEdge battery slots (start register) per connection thing which have been probed already.
+    // Empty slots get probed again once the entry expired, a battery might have been added meanwhile.
+    typedef struct BatterySlot {
+        bool present = false;
+        QDateTime timestamp;
+    } BatterySlot;
+    static const int s_emptyBatterySlotExpiry = 3600; // seconds
+    QHash<ThingId, QHash<quint16, BatterySlot>> m_solarEdgeBatterySlots;
+
+    // Deadbands for the noisy measurement states of inverters and meters
+    ModbusStateFilter m_stateFilter;
 
     Thing *getThingForSunSpecModel(uint modelId, uint modbusAddress, const ThingId &parentId);
+    SunSpecModelKey sunSpecModelThingKey(uint modelId, uint modbusAddress, const ThingId &parentId) const;
+    void registerSunSpecModelThing(Thing *thing, SunSpecModel *model);
+    uint refreshDivider(SunSpecModel *model) const;
     bool sunspecThingAlreadyAdded(uint modelId, uint modbusAddress, const ThingId &parentId);
     void processDiscoveryResult(Thing *thing, SunSpecConnection *connection);
 
@@ -113,7 +150,6 @@ private:
     void markThingStatesDisconnected(Thing *thing);
 
 private slots:
-    void onRefreshTimer();
     void onPluginConfigurationChanged(const ParamTypeId &paramTypeId, const QVariant &value);
 
     void onInverterBlockUpdated();
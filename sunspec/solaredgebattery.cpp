@@ -34,6 +34,9 @@
 #include <sunspecdatapoint.h>
 #include <sunspecconnection.h>
 
+static const int s_informationBlockSize = 0x4C;
+static const int s_valueBlockSize = 28;
+
 SolarEdgeBattery::SolarEdgeBattery(Thing *thing, SunSpecConnection *connection, int modbusStartRegister, QObject *parent) :
     SunSpecThing(thing, nullptr, parent),
     m_connection(connection),
@@ -63,6 +66,11 @@ SolarEdgeBattery::BatteryData SolarEdgeBattery::batteryData() const
     return m_batteryData;
 }
 
+bool SolarEdgeBattery::slotEmpty() const
+{
+    return m_slotEmpty;
+}
+
 void SolarEdgeBattery::init()
 {
     qCDebug(dcSunSpec()) << "Initializing battery on" << m_modbusStartRegister;
@@ -73,165 +81,175 @@ void SolarEdgeBattery::init()
 
 void SolarEdgeBattery::readBlockData()
 {
-    // Read the data in 2 block requests
-    qCDebug(dcSunSpec()) << "SolarEdgeBattery: Read block 1 from modbus address" << m_modbusStartRegister << "length" << 107<< ", Slave ID" << m_connection->slaveId();
-
-    // Total possible block size is 0xE19A - 0xE100 = 0x9A = 153 registers
-
-    // First block request 0x00 - 0x4C
-    QModbusDataUnit request = QModbusDataUnit(QModbusDataUnit::RegisterType::HoldingRegisters, m_modbusStartRegister, 0x4C);
-    if (QModbusReply *reply = m_connection->modbusTcpClient()->sendReadRequest(request, m_connection->slaveId())) {
-        if (!reply->isFinished()) {
-            connect(reply, &QModbusReply::finished, reply, &QModbusReply::deleteLater);
-            connect(reply, &QModbusReply::finished, this, [=]() {
-                if (reply->error() != QModbusDevice::NoError) {
-                    qCWarning(dcSunSpec()) << "SolarEdgeBattery: Read response error:" << reply->error();
-                    if (!m_initFinishedSuccess) {
-                        m_timer.stop();
-                        emit initFinished(false);
-                    }
-                    return;
-                }
-
-                // Example data:
-                //  "(0x3438, 0x565f, 0x4c47, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x4c47, 0x4320, 0x5245, 0x5355, 0x2031, 0x3000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x00ff, 0x0000, 0xffff, 0xff7f, 0xffff, 0xff7f, 0xffff, 0xff7f, 0xffff, 0xff7f, 0xffff, 0xff7f)"
-                //  255 "48V_LG" "LGC RESU 10" "" ""
-                //  "(0x3438, 0x565f, 0x4c47, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x4c47, 0x4320, 0x5245, 0x5355, 0x2031, 0x3000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x3438, 0x5620, 0x4443, 0x4443, 0x2032, 0x2e32, 0x2e39, 0x3120, 0x424d, 0x5320, 0x302e, 0x302e, 0x3000, 0x0000, 0x0000, 0x0000, 0x3745, 0x3034, 0x3432, 0x4543, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0070, 0x0000, 0x2000, 0x4619, 0x4000, 0x459c, 0x4000, 0x459c, 0x4000, 0x44ce, 0x4000, 0x459c)"
-                //  112 "48V_LG" "LGC RESU 10" "48V DCDC 2.2.91 BMS 0.0.0" "7E0442EC"
-
-
-                const QModbusDataUnit unit = reply->result();
-                QVector<quint16> values = unit.values();
-                qCDebug(dcSunSpec()) << "SolarEdgeBattery: Received first block data" << m_modbusStartRegister << values.count();
-                qCDebug(dcSunSpec()) << "SolarEdgeBattery:" << SunSpecDataPoint::registersToString(values);
-
-                m_batteryData.manufacturerName = SunSpecDataPoint::convertToString(values.mid(ManufacturerName, 16));
-                m_batteryData.model = SunSpecDataPoint::convertToString(values.mid(Model, 16));
-                m_batteryData.firmwareVersion = SunSpecDataPoint::convertToString(values.mid(FirmwareVersion, 16));
-                m_batteryData.serialNumber = SunSpecDataPoint::convertToString(values.mid(SerialNumber, 16));
-                m_batteryData.batteryDeviceId = values[BatteryDeviceId];
-                qCDebug(dcSunSpec()) << "SolarEdgeBattery:" << m_batteryData.batteryDeviceId << m_batteryData.manufacturerName << m_batteryData.model << m_batteryData.firmwareVersion << m_batteryData.serialNumber;
-
-                // Check if there is a battery connected, if so, one of the string must contain vaild data...
-                if (m_batteryData.manufacturerName.isEmpty() && m_batteryData.model.isEmpty() && m_batteryData.serialNumber.isEmpty() && m_batteryData.firmwareVersion.isEmpty()) {
-                    qCWarning(dcSunSpec()) << "SolarEdgeBattery: No valid information detected about the battery. Probably no battery connected at register" << m_modbusStartRegister;
-                    if (!m_initFinishedSuccess) {
-                        m_timer.stop();
-                        emit initFinished(false);
-                    }
-                    return;
-                }
-
-                // For some reason, there might be even data in there but no battery connected, let's check if there are invalid registers
-
-                // Check if there is a battery connected, if so, one of the string must contain vaild data...
-                const QVector<quint16> invalidRegisters = { 0xffff, 0xff7f };
-                if (values.mid(RatedEnergy, 2) == invalidRegisters && values.mid(MaxChargeContinuesPower, 2) == invalidRegisters &&
-                        values.mid(MaxDischargeContinuesPower, 2) == invalidRegisters && values.mid(MaxChargePeakPower, 2) == invalidRegisters &&
-                        values.mid(MaxDischargePeakPower, 2) == invalidRegisters) {
-                    qCWarning(dcSunSpec()) << "SolarEdgeBattery: No valid information detected about the battery. Probably no battery connected at register" << m_modbusStartRegister;
-                    if (!m_initFinishedSuccess) {
-                        m_timer.stop();
-                        emit initFinished(false);
-                    }
-                    return;
-                }
-
-                m_batteryData.ratedEnergy = SunSpecDataPoint::convertToFloat32(values.mid(RatedEnergy, 2));
-                m_batteryData.maxChargeContinuesPower = SunSpecDataPoint::convertToFloat32(values.mid(MaxChargeContinuesPower, 2));
-                m_batteryData.maxDischargeContinuesPower = SunSpecDataPoint::convertToFloat32(values.mid(MaxDischargeContinuesPower, 2));
-                m_batteryData.maxChargePeakPower = SunSpecDataPoint::convertToFloat32(values.mid(MaxChargePeakPower, 2));
-                m_batteryData.maxDischargePeakPower = SunSpecDataPoint::convertToFloat32(values.mid(MaxDischargePeakPower, 2));
-
-                // First block looks good, continue with second block
-
-                // 8192 17945 536888857 536888857 1.08652e-19
-                // 0x2000 0x4619
-
-                // Read from 0x6c to 0x86
-                int offset = 0x6c;
-                QModbusDataUnit request = QModbusDataUnit(QModbusDataUnit::RegisterType::HoldingRegisters, m_modbusStartRegister + offset, 28);
-                if (QModbusReply *reply = m_connection->modbusTcpClient()->sendReadRequest(request, m_connection->slaveId())) {
-                    if (!reply->isFinished()) {
-                        connect(reply, &QModbusReply::finished, reply, &QModbusReply::deleteLater);
-                        connect(reply, &QModbusReply::finished, this, [=]() {
-                            if (reply->error() != QModbusDevice::NoError) {
-                                qCWarning(dcSunSpec()) << "SolarEdgeBattery: Read response error:" << reply->error();
-                                if (!m_initFinishedSuccess) {
-                                    m_timer.stop();
-                                    emit initFinished(false);
-                                }
-                                return;
-                            }
-
-                            const QModbusDataUnit unit = reply->result();
-                            QVector<quint16> values = unit.values();
-
-                            qCDebug(dcSunSpec()) << "SolarEdgeBattery: Received second block data" << m_modbusStartRegister + offset << values.count();
-                            qCDebug(dcSunSpec()) << "SolarEdgeBattery:" << SunSpecDataPoint::registersToString(values);
-                            QVector<quint16> valueRegisters;
-
-                            valueRegisters = values.mid(BatteryAverageTemperature - offset, 2);
-                            m_batteryData.averageTemperature = SunSpecDataPoint::convertToFloat32(valueRegisters);
-                            qCDebug(dcSunSpec()) << "SolarEdgeBattery: Average temperature:" << SunSpecDataPoint::registersToString(valueRegisters) << m_batteryData.averageTemperature;
-
-                            m_batteryData.maxTemperature = SunSpecDataPoint::convertToFloat32(values.mid(BatteryMaxTemperature - offset, 2));
-                            m_batteryData.instantaneousVoltage = SunSpecDataPoint::convertToFloat32(values.mid(InstantaneousVoltage - offset, 2));
-                            m_batteryData.instantaneousCurrent = SunSpecDataPoint::convertToFloat32(values.mid(InstantaneousCurrent - offset, 2));
-                            m_batteryData.instantaneousPower = SunSpecDataPoint::convertToFloat32(values.mid(InstantaneousPower - offset, 2));
-                            m_batteryData.maxEnergy = SunSpecDataPoint::convertToFloat32(values.mid(MaxEnergy - offset, 2));
-
-                            valueRegisters = values.mid(AvailableEnergy - offset, 2);
-                            m_batteryData.availableEnergy = SunSpecDataPoint::convertToFloat32(valueRegisters);
-                            qCDebug(dcSunSpec()) << "SolarEdgeBattery: Available energy:" << (AvailableEnergy - offset) << SunSpecDataPoint::registersToString(valueRegisters) << m_batteryData.availableEnergy;
-
-                            m_batteryData.stateOfHealth = SunSpecDataPoint::convertToFloat32(values.mid(StateOfHealth - offset, 2));
-                            m_batteryData.stateOfEnergy = SunSpecDataPoint::convertToFloat32(values.mid(StateOfEnergy - offset, 2));
-                            m_batteryData.batteryStatus = static_cast<BatteryStatus>(SunSpecDataPoint::convertToUInt32(values.mid(Status - offset, 2)));
-
-                            if (!m_initFinishedSuccess) {
-                                m_timer.stop();
-                                m_initFinishedSuccess = true;
-                                emit initFinished(true);
-                            }
-
-                            emit blockDataUpdated();
-                        });
-
-                        connect(reply, &QModbusReply::errorOccurred, this, [] (QModbusDevice::Error error) {
-                            qCWarning(dcSunSpec()) << "SolarEdgeBattery: Modbus reply error:" << error;
-                        });
-                    } else {
-                        qCWarning(dcSunSpec()) << "SolarEdgeBattery: Read error: " << m_connection->modbusTcpClient()->errorString();
-                        reply->deleteLater(); // broadcast replies return immediately
-                        if (!m_initFinishedSuccess) {
-                            m_timer.stop();
-                            emit initFinished(false);
-                        }
-                        return;
-                    }
-                } else {
-                    qCWarning(dcSunSpec()) << "SolarEdgeBattery: Read error: " << m_connection->modbusTcpClient()->errorString();
-                    return;
-                }
-            });
-
-            connect(reply, &QModbusReply::errorOccurred, this, [] (QModbusDevice::Error error) {
-                qCWarning(dcSunSpec()) << "SolarEdgeBattery: Modbus reply error:" << error;
-            });
+    if (m_pendingReads > 0) {
+        // Every call has to report a finished read, the running read reports its own id
+        qCDebug(dcSunSpec()) << "SolarEdgeBattery: Read still pending on modbus address" << m_modbusStartRegister;
+        emit blockReadFinished(false, ++m_blockReadId);
+        return;
+    }
+
+    // The battery map 0x00 - 0x88 does not fit into one modbus request (max 125 registers), so it gets read in 2 blocks:
+    // the information block 0x00 - 0x4C and the value block 0x6C - 0x88. Both requests are sent at once and processed
+    // together once both arrived. The information block does not change, so it gets only read until the battery is initialized.
+    bool readInformationBlock = !m_initFinishedSuccess;
+    m_pendingReadId = ++m_blockReadId;
+    m_readFailed = false;
+    m_pendingReads = readInformationBlock ? 2 : 1;
+    if (readInformationBlock)
+        readBlock(ManufacturerName, s_informationBlockSize);
+
+    readBlock(BatteryAverageTemperature, s_valueBlockSize);
+}
+
+void SolarEdgeBattery::readBlock(int offset, int size)
+{
+    qCDebug(dcSunSpec()) << "SolarEdgeBattery: Read block from modbus address" << m_modbusStartRegister + offset << "length" << size << ", Slave ID" << m_connection->slaveId();
+
+    QModbusDataUnit request = QModbusDataUnit(QModbusDataUnit::RegisterType::HoldingRegisters, m_modbusStartRegister + offset, size);
+    QModbusReply *reply = m_connection->modbusTcpClient()->sendReadRequest(request, m_connection->slaveId());
+    if (!reply) {
+        qCWarning(dcSunSpec()) << "SolarEdgeBattery: Read error: " << m_connection->modbusTcpClient()->errorString();
+        m_readFailed = true;
+        finishBlock();
+        return;
+    }
+
+    if (reply->isFinished()) {
+        qCWarning(dcSunSpec()) << "SolarEdgeBattery: Read error: " << m_connection->modbusTcpClient()->errorString();
+        reply->deleteLater(); // broadcast replies return immediately
+        m_readFailed = true;
+        finishBlock();
+        return;
+    }
+
+    connect(reply, &QModbusReply::finished, reply, &QModbusReply::deleteLater);
+    connect(reply, &QModbusReply::finished, this, [=]() {
+        if (reply->error() != QModbusDevice::NoError) {
+            qCWarning(dcSunSpec()) << "SolarEdgeBattery: Read response error:" << reply->error();
+            m_readFailed = true;
+        } else if (offset == ManufacturerName) {
+            m_informationBlock = reply->result().values();
         } else {
-            qCWarning(dcSunSpec()) << "SolarEdgeBattery: Read error: " << m_connection->modbusTcpClient()->errorString();
-            reply->deleteLater(); // broadcast replies return immediately
-            if (!m_initFinishedSuccess) {
-                m_timer.stop();
-                emit initFinished(false);
-            }
-            return;
+            m_valueBlock = reply->result().values();
         }
-    } else {
-        qCWarning(dcSunSpec()) << "SolarEdgeBattery: Read error: " << m_connection->modbusTcpClient()->errorString();
+
+        finishBlock();
+    });
+
+    connect(reply, &QModbusReply::errorOccurred, this, [] (QModbusDevice::Error error) {
+        qCWarning(dcSunSpec()) << "SolarEdgeBattery: Modbus reply error:" << error;
+    });
+}
+
+void SolarEdgeBattery::finishBlock()
+{
+    m_pendingReads--;
+    if (m_pendingReads > 0)
+        return;
+
+    bool success = !m_readFailed;
+    if (success && !m_initFinishedSuccess) {
+        success = processInformationBlock(m_informationBlock);
+        m_slotEmpty = !success;
+    }
+
+    if (success)
+        success = processValueBlock(m_valueBlock);
+
+    if (!success) {
+        if (!m_initFinishedSuccess) {
+            m_timer.stop();
+            emit initFinished(false);
+        }
+        emit blockReadFinished(false, m_pendingReadId);
         return;
     }
+
+    if (!m_initFinishedSuccess) {
+        m_timer.stop();
+        m_initFinishedSuccess = true;
+        emit initFinished(true);
+    }
+
+    emit blockDataUpdated();
+    emit blockReadFinished(true, m_pendingReadId);
+}
+
+bool SolarEdgeBattery::processInformationBlock(const QVector<quint16> &values)
+{
+    // Example data:
+    //  "(0x3438, 0x565f, 0x4c47, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x4c47, 0x4320, 0x5245, 0x5355, 0x2031, 0x3000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x00ff, 0x0000, 0xffff, 0xff7f, 0xffff, 0xff7f, 0xffff, 0xff7f, 0xffff, 0xff7f, 0xffff, 0xff7f)"
+    //  255 "48V_LG" "LGC RESU 10" "" ""
+    //  "(0x3438, 0x565f, 0x4c47, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x4c47, 0x4320, 0x5245, 0x5355, 0x2031, 0x3000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x3438, 0x5620, 0x4443, 0x4443, 0x2032, 0x2e32, 0x2e39, 0x3120, 0x424d, 0x5320, 0x302e, 0x302e, 0x3000, 0x0000, 0x0000, 0x0000, 0x3745, 0x3034, 0x3432, 0x4543, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0070, 0x0000, 0x2000, 0x4619, 0x4000, 0x459c, 0x4000, 0x459c, 0x4000, 0x44ce, 0x4000, 0x459c)"
+    //  112 "48V_LG" "LGC RESU 10" "48V DCDC 2.2.91 BMS 0.0.0" "7E0442EC"
+
+    qCDebug(dcSunSpec()) << "SolarEdgeBattery: Received information block" << m_modbusStartRegister << values.count();
+    qCDebug(dcSunSpec()) << "SolarEdgeBattery:" << SunSpecDataPoint::registersToString(values);
+    if (values.count() != s_informationBlockSize) {
+        qCWarning(dcSunSpec()) << "SolarEdgeBattery: Received invalid information block size" << values.count();
+        return false;
+    }
+
+    m_batteryData.manufacturerName = SunSpecDataPoint::convertToString(values.mid(ManufacturerName, 16));
+    m_batteryData.model = SunSpecDataPoint::convertToString(values.mid(Model, 16));
+    m_batteryData.firmwareVersion = SunSpecDataPoint::convertToString(values.mid(FirmwareVersion, 16));
+    m_batteryData.serialNumber = SunSpecDataPoint::convertToString(values.mid(SerialNumber, 16));
+    m_batteryData.batteryDeviceId = values[BatteryDeviceId];
+    qCDebug(dcSunSpec()) << "SolarEdgeBattery:" << m_batteryData.batteryDeviceId << m_batteryData.manufacturerName << m_batteryData.model << m_batteryData.firmwareVersion << m_batteryData.serialNumber;
+
+    // Check if there is a battery connected, if so, one of the string must contain vaild data...
+    if (m_batteryData.manufacturerName.isEmpty() && m_batteryData.model.isEmpty() && m_batteryData.serialNumber.isEmpty() && m_batteryData.firmwareVersion.isEmpty()) {
+        qCWarning(dcSunSpec()) << "SolarEdgeBattery: No valid information detected about the battery. Probably no battery connected at register" << m_modbusStartRegister;
+        return false;
+    }
+
+    // For some reason, there might be even data in there but no battery connected, let's check if there are invalid registers
+    const QVector<quint16> invalidRegisters = { 0xffff, 0xff7f };
+    if (values.mid(RatedEnergy, 2) == invalidRegisters && values.mid(MaxChargeContinuesPower, 2) == invalidRegisters &&
+            values.mid(MaxDischargeContinuesPower, 2) == invalidRegisters && values.mid(MaxChargePeakPower, 2) == invalidRegisters &&
+            values.mid(MaxDischargePeakPower, 2) == invalidRegisters) {
+        qCWarning(dcSunSpec()) << "SolarEdgeBattery: No valid information detected about the battery. Probably no battery connected at register" << m_modbusStartRegister;
+        return false;
+    }
+
+    m_batteryData.ratedEnergy = SunSpecDataPoint::convertToFloat32(values.mid(RatedEnergy, 2));
+    m_batteryData.maxChargeContinuesPower = SunSpecDataPoint::convertToFloat32(values.mid(MaxChargeContinuesPower, 2));
+    m_batteryData.maxDischargeContinuesPower = SunSpecDataPoint::convertToFloat32(values.mid(MaxDischargeContinuesPower, 2));
+    m_batteryData.maxChargePeakPower = SunSpecDataPoint::convertToFloat32(values.mid(MaxChargePeakPower, 2));
+    m_batteryData.maxDischargePeakPower = SunSpecDataPoint::convertToFloat32(values.mid(MaxDischargePeakPower, 2));
+    return true;
+}
+
+bool SolarEdgeBattery::processValueBlock(const QVector<quint16> &values)
+{
+    int offset = BatteryAverageTemperature;
+    qCDebug(dcSunSpec()) << "SolarEdgeBattery: Received value block" << m_modbusStartRegister + offset << values.count();
+    qCDebug(dcSunSpec()) << "SolarEdgeBattery:" << SunSpecDataPoint::registersToString(values);
+    if (values.count() != s_valueBlockSize) {
+        qCWarning(dcSunSpec()) << "SolarEdgeBattery: Received invalid value block size" << values.count();
+        return false;
+    }
+
+    QVector<quint16> valueRegisters;
+
+    valueRegisters = values.mid(BatteryAverageTemperature - offset, 2);
+    m_batteryData.averageTemperature = SunSpecDataPoint::convertToFloat32(valueRegisters);
+    qCDebug(dcSunSpec()) << "SolarEdgeBattery: Average temperature:" << SunSpecDataPoint::registersToString(valueRegisters) << m_batteryData.averageTemperature;
+
+    m_batteryData.maxTemperature = SunSpecDataPoint::convertToFloat32(values.mid(BatteryMaxTemperature - offset, 2));
+    m_batteryData.instantaneousVoltage = SunSpecDataPoint::convertToFloat32(values.mid(InstantaneousVoltage - offset, 2));
+    m_batteryData.instantaneousCurrent = SunSpecDataPoint::convertToFloat32(values.mid(InstantaneousCurrent - offset, 2));
+    m_batteryData.instantaneousPower = SunSpecDataPoint::convertToFloat32(values.mid(InstantaneousPower - offset, 2));
+    m_batteryData.maxEnergy = SunSpecDataPoint::convertToFloat32(values.mid(MaxEnergy - offset, 2));
+
+    valueRegisters = values.mid(AvailableEnergy - offset, 2);
+    m_batteryData.availableEnergy = SunSpecDataPoint::convertToFloat32(valueRegisters);
+    qCDebug(dcSunSpec()) << "SolarEdgeBattery: Available energy:" << (AvailableEnergy - offset) << SunSpecDataPoint::registersToString(valueRegisters) << m_batteryData.availableEnergy;
+
+    m_batteryData.stateOfHealth = SunSpecDataPoint::convertToFloat32(values.mid(StateOfHealth - offset, 2));
+    m_batteryData.stateOfEnergy = SunSpecDataPoint::convertToFloat32(values.mid(StateOfEnergy - offset, 2));
+    m_batteryData.batteryStatus = static_cast<BatteryStatus>(SunSpecDataPoint::convertToUInt32(values.mid(Status - offset, 2)));
+    return true;
 }
 
 QDebug operator<<(QDebug debug, const SolarEdgeBattery::BatteryData &batteryData)
@@ -116,6 +116,9 @@ public:
 
     BatteryData batteryData() const;
 
+    // True if the device answered, but reported no battery on this start register
+    bool slotEmpty() const;
+
     void init();
     void readBlockData() override;
 
@@ -130,6 +133,18 @@ private:
     bool m_initFinishedSuccess = false;
     BatteryData m_batteryData;
 
+    int m_pendingReads = 0;
+    quint32 m_pendingReadId = 0;
+    bool m_readFailed = false;
+    bool m_slotEmpty = false;
+    QVector<quint16> m_informationBlock;
+    QVector<quint16> m_valueBlock;
+
+    void readBlock(int offset, int size);
+    void finishBlock();
+    bool processInformationBlock(const QVector<quint16> &values);
+    bool processValueBlock(const QVector<quint16> &values);
+
 };
 
 QDebug operator<<(QDebug debug, const SolarEdgeBattery::BatteryData &batteryData);
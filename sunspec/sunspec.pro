@@ -1,14 +1,17 @@
 include(../plugins.pri)
 include(../sunspec.pri)
+include(../modbus.pri)
 
 SOURCES += \
     integrationpluginsunspec.cpp \
     solaredgebattery.cpp \
     sunspecdiscovery.cpp \
+    sunspecrefreshscheduler.cpp \
     sunspecthing.cpp
 
 HEADERS += \
     integrationpluginsunspec.h \
     solaredgebattery.h \
     sunspecdiscovery.h \
+    sunspecrefreshscheduler.h \
     sunspecthing.h
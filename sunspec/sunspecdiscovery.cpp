@@ -42,6 +42,55 @@ SunSpecDiscovery::SunSpecDiscovery(NetworkDeviceDiscovery *networkDeviceDiscover
 {
     m_scanPorts.append(502);
     m_scanPorts.append(1502);
+
+    // Only slave IDs answering with the 'SunS' marker on one of the base registers get a full connection
+    m_probe = new ModbusNetworkProbe(this);
+    m_probe->setStopOnFirstMatch(false);
+
+    QList<quint16> baseRegisters = {40000, 50000, 0};
+    foreach (quint16 slaveId, m_slaveIds) {
+        foreach (quint16 baseRegister, baseRegisters) {
+            ModbusNetworkProbe::Fingerprint fingerprint;
+            fingerprint.name = QString("sunspec-%1").arg(baseRegister);
+            fingerprint.slaveId = slaveId;
+            fingerprint.registerType = QModbusDataUnit::HoldingRegisters;
+            fingerprint.registerAddress = baseRegister;
+            fingerprint.size = 2;
+            fingerprint.validator = [](const QVector<quint16> &values) {
+                return values.count() == 2 && (static_cast<quint32>(values.at(0)) << 16 | values.at(1)) == 0x53756e53;
+            };
+            m_probe->addFingerprint(fingerprint);
+        }
+    }
+
+    connect(m_probe, &ModbusNetworkProbe::resultFound, this, [this](const ModbusNetworkProbe::Result &result){
+        // Several base registers might match on the same slave, check each slave only once
+        QString target = QString("%1:%2/%3").arg(result.address.toString()).arg(result.port).arg(result.slaveId);
+        if (m_checkedTargets.contains(target))
+            return;
+
+        foreach (const NetworkDeviceInfo &networkDeviceInfo, m_networkDeviceInfos) {
+            if (networkDeviceInfo.address() == result.address) {
+                m_checkedTargets.insert(target);
+                checkNetworkDevice(networkDeviceInfo, result.port, result.slaveId);
+                return;
+            }
+        }
+    });
+
+    connect(m_probe, &ModbusNetworkProbe::finished, this, [this](){
+        m_probeFinished = true;
+        finishDiscoveryIfDone();
+    });
+
+    // Give the connections still reading the models once all hosts have been probed a chance to finish,
+    // but don't wait forever for a device which never answers
+    m_gracePeriodTimer.setInterval(5000);
+    m_gracePeriodTimer.setSingleShot(true);
+    connect(&m_gracePeriodTimer, &QTimer::timeout, this, [this](){
+        qCDebug(dcSunSpec()) << "Discovery: Grace period timer triggered";
+        finishDiscovery();
+    });
 }
 
 QList<SunSpecDiscovery::Result> SunSpecDiscovery::results() const
@@ -63,20 +112,30 @@ void SunSpecDiscovery::startDiscovery()
     NetworkDeviceDiscoveryReply *discoveryReply = m_networkDeviceDiscovery->discover();
 
     m_startDateTime = QDateTime::currentDateTime();
+    m_probeFinished = false;
+    m_finished = false;
 
-    // Imedialty check any new device gets discovered
-    connect(discoveryReply, &NetworkDeviceDiscoveryReply::networkDeviceInfoAdded, this, &SunSpecDiscovery::checkNetworkDevice);
+    foreach (quint16 port, m_scanPorts)
+        m_probe->addPort(port);
+
+    // Imedialty probe any new device gets discovered
+    connect(discoveryReply, &NetworkDeviceDiscoveryReply::networkDeviceInfoAdded, this, [this](const NetworkDeviceInfo &networkDeviceInfo){
+        m_networkDeviceInfos.append(networkDeviceInfo);
+        m_probe->probe(networkDeviceInfo.address());
+    });
 
     // Check what might be left on finished
     connect(discoveryReply, &NetworkDeviceDiscoveryReply::finished, discoveryReply, &NetworkDeviceDiscoveryReply::deleteLater);
     connect(discoveryReply, &NetworkDeviceDiscoveryReply::finished, this, [=](){
-        qCDebug(dcSunSpec()) << "Discovery: Network discovery finished. Give some time for pending discovery checks to finish...";
+        qCDebug(dcSunSpec()) << "Discovery: Network discovery finished. Found" << discoveryReply->networkDeviceInfos().count() << "network devices";
+        m_networkDeviceInfos = discoveryReply->networkDeviceInfos();
 
-        // Give the last connections added right before the network discovery finished a chance to check the device...
-        QTimer::singleShot(3000, this, [this](){
-            qCDebug(dcSunSpec()) << "Discovery: Grace period timer triggered";
-            finishDiscovery();
-        });
+        // Probe network device infos not probed already...
+        foreach (const NetworkDeviceInfo &networkDeviceInfo, m_networkDeviceInfos)
+            m_probe->probe(networkDeviceInfo.address());
+
+        // The probe finishes once all pending hosts have been checked
+        m_probe->finish();
     });
 }
 
@@ -97,81 +156,79 @@ void SunSpecDiscovery::testNextConnection(const QHostAddress &address)
     }
 }
 
-void SunSpecDiscovery::checkNetworkDevice(const NetworkDeviceInfo &networkDeviceInfo)
+void SunSpecDiscovery::checkNetworkDevice(const NetworkDeviceInfo &networkDeviceInfo, quint16 port, quint16 slaveId)
 {
-    // Create a connection queue for this network device
-
-    QQueue<SunSpecConnection *> connectionQueue;
-
-    // Check all ports for this host
-    foreach (quint16 port, m_scanPorts) {
-
-        foreach (quint16 slaveId, m_slaveIds) {
-
-            SunSpecConnection *connection = new SunSpecConnection(networkDeviceInfo.address(), port, slaveId, m_byteOrder, this);
-            connection->setNumberOfRetries(1);
-            connection->setTimeout(500);
-            m_connections.append(connection);
-            connectionQueue.enqueue(connection);
-
-            connect(connection, &SunSpecConnection::connectedChanged, this, [=](bool connected){
-                if (!connected) {
-                    // Disconnected ... done with this connection
-                    cleanupConnection(connection);
-                    return;
-                }
+    SunSpecConnection *connection = new SunSpecConnection(networkDeviceInfo.address(), port, slaveId, m_byteOrder, this);
+    connection->setNumberOfRetries(1);
+    connection->setTimeout(500);
+    m_connections.append(connection);
+    m_pendingConnectionAttempts[networkDeviceInfo.address()].enqueue(connection);
+
+    connect(connection, &SunSpecConnection::connectedChanged, this, [=](bool connected){
+        if (!connected) {
+            // Disconnected ... done with this connection
+            cleanupConnection(connection);
+            return;
+        }
 
-                // Modbus TCP connected, try to discovery sunspec models...
-                connect(connection, &SunSpecConnection::discoveryFinished, this, [=](bool success){
-                    if (!success) {
-                        qCDebug(dcSunSpec()) << "Discovery: SunSpec discovery failed on" << QString("%1:%2").arg(networkDeviceInfo.address().toString()).arg(port) << "slave ID:" << slaveId << "Continue...";;
-                        cleanupConnection(connection);
-                        return;
+        // Modbus TCP connected, try to discovery sunspec models...
+        connect(connection, &SunSpecConnection::discoveryFinished, this, [=](bool success){
+            if (!success) {
+                qCDebug(dcSunSpec()) << "Discovery: SunSpec discovery failed on" << QString("%1:%2").arg(networkDeviceInfo.address().toString()).arg(port) << "slave ID:" << slaveId << "Continue...";;
+                cleanupConnection(connection);
+                return;
+            }
+
+            // Success, we found some sunspec models here, let's read some infomation from the models
+
+            Result result;
+            result.networkDeviceInfo = networkDeviceInfo;
+            result.port = connection->port();
+            result.slaveId = connection->slaveId();
+
+            qCDebug(dcSunSpec()) << "Discovery: --> Found SunSpec devices on" << result.networkDeviceInfo << "port" << result.port << "slave ID:" << result.slaveId;
+            foreach (SunSpecModel *model, connection->models()) {
+                if (model->modelId() == SunSpecModelFactory::ModelIdCommon) {
+                    SunSpecCommonModel *commonModel = qobject_cast<SunSpecCommonModel *>(model);
+                    QString manufacturer = commonModel->manufacturer();
+                    if (!manufacturer.isEmpty() && !result.modelManufacturers.contains(manufacturer)) {
+                        result.modelManufacturers.append(manufacturer);
                     }
+                }
+            }
 
-                    // Success, we found some sunspec models here, let's read some infomation from the models
-
-                    Result result;
-                    result.networkDeviceInfo = networkDeviceInfo;
-                    result.port = connection->port();
-                    result.slaveId = connection->slaveId();
-
-                    qCDebug(dcSunSpec()) << "Discovery: --> Found SunSpec devices on" << result.networkDeviceInfo << "port" << result.port << "slave ID:" << result.slaveId;
-                    foreach (SunSpecModel *model, connection->models()) {
-                        if (model->modelId() == SunSpecModelFactory::ModelIdCommon) {
-                            SunSpecCommonModel *commonModel = qobject_cast<SunSpecCommonModel *>(model);
-                            QString manufacturer = commonModel->manufacturer();
-                            if (!manufacturer.isEmpty() && !result.modelManufacturers.contains(manufacturer)) {
-                                result.modelManufacturers.append(manufacturer);
-                            }
-                        }
-                    }
+            m_results.append(result);
 
-                    m_results.append(result);
+            // Done with this connection
+            cleanupConnection(connection);
+        });
 
-                    // Done with this connection
-                    cleanupConnection(connection);
-                });
+        // Run SunSpec discovery on connection...
+        if (!connection->startDiscovery()) {
+            qCDebug(dcSunSpec()) << "Discovery: Unable to discover SunSpec data on connection" << QString("%1:%2").arg(networkDeviceInfo.address().toString()).arg(port) << "slave ID:" << slaveId << "Continue...";;
+            cleanupConnection(connection);
+        }
+    });
 
-                // Run SunSpec discovery on connection...
-                if (!connection->startDiscovery()) {
-                    qCDebug(dcSunSpec()) << "Discovery: Unable to discover SunSpec data on connection" << QString("%1:%2").arg(networkDeviceInfo.address().toString()).arg(port) << "slave ID:" << slaveId << "Continue...";;
-                    cleanupConnection(connection);
-                }
-            });
+    // If we get any error...skip this host...
+    connect(connection->modbusTcpClient(), &QModbusTcpClient::errorOccurred, this, [=](QModbusDevice::Error error){
+        if (error != QModbusDevice::NoError) {
+            qCDebug(dcSunSpec()) << "Discovery: Connection error on" << QString("%1:%2").arg(networkDeviceInfo.address().toString()).arg(port) << "slave ID:" << slaveId << "Continue...";;
+            cleanupConnection(connection);
+        }
+    });
 
-            // If we get any error...skip this host...
-            connect(connection->modbusTcpClient(), &QModbusTcpClient::errorOccurred, this, [=](QModbusDevice::Error error){
-                if (error != QModbusDevice::NoError) {
-                    qCDebug(dcSunSpec()) << "Discovery: Connection error on" << QString("%1:%2").arg(networkDeviceInfo.address().toString()).arg(port) << "slave ID:" << slaveId << "Continue...";;
-                    cleanupConnection(connection);
-                }
-            });
+    // The connections to one host are tested one after the other
+    int hostConnections = 0;
+    foreach (SunSpecConnection *hostConnection, m_connections) {
+        if (hostConnection->hostAddress() == networkDeviceInfo.address()) {
+            hostConnections++;
         }
     }
 
-    m_pendingConnectionAttempts[networkDeviceInfo.address()] = connectionQueue;
-    testNextConnection(networkDeviceInfo.address());
+    if (hostConnections == m_pendingConnectionAttempts.value(networkDeviceInfo.address()).count()) {
+        testNextConnection(networkDeviceInfo.address());
+    }
 }
 
 void SunSpecDiscovery::cleanupConnection(SunSpecConnection *connection)
@@ -181,12 +238,33 @@ void SunSpecDiscovery::cleanupConnection(SunSpecConnection *connection)
     connection->deleteLater();
 
     testNextConnection(connection->hostAddress());
+    finishDiscoveryIfDone();
+}
+
+void SunSpecDiscovery::finishDiscoveryIfDone()
+{
+    if (m_finished || !m_probeFinished)
+        return;
+
+    if (m_connections.isEmpty()) {
+        finishDiscovery();
+    } else if (!m_gracePeriodTimer.isActive()) {
+        m_gracePeriodTimer.start();
+    }
 }
 
 void SunSpecDiscovery::finishDiscovery()
 {
     qint64 durationMilliSeconds = QDateTime::currentMSecsSinceEpoch() - m_startDateTime.toMSecsSinceEpoch();
 
+    // Make sure we finish only once
+    if (m_finished)
+        return;
+
+    m_finished = true;
+    m_gracePeriodTimer.stop();
+    m_pendingConnectionAttempts.clear();
+
     // Cleanup any leftovers...we don't care any more
     foreach (SunSpecConnection *connection, m_connections)
         cleanupConnection(connection);
@@ -31,11 +31,14 @@
 #ifndef SUNSPECDISCOVERY_H
 #define SUNSPECDISCOVERY_H
 
+#include <QSet>
 #include <QQueue>
+#include <QTimer>
 #include <QObject>
 #include <QDateTime>
 
 #include <sunspecconnection.h>
+#include <modbusnetworkprobe.h>
 #include <network/networkdevicediscovery.h>
 
 class SunSpecDiscovery : public QObject
@@ -65,6 +68,14 @@ private:
     SunSpecDataPoint::ByteOrder m_byteOrder;
 
     QDateTime m_startDateTime;
+
+    ModbusNetworkProbe *m_probe = nullptr;
+    bool m_probeFinished = false;
+    bool m_finished = false;
+    QTimer m_gracePeriodTimer;
+
+    NetworkDeviceInfos m_networkDeviceInfos;
+    QSet<QString> m_checkedTargets;
     QHash<QHostAddress, QQueue<SunSpecConnection *>> m_pendingConnectionAttempts;
 
     QList<SunSpecConnection *> m_connections;
@@ -72,8 +83,9 @@ private:
 
     void testNextConnection(const QHostAddress &address);
 
-    void checkNetworkDevice(const NetworkDeviceInfo &networkDeviceInfo);
+    void checkNetworkDevice(const NetworkDeviceInfo &networkDeviceInfo, quint16 port, quint16 slaveId);
     void cleanupConnection(SunSpecConnection *connection);
+    void finishDiscoveryIfDone();
 
     void finishDiscovery();
 };
@@ -0,0 +1,286 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+*
+* Copyright 2013 - 2023, nymea GmbH
+* Contact: contact@nymea.io
+*
+* This file is part of nymea.
+* This project including source code and documentation is protected by
+* copyright law, and remains the property of nymea GmbH. All rights, including
+* reproduction, publication, editing and translation, are reserved. The use of
+* this project is subject to the terms of a license agreement to be concluded
+* with nymea GmbH in accordance with the terms of use of nymea GmbH, available
+* under https://nymea.io/license
+*
+* GNU Lesser General Public License Usage
+* Alternatively, this project may be redistributed and/or modified under the
+* terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; version 3. This project is distributed in the hope that
+* it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+* warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this project. If not, see <https://www.gnu.org/licenses/>.
+*
+* For any further details and any questions please contact us under
+* contact@nymea.io or see our FAQ/Licensing Information on
+* https://nymea.io/license/faq
+*
+* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+
+#include "sunspecrefreshscheduler.h"
+#include "extern-plugininfo.h"
+
+#include <algorithm>
+
+SunSpecRefreshScheduler::SunSpecRefreshScheduler(QObject *parent) :
+    QObject(parent)
+{
+
+}
+
+int SunSpecRefreshScheduler::interval() const
+{
+    return m_interval;
+}
+
+void SunSpecRefreshScheduler::setInterval(int interval)
+{
+    m_interval = qMax(100, interval);
+    updatePhases();
+}
+
+void SunSpecRefreshScheduler::addModel(SunSpecModel *model, uint divider)
+{
+    addEntry(model, model->connection(), [model](){ model->readBlockData(); }, [model](){ return model->blockReadId(); }, divider);
+    connect(model, &SunSpecModel::blockReadFinished, this, [this, model](bool success, quint32 readId){
+        Q_UNUSED(success)
+        onReadFinished(model, readId);
+    });
+}
+
+void SunSpecRefreshScheduler::addThing(SunSpecThing *thing, uint divider)
+{
+    addEntry(thing, thing->connection(), [thing](){ thing->readBlockData(); }, [thing](){ return thing->blockReadId(); }, divider);
+    connect(thing, &SunSpecThing::blockReadFinished, this, [this, thing](bool success, quint32 readId){
+        Q_UNUSED(success)
+        onReadFinished(thing, readId);
+    });
+}
+
+void SunSpecRefreshScheduler::remove(QObject *object)
+{
+    if (!m_entries.contains(object))
+        return;
+
+    Entry entry = m_entries.take(object);
+    object->disconnect(this);
+
+    ConnectionSchedule &schedule = m_schedules[entry.connection];
+    schedule.objects.removeAll(object);
+    schedule.pending.removeAll(object);
+    if (schedule.objects.isEmpty()) {
+        removeConnection(entry.connection);
+        return;
+    }
+
+    if (schedule.current == object) {
+        schedule.watchdog->stop();
+        schedule.current = nullptr;
+        readNext(entry.connection);
+    }
+}
+
+bool SunSpecRefreshScheduler::isEmpty() const
+{
+    return m_entries.isEmpty();
+}
+
+bool SunSpecRefreshScheduler::isRunning() const
+{
+    return m_running;
+}
+
+void SunSpecRefreshScheduler::start()
+{
+    m_running = true;
+    updatePhases();
+}
+
+void SunSpecRefreshScheduler::stop()
+{
+    m_running = false;
+    foreach (SunSpecConnection *connection, m_schedules.keys()) {
+        ConnectionSchedule &schedule = m_schedules[connection];
+        schedule.timer->stop();
+        schedule.watchdog->stop();
+        schedule.pending.clear();
+        schedule.current = nullptr;
+    }
+}
+
+void SunSpecRefreshScheduler::addEntry(QObject *object, SunSpecConnection *connection, std::function<void()> read, std::function<quint32()> readId, uint divider)
+{
+    remove(object);
+
+    Entry entry;
+    entry.connection = connection;
+    entry.read = read;
+    entry.readId = readId;
+    entry.divider = qMax(1u, divider);
+    m_entries.insert(object, entry);
+
+    connect(object, &QObject::destroyed, this, [this, object](){
+        remove(object);
+    });
+
+    if (!m_schedules.contains(connection)) {
+        ConnectionSchedule schedule;
+        schedule.timer = new QTimer(this);
+        connect(schedule.timer, &QTimer::timeout, this, [this, connection](){
+            onRefreshTimeout(connection);
+        });
+
+        // Retries are handled by the modbus client, the watchdog only catches reads which never finish
+        schedule.watchdog = new QTimer(this);
+        schedule.watchdog->setSingleShot(true);
+        connect(schedule.watchdog, &QTimer::timeout, this, [this, connection](){
+            qCWarning(dcSunSpec()) << "Refresh of block on" << connection << "did not finish in time. Continue with the next block.";
+            m_schedules[connection].current = nullptr;
+            readNext(connection);
+        });
+
+        connect(connection, &SunSpecConnection::destroyed, this, [this, connection](){
+            removeConnection(connection);
+        });
+
+        m_schedules.insert(connection, schedule);
+        m_schedules[connection].objects.append(object);
+        updatePhases();
+    } else {
+        m_schedules[connection].objects.append(object);
+    }
+}
+
+void SunSpecRefreshScheduler::removeConnection(SunSpecConnection *connection)
+{
+    if (!m_schedules.contains(connection))
+        return;
+
+    ConnectionSchedule schedule = m_schedules.take(connection);
+    foreach (QObject *object, schedule.objects) {
+        m_entries.remove(object);
+        object->disconnect(this);
+    }
+
+    connection->disconnect(this);
+    schedule.timer->stop();
+    schedule.watchdog->stop();
+    schedule.timer->deleteLater();
+    schedule.watchdog->deleteLater();
+}
+
+void SunSpecRefreshScheduler::updatePhases()
+{
+    if (!m_running)
+        return;
+
+    // Only place connections which are not running yet. Restarting the running timers would
+    // delay or repeat their refresh, they switch to a new interval on their next timeout.
+    foreach (SunSpecConnection *connection, m_schedules.keys()) {
+        if (!m_schedules.value(connection).timer->isActive()) {
+            placeConnection(connection);
+        }
+    }
+}
+
+void SunSpecRefreshScheduler::placeConnection(SunSpecConnection *connection)
+{
+    // Start the connection in the middle of the largest gap between the next refreshes of the
+    // running connections, the timer switches to the actual interval on the first timeout
+    QList<int> phases;
+    foreach (const ConnectionSchedule &schedule, m_schedules) {
+        if (schedule.timer->isActive()) {
+            phases.append(schedule.timer->remainingTime() % m_interval);
+        }
+    }
+
+    int offset = 0;
+    if (!phases.isEmpty()) {
+        std::sort(phases.begin(), phases.end());
+        int largestGap = 0;
+        for (int i = 0; i < phases.count(); i++) {
+            int next = i + 1 < phases.count() ? phases.at(i + 1) : phases.first() + m_interval;
+            if (next - phases.at(i) > largestGap) {
+                largestGap = next - phases.at(i);
+                offset = (phases.at(i) + largestGap / 2) % m_interval;
+            }
+        }
+    }
+
+    m_schedules[connection].timer->start(qMax(1, offset));
+}
+
+void SunSpecRefreshScheduler::onRefreshTimeout(SunSpecConnection *connection)
+{
+    ConnectionSchedule &schedule = m_schedules[connection];
+    if (schedule.timer->interval() != m_interval)
+        schedule.timer->setInterval(m_interval);
+
+    if (!connection->connected())
+        return;
+
+    schedule.round++;
+    foreach (QObject *object, schedule.objects) {
+        if (schedule.round % m_entries.value(object).divider != 0)
+            continue;
+
+        // Still waiting from the last round, the device is slower than the interval
+        if (schedule.current == object || schedule.pending.contains(object))
+            continue;
+
+        schedule.pending.enqueue(object);
+    }
+
+    if (!schedule.current) {
+        readNext(connection);
+    }
+}
+
+void SunSpecRefreshScheduler::onReadFinished(QObject *object, quint32 readId)
+{
+    if (!m_entries.contains(object))
+        return;
+
+    SunSpecConnection *connection = m_entries.value(object).connection;
+    ConnectionSchedule &schedule = m_schedules[connection];
+
+    // Reads not started by the scheduler, i.e. during init, don't affect the schedule
+    if (schedule.current != object || schedule.currentReadId != readId)
+        return;
+
+    schedule.watchdog->stop();
+    schedule.current = nullptr;
+    readNext(connection);
+}
+
+void SunSpecRefreshScheduler::readNext(SunSpecConnection *connection)
+{
+    ConnectionSchedule &schedule = m_schedules[connection];
+    if (!connection->connected()) {
+        schedule.pending.clear();
+        return;
+    }
+
+    if (schedule.pending.isEmpty())
+        return;
+
+    QObject *object = schedule.pending.dequeue();
+    Entry entry = m_entries.value(object);
+    schedule.current = object;
+    // The read gets the next id of the object, the finished read may also be reported right away
+    schedule.currentReadId = entry.readId() + 1;
+    schedule.watchdog->start(connection->timeout() * (connection->numberOfRetries() + 1) + 1000);
+    entry.read();
+}
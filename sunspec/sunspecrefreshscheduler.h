@@ -0,0 +1,106 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+*
+* Copyright 2013 - 2023, nymea GmbH
+* Contact: contact@nymea.io
+*
+* This file is part of nymea.
+* This project including source code and documentation is protected by
+* copyright law, and remains the property of nymea GmbH. All rights, including
+* reproduction, publication, editing and translation, are reserved. The use of
+* this project is subject to the terms of a license agreement to be concluded
+* with nymea GmbH in accordance with the terms of use of nymea GmbH, available
+* under https://nymea.io/license
+*
+* GNU Lesser General Public License Usage
+* Alternatively, this project may be redistributed and/or modified under the
+* terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; version 3. This project is distributed in the hope that
+* it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+* warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this project. If not, see <https://www.gnu.org/licenses/>.
+*
+* For any further details and any questions please contact us under
+* contact@nymea.io or see our FAQ/Licensing Information on
+* https://nymea.io/license/faq
+*
+* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+
+#ifndef SUNSPECREFRESHSCHEDULER_H
+#define SUNSPECREFRESHSCHEDULER_H
+
+#include <QHash>
+#include <QQueue>
+#include <QTimer>
+#include <QObject>
+
+#include <functional>
+
+#include <sunspecmodel.h>
+#include <sunspecconnection.h>
+
+#include "sunspecthing.h"
+
+// Spreads the block reads of all SunSpec connections across the refresh interval. Each connection
+// gets its own phase offset within the interval and reads only one block at a time. A block can be
+// refreshed every n-th interval using the divider, i.e. for models which don't change that often.
+
+class SunSpecRefreshScheduler : public QObject
+{
+    Q_OBJECT
+public:
+    explicit SunSpecRefreshScheduler(QObject *parent = nullptr);
+
+    // Refresh interval in ms
+    int interval() const;
+    void setInterval(int interval);
+
+    void addModel(SunSpecModel *model, uint divider = 1);
+    void addThing(SunSpecThing *thing, uint divider = 1);
+    void remove(QObject *object);
+
+    bool isEmpty() const;
+    bool isRunning() const;
+
+    void start();
+    void stop();
+
+private:
+    typedef struct Entry {
+        SunSpecConnection *connection = nullptr;
+        std::function<void()> read;
+        std::function<quint32()> readId;
+        uint divider = 1;
+    } Entry;
+
+    typedef struct ConnectionSchedule {
+        QTimer *timer = nullptr;
+        QTimer *watchdog = nullptr;
+        QList<QObject *> objects;
+        QQueue<QObject *> pending;
+        QObject *current = nullptr;
+        quint32 currentReadId = 0;
+        quint64 round = 0;
+    } ConnectionSchedule;
+
+    int m_interval = 1000;
+    bool m_running = false;
+
+    QHash<QObject *, Entry> m_entries;
+    QHash<SunSpecConnection *, ConnectionSchedule> m_schedules;
+
+    void addEntry(QObject *object, SunSpecConnection *connection, std::function<void()> read, std::function<quint32()> readId, uint divider);
+    void removeConnection(SunSpecConnection *connection);
+    void updatePhases();
+    void placeConnection(SunSpecConnection *connection);
+
+    void onRefreshTimeout(SunSpecConnection *connection);
+    void onReadFinished(QObject *object, quint32 readId);
+    void readNext(SunSpecConnection *connection);
+
+};
+
+#endif // SUNSPECREFRESHSCHEDULER_H
@@ -56,6 +56,11 @@ Thing *SunSpecThing::thing() const
     return m_thing;
 }
 
+quint32 SunSpecThing::blockReadId() const
+{
+    return m_blockReadId;
+}
+
 quint16 SunSpecThing::modbusStartRegister() const
 {
     if (!m_model)
@@ -55,11 +55,19 @@ public:
 
     virtual void readBlockData() = 0;
 
+    // Id of the last read started with readBlockData(), blockReadFinished() reports the id of the finished read
+    quint32 blockReadId() const;
+
     virtual void executeAction(ThingActionInfo *info);
 
+signals:
+    // Emitted once for each readBlockData() call, also if the request failed
+    void blockReadFinished(bool success, quint32 readId);
+
 protected:
     Thing *m_thing = nullptr;
     SunSpecModel *m_model = nullptr;
+    quint32 m_blockReadId = 0;
 
 private slots:
     virtual void onBlockDataUpdated();
@@ -433,6 +433,7 @@ void IntegrationPluginUniPi::setupThing(ThingSetupInfo *info)
             neuron = nullptr;
             return info->finish(Thing::ThingErrorSetupFailed, QT_TR_NOOP("Error setting up Neuron Thing."));
         }
+        applyInputPollingSettings(neuron);
         m_neurons.insert(thing->id(), neuron);
         connect(neuron, &Neuron::requestExecuted, this, &IntegrationPluginUniPi::onRequestExecuted);
         connect(neuron, &Neuron::requestError, this, &IntegrationPluginUniPi::onRequestError);
@@ -492,6 +493,7 @@ void IntegrationPluginUniPi::setupThing(ThingSetupInfo *info)
             neuronExtension = nullptr;
             return info->finish(Thing::ThingErrorSetupFailed, QT_TR_NOOP("Error loading modbus map."));
         }
+        applyInputPollingSettings(neuronExtension);
         connect(neuronExtension, &NeuronExtension::requestExecuted, this, &IntegrationPluginUniPi::onRequestExecuted);
         connect(neuronExtension, &NeuronExtension::requestError, this, &IntegrationPluginUniPi::onRequestError);
         connect(neuronExtension, &NeuronExtension::connectionStateChanged, this, &IntegrationPluginUniPi::onNeuronExtensionConnectionStateChanged);
@@ -731,6 +733,29 @@ void IntegrationPluginUniPi::onPluginConfigurationChanged(const ParamTypeId &par
             }
         }
     }
+
+    if (paramTypeId == uniPiPluginInputPollingModeParamTypeId ||
+            paramTypeId == uniPiPluginMinimumInputPollingIntervalParamTypeId ||
+            paramTypeId == uniPiPluginMaximumInputPollingIntervalParamTypeId) {
+        foreach (Neuron *neuron, m_neurons) {
+            applyInputPollingSettings(neuron);
+        }
+        foreach (NeuronExtension *neuronExtension, m_neuronExtensions) {
+            applyInputPollingSettings(neuronExtension);
+        }
+    }
+}
+
+void IntegrationPluginUniPi::applyInputPollingSettings(NeuronCommon *neuronCommon)
+{
+    neuronCommon->setInputPollingIntervals(configValue(uniPiPluginMinimumInputPollingIntervalParamTypeId).toInt(),
+                                           configValue(uniPiPluginMaximumInputPollingIntervalParamTypeId).toInt());
+
+    if (configValue(uniPiPluginInputPollingModeParamTypeId).toString() == "Fixed") {
+        neuronCommon->setInputPollingMode(NeuronCommon::InputPollingModeFixed);
+    } else {
+        neuronCommon->setInputPollingMode(NeuronCommon::InputPollingModeAdaptive);
+    }
 }
 
 void IntegrationPluginUniPi::onNeuronConnectionStateChanged(bool state)
@@ -75,6 +75,8 @@ private:
     bool neuronDeviceInit();
     bool neuronExtensionInterfaceInit();
 
+    void applyInputPollingSettings(NeuronCommon *neuronCommon);
+
 private slots:
     void onPluginConfigurationChanged(const ParamTypeId &paramTypeId, const QVariant &value);
 
@@ -40,30 +40,22 @@
 #define CONFIGURATION_REGISTER
 
 
-MCP342XChannel::MCP342XChannel(const QString &portName, int address, int channel, Gain gain, QObject *parent) :
+MCP342XChannel::MCP342XChannel(const QString &portName, int address, int channel, Gain gain, SampleRateSelectionBit sampleRate, QObject *parent) :
     I2CDevice(portName, address, parent),
     m_channel(channel),
-    m_gain(gain)
+    m_gain(gain),
+    m_sampleRate(sampleRate)
 {
 
 }
 
 QByteArray MCP342XChannel::readData(int fd)
 {
-    // Wair for previous messurements to be completed
-    char readBuf[3] = {0};
-    do {
-        if (read(fd, readBuf, 3) != 3) {
-            qCWarning(dcUniPi()) << "MCP342X: could not read ADC data";
-            return QByteArray();
-        }
-    } while (!(readBuf[2] & (1 << ConfRegisterBits::RDY)));
-
-    // Start a configuration conversation
+    // Start a one shot conversion on this channel
     unsigned char writeBuf[1] = {0};
     writeBuf[0] |= (m_channel & 0x0003) << ConfRegisterBits::C0;
     writeBuf[0] |= m_gain << ConfRegisterBits::G0;
-    //writeBuf[0] |= SampleRateSelectionBit::Bits18 << ConfRegisterBits::S0;
+    writeBuf[0] |= m_sampleRate << ConfRegisterBits::S0;
     writeBuf[0] |= 1 << ConfRegisterBits::OC;   // one shot
     writeBuf[0] |= 1 << ConfRegisterBits::RDY;  // start conversoin
     if (write(fd, writeBuf, 1) != 1) {
@@ -71,17 +63,80 @@ QByteArray MCP342XChannel::readData(int fd)
         return QByteArray();
     }
 
-    // Wait again for the device to finish measurement
-    do {
-        if (read(fd, readBuf, 3) != 3) {
+    // In 18 bit mode the result has 3 data bytes, otherwise 2, followed by the config byte
+    int length = (m_sampleRate == Bits18) ? 4 : 3;
+    char readBuf[4] = {0};
+
+    // Instead of spinning on the bus, sleep until the conversion must be finished
+    // and check the ready bit only a few times afterwards.
+    QThread::msleep(conversionTime());
+    for (int attempt = 0; attempt < m_maxReadyAttempts; attempt++) {
+        if (read(fd, readBuf, length) != length) {
             qCWarning(dcUniPi()) << "MCP342X: could not read ADC data";
             return QByteArray();
         }
-    } while (!(readBuf[2] & (1 << ConfRegisterBits::RDY)));
 
-    if ((readBuf[2] & (0x03 << ConfRegisterBits::C0)) != ((m_channel & 0x0003) << ConfRegisterBits::C0))
+        // RDY = 0: the output register contains the new conversion result
+        if (!(readBuf[length - 1] & (1 << ConfRegisterBits::RDY)))
+            break;
+
+        if (attempt == m_maxReadyAttempts - 1) {
+            qCWarning(dcUniPi()) << "MCP342X: conversion did not finish in time on channel" << m_channel;
+            return QByteArray();
+        }
+
+        QThread::msleep(qMax(1, conversionTime() / 4));
+    }
+
+    if ((readBuf[length - 1] & (0x03 << ConfRegisterBits::C0)) != ((m_channel & 0x0003) << ConfRegisterBits::C0))
         return QByteArray();
 
-    return QByteArray(readBuf, 3);
+    return QByteArray(readBuf, length);
+}
+
+int MCP342XChannel::conversionTime() const
+{
+    switch (m_sampleRate) {
+    case Bits12:
+        return 5;   // 240 SPS
+    case Bits14:
+        return 17;  // 60 SPS
+    case Bits16:
+        return 67;  // 15 SPS
+    case Bits18:
+        return 267; // 3.75 SPS
+    }
+    return 267;
+}
+
+int MCP342XChannel::resolution() const
+{
+    return 12 + 2 * m_sampleRate;
+}
+
+double MCP342XChannel::lsb() const
+{
+    // 2 * Vref / 2^N with the internal 2.048 V reference
+    return 2 * 2.048 / (1 << resolution());
+}
+
+qint32 MCP342XChannel::fullScale() const
+{
+    return (1 << (resolution() - 1)) - 1;
 }
 
+double MCP342XChannel::voltage(const QByteArray &data) const
+{
+    // The output code is big endian in 2 bytes, or 3 bytes in 18 bit mode,
+    // with the sign bit repeated in the unused upper bits
+    int dataBytes = (m_sampleRate == Bits18) ? 3 : 2;
+    if (data.length() < dataBytes)
+        return 0;
+
+    qint32 rawValue = static_cast<qint8>(data.at(0));
+    for (int i = 1; i < dataBytes; i++)
+        rawValue = (rawValue << 8) | static_cast<quint8>(data.at(i));
+
+    rawValue = qBound(-fullScale() - 1, rawValue, fullScale());
+    return rawValue * lsb() / (1 << m_gain);
+}
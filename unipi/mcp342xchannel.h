@@ -74,13 +74,27 @@ public:
         Bits18 = 3
     };
 
-    explicit MCP342XChannel(const QString &portName, int address, int channel, Gain gain, QObject *parent = nullptr);
+    explicit MCP342XChannel(const QString &portName, int address, int channel, Gain gain, SampleRateSelectionBit sampleRate = Bits12, QObject *parent = nullptr);
 
+    // Note: called by the I2C manager on its reader thread
     QByteArray readData(int fd) override;
 
+    // Conversion time in ms for the configured sample rate
+    int conversionTime() const;
+
+    // Resolution in bits, LSB in V and the largest output code for the configured sample rate
+    int resolution() const;
+    double lsb() const;
+    qint32 fullScale() const;
+
+    // Input voltage of a reading returned by readData(), using the configured resolution and gain
+    double voltage(const QByteArray &data) const;
+
 private:
     int m_channel = 0;
     Gain m_gain = Gain_1;
+    SampleRateSelectionBit m_sampleRate = Bits12;
+    int m_maxReadyAttempts = 5;
 };
 
 #endif // MCP342X_H
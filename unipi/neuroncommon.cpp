@@ -31,10 +31,13 @@
 #include "neuroncommon.h"
 #include "extern-plugininfo.h"
 
+#include "unipimodbusmaps.h"
+
 NeuronCommon::NeuronCommon(QModbusClient *modbusInterface, int slaveAddress, QObject *parent) :
     QObject(parent),
     m_slaveAddress(slaveAddress),
-    m_modbusInterface(modbusInterface)
+    m_modbusInterface(modbusInterface),
+    m_modbusMap(new ModbusMap())
 {
     m_inputPollingTimer = new QTimer(this);
     connect(m_inputPollingTimer, &QTimer::timeout, this, &NeuronCommon::onInputPollingTimer);
@@ -46,23 +49,23 @@ NeuronCommon::NeuronCommon(QModbusClient *modbusInterface, int slaveAddress, QOb
     m_outputPollingTimer->setTimerType(Qt::TimerType::PreciseTimer);
     m_outputPollingTimer->setInterval(1000);
 
+    m_digitalInputPollingTimer = new QTimer(this);
+    connect(m_digitalInputPollingTimer, &QTimer::timeout, this, &NeuronCommon::pollDigitalInputs);
+    m_digitalInputPollingTimer->setTimerType(Qt::TimerType::PreciseTimer);
+    m_digitalInputPollingTimer->setSingleShot(true);
+    m_digitalInputPollingTimer->setInterval(m_minimumDigitalInputPollingInterval);
+    m_digitalInputPollRequestId = QUuid::createUuid();
+
     if (m_modbusInterface->state() == QModbusDevice::State::ConnectedState) {
-        m_inputPollingTimer->start();
-        m_outputPollingTimer->start();
+        startPolling();
     }
 
     connect(m_modbusInterface, &QModbusDevice::stateChanged, this, [this] (QModbusDevice::State state) {
         if (state == QModbusDevice::State::ConnectedState) {
-            if (m_inputPollingTimer)
-                m_inputPollingTimer->start();
-            if (m_outputPollingTimer)
-                m_outputPollingTimer->start();
+            startPolling();
             emit connectionStateChanged(true);
         } else {
-            if (m_inputPollingTimer)
-                m_inputPollingTimer->stop();
-            if (m_outputPollingTimer)
-                m_outputPollingTimer->stop();
+            stopPolling();
             emit connectionStateChanged(false);
         }
     });
@@ -74,6 +77,7 @@ bool NeuronCommon::init()
     if (!loadModbusMap()) {
         return false;
     }
+    buildReadPlan();
 
     if (!m_modbusInterface) {
         qWarning(dcUniPi()) << "Neuron: Modbus interface not available";
@@ -98,20 +102,49 @@ void NeuronCommon::setSlaveAddress(int slaveAddress)
     m_slaveAddress = slaveAddress;
 }
 
+NeuronCommon::InputPollingMode NeuronCommon::inputPollingMode() const
+{
+    return m_inputPollingMode;
+}
+
+void NeuronCommon::setInputPollingMode(InputPollingMode inputPollingMode)
+{
+    if (m_inputPollingMode == inputPollingMode)
+        return;
+
+    qCDebug(dcUniPi()) << "Neuron: Set input polling mode" << inputPollingMode;
+    m_inputPollingMode = inputPollingMode;
+    if (m_modbusInterface->state() == QModbusDevice::State::ConnectedState) {
+        stopPolling();
+        startPolling();
+    }
+}
+
+void NeuronCommon::setInputPollingIntervals(int minimumInterval, int maximumInterval)
+{
+    if (minimumInterval <= 0 || maximumInterval < minimumInterval || maximumInterval > 10000) {
+        qCWarning(dcUniPi()) << "Neuron: Invalid input polling intervals" << minimumInterval << maximumInterval;
+        return;
+    }
+
+    m_minimumDigitalInputPollingInterval = minimumInterval;
+    m_maximumDigitalInputPollingInterval = maximumInterval;
+}
+
 QList<QString> NeuronCommon::digitalInputs()
 {
-    return m_modbusDigitalInputRegisters.keys();
+    return m_modbusMap->digitalInputRegisters.keys();
 }
 
 QList<QString> NeuronCommon::digitalOutputs()
 {
-    return m_modbusDigitalOutputRegisters.keys();
+    return m_modbusMap->digitalOutputRegisters.keys();
 }
 
 QList<QString> NeuronCommon::analogInputs()
 {
     QList<QString> circuits;
-    Q_FOREACH(RegisterDescriptor descriptor, m_modbusAnalogInputRegisters.values()) {
+    Q_FOREACH(RegisterDescriptor descriptor, m_modbusMap->analogInputRegisters.values()) {
         circuits.append(descriptor.circuit);
     }
     return circuits;
@@ -120,7 +153,7 @@ QList<QString> NeuronCommon::analogInputs()
 QList<QString> NeuronCommon::analogOutputs()
 {
     QList<QString> circuits;
-    Q_FOREACH(RegisterDescriptor descriptor, m_modbusAnalogOutputRegisters.values()) {
+    Q_FOREACH(RegisterDescriptor descriptor, m_modbusMap->analogOutputRegisters.values()) {
         circuits.append(descriptor.circuit);
     }
     return circuits;
@@ -128,33 +161,82 @@ QList<QString> NeuronCommon::analogOutputs()
 
 QList<QString> NeuronCommon::userLEDs()
 {
-    return m_modbusUserLEDRegisters.keys();
+    return m_modbusMap->userLEDRegisters.keys();
 }
 
-NeuronCommon::RegisterDescriptor NeuronCommon::registerDescriptorFromStringList(const QStringList &data)
+bool NeuronCommon::loadCompiledModbusMap(const QString &mapName)
 {
-    RegisterDescriptor descriptor;
-    if (data.count() < 7) {
-        return descriptor;
+    // All devices of the same type share the circuit lookup tables, they get built only once
+    static QHash<QString, QSharedPointer<const ModbusMap> > modbusMaps;
+    if (modbusMaps.contains(mapName)) {
+        m_modbusMap = modbusMaps.value(mapName);
+        return true;
+    }
+
+    // The CSV modbus maps get compiled into static tables at build time (see tools/generate-modbus-maps.py)
+    const UniPiModbusMaps::Map *map = UniPiModbusMaps::findMap(mapName.toUtf8().constData());
+    if (!map) {
+        qCWarning(dcUniPi()) << "Neuron: No modbus map available for" << mapName;
+        return false;
     }
-    descriptor.address = data[0].toInt();
-    descriptor.count = data[2].toInt();
-    if (data[3] == "RW") {
-        descriptor.readWrite = RWPermissionReadWrite;
-    } else if (data[3] == "W") {
-        descriptor.readWrite = RWPermissionWrite;
-    } else if (data[3] == "R") {
-        descriptor.readWrite = RWPermissionRead;
+
+    qCDebug(dcUniPi()) << "Neuron: Loading modbus map" << mapName << map->coilCount << "coils" << map->registerCount << "registers";
+    ModbusMap *modbusMap = new ModbusMap();
+    for (int i = 0; i < map->coilCount; i++) {
+        const UniPiModbusMaps::CoilEntry &entry = map->coils[i];
+        QString circuit = QString::fromLatin1(entry.circuit);
+        switch (entry.type) {
+        case UniPiModbusMaps::DigitalInput:
+            modbusMap->digitalInputRegisters.insert(circuit, entry.address);
+            break;
+        case UniPiModbusMaps::DigitalOutput:
+        case UniPiModbusMaps::RelayOutput:
+            modbusMap->digitalOutputRegisters.insert(circuit, entry.address);
+            break;
+        case UniPiModbusMaps::UserLED:
+            modbusMap->userLEDRegisters.insert(circuit, entry.address);
+            break;
+        default:
+            break;
+        }
     }
-    descriptor.circuit = data[5].split(" ").last();
-    descriptor.category = data.last();
 
-    if (data[5].contains("Analog Input Value", Qt::CaseSensitivity::CaseInsensitive)) {
-        descriptor.registerType = QModbusDataUnit::RegisterType::InputRegisters;
-    } else if (data[5].contains("Analog Output Value", Qt::CaseSensitivity::CaseInsensitive)) {
-        descriptor.registerType = QModbusDataUnit::RegisterType::HoldingRegisters;
+    for (int i = 0; i < map->registerCount; i++) {
+        const UniPiModbusMaps::RegisterEntry &entry = map->registers[i];
+        QString circuit = QString::fromLatin1(entry.circuit);
+        if (entry.type == UniPiModbusMaps::DigitalInputBits) {
+            modbusMap->digitalInputRegisterBits[entry.address].insert(entry.bit, circuit);
+            continue;
+        }
+
+        RegisterDescriptor descriptor;
+        descriptor.address = entry.address;
+        descriptor.count = entry.count;
+        descriptor.circuit = circuit;
+        descriptor.category = "Basic";
+        QString readWrite = QString::fromLatin1(entry.readWrite);
+        if (readWrite == "RW") {
+            descriptor.readWrite = RWPermissionReadWrite;
+        } else if (readWrite == "W") {
+            descriptor.readWrite = RWPermissionWrite;
+        } else if (readWrite == "R") {
+            descriptor.readWrite = RWPermissionRead;
+        } else {
+            descriptor.readWrite = RWPermissionNone;
+        }
+
+        if (entry.type == UniPiModbusMaps::AnalogInput) {
+            descriptor.registerType = QModbusDataUnit::RegisterType::InputRegisters;
+            modbusMap->analogInputRegisters.insert(descriptor.address, descriptor);
+        } else if (entry.type == UniPiModbusMaps::AnalogOutput) {
+            descriptor.registerType = QModbusDataUnit::RegisterType::HoldingRegisters;
+            modbusMap->analogOutputRegisters.insert(descriptor.address, descriptor);
+        }
     }
-    return descriptor;
+
+    m_modbusMap = QSharedPointer<const ModbusMap>(modbusMap);
+    modbusMaps.insert(mapName, m_modbusMap);
+    return true;
 }
 
 bool NeuronCommon::circuitValueChanged(const QString &circuit, quint32 value)
@@ -173,47 +255,142 @@ bool NeuronCommon::circuitValueChanged(const QString &circuit, quint32 value)
     }
 }
 
+void NeuronCommon::buildReadPlan()
+{
+    m_digitalInputCircuits.clear();
+    foreach (const QString &circuit, m_modbusMap->digitalInputRegisters.keys())
+        m_digitalInputCircuits.insert(m_modbusMap->digitalInputRegisters.value(circuit), circuit);
+
+    m_digitalOutputCircuits.clear();
+    foreach (const QString &circuit, m_modbusMap->digitalOutputRegisters.keys())
+        m_digitalOutputCircuits.insert(m_modbusMap->digitalOutputRegisters.value(circuit), circuit);
+
+    m_userLEDCircuits.clear();
+    foreach (const QString &circuit, m_modbusMap->userLEDRegisters.keys())
+        m_userLEDCircuits.insert(m_modbusMap->userLEDRegisters.value(circuit), circuit);
+
+    m_digitalInputReadRanges = contiguousReadRanges(QModbusDataUnit::RegisterType::Coils, m_modbusMap->digitalInputRegisters.values());
+    m_digitalInputRegisterReadRanges = contiguousReadRanges(QModbusDataUnit::RegisterType::InputRegisters, m_modbusMap->digitalInputRegisterBits.keys());
+    m_digitalOutputReadRanges = contiguousReadRanges(QModbusDataUnit::RegisterType::Coils, m_modbusMap->digitalOutputRegisters.values());
+    m_userLEDReadRanges = contiguousReadRanges(QModbusDataUnit::RegisterType::Coils, m_modbusMap->userLEDRegisters.values());
+    m_analogInputReadRanges = registerReadRanges(m_modbusMap->analogInputRegisters.values());
+    m_analogOutputReadRanges = registerReadRanges(m_modbusMap->analogOutputRegisters.values());
+
+    qCDebug(dcUniPi()) << "Neuron: Read plan: digital inputs" << m_digitalInputReadRanges.count() << "requests,"
+                       << "packed digital inputs" << m_digitalInputRegisterReadRanges.count() << "requests,"
+                       << "digital outputs" << m_digitalOutputReadRanges.count() << "requests,"
+                       << "user LEDs" << m_userLEDReadRanges.count() << "requests,"
+                       << "analog inputs" << m_analogInputReadRanges.count() << "requests,"
+                       << "analog outputs" << m_analogOutputReadRanges.count() << "requests";
+}
+
+QList<QModbusDataUnit> NeuronCommon::contiguousReadRanges(QModbusDataUnit::RegisterType registerType, QList<int> addresses)
+{
+    QList<QModbusDataUnit> ranges;
+    if (addresses.isEmpty())
+        return ranges;
+
+    // Max coils / registers per read request according to the modbus specification
+    const int maxCount = registerType == QModbusDataUnit::RegisterType::Coils ? 2000 : 125;
+
+    std::sort(addresses.begin(), addresses.end());
+    int startAddress = addresses.first();
+    int count = 0;
+    foreach (int address, addresses) {
+        if (address == startAddress + count && count < maxCount) {
+            count++;
+        } else if (address < startAddress + count) {
+            // Duplicated address, already covered
+            continue;
+        } else {
+            ranges.append(QModbusDataUnit(registerType, startAddress, count));
+            startAddress = address;
+            count = 1;
+        }
+    }
+    ranges.append(QModbusDataUnit(registerType, startAddress, count));
+    return ranges;
+}
+
+QList<QModbusDataUnit> NeuronCommon::registerReadRanges(QList<RegisterDescriptor> descriptors)
+{
+    QList<QModbusDataUnit> ranges;
+    if (descriptors.isEmpty())
+        return ranges;
+
+    // Max registers per read request according to the modbus specification
+    const uint maxCount = 125;
+
+    std::sort(descriptors.begin(), descriptors.end(), [](const RegisterDescriptor &a, const RegisterDescriptor &b) {
+        if (a.registerType != b.registerType)
+            return a.registerType < b.registerType;
+
+        return a.address < b.address;
+    });
+
+    RegisterDescriptor first = descriptors.first();
+    QModbusDataUnit::RegisterType registerType = first.registerType;
+    int startAddress = first.address;
+    uint count = first.count;
+    for (int i = 1; i < descriptors.count(); i++) {
+        const RegisterDescriptor &descriptor = descriptors.at(i);
+        if (descriptor.registerType == registerType
+                && descriptor.address == startAddress + static_cast<int>(count)
+                && count + descriptor.count <= maxCount) {
+            count += descriptor.count;
+        } else {
+            ranges.append(QModbusDataUnit(registerType, startAddress, count));
+            registerType = descriptor.registerType;
+            startAddress = descriptor.address;
+            count = descriptor.count;
+        }
+    }
+    ranges.append(QModbusDataUnit(registerType, startAddress, count));
+    return ranges;
+}
+
 void NeuronCommon::getAllDigitalInputs()
 {
-    getCoils(m_modbusDigitalInputRegisters.values());
+    readRanges(m_digitalInputReadRanges);
 }
 
 void NeuronCommon::getAllDigitalOutputs()
 {
-    getCoils(m_modbusDigitalOutputRegisters.values());
+    readRanges(m_digitalOutputReadRanges);
 }
 
 void NeuronCommon::getAllAnalogInputs()
 {
-    Q_FOREACH(RegisterDescriptor descriptor, m_modbusAnalogInputRegisters.values()) {
-        getAnalogIO(descriptor);
-    }
+    readRanges(m_analogInputReadRanges);
 }
 
 void NeuronCommon::getAllAnalogOutputs()
 {
-    Q_FOREACH(RegisterDescriptor descriptor, m_modbusAnalogOutputRegisters.values()) {
-        getAnalogIO(descriptor);
-    }
+    readRanges(m_analogOutputReadRanges);
+}
+
+void NeuronCommon::getAllUserLEDs()
+{
+    readRanges(m_userLEDReadRanges);
 }
 
 bool NeuronCommon::getDigitalInput(const QString &circuit)
 {
-    if (!m_modbusDigitalInputRegisters.contains(circuit)) {
+    if (!m_modbusMap->digitalInputRegisters.contains(circuit)) {
         qCWarning(dcUniPi()) << "Neuron: Digital input circuit not found" << circuit;
         return "";
     }
-    int modbusAddress = m_modbusDigitalInputRegisters.value(circuit);
+    int modbusAddress = m_modbusMap->digitalInputRegisters.value(circuit);
     //qDebug(dcUniPi()) << "Neuron: Reading digital Input" << circuit << modbusAddress;
 
     QModbusDataUnit request = QModbusDataUnit(QModbusDataUnit::RegisterType::Coils, modbusAddress, 1);
     if (m_readRequestQueue.isEmpty()) {
-        return modbusReadRequest(request);
+        return modbusReadRequest(request) != nullptr;
     } else if (m_readRequestQueue.length() > 100) {
         qCWarning(dcUniPi()) << "Neuron: Too many pending read requests";
         return false;
     } else {
-        m_readRequestQueue.append(request);
+        m_readRequestQueue.append(Request{QUuid(), request});
     }
     return true;
 }
@@ -221,7 +398,7 @@ bool NeuronCommon::getDigitalInput(const QString &circuit)
 bool NeuronCommon::getAnalogOutput(const QString &circuit)
 {
     //qDebug(dcUniPi()) << "Neuron: Get analog output" << circuit;
-    Q_FOREACH(RegisterDescriptor descriptor, m_modbusAnalogOutputRegisters.values()) {
+    Q_FOREACH(RegisterDescriptor descriptor, m_modbusMap->analogOutputRegisters.values()) {
         if (descriptor.circuit == circuit) {
             return getAnalogIO(descriptor);
         }
@@ -233,11 +410,11 @@ bool NeuronCommon::getAnalogOutput(const QString &circuit)
 
 QUuid NeuronCommon::setDigitalOutput(const QString &circuit, bool value)
 {
-    if (!m_modbusDigitalOutputRegisters.contains(circuit)) {
+    if (!m_modbusMap->digitalOutputRegisters.contains(circuit)) {
         qCWarning(dcUniPi()) << "Neuron: Digital output circuit not found" << circuit;
         return "";
     }
-    int modbusAddress = m_modbusDigitalOutputRegisters.value(circuit);
+    int modbusAddress = m_modbusMap->digitalOutputRegisters.value(circuit);
     //qDebug(dcUniPi()) << "Neuron: Setting digital ouput" << circuit << modbusAddress << value;
 
     Request request;
@@ -258,21 +435,21 @@ QUuid NeuronCommon::setDigitalOutput(const QString &circuit, bool value)
 
 bool NeuronCommon::getDigitalOutput(const QString &circuit)
 {
-    if (!m_modbusDigitalOutputRegisters.contains(circuit)) {
+    if (!m_modbusMap->digitalOutputRegisters.contains(circuit)) {
         qCWarning(dcUniPi()) << "Neuron: Digital output circuit not found" << circuit;
         return false;
     }
-    int modbusAddress = m_modbusDigitalOutputRegisters.value(circuit);
+    int modbusAddress = m_modbusMap->digitalOutputRegisters.value(circuit);
     //qDebug(dcUniPi()) << "Reading digital Output" << circuit << modbusAddress;
 
     QModbusDataUnit request = QModbusDataUnit(QModbusDataUnit::RegisterType::HoldingRegisters, modbusAddress, 1);
     if (m_readRequestQueue.isEmpty()) {
-        return modbusReadRequest(request);
+        return modbusReadRequest(request) != nullptr;
     } else if (m_readRequestQueue.length() > 100) {
         qCWarning(dcUniPi()) << "Neuron: Too many pending read requests";
         return false;
     } else {
-        m_readRequestQueue.append(request);
+        m_readRequestQueue.append(Request{QUuid(), request});
     }
     return true;
 }
@@ -282,7 +459,7 @@ QUuid NeuronCommon::setAnalogOutput(const QString &circuit, double value)
 {
     qDebug(dcUniPi()) << "Neuron: Set analog output" << circuit << value;
 
-    Q_FOREACH(RegisterDescriptor descriptor, m_modbusAnalogOutputRegisters) {
+    Q_FOREACH(RegisterDescriptor descriptor, m_modbusMap->analogOutputRegisters) {
         if (descriptor.circuit == circuit) {
             Request request;
             request.id = QUuid::createUuid();
@@ -313,7 +490,7 @@ bool NeuronCommon::getAnalogInput(const QString &circuit)
 {
     //qDebug(dcUniPi()) << "Neuron: Get analog input" << circuit;
 
-    Q_FOREACH(RegisterDescriptor descriptor, m_modbusAnalogOutputRegisters.values()) {
+    Q_FOREACH(RegisterDescriptor descriptor, m_modbusMap->analogOutputRegisters.values()) {
         if (descriptor.circuit == circuit) {
             return getAnalogIO(descriptor);
         }
@@ -323,7 +500,7 @@ bool NeuronCommon::getAnalogInput(const QString &circuit)
 
 QUuid NeuronCommon::setUserLED(const QString &circuit, bool value)
 {
-    int modbusAddress = m_modbusUserLEDRegisters.value(circuit);
+    int modbusAddress = m_modbusMap->userLEDRegisters.value(circuit);
     //qDebug(dcUniPi()) << "Neuron: Setting user led" << circuit << modbusAddress << value;
 
     if (!m_modbusInterface)
@@ -351,17 +528,17 @@ QUuid NeuronCommon::setUserLED(const QString &circuit, bool value)
 
 bool NeuronCommon::getUserLED(const QString &circuit)
 {
-    int modbusAddress = m_modbusUserLEDRegisters.value(circuit);
+    int modbusAddress = m_modbusMap->userLEDRegisters.value(circuit);
     //qDebug(dcUniPi()) << "Neuron: Get user LED" << circuit << modbusAddress;
 
     QModbusDataUnit request = QModbusDataUnit(QModbusDataUnit::RegisterType::Coils, modbusAddress, 1);
     if (m_readRequestQueue.isEmpty()) {
-        return modbusReadRequest(request);
+        return modbusReadRequest(request) != nullptr;
     } else if (m_readRequestQueue.length() > 100) {
         qCWarning(dcUniPi()) << "Neuron: Too many pending read requests";
         return false;
     } else {
-        m_readRequestQueue.append(request);
+        m_readRequestQueue.append(Request{QUuid(), request});
     }
     return true;
 }
@@ -376,12 +553,12 @@ bool NeuronCommon::getAnalogIO(const RegisterDescriptor &descriptor)
 
     QModbusDataUnit request = QModbusDataUnit(descriptor.registerType, descriptor.address, descriptor.count);
     if (m_readRequestQueue.isEmpty()) {
-        return modbusReadRequest(request);
+        return modbusReadRequest(request) != nullptr;
     } else if (m_readRequestQueue.length() > 100) {
         qCWarning(dcUniPi()) << "Neuron: Too many pending read requests";
         return false;
     } else {
-        m_readRequestQueue.append(request);
+        m_readRequestQueue.append(Request{QUuid(), request});
     }
     return true;
 }
@@ -412,14 +589,14 @@ bool NeuronCommon::modbusWriteRequest(const Request &request)
                     emit requestExecuted(request.id, true);
                     const QModbusDataUnit unit = reply->result();
                     int modbusAddress = unit.startAddress();
-                    if(m_modbusDigitalOutputRegisters.values().contains(modbusAddress)){
-                        QString circuit = m_modbusDigitalOutputRegisters.key(modbusAddress);
+                    if(m_digitalOutputCircuits.contains(modbusAddress)){
+                        QString circuit = m_digitalOutputCircuits.value(modbusAddress);
                         emit digitalOutputStatusChanged(circuit, unit.value(0));
-                    } else if(m_modbusAnalogOutputRegisters.contains(modbusAddress)){
-                        QString circuit = m_modbusAnalogOutputRegisters.value(modbusAddress).circuit;
+                    } else if(m_modbusMap->analogOutputRegisters.contains(modbusAddress)){
+                        QString circuit = m_modbusMap->analogOutputRegisters.value(modbusAddress).circuit;
                         emit analogOutputStatusChanged(circuit, unit.value(0));
-                    } else if(m_modbusUserLEDRegisters.values().contains(modbusAddress)){
-                        QString circuit = m_modbusUserLEDRegisters.key(modbusAddress);
+                    } else if(m_userLEDCircuits.contains(modbusAddress)){
+                        QString circuit = m_userLEDCircuits.value(modbusAddress);
                         emit userLEDStatusChanged(circuit, unit.value(0));
                     }
                 } else {
@@ -441,19 +618,23 @@ bool NeuronCommon::modbusWriteRequest(const Request &request)
 }
 
 
-bool NeuronCommon::modbusReadRequest(const QModbusDataUnit &request)
+QModbusReply *NeuronCommon::modbusReadRequest(const QModbusDataUnit &request)
 {
     if (!m_modbusInterface) {
-        return false;
+        return nullptr;
     }
     if (m_modbusInterface->state() != QModbusDevice::State::ConnectedState)
-        return false;
+        return nullptr;
 
     if (QModbusReply *reply = m_modbusInterface->sendReadRequest(request, m_slaveAddress)) {
         if (!reply->isFinished()) {
             connect(reply, &QModbusReply::finished, reply, &QModbusReply::deleteLater);
             connect(reply, &QModbusReply::finished, this, [reply, this] {
 
+                if (!m_readRequestQueue.isEmpty()) {
+                    sendReadRequest(m_readRequestQueue.takeFirst());
+                }
+
                 int modbusAddress = 0;
 
                 if (reply->error() == QModbusDevice::NoError) {
@@ -466,16 +647,18 @@ bool NeuronCommon::modbusReadRequest(const QModbusDataUnit &request)
                         QString circuit;
                         switch (unit.registerType()) {
                         case QModbusDataUnit::RegisterType::Coils:
-                            if(m_modbusDigitalInputRegisters.values().contains(modbusAddress)){
-                                circuit = m_modbusDigitalInputRegisters.key(modbusAddress);
-                                if (circuitValueChanged(circuit, unit.value(i)))
+                            if(m_digitalInputCircuits.contains(modbusAddress)){
+                                circuit = m_digitalInputCircuits.value(modbusAddress);
+                                if (circuitValueChanged(circuit, unit.value(i))) {
+                                    m_digitalInputChanged = true;
                                     emit digitalInputStatusChanged(circuit, unit.value(i));
-                            } else if(m_modbusDigitalOutputRegisters.values().contains(modbusAddress)){
-                                circuit = m_modbusDigitalOutputRegisters.key(modbusAddress);
+                                }
+                            } else if(m_digitalOutputCircuits.contains(modbusAddress)){
+                                circuit = m_digitalOutputCircuits.value(modbusAddress);
                                 if (circuitValueChanged(circuit, unit.value(i)))
                                     emit digitalOutputStatusChanged(circuit, unit.value(i));
-                            } else if(m_modbusUserLEDRegisters.values().contains(modbusAddress)){
-                                circuit = m_modbusUserLEDRegisters.key(modbusAddress);
+                            } else if(m_userLEDCircuits.contains(modbusAddress)){
+                                circuit = m_userLEDCircuits.value(modbusAddress);
                                 if (circuitValueChanged(circuit, unit.value(i)))
                                     emit userLEDStatusChanged(circuit, unit.value(i));
                             } else {
@@ -484,14 +667,14 @@ bool NeuronCommon::modbusReadRequest(const QModbusDataUnit &request)
                             break;
 
                         case QModbusDataUnit::RegisterType::HoldingRegisters: {
-                            if (m_modbusAnalogOutputRegisters.keys().contains(modbusAddress)) {
-                                RegisterDescriptor descriptor =  m_modbusAnalogOutputRegisters.value(modbusAddress);
+                            if (m_modbusMap->analogOutputRegisters.contains(modbusAddress)) {
+                                RegisterDescriptor descriptor =  m_modbusMap->analogOutputRegisters.value(modbusAddress);
                                 circuit = descriptor.circuit;
                                 quint32 value = 0;
                                 if (descriptor.count == 1) {
                                     value = unit.value(i);
                                 } else if (descriptor.count == 2) {
-                                    if (unit.valueCount() >= (i+1)) {
+                                    if (unit.valueCount() > (i+1)) {
                                         value = (unit.value(i) << 16 | unit.value(i+1));
                                         i++;
                                     } else {
@@ -506,14 +689,25 @@ bool NeuronCommon::modbusReadRequest(const QModbusDataUnit &request)
                             }
                         } break;
                         case QModbusDataUnit::RegisterType::InputRegisters:
-                            if(m_modbusAnalogInputRegisters.keys().contains(modbusAddress)){
-                                RegisterDescriptor descriptor = m_modbusAnalogInputRegisters.value(modbusAddress);
+                            if (m_modbusMap->digitalInputRegisterBits.contains(modbusAddress)) {
+                                // Packed digital inputs, one bit per circuit
+                                QHash<int, QString> bits = m_modbusMap->digitalInputRegisterBits.value(modbusAddress);
+                                foreach (int bit, bits.keys()) {
+                                    circuit = bits.value(bit);
+                                    bool value = (unit.value(i) >> bit) & 0x01;
+                                    if (circuitValueChanged(circuit, value)) {
+                                        m_digitalInputChanged = true;
+                                        emit digitalInputStatusChanged(circuit, value);
+                                    }
+                                }
+                            } else if(m_modbusMap->analogInputRegisters.contains(modbusAddress)){
+                                RegisterDescriptor descriptor = m_modbusMap->analogInputRegisters.value(modbusAddress);
                                 circuit = descriptor.circuit;
                                 quint32 value = 0;
                                 if (descriptor.count == 1) {
                                     value = unit.value(i);
                                 } else if (descriptor.count == 2) {
-                                    if (unit.valueCount() >= (i+1)) {
+                                    if (unit.valueCount() > (i+1)) {
                                         value = (unit.value(i) << 16 | unit.value(i+1));
                                         i++;
                                     } else {
@@ -540,52 +734,52 @@ bool NeuronCommon::modbusReadRequest(const QModbusDataUnit &request)
                 }
             });
             QTimer::singleShot(m_responseTimeoutTime, reply, &QModbusReply::deleteLater);
+            return reply;
         } else {
             reply->deleteLater(); // broadcast replies return immediately
-            return false;
+            return nullptr;
         }
     } else {
         qCWarning(dcUniPi()) << "Neuron: Read error: " << m_modbusInterface->errorString();
-        return false;
+        return nullptr;
     }
-    return true;
 }
 
-void NeuronCommon::getCoils(QList<int> registerList)
+void NeuronCommon::sendReadRequest(const Request &request)
 {
-    if (registerList.isEmpty()) {
+    QModbusReply *reply = modbusReadRequest(request.data);
+    if (request.id != m_digitalInputPollRequestId)
         return;
+
+    m_queuedDigitalInputPolls = qMax(0, m_queuedDigitalInputPolls - 1);
+    if (reply) {
+        trackDigitalInputPoll(reply);
+    } else if (m_pendingDigitalInputReplies.isEmpty() && m_queuedDigitalInputPolls == 0) {
+        scheduleDigitalInputPolling();
     }
+}
 
-    std::sort(registerList.begin(), registerList.end());
-    int previousReg = registerList.first(); //first register to read and starting point to get the following registers
-    int startAddress;
-
-    QHash<int, int> registerGroups;
-
-    foreach (int reg, registerList) {
-        //qDebug(dcUniPi()) << "Register" << reg << "previous Register" << previousReg;
-        if (reg == previousReg) { //first register
-            startAddress = reg;
-            registerGroups.insert(startAddress, 1);
-        } else if (reg == (previousReg + 1)) { //next register in block
-            previousReg = reg;
-            registerGroups.insert(startAddress, (registerGroups.value(startAddress) + 1)); //update block length
-        } else {    // new block
-            startAddress = reg;
-            previousReg = reg;
-            registerGroups.insert(startAddress, 1);
+void NeuronCommon::trackDigitalInputPoll(QModbusReply *reply)
+{
+    // Note: destroyed will be emitted for finished and for timed out replies
+    m_pendingDigitalInputReplies.append(reply);
+    connect(reply, &QModbusReply::destroyed, this, [this, reply](){
+        m_pendingDigitalInputReplies.removeAll(reply);
+        if (m_pendingDigitalInputReplies.isEmpty() && m_queuedDigitalInputPolls == 0) {
+            scheduleDigitalInputPolling();
         }
-    }
+    });
+}
 
-    foreach (int startAddress, registerGroups.keys()) {
-        QModbusDataUnit request = QModbusDataUnit(QModbusDataUnit::RegisterType::Coils, startAddress, registerGroups.value(startAddress));
+void NeuronCommon::readRanges(const QList<QModbusDataUnit> &ranges)
+{
+    foreach (const QModbusDataUnit &request, ranges) {
         if (m_readRequestQueue.isEmpty()) {
             modbusReadRequest(request);
         } else if (m_readRequestQueue.length() > 100) {
             qCWarning(dcUniPi()) << "Neuron: Too many pending read requests";
         } else {
-            m_readRequestQueue.append(request);
+            m_readRequestQueue.append(Request{QUuid(), request});
         }
     }
 }
@@ -594,10 +788,84 @@ void NeuronCommon::onOutputPollingTimer()
 {
     getAllDigitalOutputs();
     getAllAnalogOutputs();
+    getAllUserLEDs();
 }
 
 void NeuronCommon::onInputPollingTimer()
 {
-    getAllDigitalInputs();
+    if (m_inputPollingMode == InputPollingModeFixed)
+        getAllDigitalInputs();
+
     getAllAnalogInputs();
 }
+
+void NeuronCommon::startPolling()
+{
+    m_inputPollingTimer->start();
+    m_outputPollingTimer->start();
+
+    if (m_inputPollingMode == InputPollingModeAdaptive) {
+        m_digitalInputPollingTimer->setInterval(m_minimumDigitalInputPollingInterval);
+        m_digitalInputPollingTimer->start();
+    }
+}
+
+void NeuronCommon::stopPolling()
+{
+    m_inputPollingTimer->stop();
+    m_outputPollingTimer->stop();
+    m_digitalInputPollingTimer->stop();
+
+    // Queued requests will not be sent any more on this connection
+    m_readRequestQueue.clear();
+    m_queuedDigitalInputPolls = 0;
+}
+
+void NeuronCommon::pollDigitalInputs()
+{
+    if (m_inputPollingMode != InputPollingModeAdaptive)
+        return;
+
+    if (!m_pendingDigitalInputReplies.isEmpty() || m_queuedDigitalInputPolls > 0)
+        return;
+
+    // Prefer the packed digital input registers (one register per group) over the single coils
+    const QList<QModbusDataUnit> ranges = m_digitalInputRegisterReadRanges.isEmpty() ? m_digitalInputReadRanges : m_digitalInputRegisterReadRanges;
+
+    // Go through the read queue like any other read, so the poll does not overtake queued requests
+    m_digitalInputChanged = false;
+    foreach (const QModbusDataUnit &request, ranges) {
+        if (m_readRequestQueue.isEmpty()) {
+            if (QModbusReply *reply = modbusReadRequest(request)) {
+                trackDigitalInputPoll(reply);
+            }
+        } else if (m_readRequestQueue.length() > 100) {
+            qCWarning(dcUniPi()) << "Neuron: Too many pending read requests";
+        } else {
+            m_readRequestQueue.append(Request{m_digitalInputPollRequestId, request});
+            m_queuedDigitalInputPolls++;
+        }
+    }
+
+    if (m_pendingDigitalInputReplies.isEmpty() && m_queuedDigitalInputPolls == 0) {
+        scheduleDigitalInputPolling();
+    }
+}
+
+void NeuronCommon::scheduleDigitalInputPolling()
+{
+    if (m_inputPollingMode != InputPollingModeAdaptive)
+        return;
+
+    if (m_modbusInterface->state() != QModbusDevice::State::ConnectedState)
+        return;
+
+    // Poll tight right after a change, double the interval on each idle poll
+    int interval = m_minimumDigitalInputPollingInterval;
+    if (!m_digitalInputChanged) {
+        interval = qMin(m_digitalInputPollingTimer->interval() * 2, m_maximumDigitalInputPollingInterval);
+    }
+
+    m_digitalInputPollingTimer->setInterval(interval);
+    m_digitalInputPollingTimer->start();
+}
@@ -33,11 +33,18 @@
 
 #include <QObject>
 #include <QtSerialBus>
+#include <QSharedPointer>
 
 class NeuronCommon : public QObject
 {
     Q_OBJECT
 public:
+    enum InputPollingMode {
+        InputPollingModeFixed,      // Poll all digital inputs every 200 ms
+        InputPollingModeAdaptive    // Poll fast after a change, back off exponentially while idle
+    };
+    Q_ENUM(InputPollingMode)
+
     explicit NeuronCommon(QModbusClient *modbusInterface, int slaveAddress, QObject *parent = nullptr);
     bool init();
     int slaveAddress();
@@ -63,9 +70,14 @@ public:
     void getAllDigitalInputs();
     void getAllAnalogInputs();
     void getAllAnalogOutputs();
+    void getAllUserLEDs();
 
     bool getUserLED(const QString &circuit);
 
+    InputPollingMode inputPollingMode() const;
+    void setInputPollingMode(InputPollingMode inputPollingMode);
+    void setInputPollingIntervals(int minimumInterval, int maximumInterval);
+
 protected:
     enum RWPermission {
         RWPermissionNone,
@@ -84,13 +96,19 @@ protected:
     };
 
     virtual bool loadModbusMap() = 0;
-    RegisterDescriptor registerDescriptorFromStringList(const QStringList &data);
-
-    QHash<QString, int> m_modbusDigitalOutputRegisters;
-    QHash<QString, int> m_modbusDigitalInputRegisters;
-    QHash<QString, int> m_modbusUserLEDRegisters;
-    QHash<int, RegisterDescriptor> m_modbusAnalogInputRegisters;
-    QHash<int, RegisterDescriptor> m_modbusAnalogOutputRegisters;
+    bool loadCompiledModbusMap(const QString &mapName);
+    void buildReadPlan();
+
+    // Circuit lookup tables of one device type, shared by all devices of that type
+    struct ModbusMap {
+        QHash<QString, int> digitalOutputRegisters;
+        QHash<QString, int> digitalInputRegisters;
+        QHash<QString, int> userLEDRegisters;
+        QHash<int, RegisterDescriptor> analogInputRegisters;
+        QHash<int, RegisterDescriptor> analogOutputRegisters;
+        // Packed digital input registers: register address -> (bit -> circuit)
+        QHash<int, QHash<int, QString>> digitalInputRegisterBits;
+    };
 
 private:
     struct Request {
@@ -101,20 +119,53 @@ private:
     int m_slaveAddress = 0;
     uint m_responseTimeoutTime = 2000;
     QModbusClient *m_modbusInterface = nullptr;
+    QSharedPointer<const ModbusMap> m_modbusMap;
 
     QTimer *m_inputPollingTimer = nullptr;
     QTimer *m_outputPollingTimer = nullptr;
 
+    InputPollingMode m_inputPollingMode = InputPollingModeAdaptive;
+    QTimer *m_digitalInputPollingTimer = nullptr;
+    int m_minimumDigitalInputPollingInterval = 20;
+    int m_maximumDigitalInputPollingInterval = 1000;
+    QUuid m_digitalInputPollRequestId;
+    QList<QModbusReply *> m_pendingDigitalInputReplies;
+    int m_queuedDigitalInputPolls = 0;
+    bool m_digitalInputChanged = false;
+
     QList<Request> m_writeRequestQueue;
-    QList<QModbusDataUnit> m_readRequestQueue;
+    QList<Request> m_readRequestQueue;
 
     QHash<QString, uint16_t> m_previousCircuitValue;
 
+    // Read plan, built once from the modbus map. Each list contains the minimal set
+    // of contiguous range reads covering all circuits of one kind.
+    QList<QModbusDataUnit> m_digitalInputReadRanges;
+    QList<QModbusDataUnit> m_digitalInputRegisterReadRanges;
+    QList<QModbusDataUnit> m_digitalOutputReadRanges;
+    QList<QModbusDataUnit> m_userLEDReadRanges;
+    QList<QModbusDataUnit> m_analogInputReadRanges;
+    QList<QModbusDataUnit> m_analogOutputReadRanges;
+
+    // Reverse lookup modbus address -> circuit for decoding the range replies
+    QHash<int, QString> m_digitalInputCircuits;
+    QHash<int, QString> m_digitalOutputCircuits;
+    QHash<int, QString> m_userLEDCircuits;
+
     bool circuitValueChanged(const QString &circuit, quint32 value);
     bool getAnalogIO(const RegisterDescriptor &descriptor);
-    bool modbusReadRequest(const QModbusDataUnit &request);
+    QModbusReply *modbusReadRequest(const QModbusDataUnit &request);
+    void sendReadRequest(const Request &request);
+    void trackDigitalInputPoll(QModbusReply *reply);
     bool modbusWriteRequest(const Request &request);
-    void getCoils(QList<int> registers);
+    void readRanges(const QList<QModbusDataUnit> &ranges);
+    void startPolling();
+    void stopPolling();
+    void pollDigitalInputs();
+    void scheduleDigitalInputPolling();
+
+    static QList<QModbusDataUnit> contiguousReadRanges(QModbusDataUnit::RegisterType registerType, QList<int> addresses);
+    static QList<QModbusDataUnit> registerReadRanges(QList<RegisterDescriptor> descriptors);
 
 signals:
     void requestExecuted(const QUuid &requestId, bool success);
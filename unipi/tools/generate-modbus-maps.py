@@ -0,0 +1,195 @@
+#!/usr/bin/env python3
+
+# Copyright (C) 2021 - 2023 nymea GmbH <developer@nymea.io>
+#
+# This program is free software; you can redistribute it and/or
+# modify it under the terms of the GNU General Public License
+# as published by the Free Software Foundation; either version 2
+# of the License, or (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+# Compile the UniPi Neuron modbus maps (CSV files exported from the UniPi documentation)
+# into static tables, so the plugin does not have to parse dozens of files on each thing setup.
+
+import os
+import sys
+import csv
+import argparse
+import logging
+
+logger = logging.getLogger('generate-modbus-maps')
+
+
+def classifyCoil(content):
+    if 'digital input' in content.lower():
+        return 'DigitalInput'
+    if 'digital output' in content.lower():
+        return 'DigitalOutput'
+    if 'relay output' in content.lower():
+        return 'RelayOutput'
+    if 'user programmable led' in content.lower():
+        return 'UserLED'
+    return None
+
+
+def classifyRegister(content):
+    if content.lower().startswith('digital input'):
+        return 'DigitalInputBits'
+    if 'analog input value' in content.lower():
+        return 'AnalogInput'
+    if 'analog output value' in content.lower():
+        return 'AnalogOutput'
+    return None
+
+
+def loadCoils(filePath):
+    entries = []
+    with open(filePath, newline='') as csvFile:
+        reader = csv.reader(csvFile)
+        next(reader, None) # Header
+        for row in reader:
+            if len(row) <= 4:
+                logger.error('Corrupted CSV file %s' % filePath)
+                sys.exit(1)
+
+            if row[4] != 'Basic' or row[0] == '':
+                continue
+
+            entryType = classifyCoil(row[3])
+            if entryType:
+                entries.append((int(row[0]), row[3].split(' ')[-1], entryType))
+
+    return entries
+
+
+def loadRegisters(filePath):
+    entries = []
+    with open(filePath, newline='') as csvFile:
+        reader = csv.reader(csvFile)
+        next(reader, None) # Header
+        for row in reader:
+            if len(row) <= 5:
+                logger.error('Corrupted CSV file %s' % filePath)
+                sys.exit(1)
+
+            if row[-1] != 'Basic' or row[0] == '':
+                continue
+
+            entryType = classifyRegister(row[5])
+            if entryType:
+                bit = int(row[6]) if len(row) > 6 and row[6] != '' else -1
+                entries.append((int(row[0]), int(row[2]), bit, row[3], row[5].split(' ')[-1], entryType))
+
+    return entries
+
+
+def writeHeader(outputFilePath, maps):
+    with open(outputFilePath, 'w') as headerFile:
+        headerFile.write('// This file has been generated by generate-modbus-maps.py. Do not edit, all changes will be lost.\n\n')
+        headerFile.write('#ifndef UNIPIMODBUSMAPS_H\n')
+        headerFile.write('#define UNIPIMODBUSMAPS_H\n\n')
+        headerFile.write('#include <string.h>\n\n')
+        headerFile.write('namespace UniPiModbusMaps {\n\n')
+        headerFile.write('enum EntryType {\n')
+        headerFile.write('    DigitalInput,\n')
+        headerFile.write('    DigitalOutput,\n')
+        headerFile.write('    RelayOutput,\n')
+        headerFile.write('    UserLED,\n')
+        headerFile.write('    DigitalInputBits,\n')
+        headerFile.write('    AnalogInput,\n')
+        headerFile.write('    AnalogOutput\n')
+        headerFile.write('};\n\n')
+        headerFile.write('struct CoilEntry {\n')
+        headerFile.write('    int address;\n')
+        headerFile.write('    const char *circuit;\n')
+        headerFile.write('    EntryType type;\n')
+        headerFile.write('};\n\n')
+        headerFile.write('struct RegisterEntry {\n')
+        headerFile.write('    int address;\n')
+        headerFile.write('    int count;\n')
+        headerFile.write('    int bit;\n')
+        headerFile.write('    const char *readWrite;\n')
+        headerFile.write('    const char *circuit;\n')
+        headerFile.write('    EntryType type;\n')
+        headerFile.write('};\n\n')
+        headerFile.write('struct Map {\n')
+        headerFile.write('    const char *name;\n')
+        headerFile.write('    const CoilEntry *coils;\n')
+        headerFile.write('    int coilCount;\n')
+        headerFile.write('    const RegisterEntry *registers;\n')
+        headerFile.write('    int registerCount;\n')
+        headerFile.write('};\n\n')
+
+        for name, (coils, registers) in maps:
+            headerFile.write('static const CoilEntry %sCoils[] = {\n' % name)
+            for address, circuit, entryType in coils:
+                headerFile.write('    { %s, "%s", %s },\n' % (address, circuit, entryType))
+            if not coils:
+                headerFile.write('    { 0, "", DigitalInput }\n')
+            headerFile.write('};\n\n')
+
+            headerFile.write('static const RegisterEntry %sRegisters[] = {\n' % name)
+            for address, count, bit, readWrite, circuit, entryType in registers:
+                headerFile.write('    { %s, %s, %s, "%s", "%s", %s },\n' % (address, count, bit, readWrite, circuit, entryType))
+            if not registers:
+                headerFile.write('    { 0, 0, -1, "", "", AnalogInput }\n')
+            headerFile.write('};\n\n')
+
+        headerFile.write('static const Map maps[] = {\n')
+        for name, (coils, registers) in maps:
+            headerFile.write('    { "%s", %sCoils, %s, %sRegisters, %s },\n' % (name, name, len(coils), name, len(registers)))
+        headerFile.write('};\n\n')
+
+        headerFile.write('inline const Map *findMap(const char *name)\n')
+        headerFile.write('{\n')
+        headerFile.write('    for (unsigned int i = 0; i < sizeof(maps) / sizeof(Map); i++) {\n')
+        headerFile.write('        if (strcmp(maps[i].name, name) == 0)\n')
+        headerFile.write('            return &maps[i];\n')
+        headerFile.write('    }\n')
+        headerFile.write('    return nullptr;\n')
+        headerFile.write('}\n\n')
+        headerFile.write('}\n\n')
+        headerFile.write('#endif // UNIPIMODBUSMAPS_H\n')
+
+
+if __name__ == '__main__':
+    parser = argparse.ArgumentParser(description='Compile the UniPi modbus map CSV files into a C++ header with static tables.')
+    parser.add_argument('-i', '--input', metavar='<directory>', help='The modbus_maps directory containing one sub directory per device.', required=True)
+    parser.add_argument('-o', '--output', metavar='<file>', help='The header file to generate.', required=True)
+    parser.add_argument('-v', '--verbose', help='Print more information.', action='store_true')
+    args = parser.parse_args()
+
+    logging.basicConfig(format='%(levelname)s: %(message)s', level=logging.DEBUG if args.verbose else logging.INFO)
+
+    maps = []
+    for deviceName in sorted(os.listdir(args.input)):
+        deviceDirectory = os.path.join(args.input, deviceName)
+        if not os.path.isdir(deviceDirectory):
+            continue
+
+        coils = []
+        registers = []
+        for fileName in sorted(os.listdir(deviceDirectory)):
+            filePath = os.path.join(deviceDirectory, fileName)
+            if '-Coils-' in fileName:
+                coils += loadCoils(filePath)
+            elif '-Registers-' in fileName:
+                registers += loadRegisters(filePath)
+
+        logger.debug('%s: %s coils, %s registers' % (deviceName, len(coils), len(registers)))
+        maps.append((deviceName, (coils, registers)))
+
+    outputDirectory = os.path.dirname(os.path.abspath(args.output))
+    if not os.path.exists(outputDirectory):
+        os.makedirs(outputDirectory)
+
+    writeHeader(args.output, maps)
+    logger.info('Compiled %s modbus maps into %s' % (len(maps), args.output))
@@ -39,8 +39,8 @@ UniPi::UniPi(I2CManager *i2cManager, UniPiType unipiType, QObject *parent) :
     m_unipiType(unipiType)
 {
     m_mcp23008 = new MCP23008("i2c-1", 0x20, this);
-    m_analogInputChannel1 = new MCP342XChannel("i2c-1", 0x68, 0, MCP342XChannel::Gain_1, this);
-    m_analogInputChannel2 = new MCP342XChannel("i2c-1", 0x68, 1, MCP342XChannel::Gain_1, this);
+    m_analogInputChannel1 = new MCP342XChannel("i2c-1", 0x68, 0, MCP342XChannel::Gain_1, MCP342XChannel::Bits12, this);
+    m_analogInputChannel2 = new MCP342XChannel("i2c-1", 0x68, 1, MCP342XChannel::Gain_1, MCP342XChannel::Bits12, this);
 
     m_analogOutput = new UniPiPwm(0, this);
 }
@@ -126,8 +126,8 @@ bool UniPi::init()
             qCWarning(dcUniPi()) << "Error reading data from analog channel 1" << data;
             return;
         }
-        qint16 rawValue = (static_cast<quint16>(data[0]) << 8) | data[1];
-        double voltage = (rawValue * 0.001 * 5.51)/2.00;
+        // Input divider of the analog inputs
+        double voltage = (m_analogInputChannel1->voltage(data) * 5.51)/2.00;
         emit analogInputStatusChanged("AI1", voltage);
     });
     m_i2cManager->startReading(m_analogInputChannel1, 5000);
@@ -142,8 +142,7 @@ bool UniPi::init()
             qCWarning(dcUniPi()) << "Error reading data from analog channel 2" << data;
             return;
         }
-        qint16 rawValue = (static_cast<quint16>(data[0]) << 8) | data[1];
-        double voltage = (rawValue * 0.001 * 5.51)/2.00;
+        double voltage = (m_analogInputChannel2->voltage(data) * 5.51)/2.00;
         emit analogInputStatusChanged("AI2", voltage);
     });
     m_i2cManager->startReading(m_analogInputChannel2, 5000);
@@ -33,7 +33,11 @@ HEADERS += \
     mcp342xchannel.h \
     unipipwm.h
 
-MAP_FILES.files = files(modbus_maps/*)
-MAP_FILES.path = [QT_INSTALL_PREFIX]/share/nymea/modbus/
-INSTALLS += MAP_FILES
+# Compile the modbus maps into static tables
+message("Compiling UniPi modbus maps")
+system(python3 $${PWD}/tools/generate-modbus-maps.py -i $${PWD}/modbus_maps -o $${OUT_PWD}/autogenerated/unipimodbusmaps.h)
+INCLUDEPATH += $${OUT_PWD}/autogenerated
+HEADERS += $${OUT_PWD}/autogenerated/unipimodbusmaps.h
+
+OTHER_FILES += $$files(modbus_maps/*.csv, true)
 
@@ -691,23 +691,16 @@ void IntegrationPluginWebasto::setupWebastoNextConnection(ThingSetupInfo *info)
 
 void IntegrationPluginWebasto::update(Webasto *webasto)
 {
-    webasto->getRegister(Webasto::TqChargePointState);
-    webasto->getRegister(Webasto::TqCableState);
-    webasto->getRegister(Webasto::TqEVSEError);
+    // Charge point state, cable state, errors, currents, power and energy meter
+    webasto->getRegisterBlock(Webasto::TqChargePointState, Webasto::TqEnergyMeter + Webasto::registerLength(Webasto::TqEnergyMeter) - Webasto::TqChargePointState);
 
-    webasto->getRegister(Webasto::TqCurrentL1);
-    webasto->getRegister(Webasto::TqCurrentL2);
-    webasto->getRegister(Webasto::TqCurrentL3);
+    // Maximal current limits
+    webasto->getRegisterBlock(Webasto::TqMaxCurrent, Webasto::TqMaxCurrentFromEV + Webasto::registerLength(Webasto::TqMaxCurrentFromEV) - Webasto::TqMaxCurrent);
 
-    webasto->getRegister(Webasto::TqActivePower, 2);
-    webasto->getRegister(Webasto::TqEnergyMeter, 2);
+    // Charged energy and session times
+    webasto->getRegisterBlock(Webasto::TqChargedEnergy, Webasto::TqEndTime + Webasto::registerLength(Webasto::TqEndTime) - Webasto::TqChargedEnergy);
 
-    webasto->getRegister(Webasto::TqMaxCurrent);
-
-    webasto->getRegister(Webasto::TqChargedEnergy);
-    webasto->getRegister(Webasto::TqChargingTime, 2);
-
-    webasto->getRegister(Webasto::TqUserId, 10);
+    webasto->getRegister(Webasto::TqUserId, Webasto::registerLength(Webasto::TqUserId));
 }
 
 void IntegrationPluginWebasto::evaluatePhaseCount(Thing *thing)
@@ -31,6 +31,8 @@
 #include "webasto.h"
 #include "extern-plugininfo.h"
 
+#include <QMetaEnum>
+
 Webasto::Webasto(const QHostAddress &address, uint port, QObject *parent) :
     QObject(parent)
 {
@@ -88,6 +90,35 @@ void Webasto::getRegister(Webasto::TqModbusRegister modbusRegister, uint length)
     m_modbusConnection->readHoldingRegister(m_unitId, modbusRegister, length);
 }
 
+void Webasto::getRegisterBlock(Webasto::TqModbusRegister startRegister, uint length)
+{
+    qCDebug(dcWebasto()) << "Webasto: Get register block" << startRegister << length;
+    if (length < 1 || length > 125) {
+        qCWarning(dcWebasto()) << "Invalide register block length, allowed values [1,125]";
+        return;
+    }
+
+    m_modbusConnection->readHoldingRegister(m_unitId, startRegister, length);
+}
+
+uint Webasto::registerLength(Webasto::TqModbusRegister modbusRegister)
+{
+    switch (modbusRegister) {
+    case TqActivePower:
+    case TqEnergyMeter:
+    case TqEVBatteryCapacity:
+    case TqRequiredEnergy:
+    case TqStartTime:
+    case TqChargingTime:
+    case TqEndTime:
+        return 2;
+    case TqUserId:
+        return 10;
+    default:
+        return 1;
+    }
+}
+
 QUuid Webasto::setSafeCurrent(quint16 ampere) const
 {
     return m_modbusConnection->writeHoldingRegister(m_unitId, TqSafeCurrent, ampere);
@@ -137,5 +168,27 @@ void Webasto::onReceivedHoldingRegister(uint slaveAddress, uint modbusRegister,
             emit connectionStateChanged(true);
         }
     }
-    emit receivedRegister(TqModbusRegister(modbusRegister), values);
+
+    if (static_cast<uint>(values.count()) <= registerLength(TqModbusRegister(modbusRegister))) {
+        emit receivedRegister(TqModbusRegister(modbusRegister), values);
+        return;
+    }
+
+    // Split the block into the known registers it contains
+    QMetaEnum registerEnum = QMetaEnum::fromType<TqModbusRegister>();
+    for (int i = 0; i < registerEnum.keyCount(); i++) {
+        uint registerAddress = registerEnum.value(i);
+        if (registerAddress < modbusRegister)
+            continue;
+
+        uint offset = registerAddress - modbusRegister;
+        if (offset >= static_cast<uint>(values.count()))
+            break;
+
+        uint length = registerLength(TqModbusRegister(registerAddress));
+        if (offset + length > static_cast<uint>(values.count()))
+            continue;
+
+        emit receivedRegister(TqModbusRegister(registerAddress), values.mid(offset, length));
+    }
 }
@@ -122,6 +122,10 @@ public:
     void setLivebitInterval(uint seconds);
 
     void getRegister(TqModbusRegister modbusRegister, uint length = 1);
+    // Reads a range of registers with one request, receivedRegister will be emitted for each register within the block
+    void getRegisterBlock(TqModbusRegister startRegister, uint length);
+
+    static uint registerLength(TqModbusRegister modbusRegister);
 
     QUuid setSafeCurrent(quint16 ampere) const;
     QUuid seComTimeout(quint16 seconds) const;
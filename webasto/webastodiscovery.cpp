@@ -35,7 +35,45 @@ WebastoDiscovery::WebastoDiscovery(NetworkDeviceDiscovery *networkDeviceDiscover
     : QObject{parent},
       m_networkDeviceDiscovery{networkDeviceDiscovery}
 {
+    // Only hosts answering with valid charger, charge and EVSE states get a full connection
+    m_probe = new ModbusNetworkProbe(this);
+    m_probe->addPort(502);
+
+    ModbusNetworkProbe::Fingerprint fingerprint;
+    fingerprint.name = "webasto-next";
+    fingerprint.slaveId = 1;
+    fingerprint.registerType = QModbusDataUnit::HoldingRegisters;
+    fingerprint.registerAddress = 1000; // The "states" block: chargerState, chargeState, evseState
+    fingerprint.size = 3;
+    fingerprint.validator = [](const QVector<quint16> &values) {
+        const QMetaObject &metaObject = WebastoNextModbusTcpConnection::staticMetaObject;
+        QMetaEnum chargerStateEnum = metaObject.enumerator(metaObject.indexOfEnumerator("ChargerState"));
+        QMetaEnum chargeStateEnum = metaObject.enumerator(metaObject.indexOfEnumerator("ChargeState"));
+        QMetaEnum evseStateEnum = metaObject.enumerator(metaObject.indexOfEnumerator("EvseState"));
+        return values.count() == 3 && chargerStateEnum.valueToKey(values.at(0)) && chargeStateEnum.valueToKey(values.at(1)) && evseStateEnum.valueToKey(values.at(2));
+    };
+    m_probe->addFingerprint(fingerprint);
+
+    connect(m_probe, &ModbusNetworkProbe::resultFound, this, [this](const ModbusNetworkProbe::Result &result){
+        foreach (const NetworkDeviceInfo &networkDeviceInfo, m_networkDeviceInfos) {
+            if (networkDeviceInfo.address() == result.address) {
+                checkNetworkDevice(networkDeviceInfo);
+                return;
+            }
+        }
+    });
+
+    connect(m_probe, &ModbusNetworkProbe::finished, this, [this](){
+        m_probeFinished = true;
+        finishDiscoveryIfDone();
+    });
 
+    m_gracePeriodTimer.setInterval(5000);
+    m_gracePeriodTimer.setSingleShot(true);
+    connect(&m_gracePeriodTimer, &QTimer::timeout, this, [this](){
+        qCDebug(dcWebasto()) << "Discovery: Grace period timer triggered.";
+        finishDiscovery();
+    });
 }
 
 void WebastoDiscovery::startDiscovery()
@@ -43,18 +81,26 @@ void WebastoDiscovery::startDiscovery()
     // TODO: add parameter for searching WebastoNext or WebastoLive, for now the discovery searches only for WebastoNext
 
     m_startDateTime = QDateTime::currentDateTime();
+    m_probeFinished = false;
+    m_finished = false;
 
     qCInfo(dcWebasto()) << "Discovery: Starting to search for WebastoNext wallboxes in the network...";
     NetworkDeviceDiscoveryReply *discoveryReply = m_networkDeviceDiscovery->discover();
-    connect(discoveryReply, &NetworkDeviceDiscoveryReply::networkDeviceInfoAdded, this, &WebastoDiscovery::checkNetworkDevice);
+    connect(discoveryReply, &NetworkDeviceDiscoveryReply::networkDeviceInfoAdded, this, [this](const NetworkDeviceInfo &networkDeviceInfo){
+        m_networkDeviceInfos.append(networkDeviceInfo);
+        m_probe->probe(networkDeviceInfo.address());
+    });
     connect(discoveryReply, &NetworkDeviceDiscoveryReply::finished, discoveryReply, &NetworkDeviceDiscoveryReply::deleteLater);
     connect(discoveryReply, &NetworkDeviceDiscoveryReply::finished, this, [=](){
         qCDebug(dcWebasto()) << "Discovery: Network discovery finished. Found" << discoveryReply->networkDeviceInfos().count() << "network devices";
-        // Give the last connections added right before the network discovery finished a chance to check the device...
-        QTimer::singleShot(3000, this, [this](){
-            qCDebug(dcWebasto()) << "Discovery: Grace period timer triggered.";
-            finishDiscovery();
-        });
+        m_networkDeviceInfos = discoveryReply->networkDeviceInfos();
+
+        // Probe network device infos not probed already...
+        foreach (const NetworkDeviceInfo &networkDeviceInfo, m_networkDeviceInfos)
+            m_probe->probe(networkDeviceInfo.address());
+
+        // The probe finishes once all pending hosts have been checked
+        m_probe->finish();
     });
 }
 
@@ -94,6 +140,7 @@ void WebastoDiscovery::checkNetworkDevice(const NetworkDeviceInfo &networkDevice
             if (!valueEnum.valueToKey(rawValue)) {
                 qCDebug(dcWebasto()) << "Discovery: invalid enum value for cable state on connection on" << networkDeviceInfo.address().toString() << "Continue...";;
                 cleanupConnection(connection);
+                return;
             }
 
             QModbusReply *reply = connection->readChargerState();
@@ -114,6 +161,7 @@ void WebastoDiscovery::checkNetworkDevice(const NetworkDeviceInfo &networkDevice
                 if (!valueEnum.valueToKey(rawValue)) {
                     qCDebug(dcWebasto()) << "Discovery: invalid enum value for charger state on connection on" << networkDeviceInfo.address().toString() << "Continue...";;
                     cleanupConnection(connection);
+                    return;
                 }
 
 
@@ -182,12 +230,33 @@ void WebastoDiscovery::cleanupConnection(WebastoNextModbusTcpConnection *connect
     m_connections.removeAll(connection);
     connection->disconnectDevice();
     connection->deleteLater();
+
+    finishDiscoveryIfDone();
+}
+
+void WebastoDiscovery::finishDiscoveryIfDone()
+{
+    if (m_finished || !m_probeFinished)
+        return;
+
+    if (m_connections.isEmpty()) {
+        finishDiscovery();
+    } else if (!m_gracePeriodTimer.isActive()) {
+        m_gracePeriodTimer.start();
+    }
 }
 
 void WebastoDiscovery::finishDiscovery()
 {
     qint64 durationMilliSeconds = QDateTime::currentMSecsSinceEpoch() - m_startDateTime.toMSecsSinceEpoch();
 
+    // Make sure we finish only once
+    if (m_finished)
+        return;
+
+    m_finished = true;
+    m_gracePeriodTimer.stop();
+
     // Cleanup any leftovers...we don't care any more
     foreach (WebastoNextModbusTcpConnection *connection, m_connections)
         cleanupConnection(connection);
@@ -32,9 +32,11 @@
 #define WEBASTODISCOVERY_H
 
 #include <QObject>
+#include <QTimer>
 
 #include <network/networkdevicediscovery.h>
 
+#include "modbusnetworkprobe.h"
 #include "webastonextmodbustcpconnection.h"
 
 class WebastoDiscovery : public QObject
@@ -65,6 +67,12 @@ signals:
 private:
     NetworkDeviceDiscovery *m_networkDeviceDiscovery = nullptr;
 
+    ModbusNetworkProbe *m_probe = nullptr;
+    bool m_probeFinished = false;
+    bool m_finished = false;
+    QTimer m_gracePeriodTimer;
+
+    NetworkDeviceInfos m_networkDeviceInfos;
     QList<WebastoNextModbusTcpConnection *> m_connections;
 
     QList<Result> m_results;
@@ -73,6 +81,7 @@ private:
 
     void checkNetworkDevice(const NetworkDeviceInfo &networkDeviceInfo);
     void cleanupConnection(WebastoNextModbusTcpConnection *connection);
+    void finishDiscoveryIfDone();
 
     void finishDiscovery();
 };